@@ -0,0 +1,29 @@
+#include <backend.h>
+#include <utils/flog.h>
+
+// Backend for builds without any windowing library, only the headless mode can run
+namespace backend {
+    int init(std::string resDir) {
+        flog::error("This build has no GUI backend, run it with --headless <graph.json>");
+        return -1;
+    }
+
+    void beginFrame() {}
+
+    void render(bool vsync) {}
+
+    void getMouseScreenPos(double& x, double& y) {
+        x = 0;
+        y = 0;
+    }
+
+    void setMouseScreenPos(double x, double y) {}
+
+    int renderLoop() {
+        return 0;
+    }
+
+    int end() {
+        return 0;
+    }
+}
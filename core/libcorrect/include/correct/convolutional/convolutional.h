@@ -7,6 +7,9 @@
 #include "correct/convolutional/history_buffer.h"
 #include "correct/convolutional/error_buffer.h"
 
+typedef void (*convolutional_decode_inner_t)(correct_convolutional *conv, unsigned int sets,
+                                             const uint8_t *soft);
+
 struct correct_convolutional {
     const unsigned int *table;  // size 2**order
     size_t rate;                // e.g. 2, 3...
@@ -21,6 +24,10 @@ struct correct_convolutional {
     soft_measurement_t soft_measurement;
     history_buffer *history_buffer;
     error_buffer_t *errors;
+
+    // vectorized inner loop picked for this cpu, NULL to use the portable one
+    convolutional_decode_inner_t simd_decode_inner;
+    uint8_t *simd_shuffles;
 };
 
 correct_convolutional *_correct_convolutional_init(correct_convolutional *conv,
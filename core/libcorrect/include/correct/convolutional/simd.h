@@ -0,0 +1,67 @@
+#ifndef CORRECT_CONVOLUTIONAL_SIMD
+#define CORRECT_CONVOLUTIONAL_SIMD
+#include "correct/convolutional/convolutional.h"
+
+// vectorized add-compare-select for the inner decoding loop
+// each kernel computes exactly what convolutional_decode_inner does, ties included,
+// so its output is bit for bit the same as the portable decoder's
+//
+// the branch metrics of a time slice are shuffled into place for every state from a
+// single register, which limits the kernels to rate 2 and 3 codes
+// and the states are processed 16 at a time, which needs order 5 or more
+#define CONVOLUTIONAL_SIMD_MAX_RATE 3
+#define CONVOLUTIONAL_SIMD_MIN_ORDER 5
+
+bool convolutional_simd_supported(size_t rate, size_t order);
+
+// returns the fastest kernel this cpu can run for these parameters, or NULL
+convolutional_decode_inner_t convolutional_simd_select(size_t rate, size_t order);
+
+// byte shuffles that pick the branch metric of each low and high register
+// the first numstates bytes are for the low registers, the next numstates for the high ones
+uint8_t *convolutional_simd_shuffles_create(size_t rate, size_t order, const unsigned int *table);
+
+void convolutional_decode_inner_avx2(correct_convolutional *conv, unsigned int sets,
+                                     const uint8_t *soft);
+void convolutional_decode_inner_neon(correct_convolutional *conv, unsigned int sets,
+                                     const uint8_t *soft);
+
+// same branch metrics as the portable decoder, padded to the 8 entries of a register
+static inline void convolutional_simd_fill_distances(correct_convolutional *conv, unsigned int i,
+                                                     const uint8_t *soft, distance_t *distances) {
+    if (soft) {
+        if (conv->soft_measurement == CORRECT_SOFT_LINEAR) {
+            for (unsigned int j = 0; j < 1 << (conv->rate); j++) {
+                distances[j] = metric_soft_distance_linear(j, soft + i * conv->rate, conv->rate);
+            }
+        } else {
+            for (unsigned int j = 0; j < 1 << (conv->rate); j++) {
+                distances[j] = metric_soft_distance_quadratic(j, soft + i * conv->rate, conv->rate);
+            }
+        }
+    } else {
+        unsigned int out = bit_reader_read(conv->bit_reader, conv->rate);
+        for (unsigned int j = 0; j < 1 << (conv->rate); j++) {
+            distances[j] = metric_distance(j, out);
+        }
+    }
+    for (unsigned int j = 1 << (conv->rate); j < 8; j++) {
+        distances[j] = 0;
+    }
+}
+
+// history_buffer_process, with the common step that neither renormalizes nor traces back done inline
+static inline void convolutional_simd_history_process(history_buffer *buf, distance_t *distances,
+                                                      bit_writer_t *output) {
+    if (buf->len == buf->cap - 1 || buf->renormalize_counter == buf->renormalize_interval - 1) {
+        history_buffer_process(buf, distances, output);
+        return;
+    }
+    buf->index++;
+    if (buf->index == buf->cap) {
+        buf->index = 0;
+    }
+    buf->renormalize_counter++;
+    buf->len++;
+}
+#endif
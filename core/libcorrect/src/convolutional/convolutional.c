@@ -1,4 +1,5 @@
 #include "correct/convolutional/convolutional.h"
+#include "correct/convolutional/simd.h"
 
 // https://www.youtube.com/watch?v=b3_lVSrPB6w
 
@@ -28,6 +29,8 @@ correct_convolutional *_correct_convolutional_init(correct_convolutional *conv,
     conv->bit_reader = bit_reader_create(NULL, 0);
 
     conv->has_init_decode = false;
+    conv->simd_decode_inner = convolutional_simd_select(rate, order);
+    conv->simd_shuffles = NULL;
     return conv;
 }
 
@@ -50,6 +53,7 @@ void _correct_convolutional_teardown(correct_convolutional *conv) {
         history_buffer_destroy(conv->history_buffer);
         error_buffer_destroy(conv->errors);
         free(conv->distances);
+        free(conv->simd_shuffles);
     }
 }
 
@@ -1,4 +1,5 @@
 #include "correct/convolutional/convolutional.h"
+#include "correct/convolutional/simd.h"
 
 void conv_decode_print_iter(correct_convolutional *conv, unsigned int iter,
                             unsigned int winner_index) {
@@ -260,6 +261,10 @@ void _convolutional_decode_init(correct_convolutional *conv, unsigned int min_tr
                                                  conv->numstates / 2, 1 << (conv->order - 1));
 
     conv->errors = error_buffer_create(conv->numstates);
+
+    if (convolutional_simd_supported(conv->rate, conv->order)) {
+        conv->simd_shuffles = convolutional_simd_shuffles_create(conv->rate, conv->order, conv->table);
+    }
 }
 
 static ssize_t _convolutional_decode(correct_convolutional *conv, size_t num_encoded_bits,
@@ -281,7 +286,11 @@ static ssize_t _convolutional_decode(correct_convolutional *conv, size_t num_enc
 
     // no outputs are generated during warmup
     convolutional_decode_warmup(conv, sets, soft_encoded);
-    convolutional_decode_inner(conv, sets, soft_encoded);
+    if (conv->simd_decode_inner) {
+        conv->simd_decode_inner(conv, sets, soft_encoded);
+    } else {
+        convolutional_decode_inner(conv, sets, soft_encoded);
+    }
     convolutional_decode_tail(conv, sets, soft_encoded);
 
     history_buffer_flush(conv->history_buffer, conv->bit_writer);
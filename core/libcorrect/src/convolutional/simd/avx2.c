@@ -0,0 +1,58 @@
+#include "correct/convolutional/simd.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+
+// 16 successor states per iteration
+// for successor s, the low register is s and the high register is s | highbit,
+// and their predecessors are s >> 1 and highbase + (s >> 1)
+void convolutional_decode_inner_avx2(correct_convolutional *conv, unsigned int sets,
+                                     const uint8_t *soft) {
+    shift_register_t highbit = 1 << (conv->order - 1);
+    shift_register_t highbase = highbit >> 1;
+    const uint8_t *low_shuffles = conv->simd_shuffles;
+    const uint8_t *high_shuffles = conv->simd_shuffles + 2 * highbit;
+    const __m256i one = _mm256_set1_epi16(1);
+    distance_t distances[8];
+
+    for (unsigned int i = conv->order - 1; i < (sets - conv->order + 1); i++) {
+        convolutional_simd_fill_distances(conv, i, soft, distances);
+        // every output's distance, in both lanes so that the in-lane shuffles can reach them
+        __m256i dist = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)distances));
+
+        const distance_t *read_errors = conv->errors->read_errors;
+        distance_t *write_errors = conv->errors->write_errors;
+        uint8_t *history = history_buffer_get_slice(conv->history_buffer);
+
+        for (shift_register_t s = 0; s < highbit; s += 16) {
+            __m256i low_dist =
+                _mm256_shuffle_epi8(dist, _mm256_loadu_si256((const __m256i *)(low_shuffles + 2 * s)));
+            __m256i high_dist =
+                _mm256_shuffle_epi8(dist, _mm256_loadu_si256((const __m256i *)(high_shuffles + 2 * s)));
+
+            // successors 2k and 2k + 1 share predecessor k, so each past error is used twice
+            __m256i low_past_error =
+                _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(read_errors + (s >> 1))));
+            __m256i high_past_error = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128((const __m128i *)(read_errors + highbase + (s >> 1))));
+            low_past_error = _mm256_or_si256(low_past_error, _mm256_slli_epi32(low_past_error, 16));
+            high_past_error = _mm256_or_si256(high_past_error, _mm256_slli_epi32(high_past_error, 16));
+
+            __m256i low_error = _mm256_add_epi16(low_past_error, low_dist);
+            __m256i high_error = _mm256_add_epi16(high_past_error, high_dist);
+            __m256i error = _mm256_min_epu16(low_error, high_error);
+            _mm256_storeu_si256((__m256i *)(write_errors + s), error);
+
+            // the high register wins only when strictly better, as in the portable loop
+            __m256i hist = _mm256_andnot_si256(_mm256_cmpeq_epi16(low_error, error), one);
+            hist = _mm256_packus_epi16(hist, hist);
+            hist = _mm256_permute4x64_epi64(hist, 0x08);
+            _mm_storeu_si128((__m128i *)(history + s), _mm256_castsi256_si128(hist));
+        }
+
+        convolutional_simd_history_process(conv->history_buffer, write_errors, conv->bit_writer);
+        error_buffer_swap(conv->errors);
+    }
+}
@@ -0,0 +1,62 @@
+#include "correct/convolutional/simd.h"
+
+#if defined(HAVE_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef HAVE_AVX2
+static bool cpu_has_avx2(void) {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // the os must also save the ymm registers
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+bool convolutional_simd_supported(size_t rate, size_t order) {
+    return rate <= CONVOLUTIONAL_SIMD_MAX_RATE && order >= CONVOLUTIONAL_SIMD_MIN_ORDER;
+}
+
+convolutional_decode_inner_t convolutional_simd_select(size_t rate, size_t order) {
+    if (!convolutional_simd_supported(rate, order)) {
+        return NULL;
+    }
+#ifdef HAVE_AVX2
+    if (cpu_has_avx2()) {
+        return convolutional_decode_inner_avx2;
+    }
+#endif
+#ifdef HAVE_NEON
+    // always present on aarch64
+    return convolutional_decode_inner_neon;
+#endif
+    return NULL;
+}
+
+uint8_t *convolutional_simd_shuffles_create(size_t rate, size_t order, const unsigned int *table) {
+    unsigned int highbit = 1 << (order - 1);
+    uint8_t *shuffles = malloc(4 * highbit);
+    for (unsigned int i = 0; i < highbit; i++) {
+        // both bytes of the 16 bit distance for the output of this register
+        unsigned int low_output = table[i];
+        unsigned int high_output = table[highbit + i];
+        shuffles[2 * i] = 2 * low_output;
+        shuffles[2 * i + 1] = 2 * low_output + 1;
+        shuffles[2 * (highbit + i)] = 2 * high_output;
+        shuffles[2 * (highbit + i) + 1] = 2 * high_output + 1;
+    }
+    return shuffles;
+}
@@ -0,0 +1,46 @@
+#include "correct/convolutional/simd.h"
+#include <arm_neon.h>
+
+// 8 successor states per iteration
+// for successor s, the low register is s and the high register is s | highbit,
+// and their predecessors are s >> 1 and highbase + (s >> 1)
+void convolutional_decode_inner_neon(correct_convolutional *conv, unsigned int sets,
+                                     const uint8_t *soft) {
+    shift_register_t highbit = 1 << (conv->order - 1);
+    shift_register_t highbase = highbit >> 1;
+    const uint8_t *low_shuffles = conv->simd_shuffles;
+    const uint8_t *high_shuffles = conv->simd_shuffles + 2 * highbit;
+    const uint8x8_t one = vdup_n_u8(1);
+    distance_t distances[8];
+
+    for (unsigned int i = conv->order - 1; i < (sets - conv->order + 1); i++) {
+        convolutional_simd_fill_distances(conv, i, soft, distances);
+        uint8x16_t dist = vreinterpretq_u8_u16(vld1q_u16(distances));
+
+        const distance_t *read_errors = conv->errors->read_errors;
+        distance_t *write_errors = conv->errors->write_errors;
+        uint8_t *history = history_buffer_get_slice(conv->history_buffer);
+
+        for (shift_register_t s = 0; s < highbit; s += 8) {
+            uint16x8_t low_dist = vreinterpretq_u16_u8(vqtbl1q_u8(dist, vld1q_u8(low_shuffles + 2 * s)));
+            uint16x8_t high_dist = vreinterpretq_u16_u8(vqtbl1q_u8(dist, vld1q_u8(high_shuffles + 2 * s)));
+
+            // successors 2k and 2k + 1 share predecessor k, so each past error is used twice
+            uint16x4_t low_past = vld1_u16(read_errors + (s >> 1));
+            uint16x4_t high_past = vld1_u16(read_errors + highbase + (s >> 1));
+            uint16x8_t low_past_error = vcombine_u16(vzip1_u16(low_past, low_past), vzip2_u16(low_past, low_past));
+            uint16x8_t high_past_error = vcombine_u16(vzip1_u16(high_past, high_past), vzip2_u16(high_past, high_past));
+
+            uint16x8_t low_error = vaddq_u16(low_past_error, low_dist);
+            uint16x8_t high_error = vaddq_u16(high_past_error, high_dist);
+            vst1q_u16(write_errors + s, vminq_u16(low_error, high_error));
+
+            // the high register wins only when strictly better, as in the portable loop
+            uint8x8_t hist = vmovn_u16(vcgtq_u16(low_error, high_error));
+            vst1_u8(history + s, vand_u8(hist, one));
+        }
+
+        convolutional_simd_history_process(conv->history_buffer, write_errors, conv->bit_writer);
+        error_buffer_swap(conv->errors);
+    }
+}
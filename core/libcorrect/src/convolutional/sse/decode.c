@@ -281,7 +281,12 @@ static ssize_t _convolutional_sse_decode(correct_convolutional_sse *sse_conv,
 
     // no outputs are generated during warmup
     convolutional_decode_warmup(conv, sets, soft_encoded);
-    convolutional_sse_decode_inner(sse_conv, sets, soft_encoded);
+    // a wider kernel makes the same decisions as the sse loop
+    if (conv->simd_decode_inner) {
+        conv->simd_decode_inner(conv, sets, soft_encoded);
+    } else {
+        convolutional_sse_decode_inner(sse_conv, sets, soft_encoded);
+    }
     convolutional_decode_tail(conv, sets, soft_encoded);
 
     history_buffer_flush(conv->history_buffer, conv->bit_writer);
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "correct.h"
+#include "correct/convolutional/convolutional.h"
+#ifdef HAVE_SSE
+#include "correct-sse.h"
+#include "correct/convolutional/sse/convolutional.h"
+#endif
+
+// the vectorized decoders must give the same output as the portable one, bit for bit
+
+size_t max_encoded_bits = 65536;
+
+typedef ssize_t (*decode_soft_t)(void *conv, const uint8_t *soft, size_t num_encoded_bits, uint8_t *msg);
+typedef ssize_t (*decode_hard_t)(void *conv, const uint8_t *encoded, size_t num_encoded_bits, uint8_t *msg);
+
+ssize_t decode_soft(void *conv, const uint8_t *soft, size_t num_encoded_bits, uint8_t *msg) {
+    return correct_convolutional_decode_soft((correct_convolutional *)conv, soft, num_encoded_bits, msg);
+}
+
+ssize_t decode_hard(void *conv, const uint8_t *encoded, size_t num_encoded_bits, uint8_t *msg) {
+    return correct_convolutional_decode((correct_convolutional *)conv, encoded, num_encoded_bits, msg);
+}
+
+#ifdef HAVE_SSE
+ssize_t decode_sse_soft(void *conv, const uint8_t *soft, size_t num_encoded_bits, uint8_t *msg) {
+    return correct_convolutional_sse_decode_soft((correct_convolutional_sse *)conv, soft, num_encoded_bits, msg);
+}
+
+ssize_t decode_sse_hard(void *conv, const uint8_t *encoded, size_t num_encoded_bits, uint8_t *msg) {
+    return correct_convolutional_sse_decode((correct_convolutional_sse *)conv, encoded, num_encoded_bits, msg);
+}
+#endif
+
+// soft symbols of an encoded message with uniform noise of the given amplitude
+void corrupt(correct_convolutional *conv, size_t msg_len, int noise, uint8_t *encoded, uint8_t *soft,
+             size_t *num_encoded_bits) {
+    uint8_t *msg = malloc(msg_len);
+    for (size_t i = 0; i < msg_len; i++) {
+        msg[i] = rand() % 256;
+    }
+    *num_encoded_bits = correct_convolutional_encode(conv, msg, msg_len, encoded);
+    for (size_t i = 0; i < *num_encoded_bits; i++) {
+        int bit = (encoded[i / 8] >> (7 - (i % 8))) & 1;
+        int v = (bit ? 255 : 0) + (noise ? (rand() % (2 * noise + 1)) - noise : 0);
+        soft[i] = (v < 0) ? 0 : ((v > 255) ? 255 : v);
+    }
+    // hard decisions of the noisy symbols
+    memset(encoded, 0, *num_encoded_bits / 8 + 1);
+    for (size_t i = 0; i < *num_encoded_bits; i++) {
+        encoded[i / 8] |= (soft[i] >= 128) << (7 - (i % 8));
+    }
+    free(msg);
+}
+
+size_t compare(void *portable, void *simd, decode_soft_t soft_decoder, decode_hard_t hard_decoder,
+               const uint8_t *encoded, const uint8_t *soft, size_t num_encoded_bits) {
+    size_t len = num_encoded_bits / 8 + 1;
+    uint8_t *expected = calloc(len, 1);
+    uint8_t *decoded = calloc(len, 1);
+    size_t mismatches = 0;
+
+    ssize_t expected_len = soft_decoder(portable, soft, num_encoded_bits, expected);
+    ssize_t decoded_len = soft_decoder(simd, soft, num_encoded_bits, decoded);
+    if (expected_len != decoded_len || memcmp(expected, decoded, expected_len)) {
+        mismatches++;
+    }
+
+    memset(expected, 0, len);
+    memset(decoded, 0, len);
+    expected_len = hard_decoder(portable, encoded, num_encoded_bits, expected);
+    decoded_len = hard_decoder(simd, encoded, num_encoded_bits, decoded);
+    if (expected_len != decoded_len || memcmp(expected, decoded, expected_len)) {
+        mismatches++;
+    }
+
+    free(expected);
+    free(decoded);
+    return mismatches;
+}
+
+size_t compare_conv(correct_convolutional *portable, correct_convolutional *simd, void *portable_dec,
+                    void *simd_dec, decode_soft_t soft_decoder, decode_hard_t hard_decoder) {
+    uint8_t *encoded = malloc(max_encoded_bits / 8 + 1);
+    uint8_t *soft = malloc(max_encoded_bits);
+    size_t mismatches = 0;
+
+    // short blocks, long ones that go through many renormalizations, and random symbols full of ties
+    const size_t msg_lens[] = {1, 8, 31, 256, 2000};
+    const int noises[] = {0, 100, 180, 255};
+    for (size_t i = 0; i < sizeof(msg_lens) / sizeof(msg_lens[0]); i++) {
+        for (size_t j = 0; j < sizeof(noises) / sizeof(noises[0]); j++) {
+            size_t num_encoded_bits;
+            corrupt(portable, msg_lens[i], noises[j], encoded, soft, &num_encoded_bits);
+            mismatches += compare(portable_dec, simd_dec, soft_decoder, hard_decoder, encoded, soft, num_encoded_bits);
+        }
+    }
+    for (size_t num_encoded_bits = 124 * simd->rate; num_encoded_bits < 4096; num_encoded_bits += 301 * simd->rate) {
+        for (size_t i = 0; i < num_encoded_bits; i++) {
+            soft[i] = rand() % 256;
+            encoded[i / 8] = rand() % 256;
+        }
+        mismatches += compare(portable_dec, simd_dec, soft_decoder, hard_decoder, encoded, soft, num_encoded_bits);
+    }
+
+    free(encoded);
+    free(soft);
+    return mismatches;
+}
+
+void assert_test_result(size_t rate, size_t order, const correct_convolutional_polynomial_t *poly) {
+    correct_convolutional *portable = correct_convolutional_create(rate, order, poly);
+    correct_convolutional *simd = correct_convolutional_create(rate, order, poly);
+    portable->simd_decode_inner = NULL;
+    size_t mismatches = compare_conv(portable, simd, portable, simd, decode_soft, decode_hard);
+    correct_convolutional_destroy(portable);
+    correct_convolutional_destroy(simd);
+
+#ifdef HAVE_SSE
+    // the sse decoder itself needs order 6 or more
+    if (order >= 6) {
+        correct_convolutional_sse *portable_sse = correct_convolutional_sse_create(rate, order, poly);
+        correct_convolutional_sse *simd_sse = correct_convolutional_sse_create(rate, order, poly);
+        portable_sse->base_conv.simd_decode_inner = NULL;
+        mismatches += compare_conv(&portable_sse->base_conv, &simd_sse->base_conv, portable_sse, simd_sse,
+                                   decode_sse_soft, decode_sse_hard);
+        correct_convolutional_sse_destroy(portable_sse);
+        correct_convolutional_sse_destroy(simd_sse);
+    }
+#endif
+
+    if (mismatches) {
+        printf("test failed, %zu decodes differ from the portable decoder for rate %zu order %zu\n",
+               mismatches, rate, order);
+        exit(1);
+    } else {
+        printf("test passed, vectorized decoder matches the portable decoder for rate %zu order %zu\n",
+               rate, order);
+    }
+}
+
+int main() {
+    srand(time(NULL));
+
+    correct_convolutional *probe = correct_convolutional_create(2, 7, correct_conv_r12_7_polynomial);
+    bool available = probe->simd_decode_inner != NULL;
+    correct_convolutional_destroy(probe);
+    if (!available) {
+        printf("no vectorized decoder for this cpu, skipping\n");
+        return 0;
+    }
+
+    const correct_convolutional_polynomial_t r12_5_polynomial[] = {023, 035};
+    const correct_convolutional_polynomial_t r12_7_ccsds_polynomial[] = {0155, 0117};
+
+    assert_test_result(2, 5, r12_5_polynomial);
+    assert_test_result(2, 6, correct_conv_r12_6_polynomial);
+    assert_test_result(2, 7, correct_conv_r12_7_polynomial);
+    assert_test_result(2, 7, r12_7_ccsds_polynomial);
+    assert_test_result(2, 8, correct_conv_r12_8_polynomial);
+    assert_test_result(2, 9, correct_conv_r12_9_polynomial);
+    assert_test_result(3, 6, correct_conv_r13_6_polynomial);
+    assert_test_result(3, 7, correct_conv_r13_7_polynomial);
+    assert_test_result(3, 8, correct_conv_r13_8_polynomial);
+    assert_test_result(3, 9, correct_conv_r13_9_polynomial);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "correct.h"
+#include "correct/convolutional/convolutional.h"
+#ifdef HAVE_SSE
+#include "correct-sse.h"
+#include "correct/convolutional/sse/convolutional.h"
+#endif
+
+// soft decoding rate of each decoder, in decoded Mbit/s
+
+// enough for the measurement to last about a second on the portable decoder
+size_t msg_len = 4096;
+size_t iterations = 64;
+
+typedef ssize_t (*decode_soft_t)(void *conv, const uint8_t *soft, size_t num_encoded_bits, uint8_t *msg);
+
+ssize_t decode_soft(void *conv, const uint8_t *soft, size_t num_encoded_bits, uint8_t *msg) {
+    return correct_convolutional_decode_soft((correct_convolutional *)conv, soft, num_encoded_bits, msg);
+}
+
+#ifdef HAVE_SSE
+ssize_t decode_sse_soft(void *conv, const uint8_t *soft, size_t num_encoded_bits, uint8_t *msg) {
+    return correct_convolutional_sse_decode_soft((correct_convolutional_sse *)conv, soft, num_encoded_bits, msg);
+}
+#endif
+
+void benchmark(const char *name, void *conv, decode_soft_t decoder, size_t rate, const uint8_t *soft,
+               size_t num_encoded_bits, size_t block_bits) {
+    uint8_t *msg = malloc(num_encoded_bits / 8 + 1);
+    size_t decoded_bits = 0;
+    clock_t start = clock();
+    for (size_t i = 0; i < iterations; i++) {
+        // the stream is decoded in blocks of block_bits symbols, as the decoder modules do
+        for (size_t pos = 0; pos + block_bits <= num_encoded_bits; pos += block_bits) {
+            decoder(conv, soft + pos, block_bits, msg);
+            decoded_bits += block_bits / rate;
+        }
+    }
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("  %-16s %8.2f Mbit/s\n", name, decoded_bits / elapsed / 1e6);
+    free(msg);
+}
+
+void benchmark_code(size_t rate, size_t order, const correct_convolutional_polynomial_t *poly, size_t block_bits) {
+    correct_convolutional *portable = correct_convolutional_create(rate, order, poly);
+    correct_convolutional *simd = correct_convolutional_create(rate, order, poly);
+    portable->simd_decode_inner = NULL;
+
+    uint8_t *msg = malloc(msg_len);
+    for (size_t i = 0; i < msg_len; i++) {
+        msg[i] = rand() % 256;
+    }
+    size_t num_encoded_bits = correct_convolutional_encode_len(portable, msg_len);
+    uint8_t *encoded = malloc(num_encoded_bits / 8 + 1);
+    correct_convolutional_encode(portable, msg, msg_len, encoded);
+    uint8_t *soft = malloc(num_encoded_bits);
+    for (size_t i = 0; i < num_encoded_bits; i++) {
+        int bit = (encoded[i / 8] >> (7 - (i % 8))) & 1;
+        int v = (bit ? 255 : 0) + (rand() % 201) - 100;
+        soft[i] = (v < 0) ? 0 : ((v > 255) ? 255 : v);
+    }
+    if (!block_bits) {
+        block_bits = num_encoded_bits;
+    }
+
+    printf("rate %zu order %zu, blocks of %zu symbols\n", rate, order, block_bits);
+    benchmark("portable", portable, decode_soft, rate, soft, num_encoded_bits, block_bits);
+    if (simd->simd_decode_inner) {
+        benchmark("vectorized", simd, decode_soft, rate, soft, num_encoded_bits, block_bits);
+    }
+#ifdef HAVE_SSE
+    if (order >= 6) {
+        correct_convolutional_sse *sse = correct_convolutional_sse_create(rate, order, poly);
+        sse->base_conv.simd_decode_inner = NULL;
+        benchmark("sse", sse, decode_sse_soft, rate, soft, num_encoded_bits, block_bits);
+        correct_convolutional_sse_destroy(sse);
+    }
+#endif
+
+    correct_convolutional_destroy(portable);
+    correct_convolutional_destroy(simd);
+    free(msg);
+    free(encoded);
+    free(soft);
+}
+
+int main() {
+    srand(time(NULL));
+
+    const correct_convolutional_polynomial_t r12_7_ccsds_polynomial[] = {0155, 0117};
+
+    benchmark_code(2, 7, r12_7_ccsds_polynomial, 0);
+    benchmark_code(2, 7, r12_7_ccsds_polynomial, 124);
+    benchmark_code(2, 9, correct_conv_r12_9_polynomial, 0);
+    benchmark_code(3, 7, correct_conv_r13_7_polynomial, 0);
+    return 0;
+}
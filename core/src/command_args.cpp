@@ -15,6 +15,7 @@ void CommandArgsParser::defineAll() {
 
         define('a', "addr", "Server mode address", "0.0.0.0");
         define('h', "help", "Show help");
+        define('\0', "headless", "Run without a GUI, with the DSP graph described by the given JSON file", "");
         define('p', "port", "Server mode port", 5259);
         define('r', "root", "Root directory, where all config files are stored", std::filesystem::absolute(root).string());
         define('s', "server", "Run in server mode");
@@ -1,4 +1,5 @@
 #include <server.h>
+#include <headless.h>
 #include "imgui.h"
 #include <stdio.h>
 #include <gui/main_window.h>
@@ -13,6 +14,7 @@
 #include <core.h>
 #include <filesystem>
 #include <gui/menus/theme.h>
+#include <gui/menus/decoder_output.h>
 #include <backend.h>
 
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
@@ -37,10 +39,12 @@ namespace core {
     ModuleManager moduleManager;
     ModuleComManager modComManager;
     CommandArgsParser args;
+    DecoderBus decoderBus;
 
     void setInputSampleRate(double samplerate) {
-        // Forward this to the server
+        // Forward this to the server or headless mode
         if (args["server"].b()) { server::setInputSampleRate(samplerate); return; }
+        if (!args["headless"].s().empty()) { headless::setInputSampleRate(samplerate); return; }
         
         // Update IQ frontend input samplerate and get effective samplerate
         sigpath::iqFrontEnd.setSampleRate(samplerate);
@@ -78,10 +82,11 @@ int sdrpp_main(int argc, char* argv[]) {
     }
 
     bool serverMode = (bool)core::args["server"];
+    std::string headlessGraph = (std::string)core::args["headless"];
 
 #ifdef _WIN32
     // Free console if the user hasn't asked for a console and not in server mode
-    if (!core::args["con"].b() && !serverMode) { FreeConsole(); }
+    if (!core::args["con"].b() && !serverMode && headlessGraph.empty()) { FreeConsole(); }
 
     // Set error mode to avoid abnoxious popups
     SetErrorMode(SEM_NOOPENFILEERRORBOX | SEM_NOGPFAULTERRORBOX | SEM_FAILCRITICALERRORS);
@@ -233,6 +238,20 @@ int sdrpp_main(int argc, char* argv[]) {
     defConfig["decimationPower"] = 0;
     defConfig["iqCorrection"] = false;
     defConfig["invertIQ"] = false;
+    defConfig["sourceBuffers"] = json::object();
+    defConfig["captureZeroFill"] = false;
+    defConfig["fixedPointInput"] = false;
+
+    defConfig["decoderOutput"]["fileEnabled"] = false;
+    defConfig["decoderOutput"]["filePath"] = "%ROOT%/decoders";
+    defConfig["decoderOutput"]["fileFormat"] = "jsonl";
+    defConfig["decoderOutput"]["fileMaxSize"] = 16;
+    defConfig["decoderOutput"]["fileMaxCount"] = 10;
+    defConfig["decoderOutput"]["feedEnabled"] = false;
+    defConfig["decoderOutput"]["feedType"] = "udp";
+    defConfig["decoderOutput"]["feedHost"] = "127.0.0.1";
+    defConfig["decoderOutput"]["feedPort"] = 5270;
+    defConfig["decoderOutput"]["feedPath"] = "/tmp/sdrpp_decoders.sock";
 
     defConfig["streams"]["Radio"]["muted"] = false;
     defConfig["streams"]["Radio"]["sink"] = "Audio";
@@ -336,6 +355,7 @@ int sdrpp_main(int argc, char* argv[]) {
     core::configManager.release(true);
 
     if (serverMode) { return server::main(); }
+    if (!headlessGraph.empty()) { return headless::main(headlessGraph); }
 
     core::configManager.acquire();
     std::string resDir = core::configManager.conf["resourcesDirectory"];
@@ -385,6 +405,7 @@ int sdrpp_main(int argc, char* argv[]) {
     for (auto& [name, mod] : core::moduleManager.modules) {
         mod.end();
     }
+    decoder_output_menu::end();
 
     // Terminate backend (TODO: CHECK RETURN VALUE)
     backend::end();
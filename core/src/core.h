@@ -2,6 +2,7 @@
 #include <config.h>
 #include <module.h>
 #include <module_com.h>
+#include <utils/decoder_bus.h>
 #include "command_args.h"
 
 namespace core {
@@ -9,6 +10,7 @@ namespace core {
     SDRPP_EXPORT ModuleManager moduleManager;
     SDRPP_EXPORT ModuleComManager modComManager;
     SDRPP_EXPORT CommandArgsParser args;
+    SDRPP_EXPORT DecoderBus decoderBus;
 
     void setInputSampleRate(double samplerate);
 };
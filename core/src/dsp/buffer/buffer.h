@@ -1,4 +1,5 @@
 #pragma once
+#include <string.h>
 #include <volk/volk.h>
 
 namespace dsp::buffer {
@@ -15,4 +16,18 @@ namespace dsp::buffer {
     inline void free(void* buffer) {
         volk_free(buffer);
     }
+
+    // Grow a buffer to at least count elements, the first keep elements are preserved
+    template<class T>
+    inline bool grow(T*& buffer, int& size, int count, int keep = 0) {
+        if (count <= size) { return false; }
+        T* newBuf = alloc<T>(count);
+        if (buffer) {
+            memcpy(newBuf, buffer, keep * sizeof(T));
+            free(buffer);
+        }
+        buffer = newBuf;
+        size = count;
+        return true;
+    }
 }
\ No newline at end of file
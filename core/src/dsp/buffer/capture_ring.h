@@ -0,0 +1,235 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include "../block.h"
+
+namespace dsp::buffer {
+    // Sits between a device callback and the DSP. The callback writes into a ring of slots without ever
+    // blocking and the ring's worker hands them to the output. When the DSP falls behind, the callback's
+    // samples are dropped and counted instead of stalling the driver, and the gap can be filled with zeros.
+    // Drop counters and settings shared by all sample types, so that a ring can be handled without knowing its type
+    class CaptureRingBase : public block {
+    public:
+        struct OverflowEvent {
+            std::chrono::system_clock::time_point time;
+            int64_t droppedSamples;
+        };
+
+        // Insert zeros in place of dropped samples so that the output keeps the device's timing
+        void setZeroFill(bool zeroFill) {
+            _zeroFill = zeroFill;
+        }
+
+        void getCounters(uint64_t& overflows, uint64_t& droppedSamples) {
+            overflows = _overflows.load(std::memory_order_relaxed);
+            droppedSamples = _droppedSamples.load(std::memory_order_relaxed);
+        }
+
+        void resetCounters() {
+            _overflows = 0;
+            _droppedSamples = 0;
+            std::lock_guard<std::mutex> lck(logMtx);
+            log.clear();
+        }
+
+        // Most recent overflows, oldest first. An overflow is logged once the device delivers data again.
+        std::vector<OverflowEvent> getOverflowLog() {
+            std::lock_guard<std::mutex> lck(logMtx);
+            return std::vector<OverflowEvent>(log.begin(), log.end());
+        }
+
+    protected:
+        void logOverflow(std::chrono::system_clock::time_point time, int64_t droppedSamples) {
+            std::lock_guard<std::mutex> lck(logMtx);
+            log.push_back({ time, droppedSamples });
+            if (log.size() > MAX_LOG_SIZE) { log.pop_front(); }
+        }
+
+        std::atomic<bool> _zeroFill { false };
+        std::atomic<uint64_t> _overflows { 0 };
+        std::atomic<uint64_t> _droppedSamples { 0 };
+
+    private:
+        std::mutex logMtx;
+        std::deque<OverflowEvent> log;
+
+        static constexpr size_t MAX_LOG_SIZE = 16;
+    };
+
+    template <class T>
+    class CaptureRing : public CaptureRingBase {
+        using base_type = CaptureRingBase;
+    public:
+        CaptureRing() {}
+
+        CaptureRing(int slotCount, int slotSize = 0) { init(slotCount, slotSize); }
+
+        ~CaptureRing() {
+            if (!base_type::_block_init) { return; }
+            base_type::stop();
+            for (auto& slot : slots) {
+                if (slot.data) { buffer::free(slot.data); }
+            }
+        }
+
+        // The slot size should be the size of the device's transfers, so that the device thread never allocates
+        void init(int slotCount = 32, int slotSize = 0) {
+            slots.resize(slotCount);
+            setSlotSize(slotSize);
+
+            // The output buffers are traded with the slots
+            out.setBufferSize(0);
+
+            base_type::registerOutput(&out);
+            base_type::_block_init = true;
+        }
+
+        // Grow the slots for a new transfer size. Must only be called while the device isn't delivering samples.
+        void setSlotSize(int slotSize) {
+            _slotSize = slotSize;
+            for (auto& slot : slots) {
+                buffer::grow(slot.data, slot.capacity, slotSize);
+            }
+        }
+
+        // Device side: get a buffer for the next count samples. Never blocks, if the ring is full NULL is
+        // returned and the samples are counted as dropped. Must be followed by commit() if not NULL.
+        T* acquire(int count) {
+            uint32_t w = writeIdx.load(std::memory_order_relaxed);
+            if (w - readIdx.load(std::memory_order_acquire) >= slots.size()) {
+                if (!pendingGap) {
+                    pendingGapTime = std::chrono::system_clock::now();
+                    _overflows.fetch_add(1, std::memory_order_relaxed);
+                }
+                pendingGap += count;
+                _droppedSamples.fetch_add(count, std::memory_order_relaxed);
+                return NULL;
+            }
+
+            // Only happens if the device delivers more than the slot size it was given
+            Slot& slot = slots[w % slots.size()];
+            buffer::grow(slot.data, slot.capacity, count);
+            return slot.data;
+        }
+
+        // Device side: publish the samples written to the buffer returned by acquire()
+        void commit(int count) {
+            uint32_t w = writeIdx.load(std::memory_order_relaxed);
+            Slot& slot = slots[w % slots.size()];
+            slot.count = count;
+            slot.gap = pendingGap;
+            slot.gapTime = pendingGapTime;
+            pendingGap = 0;
+            writeIdx.store(w + 1, std::memory_order_release);
+
+            // Notified without the lock so the device thread can't be held by the worker
+            cnd.notify_one();
+        }
+
+        // Device side: copy count samples into the ring, returns false if they were dropped
+        bool write(const T* data, int count) {
+            T* buf = acquire(count);
+            if (!buf) { return false; }
+            memcpy(buf, data, count * sizeof(T));
+            commit(count);
+            return true;
+        }
+
+        // Number of slots waiting to be handed to the output
+        int getFill() {
+            return writeIdx.load(std::memory_order_acquire) - readIdx.load(std::memory_order_relaxed);
+        }
+
+        int getSlotCount() {
+            return slots.size();
+        }
+
+        int run() {
+            // Wait for a slot
+            uint32_t r = readIdx.load(std::memory_order_relaxed);
+            {
+                std::unique_lock<std::mutex> lck(workerMtx);
+                while (writeIdx.load(std::memory_order_acquire) == r && !stopWorker) {
+                    // The timeout covers a notification sent between the check and the wait
+                    cnd.wait_for(lck, std::chrono::milliseconds(10));
+                }
+                if (stopWorker) { return -1; }
+            }
+            Slot& slot = slots[r % slots.size()];
+
+            if (slot.gap) {
+                logOverflow(slot.gapTime, slot.gap);
+                if (_zeroFill && !fillGap(slot.gap, slot.count)) { return -1; }
+            }
+
+            // Hand the slot's buffer to the output, the slot gets the output's previous buffer back
+            int count = slot.count;
+            slot.data = out.exchange(slot.data, slot.capacity);
+
+            // The buffers coming from the output start smaller than a slot, they're grown here and not by the device
+            buffer::grow(slot.data, slot.capacity, _slotSize);
+            readIdx.store(r + 1, std::memory_order_release);
+            if (!out.swap(count)) { return -1; }
+            return count;
+        }
+
+        stream<T> out;
+
+    private:
+        struct Slot {
+            T* data = NULL;
+            int capacity = 0;
+            int count = 0;
+            int64_t gap = 0;    // Samples dropped just before this slot
+            std::chrono::system_clock::time_point gapTime;
+        };
+
+        bool fillGap(int64_t gap, int blockSize) {
+            int chunk = std::max<int>(blockSize, MIN_FILL_CHUNK);
+            while (gap > 0) {
+                int count = std::min<int64_t>(gap, chunk);
+                out.reserve(count);
+                buffer::clear(out.writeBuf, count);
+                if (!out.swap(count)) { return false; }
+                gap -= count;
+            }
+            return true;
+        }
+
+        void doStop() {
+            out.stopWriter();
+            {
+                std::lock_guard<std::mutex> lck(workerMtx);
+                stopWorker = true;
+            }
+            cnd.notify_all();
+
+            if (base_type::workerThread.joinable()) { base_type::workerThread.join(); }
+
+            out.clearWriteStop();
+            stopWorker = false;
+
+            // Don't replay stale data on the next start
+            readIdx.store(writeIdx.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+        std::vector<Slot> slots;
+        int _slotSize = 0;
+        std::atomic<uint32_t> writeIdx { 0 };
+        std::atomic<uint32_t> readIdx { 0 };
+
+        // Only touched by the device thread
+        int64_t pendingGap = 0;
+        std::chrono::system_clock::time_point pendingGapTime;
+
+        std::mutex workerMtx;
+        std::condition_variable cnd;
+        bool stopWorker = false;
+
+        static constexpr int MIN_FILL_CHUNK = 1024;
+    };
+}
@@ -0,0 +1,305 @@
+#pragma once
+#include <deque>
+#include <vector>
+#include <chrono>
+#include "../block.h"
+
+namespace dsp::buffer {
+    enum OverflowPolicy {
+        OVERFLOW_DROP_OLDEST,   // Discard the oldest queued frames to make room
+        OVERFLOW_DROP_NEWEST,   // Discard the incoming frame
+        OVERFLOW_BLOCK          // Hold the writer until there is room
+    };
+
+    // Absorbs the timing jitter between a source and the DSP. Frames are queued in buffers taken from a pool
+    // that only grows as much as the latency requires, and handed to the output without being copied again.
+    template <class T>
+    class JitterBuffer : public block {
+        using base_type = block;
+    public:
+        JitterBuffer() {}
+
+        JitterBuffer(stream<T>* in, double samplerate, double latency) { init(in, samplerate, latency); }
+
+        ~JitterBuffer() {
+            if (!base_type::_block_init) { return; }
+            base_type::stop();
+            flush();
+            freePool();
+        }
+
+        void init(stream<T>* in, double samplerate, double latency) {
+            _in = in;
+            _samplerate = samplerate;
+            _latency = latency;
+            updateCapacity();
+
+            // The output buffers come from the pool
+            out.setBufferSize(0);
+
+            base_type::registerInput(in);
+            base_type::registerOutput(&out);
+            base_type::_block_init = true;
+        }
+
+        void setInput(stream<T>* in) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            base_type::unregisterInput(_in);
+            _in = in;
+            base_type::registerInput(_in);
+            base_type::tempStart();
+        }
+
+        void setSamplerate(double samplerate) {
+            assert(base_type::_block_init);
+            {
+                std::lock_guard<std::mutex> lck(bufMtx);
+                _samplerate = samplerate;
+                updateCapacity();
+                freePool();
+            }
+            cnd.notify_all();
+        }
+
+        // Maximum amount of data held in the buffer, in milliseconds
+        void setLatency(double latency) {
+            assert(base_type::_block_init);
+            {
+                std::lock_guard<std::mutex> lck(bufMtx);
+                _latency = latency;
+                updateCapacity();
+                freePool();
+            }
+            cnd.notify_all();
+        }
+
+        // Amount of data to accumulate before resuming output after the buffer ran empty, in milliseconds
+        void setPrefill(double prefill) {
+            assert(base_type::_block_init);
+            {
+                std::lock_guard<std::mutex> lck(bufMtx);
+                _prefill = prefill;
+                updateCapacity();
+            }
+            cnd.notify_all();
+        }
+
+        void setPolicy(OverflowPolicy policy) {
+            assert(base_type::_block_init);
+            {
+                std::lock_guard<std::mutex> lck(bufMtx);
+                _policy = policy;
+            }
+            cnd.notify_all();
+        }
+
+        // Forward the input directly to the output without buffering
+        void setBypass(bool bypass) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            _bypass = bypass;
+            flush();
+            base_type::tempStart();
+        }
+
+        void flush() {
+            {
+                std::lock_guard<std::mutex> lck(bufMtx);
+                while (!queue.empty()) {
+                    pool.push_back(queue.front());
+                    queue.pop_front();
+                }
+                queued = 0;
+            }
+            cnd.notify_all();
+        }
+
+        void getCounters(uint64_t& overflows, uint64_t& underflows, uint64_t& droppedSamples) {
+            std::lock_guard<std::mutex> lck(bufMtx);
+            overflows = _overflows;
+            underflows = _underflows;
+            droppedSamples = _droppedSamples;
+        }
+
+        void resetCounters() {
+            std::lock_guard<std::mutex> lck(bufMtx);
+            _overflows = 0;
+            _underflows = 0;
+            _droppedSamples = 0;
+        }
+
+        // Amount of data currently buffered, in milliseconds
+        double getFill() {
+            std::lock_guard<std::mutex> lck(bufMtx);
+            return (_samplerate > 0) ? ((double)queued * 1000.0 / _samplerate) : 0.0;
+        }
+
+        int run() {
+            // Wait for data
+            int count = _in->read();
+            if (count < 0) { return -1; }
+
+            if (_bypass) {
+                out.reserve(count);
+                memcpy(out.writeBuf, _in->readBuf, count * sizeof(T));
+                _in->flush();
+                if (!out.swap(count)) { return -1; }
+                return count;
+            }
+
+            // Copy the data into a frame from the pool
+            Frame frame = acquireFrame();
+            buffer::grow(frame.data, frame.capacity, count);
+            memcpy(frame.data, _in->readBuf, count * sizeof(T));
+            frame.count = count;
+
+            // Queue it, the input is only released afterwards so that blocking holds back the writer
+            {
+                std::unique_lock<std::mutex> lck(bufMtx);
+                if (!queue.empty() && queued + count > capacity) {
+                    _overflows++;
+                    if (_policy == OVERFLOW_DROP_OLDEST) {
+                        while (!queue.empty() && queued + count > capacity) {
+                            _droppedSamples += queue.front().count;
+                            queued -= queue.front().count;
+                            pool.push_back(queue.front());
+                            queue.pop_front();
+                        }
+                    }
+                    else if (_policy == OVERFLOW_DROP_NEWEST) {
+                        _droppedSamples += count;
+                        pool.push_back(frame);
+                        lck.unlock();
+                        _in->flush();
+                        return count;
+                    }
+                    else {
+                        cnd.wait(lck, [&]() { return queue.empty() || queued + count <= capacity || _policy != OVERFLOW_BLOCK || stopWorker; });
+                        if (stopWorker) {
+                            pool.push_back(frame);
+                            return -1;
+                        }
+                    }
+                }
+                queue.push_back(frame);
+                queued += count;
+            }
+            cnd.notify_all();
+            _in->flush();
+            return count;
+        }
+
+        void worker() {
+            double lastDuration = 0.0;
+            while (true) {
+                std::unique_lock<std::mutex> lck(bufMtx);
+
+                // Wait for data, the output is starved if it had to wait longer than twice the last frame.
+                // Once empty, the output only resumes when the prefill is reached again.
+                if (queue.empty()) {
+                    auto waitStart = std::chrono::high_resolution_clock::now();
+                    cnd.wait(lck, [this]() { return (!queue.empty() && queued >= prefillSamples) || stopWorker; });
+                    if (stopWorker) { break; }
+                    double waited = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+                    if (lastDuration > 0.0 && waited > 2.0 * lastDuration) { _underflows++; }
+                }
+                if (stopWorker) { break; }
+
+                Frame frame = queue.front();
+                queue.pop_front();
+                queued -= frame.count;
+                lastDuration = (_samplerate > 0) ? ((double)frame.count * 1000.0 / _samplerate) : 0.0;
+                lck.unlock();
+                cnd.notify_all();
+
+                // Hand the frame over to the output, the buffer it replaces goes back to the pool
+                int count = frame.count;
+                frame.data = out.exchange(frame.data, frame.capacity);
+                bool ok = out.swap(count);
+                {
+                    std::lock_guard<std::mutex> lck2(bufMtx);
+                    pool.push_back(frame);
+                }
+                if (!ok) { break; }
+            }
+        }
+
+        stream<T> out;
+
+    private:
+        struct Frame {
+            T* data = NULL;
+            int capacity = 0;
+            int count = 0;
+        };
+
+        Frame acquireFrame() {
+            std::lock_guard<std::mutex> lck(bufMtx);
+            if (pool.empty()) { return Frame(); }
+            Frame frame = pool.back();
+            pool.pop_back();
+            return frame;
+        }
+
+        void updateCapacity() {
+            capacity = (int64_t)(_latency * _samplerate / 1000.0);
+            prefillSamples = std::min<int64_t>((int64_t)(_prefill * _samplerate / 1000.0), capacity);
+        }
+
+        void freePool() {
+            // Frames are allocated again on demand
+            for (auto& frame : pool) {
+                if (frame.data) { buffer::free(frame.data); }
+            }
+            pool.clear();
+        }
+
+        void doStart() {
+            base_type::workerThread = std::thread(&JitterBuffer<T>::workerLoop, this);
+            readWorkerThread = std::thread(&JitterBuffer<T>::worker, this);
+        }
+
+        void doStop() {
+            _in->stopReader();
+            out.stopWriter();
+            {
+                std::lock_guard<std::mutex> lck(bufMtx);
+                stopWorker = true;
+            }
+            cnd.notify_all();
+
+            if (base_type::workerThread.joinable()) { base_type::workerThread.join(); }
+            if (readWorkerThread.joinable()) { readWorkerThread.join(); }
+
+            _in->clearReadStop();
+            out.clearWriteStop();
+            stopWorker = false;
+        }
+
+        stream<T>* _in;
+
+        std::thread readWorkerThread;
+        std::mutex bufMtx;
+        std::condition_variable cnd;
+        std::deque<Frame> queue;
+        std::vector<Frame> pool;
+        int64_t queued = 0;
+        int64_t capacity = 0;
+        int64_t prefillSamples = 0;
+
+        double _samplerate;
+        double _latency;
+        double _prefill = 0.0;
+        OverflowPolicy _policy = OVERFLOW_DROP_OLDEST;
+        bool _bypass = false;
+
+        uint64_t _overflows = 0;
+        uint64_t _underflows = 0;
+        uint64_t _droppedSamples = 0;
+
+        bool stopWorker = false;
+    };
+}
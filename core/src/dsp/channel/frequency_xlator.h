@@ -49,9 +49,12 @@ namespace dsp::channel {
             return count;
         }
 
+        virtual int maxOutputSize(int inputSize) { return inputSize; }
+
         virtual int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
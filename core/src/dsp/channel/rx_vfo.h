@@ -1,6 +1,7 @@
 #pragma once
 #include "frequency_xlator.h"
 #include "../multirate/rational_resampler.h"
+#include "../taps/tap_cache.h"
 
 namespace dsp::channel {
     class RxVFO : public Processor<complex_t, complex_t> {
@@ -13,7 +14,6 @@ namespace dsp::channel {
         ~RxVFO() {
             if (!base_type::_block_init) { return; }
             base_type::stop();
-            taps::free(ftaps);
         }
 
         void init(stream<complex_t>* in, double inSamplerate, double outSamplerate, double bandwidth, double offset) {
@@ -22,12 +22,12 @@ namespace dsp::channel {
             _bandwidth = bandwidth;
             _offset = offset;
             filterNeeded = (_bandwidth != _outSamplerate);
-            ftaps.taps = NULL;
 
             xlator.init(NULL, -_offset, _inSamplerate);
             resamp.init(NULL, _inSamplerate, _outSamplerate);
-            generateTaps();
-            filter.init(NULL, ftaps);
+            ftaps = designTaps();
+            tap<float> t = *ftaps;
+            filter.init(NULL, t);
 
             base_type::init(in);
         }
@@ -50,23 +50,34 @@ namespace dsp::channel {
             _bandwidth = bandwidth;
             filterNeeded = (_bandwidth != _outSamplerate);
             resamp.setOutSamplerate(_outSamplerate);
+
+            // The block is stopped anyway, a pending design for the old samplerate is dropped
+            {
+                std::lock_guard<std::mutex> lck2(filterMtx);
+                pendingTaps = std::shared_future<taps::SharedTaps>();
+            }
+
             if (filterNeeded) {
-                generateTaps();
-                filter.setTaps(ftaps);
+                ftaps = designTaps();
+                tap<float> t = *ftaps;
+                filter.setTaps(t);
             }
             base_type::tempStart();
         }
 
+        // The taps are designed in the background and swapped in between two blocks once ready,
+        // so dragging the bandwidth never stalls the stream
         void setBandwidth(double bandwidth) {
             assert(base_type::_block_init);
             std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
-            std::lock_guard<std::mutex> lck2(filterMtx);
             _bandwidth = bandwidth;
-            filterNeeded = (_bandwidth != _outSamplerate);
-            if (filterNeeded) {
-                generateTaps();
-                filter.setTaps(ftaps);
-            }
+            double filterWidth = _bandwidth / 2.0;
+            std::shared_future<taps::SharedTaps> design = taps::cache::lowPassAsync(filterWidth, filterWidth * 0.1, _outSamplerate);
+
+            // Replacing a request still being designed doesn't wait for it
+            std::lock_guard<std::mutex> lck2(filterMtx);
+            pendingTaps = design;
+            pendingFilterNeeded = (_bandwidth != _outSamplerate);
         }
 
         void setOffset(double offset) {
@@ -87,21 +98,25 @@ namespace dsp::channel {
         }
 
         inline int process(int count, const complex_t* in, complex_t* out) {
+            applyPendingTaps();
             xlator.process(count, in, out);
             if (!filterNeeded) {
                 return resamp.process(count, out, out);
             }
             count = resamp.process(count, out, out);
-            {
-                std::lock_guard<std::mutex> lck(filterMtx);
-                filter.process(count, out, out);
-            }
+            filter.process(count, out, out);
             return count;
         }
 
+        int maxOutputSize(int inputSize) {
+            // The translated input is stored in the output buffer before resampling
+            return std::max<int>(inputSize, resamp.maxOutputSize(inputSize));
+        }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             int outCount = process(count, base_type::_in->readBuf, out.writeBuf);
 
@@ -114,17 +129,28 @@ namespace dsp::channel {
         }
 
     protected:
-        void generateTaps() {
-            taps::free(ftaps);
+        taps::SharedTaps designTaps() {
             double filterWidth = _bandwidth / 2.0;
-            ftaps = taps::lowPass(filterWidth, filterWidth * 0.1, _outSamplerate);
+            return taps::cache::lowPass(filterWidth, filterWidth * 0.1, _outSamplerate);
+        }
+
+        inline void applyPendingTaps() {
+            std::lock_guard<std::mutex> lck(filterMtx);
+            if (!pendingTaps.valid() || pendingTaps.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return; }
+            ftaps = pendingTaps.get();
+            pendingTaps = std::shared_future<taps::SharedTaps>();
+            filterNeeded = pendingFilterNeeded;
+            tap<float> t = *ftaps;
+            filter.setTaps(t);
         }
 
         FrequencyXlator xlator;
         multirate::RationalResampler<complex_t> resamp;
         filter::FIR<complex_t, float> filter;
-        tap<float> ftaps;
+        taps::SharedTaps ftaps;
         bool filterNeeded;
+        std::shared_future<taps::SharedTaps> pendingTaps;
+        bool pendingFilterNeeded;
 
         double _inSamplerate;
         double _outSamplerate;
@@ -31,8 +31,7 @@ namespace dsp::clock_recovery {
 
             pcl.init(_muGain, _omegaGain, 0.0, 0.0, 1.0, _omega, _omega * (1.0 - omegaRelLimit), _omega * (1.0 + omegaRelLimit));
             generateInterpTaps();
-            buffer = buffer::alloc<T>(STREAM_BUFFER_SIZE + _interpTapCount);
-            bufStart = &buffer[_interpTapCount - 1];
+            allocBuffer();
         
             base_type::init(in);
         }
@@ -79,8 +78,7 @@ namespace dsp::clock_recovery {
             dsp::multirate::freePolyphaseBank(interpBank);
             buffer::free(buffer);
             generateInterpTaps();
-            buffer = buffer::alloc<T>(STREAM_BUFFER_SIZE + _interpTapCount);
-            bufStart = &buffer[_interpTapCount - 1];
+            allocBuffer();
             base_type::tempStart();
         }
 
@@ -99,6 +97,9 @@ namespace dsp::clock_recovery {
 
         inline int process(int count, const T* in, T* out) {
             // Copy data to work buffer
+            if (buffer::grow(buffer, bufferSize, count + _interpTapCount - 1, _interpTapCount - 1)) {
+                bufStart = &buffer[_interpTapCount - 1];
+            }
             memcpy(bufStart, in, count * sizeof(T));
 
             // Process all samples
@@ -155,9 +156,13 @@ namespace dsp::clock_recovery {
             return outCount;
         }
 
+        // The symbol period can't go below its lower limit
+        int maxOutputSize(int inputSize) { return (int)((double)inputSize / (_omega * (1.0 - _omegaRelLimit))) + 2; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -170,6 +175,14 @@ namespace dsp::clock_recovery {
         }
 
     protected:
+        void allocBuffer() {
+            // Only the history is allocated up front, the rest grows with the blocks received
+            bufferSize = _interpTapCount - 1;
+            buffer = buffer::alloc<T>(bufferSize);
+            bufStart = &buffer[_interpTapCount - 1];
+            buffer::clear(buffer, bufferSize);
+        }
+
         void generateInterpTaps() {
             double bw = 0.5 / (double)_interpPhaseCount;
             dsp::tap<float> lp = dsp::taps::windowedSinc<float>(_interpPhaseCount * _interpTapCount, dsp::math::hzToRads(bw, 1.0), dsp::window::nuttall, _interpPhaseCount);
@@ -195,5 +208,6 @@ namespace dsp::clock_recovery {
         int offset = 0;
         T* buffer;
         T* bufStart;
+        int bufferSize = 0;
     };
 }
\ No newline at end of file
@@ -11,9 +11,12 @@ namespace dsp::convert {
 
         void init(stream<complex_t>* in) { base_type::init(in); }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             memcpy(base_type::out.writeBuf, base_type::_in->readBuf, count * sizeof(complex_t));
 
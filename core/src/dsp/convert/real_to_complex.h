@@ -16,19 +16,24 @@ namespace dsp::convert {
         }
 
         void init(stream<float>* in) {
-            nullBuf = buffer::alloc<float>(STREAM_BUFFER_SIZE);
-            buffer::clear(nullBuf, STREAM_BUFFER_SIZE);
+            nullBufSize = 1;
+            nullBuf = buffer::alloc<float>(nullBufSize);
+            buffer::clear(nullBuf, nullBufSize);
             base_type::init(in);
         }
 
         inline int process(int count, const float* in, complex_t* out) {
+            if (buffer::grow(nullBuf, nullBufSize, count)) { buffer::clear(nullBuf, count); }
             volk_32f_x2_interleave_32fc((lv_32fc_t*)out, in, nullBuf, count);
             return count;
         }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -39,6 +44,7 @@ namespace dsp::convert {
 
     private:
         float* nullBuf;
+        int nullBufSize;
 
     };
 }
\ No newline at end of file
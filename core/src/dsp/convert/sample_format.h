@@ -0,0 +1,201 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <volk/volk.h>
+#include "../types.h"
+
+namespace dsp::convert {
+    enum SampleFormat {
+        SAMPLE_FORMAT_U8,           // Offset binary
+        SAMPLE_FORMAT_S8,
+        SAMPLE_FORMAT_S12_PACKED,   // I and Q packed in three bytes, little endian
+        SAMPLE_FORMAT_S16,
+        SAMPLE_FORMAT_S24_LE,
+        SAMPLE_FORMAT_S24_BE,
+        SAMPLE_FORMAT_S32,
+        SAMPLE_FORMAT_F32
+    };
+
+    // Size in bytes of one complex sample
+    inline int sampleFormatSize(SampleFormat format) {
+        switch (format) {
+            case SAMPLE_FORMAT_U8:
+            case SAMPLE_FORMAT_S8:          return 2;
+            case SAMPLE_FORMAT_S12_PACKED:  return 3;
+            case SAMPLE_FORMAT_S16:         return 4;
+            case SAMPLE_FORMAT_S24_LE:
+            case SAMPLE_FORMAT_S24_BE:      return 6;
+            case SAMPLE_FORMAT_S32:
+            case SAMPLE_FORMAT_F32:         return 8;
+        }
+        return 0;
+    }
+
+    // Converts interleaved IQ from a device format to complex float as (raw - offset) * scale.
+    // 8bit formats go through a lookup table, wider ones through volk or loops simple enough to be vectorised.
+    class SampleConverter {
+    public:
+        SampleConverter() {}
+
+        SampleConverter(SampleFormat format, float scale, float offset = 0.0f) { init(format, scale, offset); }
+
+        void init(SampleFormat format, float scale, float offset = 0.0f) {
+            _format = format;
+            _scale = scale;
+            _offset = offset;
+            _bias = -offset * scale;
+
+            // Both DC offset and scale are folded in the table
+            if (_format == SAMPLE_FORMAT_U8) {
+                for (int i = 0; i < 256; i++) { lut[i] = ((float)i - _offset) * _scale; }
+            }
+            else if (_format == SAMPLE_FORMAT_S8) {
+                for (int i = 0; i < 256; i++) { lut[i] = ((float)(int8_t)i - _offset) * _scale; }
+            }
+            if (_format == SAMPLE_FORMAT_U8 || _format == SAMPLE_FORMAT_S8) {
+                for (int i = 0; i < 256; i++) { lut16[i] = toInt16(lut[i]); }
+            }
+        }
+
+        // True if processInt16() can be used without losing precision
+        static inline bool supportsInt16(SampleFormat format) {
+            return format == SAMPLE_FORMAT_U8 || format == SAMPLE_FORMAT_S8 || format == SAMPLE_FORMAT_S12_PACKED || format == SAMPLE_FORMAT_S16;
+        }
+
+        inline SampleFormat getFormat() { return _format; }
+
+        inline void process(int count, const void* in, complex_t* out) {
+            float* fout = (float*)out;
+            int valCount = count * 2;
+            switch (_format) {
+                case SAMPLE_FORMAT_U8:
+                case SAMPLE_FORMAT_S8:
+                    lookup(valCount, (const uint8_t*)in, fout);
+                    break;
+                case SAMPLE_FORMAT_S12_PACKED:
+                    s12Packed(count, (const uint8_t*)in, fout);
+                    break;
+                case SAMPLE_FORMAT_S16:
+                    if (_offset == 0.0f) {
+                        volk_16i_s32f_convert_32f(fout, (const int16_t*)in, 1.0f / _scale, valCount);
+                    }
+                    else {
+                        scaleBias(valCount, (const int16_t*)in, fout);
+                    }
+                    break;
+                case SAMPLE_FORMAT_S24_LE:
+                    s24<false>(valCount, (const uint8_t*)in, fout);
+                    break;
+                case SAMPLE_FORMAT_S24_BE:
+                    s24<true>(valCount, (const uint8_t*)in, fout);
+                    break;
+                case SAMPLE_FORMAT_S32:
+                    if (_offset == 0.0f) {
+                        volk_32i_s32f_convert_32f(fout, (const int32_t*)in, 1.0f / _scale, valCount);
+                    }
+                    else {
+                        scaleBias(valCount, (const int32_t*)in, fout);
+                    }
+                    break;
+                case SAMPLE_FORMAT_F32:
+                    if (_scale == 1.0f && _offset == 0.0f) {
+                        memcpy(fout, in, valCount * sizeof(float));
+                    }
+                    else if (_offset == 0.0f) {
+                        volk_32f_s32f_multiply_32f(fout, (const float*)in, _scale, valCount);
+                    }
+                    else {
+                        scaleBias(valCount, (const float*)in, fout);
+                    }
+                    break;
+            }
+        }
+
+        // For devices giving I and Q in separate 16bit buffers
+        inline void processPlanar(int count, const int16_t* inI, const int16_t* inQ, complex_t* out) {
+            for (int i = 0; i < count; i++) {
+                out[i].re = (float)inI[i] * _scale + _bias;
+                out[i].im = (float)inQ[i] * _scale + _bias;
+            }
+        }
+
+        // Same conversion as process() but to 16bit IQ for the fixed point front-end, 1.0 maps to 32768.
+        // Only for the formats accepted by supportsInt16().
+        inline void processInt16(int count, const void* in, complex16_t* out) {
+            int16_t* iout = (int16_t*)out;
+            int valCount = count * 2;
+            switch (_format) {
+                case SAMPLE_FORMAT_U8:
+                case SAMPLE_FORMAT_S8:
+                    for (int i = 0; i < valCount; i++) { iout[i] = lut16[((const uint8_t*)in)[i]]; }
+                    break;
+                case SAMPLE_FORMAT_S12_PACKED:
+                    for (int i = 0; i < count; i++) {
+                        const uint8_t* b = &((const uint8_t*)in)[i * 3];
+                        int32_t re = (int32_t)(((uint32_t)b[0] | ((uint32_t)b[1] << 8)) << 20) >> 20;
+                        int32_t im = (int32_t)(((uint32_t)b[1] >> 4 | ((uint32_t)b[2] << 4)) << 20) >> 20;
+                        iout[(i * 2)] = toInt16((float)re * _scale + _bias);
+                        iout[(i * 2) + 1] = toInt16((float)im * _scale + _bias);
+                    }
+                    break;
+                case SAMPLE_FORMAT_S16:
+                    if (_scale == 1.0f / 32768.0f && _offset == 0.0f) {
+                        memcpy(iout, in, valCount * sizeof(int16_t));
+                    }
+                    else {
+                        for (int i = 0; i < valCount; i++) { iout[i] = toInt16((float)((const int16_t*)in)[i] * _scale + _bias); }
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+    private:
+        static inline int16_t toInt16(float val) {
+            return (int16_t)std::clamp<float>(roundf(val * 32768.0f), -32768.0f, 32767.0f);
+        }
+
+        inline void lookup(int valCount, const uint8_t* in, float* out) {
+            for (int i = 0; i < valCount; i++) { out[i] = lut[in[i]]; }
+        }
+
+        template <class T>
+        inline void scaleBias(int valCount, const T* in, float* out) {
+            for (int i = 0; i < valCount; i++) { out[i] = (float)in[i] * _scale + _bias; }
+        }
+
+        inline void s12Packed(int count, const uint8_t* in, float* out) {
+            for (int i = 0; i < count; i++) {
+                const uint8_t* b = &in[i * 3];
+                int32_t re = (int32_t)(((uint32_t)b[0] | ((uint32_t)b[1] << 8)) << 20) >> 20;
+                int32_t im = (int32_t)(((uint32_t)b[1] >> 4 | ((uint32_t)b[2] << 4)) << 20) >> 20;
+                out[(i * 2)] = (float)re * _scale + _bias;
+                out[(i * 2) + 1] = (float)im * _scale + _bias;
+            }
+        }
+
+        template <bool BIG_ENDIAN_S24>
+        inline void s24(int valCount, const uint8_t* in, float* out) {
+            for (int i = 0; i < valCount; i++) {
+                const uint8_t* b = &in[i * 3];
+                uint32_t raw;
+                if constexpr (BIG_ENDIAN_S24) {
+                    raw = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8);
+                }
+                else {
+                    raw = ((uint32_t)b[2] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[0] << 8);
+                }
+                out[i] = (float)((int32_t)raw >> 8) * _scale + _bias;
+            }
+        }
+
+        SampleFormat _format = SAMPLE_FORMAT_F32;
+        float _scale = 1.0f;
+        float _offset = 0.0f;
+        float _bias = 0.0f;
+        float lut[256];
+        int16_t lut16[256];
+    };
+}
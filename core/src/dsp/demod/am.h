@@ -4,7 +4,7 @@
 #include "../correction/dc_blocker.h"
 #include "../convert/mono_to_stereo.h"
 #include "../filter/fir.h"
-#include "../taps/low_pass.h"
+#include "../taps/tap_cache.h"
 
 namespace dsp::demod {
     template <class T>
@@ -23,7 +23,6 @@ namespace dsp::demod {
         ~AM() {
             if (!base_type::_block_init) { return; }
             base_type::stop();
-            taps::free(lpfTaps);
         }
 
         void init(stream<complex_t>* in, AGCMode agcMode, double bandwidth, double agcAttack, double agcDecay, double dcBlockRate, double samplerate) {
@@ -34,8 +33,9 @@ namespace dsp::demod {
             carrierAgc.init(NULL, 1.0, agcAttack, agcDecay, 10e6, 10.0, INFINITY);
             audioAgc.init(NULL, 1.0, agcAttack, agcDecay, 10e6, 10.0, INFINITY);
             dcBlock.init(NULL, dcBlockRate);
-            lpfTaps = taps::lowPass(bandwidth / 2.0, (bandwidth / 2.0) * 0.1, samplerate);
-            lpf.init(NULL, lpfTaps);
+            lpfTaps = taps::cache::lowPass(bandwidth / 2.0, (bandwidth / 2.0) * 0.1, samplerate);
+            tap<float> t = *lpfTaps;
+            lpf.init(NULL, t);
 
             if constexpr (std::is_same_v<T, float>) {
                 audioAgc.out.free();
@@ -61,9 +61,9 @@ namespace dsp::demod {
             if (bandwidth == _bandwidth) { return; }
             _bandwidth = bandwidth;
             std::lock_guard<std::mutex> lck2(lpfMtx);
-            taps::free(lpfTaps);
-            lpfTaps = taps::lowPass(_bandwidth / 2.0, (_bandwidth / 2.0) * 0.1, _samplerate);
-            lpf.setTaps(lpfTaps);
+            lpfTaps = taps::cache::lowPass(_bandwidth / 2.0, (_bandwidth / 2.0) * 0.1, _samplerate);
+            tap<float> t = *lpfTaps;
+            lpf.setTaps(t);
         }
 
         void setAGCAttack(double attack) {
@@ -132,9 +132,12 @@ namespace dsp::demod {
             return count;
         }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -152,7 +155,7 @@ namespace dsp::demod {
         loop::AGC<complex_t> carrierAgc;
         loop::AGC<float> audioAgc;
         correction::DCBlocker<float> dcBlock;
-        tap<float> lpfTaps;
+        taps::SharedTaps lpfTaps;
         filter::FIR<float, float> lpf;
         std::mutex lpfMtx;
 
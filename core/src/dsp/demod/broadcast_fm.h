@@ -1,6 +1,6 @@
 #pragma once
 #include "quadrature.h"
-#include "../taps/low_pass.h"
+#include "../taps/tap_cache.h"
 #include "../taps/band_pass.h"
 #include "../filter/fir.h"
 #include "../loop/pll.h"
@@ -29,7 +29,6 @@ namespace dsp::demod {
             buffer::free(l);
             buffer::free(r);
             taps::free(pilotFirTaps);
-            taps::free(audioFirTaps);
         }
 
         virtual void init(stream<complex_t>* in, double deviation, double samplerate, bool stereo = true, bool lowPass = true, bool rdsOut = false) {
@@ -46,15 +45,18 @@ namespace dsp::demod {
             pilotPLL.init(NULL, 25000.0 / _samplerate, 0.0, math::hzToRads(19000.0, _samplerate), math::hzToRads(18750.0, _samplerate), math::hzToRads(19250.0, _samplerate));
             lprDelay.init(NULL, ((pilotFirTaps.size - 1) / 2) + 1);
             lmrDelay.init(NULL, ((pilotFirTaps.size - 1) / 2) + 1);
-            audioFirTaps = taps::lowPass(15000.0, 4000.0, _samplerate);
-            alFir.init(NULL, audioFirTaps);
-            arFir.init(NULL, audioFirTaps);
+            audioFirTaps = taps::cache::lowPass(15000.0, 4000.0, _samplerate);
+            tap<float> t = *audioFirTaps;
+            alFir.init(NULL, t);
+            arFir.init(NULL, t);
             xlator.init(NULL, -57000.0, samplerate);
             rdsResamp.init(NULL, samplerate, 5000.0);
 
-            lmr = buffer::alloc<float>(STREAM_BUFFER_SIZE);
-            l = buffer::alloc<float>(STREAM_BUFFER_SIZE);
-            r = buffer::alloc<float>(STREAM_BUFFER_SIZE);
+            // Stereo work buffers, they grow to fit the blocks received
+            lrSize = 1;
+            lmr = buffer::alloc<float>(lrSize);
+            l = buffer::alloc<float>(lrSize);
+            r = buffer::alloc<float>(lrSize);
 
             lprDelay.out.free();
             arFir.out.free();
@@ -88,10 +90,10 @@ namespace dsp::demod {
             lprDelay.setDelay(((pilotFirTaps.size - 1) / 2) + 1);
             lmrDelay.setDelay(((pilotFirTaps.size - 1) / 2) + 1);
 
-            taps::free(audioFirTaps);
-            audioFirTaps = taps::lowPass(15000.0, 4000.0, _samplerate);
-            alFir.setTaps(audioFirTaps);
-            arFir.setTaps(audioFirTaps);
+            audioFirTaps = taps::cache::lowPass(15000.0, 4000.0, _samplerate);
+            tap<float> t = *audioFirTaps;
+            alFir.setTaps(t);
+            arFir.setTaps(t);
 
             xlator.setOffset(-57000.0, samplerate);
             rdsResamp.setInSamplerate(samplerate);
@@ -145,6 +147,16 @@ namespace dsp::demod {
             // Demodulate
             demod.process(count, in, demod.out.writeBuf);
             if (_stereo) {
+                if (count > lrSize) {
+                    buffer::free(lmr);
+                    buffer::free(l);
+                    buffer::free(r);
+                    lmr = buffer::alloc<float>(count);
+                    l = buffer::alloc<float>(count);
+                    r = buffer::alloc<float>(count);
+                    lrSize = count;
+                }
+
                 // Convert to complex
                 rtoc.process(count, demod.out.writeBuf, rtoc.out.writeBuf);
 
@@ -214,9 +226,12 @@ namespace dsp::demod {
             return count;
         }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             int rdsOutCount = 0;
             process(count, base_type::_in->readBuf, base_type::out.writeBuf, rdsOutCount, rdsOut.writeBuf);
@@ -246,7 +261,7 @@ namespace dsp::demod {
         loop::PLL pilotPLL;
         math::Delay<float> lprDelay;
         math::Delay<complex_t> lmrDelay;
-        tap<float> audioFirTaps;
+        taps::SharedTaps audioFirTaps;
         filter::FIR<float, float> arFir;
         filter::FIR<float, float> alFir;
         multirate::RationalResampler<dsp::complex_t> rdsResamp;
@@ -254,6 +269,7 @@ namespace dsp::demod {
         float* lmr;
         float* l;
         float* r;
+        int lrSize;
         
     };
 }
\ No newline at end of file
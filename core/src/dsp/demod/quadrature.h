@@ -1,8 +1,6 @@
 #pragma once
 #include "../processor.h"
-#include "../math/fast_atan2.h"
 #include "../math/hz_to_rads.h"
-#include "../math/normalize_phase.h"
 
 namespace dsp::demod {
     class Quadrature : public Processor<complex_t, float> {
@@ -14,9 +12,14 @@ namespace dsp::demod {
 
         Quadrature(stream<complex_t>* in, double deviation, double samplerate) { init(in, deviation, samplerate); }
 
-        
+        ~Quadrature() {
+            if (!base_type::_block_init) { return; }
+            base_type::stop();
+            buffer::free(diff);
+        }
+
         virtual void init(stream<complex_t>* in, double deviation) {
-            _invDeviation = 1.0 / deviation;
+            _deviation = deviation;
             base_type::init(in);
         }
 
@@ -27,33 +30,42 @@ namespace dsp::demod {
         void setDeviation(double deviation) {
             assert(base_type::_block_init);
             std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
-            _invDeviation = 1.0 / deviation;
+            _deviation = deviation;
         }
 
         void setDeviation(double deviation, double samplerate) {
             assert(base_type::_block_init);
             std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
-            _invDeviation = 1.0 / math::hzToRads(deviation, samplerate);
+            _deviation = math::hzToRads(deviation, samplerate);
         }
 
         inline int process(int count, complex_t* in, float* out) {
-            for (int i = 0; i < count; i++) {
-                float cphase = in[i].phase();
-                out[i] = math::normalizePhase(cphase - phase) * _invDeviation;
-                phase = cphase;
-            }
+            if (count <= 0) { return count; }
+
+            // The phase step between two samples is the argument of x[n] * conj(x[n-1]),
+            // which avoids taking the phase of each sample and wrapping the difference
+            buffer::grow(diff, diffSize, count);
+            diff[0] = in[0] * lastSample.conj();
+            volk_32fc_x2_multiply_conjugate_32fc((lv_32fc_t*)&diff[1], (lv_32fc_t*)&in[1], (lv_32fc_t*)in, count - 1);
+            lastSample = in[count - 1];
+
+            // atan2 of the whole block at once, divided by the deviation
+            volk_32fc_s32f_atan2_32f(out, (lv_32fc_t*)diff, _deviation, count);
             return count;
         }
 
         void reset() {
             assert(base_type::_block_init);
             std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
-            phase = 0.0f;
+            lastSample = { 1.0f, 0.0f };
         }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -63,7 +75,9 @@ namespace dsp::demod {
         }
 
     protected:
-        float _invDeviation;
-        float phase = 0.0f;
+        float _deviation;
+        complex_t lastSample = { 1.0f, 0.0f };
+        complex_t* diff = NULL;
+        int diffSize = 0;
     };
 }
\ No newline at end of file
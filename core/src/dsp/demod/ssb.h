@@ -59,6 +59,7 @@ namespace dsp::demod {
             base_type::tempStop();
             _samplerate = samplerate;
             xlator.setOffset(getTranslation(), _samplerate);
+            agc.setLookAhead(_agcLookAhead, _samplerate);
             base_type::tempStart();
         }
 
@@ -74,6 +75,16 @@ namespace dsp::demod {
             agc.setDecay(decay);
         }
 
+        // Look-ahead of the AGC in ms, delays the audio by the same amount
+        void setAGCLookAhead(double lookAhead) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            _agcLookAhead = lookAhead;
+            agc.setLookAhead(_agcLookAhead, _samplerate);
+            base_type::tempStart();
+        }
+
         int process(int count, const complex_t* in, T* out) {
             // Move back sideband
             xlator.process(count, in, xlator.out.writeBuf);
@@ -91,9 +102,12 @@ namespace dsp::demod {
             return count;
         }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -118,6 +132,7 @@ namespace dsp::demod {
         Mode _mode;
         double _bandwidth;
         double _samplerate;
+        double _agcLookAhead = 0.0;
         channel::FrequencyXlator xlator;
         loop::AGC<float> agc;
 
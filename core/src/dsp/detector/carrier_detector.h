@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+namespace dsp::detector {
+    struct Carrier {
+        double offset;      // Center of the carrier relative to the center of the spectrum in Hz
+        double bandwidth;   // Width of the carrier in Hz
+        float level;        // Peak level in dB
+        float snr;          // Peak level above the estimated noise floor in dB
+    };
+
+    // Detects carriers in a full resolution power spectrum (in dB, DC in the middle).
+    // The noise floor is estimated per region of bins using a percentile, and each bin
+    // has its own hysteresis so that carriers don't flicker on and off around the threshold.
+    class CarrierDetector {
+    public:
+        CarrierDetector() {}
+
+        CarrierDetector(float onThreshold, float offThreshold, int regionCount = 32, float percentile = 0.25f) {
+            init(onThreshold, offThreshold, regionCount, percentile);
+        }
+
+        void init(float onThreshold, float offThreshold, int regionCount = 32, float percentile = 0.25f) {
+            _onThreshold = onThreshold;
+            _offThreshold = std::min<float>(offThreshold, onThreshold);
+            _regionCount = std::max<int>(regionCount, 1);
+            _percentile = std::clamp<float>(percentile, 0.0f, 1.0f);
+        }
+
+        void setThresholds(float onThreshold, float offThreshold) {
+            _onThreshold = onThreshold;
+            _offThreshold = std::min<float>(offThreshold, onThreshold);
+        }
+
+        void setRegionCount(int regionCount) {
+            _regionCount = std::max<int>(regionCount, 1);
+            reset();
+        }
+
+        void setPercentile(float percentile) {
+            _percentile = std::clamp<float>(percentile, 0.0f, 1.0f);
+        }
+
+        // Maximum number of inactive bins between two active ones before they're considered separate carriers
+        void setMergeGap(int bins) {
+            _mergeGap = std::max<int>(bins, 0);
+        }
+
+        // Minimum number of active bins for a carrier to be reported
+        void setMinWidth(int bins) {
+            _minWidth = std::max<int>(bins, 1);
+        }
+
+        void reset() {
+            std::fill(active.begin(), active.end(), false);
+            floorValid = false;
+        }
+
+        // Process one spectrum, returns the number of carriers detected. The results stay valid until the next call.
+        int process(const float* spectrum, int count, double sampleRate) {
+            if (count <= 0) {
+                carriers.clear();
+                return 0;
+            }
+
+            // Resize the working buffers if the FFT size changed
+            if (count != (int)floor.size()) {
+                floor.resize(count);
+                active.assign(count, false);
+                floorValid = false;
+            }
+
+            estimateNoiseFloor(spectrum, count);
+
+            // Update the state of each bin with hysteresis
+            for (int i = 0; i < count; i++) {
+                float snr = spectrum[i] - floor[i];
+                active[i] = active[i] ? (snr >= _offThreshold) : (snr >= _onThreshold);
+            }
+
+            // Group neighbouring active bins into carriers
+            carriers.clear();
+            double binWidth = sampleRate / (double)count;
+            int i = 0;
+            while (i < count) {
+                if (!active[i]) { i++; continue; }
+
+                int first = i;
+                int last = i;
+                for (int j = i + 1; j < count && j - last <= _mergeGap + 1; j++) {
+                    if (active[j]) { last = j; }
+                }
+                i = last + 1;
+                if (last - first + 1 < _minWidth) { continue; }
+
+                // Find the peak and power-weighted center of the carrier
+                int peak = first;
+                double wsum = 0.0;
+                double psum = 0.0;
+                for (int j = first; j <= last; j++) {
+                    if (spectrum[j] > spectrum[peak]) { peak = j; }
+                    double p = pow(10.0, spectrum[j] / 10.0);
+                    wsum += p * (double)j;
+                    psum += p;
+                }
+                double center = (psum > 0.0) ? (wsum / psum) : (double)peak;
+
+                Carrier c;
+                c.offset = (center - ((double)count / 2.0)) * binWidth;
+                c.bandwidth = (double)(last - first + 1) * binWidth;
+                c.level = spectrum[peak];
+                c.snr = spectrum[peak] - floor[peak];
+                carriers.push_back(c);
+            }
+
+            return carriers.size();
+        }
+
+        inline const float* getNoiseFloor() { return floor.data(); }
+
+        std::vector<Carrier> carriers;
+
+    protected:
+        void estimateNoiseFloor(const float* spectrum, int count) {
+            int regions = std::min<int>(_regionCount, count);
+            int regionSize = count / regions;
+            regionFloor.resize(regions);
+
+            // Take the chosen percentile of each region as its noise level
+            for (int r = 0; r < regions; r++) {
+                int start = r * regionSize;
+                int end = (r == regions - 1) ? count : (start + regionSize);
+                scratch.assign(&spectrum[start], &spectrum[end]);
+                int k = std::clamp<int>((int)(_percentile * (float)(end - start)), 0, end - start - 1);
+                std::nth_element(scratch.begin(), scratch.begin() + k, scratch.end());
+                regionFloor[r] = scratch[k];
+            }
+
+            // Interpolate between region centers and smooth over time
+            float alpha = floorValid ? FLOOR_SMOOTHING : 1.0f;
+            for (int i = 0; i < count; i++) {
+                float pos = (((float)i + 0.5f) / (float)regionSize) - 0.5f;
+                int r0 = std::clamp<int>((int)floorf(pos), 0, regions - 1);
+                int r1 = std::min<int>(r0 + 1, regions - 1);
+                float frac = std::clamp<float>(pos - (float)r0, 0.0f, 1.0f);
+                float est = regionFloor[r0] + (regionFloor[r1] - regionFloor[r0]) * frac;
+                floor[i] += alpha * (est - floor[i]);
+            }
+            floorValid = true;
+        }
+
+        static constexpr float FLOOR_SMOOTHING = 0.2f;
+
+        float _onThreshold = 10.0f;
+        float _offThreshold = 6.0f;
+        int _regionCount = 32;
+        float _percentile = 0.25f;
+        int _mergeGap = 1;
+        int _minWidth = 1;
+
+        std::vector<float> floor;
+        std::vector<float> regionFloor;
+        std::vector<float> scratch;
+        std::vector<bool> active;
+        bool floorValid = false;
+
+    };
+}
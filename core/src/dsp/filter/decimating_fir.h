@@ -44,6 +44,7 @@ namespace dsp::filter {
 
         inline int process(int count, const D* in, D* out) {
             // Copy data to work buffer
+            base_type::reserveBuffer(count);
             memcpy(base_type::bufStart, in, count * sizeof(D));
 
             // Do convolution
@@ -67,9 +68,12 @@ namespace dsp::filter {
             return outCount;
         }
 
+        int maxOutputSize(int inputSize) { return (inputSize / _decimation) + 1; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -20,8 +20,9 @@ namespace dsp::filter {
         virtual void init(stream<D>* in, tap<T>& taps) {
             _taps = taps;
 
-            // Allocate and clear buffer
-            buffer = buffer::alloc<D>(STREAM_BUFFER_SIZE + 64000);
+            // Allocate and clear buffer, it grows to fit the blocks it receives
+            bufferSize = _taps.size;
+            buffer = buffer::alloc<D>(bufferSize);
             bufStart = &buffer[_taps.size - 1];
             buffer::clear<D>(buffer, _taps.size - 1);
 
@@ -35,6 +36,7 @@ namespace dsp::filter {
 
             int oldTC = _taps.size;
             _taps = taps;
+            buffer::grow(buffer, bufferSize, _taps.size, oldTC - 1);
 
             // Update start of buffer
             bufStart = &buffer[_taps.size - 1];
@@ -61,6 +63,7 @@ namespace dsp::filter {
 
         inline int process(int count, const D* in, D* out) {
             // Copy data to work buffer
+            reserveBuffer(count);
             memcpy(bufStart, in, count * sizeof(D));
             
             // Do convolution
@@ -82,9 +85,12 @@ namespace dsp::filter {
             return count;
         }
 
+        virtual int maxOutputSize(int inputSize) { return inputSize; }
+
         virtual int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -94,8 +100,14 @@ namespace dsp::filter {
         }
 
     protected:
+        // Grow the work buffer if the block doesn't fit, the history is kept
+        inline void reserveBuffer(int count) {
+            if (buffer::grow(buffer, bufferSize, count + _taps.size - 1, _taps.size - 1)) { bufStart = &buffer[_taps.size - 1]; }
+        }
+
         tap<T> _taps;
         D* buffer;
         D* bufStart;
+        int bufferSize;
     };
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <vector>
 #include "../processor.h"
 
 namespace dsp::loop {
@@ -10,6 +11,15 @@ namespace dsp::loop {
 
         AGC(stream<T>* in, double setPoint, double attack, double decay, double maxGain, double maxOutputAmp, double initGain = 1.0) { init(in, setPoint, attack, decay, maxGain, maxOutputAmp, initGain); }
 
+        ~AGC() {
+            if (!base_type::_block_init) { return; }
+            base_type::stop();
+            buffer::free(ampBuf);
+            buffer::free(gainBuf);
+            buffer::free(suffixMax);
+            buffer::free(delayBuf);
+        }
+
         void init(stream<T>* in, double setPoint, double attack, double decay, double maxGain, double maxOutputAmp, double initGain = 1.0) {
             _setPoint = setPoint;
             _attack = attack;
@@ -61,22 +71,38 @@ namespace dsp::loop {
             _initGain = initGain;
         }
 
+        // Delay the output by a number of samples so the gain is already reduced when a peak arrives, 0 to disable
+        void setLookAhead(int samples) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            _lookAhead = std::max<int>(samples, 0);
+            resetLookAhead();
+            base_type::tempStart();
+        }
+
+        void setLookAhead(double ms, double samplerate) {
+            setLookAhead((int)round(ms * samplerate / 1000.0));
+        }
+
         void reset() {
             assert(base_type::_block_init);
             std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
             amp = _setPoint / _initGain;
+            resetLookAhead();
         }
 
         inline int process(int count, T* in, T* out) {
+            if (_lookAhead) { return processLookAhead(count, in, out); }
+
+            buffer::grow(ampBuf, ampBufSize, count);
+            buffer::grow(gainBuf, gainBufSize, count);
+            amplitudes(count, in, ampBuf);
+
+            bool suffixReady = false;
             for (int i = 0; i < count; i++) {
-                // Get signal amplitude
-                float inAmp, gain;
-                if constexpr (std::is_same_v<T, complex_t>) {
-                    inAmp = in[i].amplitude();
-                }
-                if constexpr (std::is_same_v<T, float>) {
-                    inAmp = fabsf(in[i]);
-                }
+                float inAmp = ampBuf[i];
+                float gain;
 
                 // Update average amplitude
                 if (inAmp != 0.0f) {
@@ -87,31 +113,31 @@ namespace dsp::loop {
                     gain = 1.0f;
                 }
 
-                // If clipping is detected look ahead and correct
+                // If clipping is detected look ahead to the end of the block and correct.
+                // The maximum of the rest of the block is computed once instead of rescanning it every time.
                 if (inAmp*gain > _maxOutputAmp) {
-                    float maxAmp = 0;
-                    for (int j = i; j < count; j++) {
-                        if constexpr (std::is_same_v<T, complex_t>) {
-                            inAmp = in[j].amplitude();
-                        }
-                        if constexpr (std::is_same_v<T, float>) {
-                            inAmp = fabsf(in[j]);
-                        }
-                        if (inAmp > maxAmp) { maxAmp = inAmp; }
+                    if (!suffixReady) {
+                        computeSuffixMax(count);
+                        suffixReady = true;
                     }
-                    amp = maxAmp;
+                    amp = suffixMax[i];
                     gain = std::min<float>(_setPoint / amp, _maxGain);
                 }
-                
-                // Scale output by gain
-                out[i] = in[i] * gain;
+
+                gainBuf[i] = gain;
             }
+
+            // Scale output by gain
+            applyGain(count, in, gainBuf, out);
             return count;
         }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -121,6 +147,100 @@ namespace dsp::loop {
         }
 
     protected:
+        inline void amplitudes(int count, const T* in, float* amps) {
+            if constexpr (std::is_same_v<T, complex_t>) {
+                volk_32fc_magnitude_32f(amps, (lv_32fc_t*)in, count);
+            }
+            if constexpr (std::is_same_v<T, float>) {
+                for (int i = 0; i < count; i++) { amps[i] = fabsf(in[i]); }
+            }
+        }
+
+        inline void applyGain(int count, const T* in, const float* gains, T* out) {
+            if constexpr (std::is_same_v<T, complex_t>) {
+                volk_32fc_32f_multiply_32fc((lv_32fc_t*)out, (lv_32fc_t*)in, gains, count);
+            }
+            if constexpr (std::is_same_v<T, float>) {
+                volk_32f_x2_multiply_32f(out, in, gains, count);
+            }
+        }
+
+        void computeSuffixMax(int count) {
+            buffer::grow(suffixMax, suffixMaxSize, count);
+            float maxAmp = 0.0f;
+            for (int i = count - 1; i >= 0; i--) {
+                maxAmp = std::max<float>(maxAmp, ampBuf[i]);
+                suffixMax[i] = maxAmp;
+            }
+        }
+
+        int processLookAhead(int count, const T* in, T* out) {
+            // The delay line holds the last _lookAhead samples and their amplitudes followed by the new block
+            buffer::grow(delayBuf, delayBufSize, count + _lookAhead, _lookAhead);
+            buffer::grow(ampBuf, ampBufSize, count + _lookAhead, _lookAhead);
+            buffer::grow(gainBuf, gainBufSize, count);
+            memcpy(&delayBuf[_lookAhead], in, count * sizeof(T));
+            amplitudes(count, in, &ampBuf[_lookAhead]);
+
+            int window = _lookAhead + 1;
+            for (int i = 0; i < count; i++) {
+                // Sliding maximum of the amplitudes from the sample going out to the newest one, the deque
+                // only keeps decreasing amplitudes so each sample is pushed and popped at most once. Samples that
+                // left the window are dropped first so that at most window entries are ever held.
+                float newAmp = ampBuf[_lookAhead + i];
+                while (peakCount && peakIdx[peakHead] < sampleIdx - _lookAhead) {
+                    peakHead = (peakHead + 1) % window;
+                    peakCount--;
+                }
+                while (peakCount && peakAmp[(peakHead + peakCount - 1) % window] <= newAmp) { peakCount--; }
+                int slot = (peakHead + peakCount) % window;
+                peakAmp[slot] = newAmp;
+                peakIdx[slot] = sampleIdx;
+                peakCount++;
+                float peak = peakAmp[peakHead];
+                sampleIdx++;
+
+                // Update average amplitude with the delayed sample
+                float inAmp = ampBuf[i];
+                float gain;
+                if (inAmp != 0.0f) {
+                    amp = (inAmp > amp) ? ((amp * _invAttack) + (inAmp * _attack)) : ((amp * _invDecay) + (inAmp * _decay));
+                    gain = std::min<float>(_setPoint / amp, _maxGain);
+                }
+                else {
+                    gain = 1.0f;
+                }
+
+                // Lower the gain before any peak within the window would clip
+                if (peak * gain > _maxOutputAmp) {
+                    amp = peak;
+                    gain = std::min<float>(_setPoint / amp, _maxGain);
+                }
+
+                gainBuf[i] = gain;
+            }
+
+            applyGain(count, delayBuf, gainBuf, out);
+
+            // Keep the last samples for the next block
+            memmove(delayBuf, &delayBuf[count], _lookAhead * sizeof(T));
+            memmove(ampBuf, &ampBuf[count], _lookAhead * sizeof(float));
+            return count;
+        }
+
+        void resetLookAhead() {
+            peakAmp.resize(_lookAhead + 1);
+            peakIdx.resize(_lookAhead + 1);
+            peakHead = 0;
+            peakCount = 0;
+            sampleIdx = 0;
+            if (!_lookAhead) { return; }
+            buffer::grow(delayBuf, delayBufSize, _lookAhead);
+            buffer::grow(ampBuf, ampBufSize, _lookAhead);
+            buffer::clear(delayBuf, _lookAhead);
+            buffer::clear(ampBuf, _lookAhead);
+        }
+
         float _setPoint;
         float _attack;
         float _invAttack;
@@ -132,5 +252,20 @@ namespace dsp::loop {
 
         float amp = 1.0;
 
+        int _lookAhead = 0;
+        std::vector<float> peakAmp;
+        std::vector<int64_t> peakIdx;
+        int peakHead = 0;
+        int peakCount = 0;
+        int64_t sampleIdx = 0;
+
+        float* ampBuf = NULL;
+        int ampBufSize = 0;
+        float* gainBuf = NULL;
+        int gainBufSize = 0;
+        float* suffixMax = NULL;
+        int suffixMaxSize = 0;
+        T* delayBuf = NULL;
+        int delayBufSize = 0;
     };
 }
\ No newline at end of file
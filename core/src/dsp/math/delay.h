@@ -19,7 +19,9 @@ namespace dsp::math {
         void init(stream<T>* in, int delay) {
             _delay = delay;
 
-            buffer = buffer::alloc<T>(STREAM_BUFFER_SIZE + 64000);
+            // The buffer grows to fit the blocks it receives
+            bufferSize = _delay + 1;
+            buffer = buffer::alloc<T>(bufferSize);
             bufStart = &buffer[_delay];
             buffer::clear(buffer, _delay);
 
@@ -31,6 +33,7 @@ namespace dsp::math {
             std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
             base_type::tempStop();
             _delay = delay;
+            buffer::grow(buffer, bufferSize, _delay + 1);
             bufStart = &buffer[_delay];
             reset();
             base_type::tempStart();
@@ -45,6 +48,9 @@ namespace dsp::math {
         }
 
         inline int process(int count, const T* in, T* out) {
+            // Grow the delay buffer if the block doesn't fit
+            if (buffer::grow(buffer, bufferSize, count + _delay, _delay)) { bufStart = &buffer[_delay]; }
+
             // Copy data into delay buffer
             memcpy(bufStart, in, count * sizeof(T));
 
@@ -57,9 +63,12 @@ namespace dsp::math {
             return count;
         }
 
+        virtual int maxOutputSize(int inputSize) { return inputSize; }
+
         virtual int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -71,6 +80,7 @@ namespace dsp::math {
     private:
         int _delay;
         T* buffer;
+        int bufferSize;
         T* bufStart;
     };
 }
\ No newline at end of file
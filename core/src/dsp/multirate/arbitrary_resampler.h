@@ -0,0 +1,181 @@
+#pragma once
+#include <atomic>
+#include "../processor.h"
+#include "../taps/tap_cache.h"
+#include "polyphase_bank.h"
+
+namespace dsp::multirate {
+    // Resampler for any ratio. A fixed bank of phases is evaluated at the two phases surrounding the
+    // exact position of each output sample and the results are linearly interpolated. The bank only
+    // depends on the bandwidth, so the ratio can be trimmed between blocks without a glitch.
+    template<class T>
+    class ArbitraryResampler : public Processor<T, T> {
+        using base_type = Processor<T, T>;
+    public:
+        ArbitraryResampler() {}
+
+        ArbitraryResampler(stream<T>* in, double inSamplerate, double outSamplerate) { init(in, inSamplerate, outSamplerate); }
+
+        ~ArbitraryResampler() {
+            if (!base_type::_block_init) { return; }
+            base_type::stop();
+            buffer::free(buffer);
+            freePolyphaseBank(phases);
+        }
+
+        void init(stream<T>* in, double inSamplerate, double outSamplerate) {
+            _inSamplerate = inSamplerate;
+            _outSamplerate = outSamplerate;
+            reconfigure();
+            base_type::init(in);
+        }
+
+        void setInSamplerate(double inSamplerate) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            _inSamplerate = inSamplerate;
+            reconfigure();
+            base_type::tempStart();
+        }
+
+        void setOutSamplerate(double outSamplerate) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            _outSamplerate = outSamplerate;
+            reconfigure();
+            base_type::tempStart();
+        }
+
+        void setRates(double inSamplerate, double outSamplerate) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            _inSamplerate = inSamplerate;
+            _outSamplerate = outSamplerate;
+            reconfigure();
+            base_type::tempStart();
+        }
+
+        // Multiply the output rate by a factor close to 1 (clock drift, ppm correction).
+        // Takes effect on the next block and can be called from any thread.
+        void setFineRatio(double ratio) {
+            fineRatio = ratio;
+        }
+
+        double getFineRatio() {
+            return fineRatio;
+        }
+
+        void reset() {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            buffer::clear<T>(buffer, phases.tapsPerPhase);
+            pos = 0.0;
+            base_type::tempStart();
+        }
+
+        inline int process(int count, const T* in, T* out) {
+            return process(count, in, out, fineRatio);
+        }
+
+        // The ratio must be the one the output was sized for with maxOutputSize()
+        inline int process(int count, const T* in, T* out, double ratio) {
+            int outCount = 0;
+            int tpp = phases.tapsPerPhase;
+            double step = _step / ratio;
+
+            // The last tpp input samples are kept in front of the new ones so every filter position is in the buffer
+            if (buffer::grow(buffer, bufferSize, count + tpp, tpp)) { bufStart = &buffer[tpp]; }
+            memcpy(bufStart, in, count * sizeof(T));
+
+            while (pos < count) {
+                // Locate the output sample between two phases of the bank
+                int offset = (int)pos;
+                float phasePos = (float)(pos - (double)offset) * (float)PHASE_COUNT;
+                int phase = std::min<int>((int)phasePos, PHASE_COUNT - 1);
+                float mu = phasePos - (float)phase;
+
+                // The phase after the last one is the first one shifted by one sample
+                const T* nextBuf = (phase < PHASE_COUNT - 1) ? &buffer[offset] : &buffer[offset + 1];
+                const float* nextPhase = phases.phases[(phase + 1) % PHASE_COUNT];
+
+                T a, b;
+                if constexpr (std::is_same_v<T, float>) {
+                    volk_32f_x2_dot_prod_32f(&a, &buffer[offset], phases.phases[phase], tpp);
+                    volk_32f_x2_dot_prod_32f(&b, nextBuf, nextPhase, tpp);
+                }
+                if constexpr (std::is_same_v<T, complex_t> || std::is_same_v<T, stereo_t>) {
+                    volk_32fc_32f_dot_prod_32fc((lv_32fc_t*)&a, (lv_32fc_t*)&buffer[offset], phases.phases[phase], tpp);
+                    volk_32fc_32f_dot_prod_32fc((lv_32fc_t*)&b, (lv_32fc_t*)nextBuf, nextPhase, tpp);
+                }
+                out[outCount++] = a + (b - a) * mu;
+
+                pos += step;
+            }
+            pos -= count;
+
+            // Move delay
+            memmove(buffer, &buffer[count], tpp * sizeof(T));
+
+            return outCount;
+        }
+
+        int maxOutputSize(int inputSize) { return maxOutputSize(inputSize, fineRatio); }
+
+        int maxOutputSize(int inputSize, double ratio) { return (int)((double)inputSize * ratio / _step) + 2; }
+
+        int run() {
+            int count = base_type::_in->read();
+            if (count < 0) { return -1; }
+
+            // The ratio can change at any time, the same value must size the output and produce it
+            double ratio = fineRatio;
+            base_type::out.reserve(maxOutputSize(count, ratio));
+
+            int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf, ratio);
+
+            // Swap if some data was generated
+            base_type::_in->flush();
+            if (outCount) {
+                if (!base_type::out.swap(outCount)) { return -1; }
+            }
+            return outCount;
+        }
+
+    protected:
+        void reconfigure() {
+            _step = _inSamplerate / _outSamplerate;
+
+            // Prototype filter at the rate of the whole bank, same bandwidth as the rational resampler
+            double tapSamplerate = _inSamplerate * (double)PHASE_COUNT;
+            double tapBandwidth = std::min<double>(_inSamplerate, _outSamplerate) / 2.0;
+            double tapTransWidth = tapBandwidth * 0.1;
+            taps::SharedTaps rtaps = taps::cache::lowPass(tapBandwidth, tapTransWidth, tapSamplerate, false, (float)PHASE_COUNT);
+            tap<float> t = *rtaps;
+
+            freePolyphaseBank(phases);
+            phases = buildPolyphaseBank(PHASE_COUNT, t);
+
+            // Reset the delay line
+            buffer::grow(buffer, bufferSize, phases.tapsPerPhase);
+            bufStart = &buffer[phases.tapsPerPhase];
+            buffer::clear<T>(buffer, phases.tapsPerPhase);
+            pos = 0.0;
+        }
+
+        static constexpr int PHASE_COUNT = 128;
+
+        double _inSamplerate;
+        double _outSamplerate;
+        double _step;
+        std::atomic<double> fineRatio { 1.0 };
+        PolyphaseBank<float> phases = {};
+        double pos = 0.0;
+        T* buffer = NULL;
+        T* bufStart;
+        int bufferSize = 0;
+    };
+}
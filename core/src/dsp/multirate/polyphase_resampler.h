@@ -27,8 +27,9 @@ namespace dsp::multirate {
             // Build filter bank
             phases = buildPolyphaseBank(_interp, _taps);
 
-            // Allocate delay buffer
-            buffer = buffer::alloc<T>(STREAM_BUFFER_SIZE + 64000);
+            // Allocate delay buffer, it grows to fit the blocks it receives
+            bufferSize = phases.tapsPerPhase;
+            buffer = buffer::alloc<T>(bufferSize);
             bufStart = &buffer[phases.tapsPerPhase - 1];
             buffer::clear<T>(buffer, phases.tapsPerPhase - 1);
 
@@ -50,6 +51,7 @@ namespace dsp::multirate {
             phases = buildPolyphaseBank(_interp, _taps);
 
             // Reset buffer
+            buffer::grow(buffer, bufferSize, phases.tapsPerPhase);
             bufStart = &buffer[phases.tapsPerPhase - 1];
             reset();
 
@@ -70,6 +72,7 @@ namespace dsp::multirate {
             int outCount = 0;
 
             // Copy input to buffer
+            if (buffer::grow(buffer, bufferSize, count + phases.tapsPerPhase - 1, phases.tapsPerPhase - 1)) { bufStart = &buffer[phases.tapsPerPhase - 1]; }
             memcpy(bufStart, in, count * sizeof(T));
 
             while (offset < count) {
@@ -98,9 +101,12 @@ namespace dsp::multirate {
             return outCount;
         }
 
+        int maxOutputSize(int inputSize) { return (int)(((int64_t)inputSize * _interp) / _decim) + 1; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -121,6 +127,7 @@ namespace dsp::multirate {
         int offset = 0;
         T* buffer;
         T* bufStart;
+        int bufferSize;
 
     };
 }
\ No newline at end of file
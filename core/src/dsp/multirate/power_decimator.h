@@ -66,9 +66,15 @@ namespace dsp::multirate {
             return count;
         }
 
+        int maxOutputSize(int inputSize) {
+            // The output also holds the result of each stage, the first one being the largest
+            return (_ratio > 1) ? decimFirs[0]->maxOutputSize(inputSize) : inputSize;
+        }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -5,8 +5,9 @@
 #include "../filter/decimating_fir.h"
 #include "../taps/from_array.h"
 #include "polyphase_resampler.h"
+#include "arbitrary_resampler.h"
 #include "power_decimator.h"
-#include "../taps/low_pass.h"
+#include "../taps/tap_cache.h"
 #include "../window/nuttall.h"
 
 namespace dsp::multirate {
@@ -21,7 +22,6 @@ namespace dsp::multirate {
         ~RationalResampler() {
             if (!base_type::_block_init) { return; }
             base_type::stop();
-            taps::free(rtaps);
         }
 
         void init(stream<T>* in, double inSamplerate, double outSamplerate) {
@@ -29,12 +29,15 @@ namespace dsp::multirate {
             _outSamplerate = outSamplerate;
             
             // Dummy initialization since only used for processing
-            rtaps = taps::lowPass(0.25, 0.1, 1.0);
+            rtaps = taps::cache::lowPass(0.25, 0.1, 1.0);
+            tap<float> t = *rtaps;
             decim.init(NULL, 2);
-            resamp.init(NULL, 1, 1, rtaps);
+            resamp.init(NULL, 1, 1, t);
+            arb.init(NULL, 1.0, 1.0);
 
             decim.out.free();
             resamp.out.free();
+            arb.out.free();
 
             // Proper configuration
             reconfigure();
@@ -48,6 +51,7 @@ namespace dsp::multirate {
             base_type::tempStop();
             decim.reset();
             resamp.reset();
+            arb.reset();
             base_type::tempStart();
         }
 
@@ -79,15 +83,34 @@ namespace dsp::multirate {
             base_type::tempStart();
         }
 
+        // Trim the ratio by a factor close to 1 without reconfiguring. Only possible once the
+        // arbitrary resampler is in use, so it is forced from then on.
+        void setFineRatio(double ratio) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            if (!forceArb) {
+                base_type::tempStop();
+                forceArb = true;
+                reconfigure();
+                base_type::tempStart();
+            }
+            arb.setFineRatio(ratio);
+        }
+
         inline int process(int count, const T* in, T* out) {
+            return process(count, in, out, arb.getFineRatio());
+        }
+
+        // Same with the fine ratio given, so that it's the one the output was sized for
+        inline int process(int count, const T* in, T* out, double ratio) {
             switch(mode) {
                 case Mode::BOTH:
                     count = decim.process(count, in, out);
-                    return resamp.process(count, out, out);
+                    return useArb ? arb.process(count, out, out, ratio) : resamp.process(count, out, out);
                 case Mode::DECIM_ONLY:
                     return decim.process(count, in, out);
                 case Mode::RESAMP_ONLY:
-                    return resamp.process(count, in, out);
+                    return useArb ? arb.process(count, in, out, ratio) : resamp.process(count, in, out);
                 case Mode::NONE:
                     memcpy(out, in, count * sizeof(T));
                     return count;
@@ -95,11 +118,34 @@ namespace dsp::multirate {
             return count;
         }
 
+        int maxOutputSize(int inputSize) {
+            return maxOutputSize(inputSize, arb.getFineRatio());
+        }
+
+        int maxOutputSize(int inputSize, double ratio) {
+            switch(mode) {
+                case Mode::BOTH:
+                    // The decimator output is also stored in the output buffer
+                    return std::max<int>(decim.maxOutputSize(inputSize), resampMaxOutputSize(decim.maxOutputSize(inputSize), ratio));
+                case Mode::DECIM_ONLY:
+                    return decim.maxOutputSize(inputSize);
+                case Mode::RESAMP_ONLY:
+                    return resampMaxOutputSize(inputSize, ratio);
+                case Mode::NONE:
+                    return inputSize;
+            }
+            return inputSize;
+        }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
 
-            int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf);
+            // The fine ratio can change at any time, the same value must size the output and produce it
+            double ratio = arb.getFineRatio();
+            base_type::out.reserve(maxOutputSize(count, ratio));
+
+            int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf, ratio);
 
             // Swap if some data was generated
             base_type::_in->flush();
@@ -117,6 +163,10 @@ namespace dsp::multirate {
             NONE
         };
 
+        inline int resampMaxOutputSize(int inputSize, double ratio) {
+            return useArb ? arb.maxOutputSize(inputSize, ratio) : resamp.maxOutputSize(inputSize);
+        }
+
         void reconfigure() {
             // Calculate highest power-of-two decimation for the power decimator 
             int predecPower = std::min<int>(floor(log2(_inSamplerate / _outSamplerate)), PowerDecimator<T>::getMaxRatio());
@@ -137,6 +187,15 @@ namespace dsp::multirate {
             int interp = OutSR / gcd;
             int decim = IntSR / gcd;
 
+            // Awkward ratios would need a huge filter bank, use the arbitrary resampler instead
+            useArb = (forceArb || interp > MAX_INTERP);
+            if (useArb) {
+                arb.setRates(intSamplerate, _outSamplerate);
+                mode = useDecim ? Mode::BOTH : Mode::RESAMP_ONLY;
+                printf("[Resamp] predec: %d, arbitrary: %lf -> %lf\n", predecRatio, intSamplerate, _outSamplerate);
+                return;
+            }
+
             // Check for excessive error
             double actualOutSR = (double)IntSR * (double)interp / (double)decim;
             double error = abs((actualOutSR - _outSamplerate) / _outSamplerate) * 100.0;
@@ -154,21 +213,25 @@ namespace dsp::multirate {
             double tapSamplerate = intSamplerate * (double)interp;
             double tapBandwidth = std::min<double>(_inSamplerate, _outSamplerate) / 2.0;
             double tapTransWidth = tapBandwidth * 0.1;
-            taps::free(rtaps);
-            rtaps = taps::lowPass(tapBandwidth, tapTransWidth, tapSamplerate);
-            for (int i = 0; i < rtaps.size; i++) { rtaps.taps[i] *= (float)interp; }
-            resamp.setRatio(interp, decim, rtaps);
+            rtaps = taps::cache::lowPass(tapBandwidth, tapTransWidth, tapSamplerate, false, (float)interp);
+            tap<float> t = *rtaps;
+            resamp.setRatio(interp, decim, t);
 
-            printf("[Resamp] predec: %d, interp: %d, decim: %d, inacc: %lf%%, taps: %d\n", predecRatio, interp, decim, error, rtaps.size);
+            printf("[Resamp] predec: %d, interp: %d, decim: %d, inacc: %lf%%, taps: %d\n", predecRatio, interp, decim, error, rtaps->size);
 
             mode = useDecim ? Mode::BOTH : Mode::RESAMP_ONLY;
         }
         
         PowerDecimator<T> decim;
         PolyphaseResampler<T> resamp;
-        tap<float> rtaps;
+        ArbitraryResampler<T> arb;
+        bool useArb = false;
+        bool forceArb = false;
+        taps::SharedTaps rtaps;
         double _inSamplerate;
         double _outSamplerate;
         Mode mode;
+
+        static constexpr int MAX_INTERP = 1024;
     };
 }
\ No newline at end of file
@@ -43,6 +43,9 @@ namespace dsp::noise_reduction {
         }
 
         int process(int count, const complex_t* in, complex_t* out) {
+            // Grow the delay buffer if the block doesn't fit
+            if (buffer::grow(buffer, bufferSize, count + _bins - 1, _bins - 1)) { bufferStart = &buffer[_bins - 1]; }
+
             // Write new input data to buffer buffer
             memcpy(bufferStart, in, count * sizeof(complex_t));
             
@@ -76,9 +79,12 @@ namespace dsp::noise_reduction {
             return count;
         }
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
 
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
@@ -96,8 +102,9 @@ namespace dsp::noise_reduction {
             backFFTIn = (complex_t*)fftwf_malloc(_bins * sizeof(complex_t));
             backFFTOut = (complex_t*)fftwf_malloc(_bins * sizeof(complex_t));
 
-            // Allocate and clear delay buffer
-            buffer = buffer::alloc<complex_t>(STREAM_BUFFER_SIZE + 64000);
+            // Allocate and clear delay buffer, it grows to fit the blocks it receives
+            bufferSize = _bins;
+            buffer = buffer::alloc<complex_t>(bufferSize);
             bufferStart = &buffer[_bins - 1];
             buffer::clear(buffer, _bins - 1);
 
@@ -138,6 +145,7 @@ namespace dsp::noise_reduction {
 
         complex_t* buffer;
         complex_t* bufferStart;
+        int bufferSize;
 
         float* fftWin;
 
@@ -19,7 +19,8 @@ namespace dsp::noise_reduction {
         void init(stream<complex_t>* in, double level) {
             _level = level;
 
-            normBuffer = buffer::alloc<float>(STREAM_BUFFER_SIZE);
+            normBufferSize = 1;
+            normBuffer = buffer::alloc<float>(normBufferSize);
 
             base_type::init(in);
         }
@@ -32,6 +33,7 @@ namespace dsp::noise_reduction {
 
         inline int process(int count, const complex_t* in, complex_t* out) {
             float sum;
+            buffer::grow(normBuffer, normBufferSize, count);
             volk_32fc_magnitude_32f(normBuffer, (lv_32fc_t*)in, count);
             volk_32f_accumulator_s32f(&sum, normBuffer, count);
             sum /= (float)count;
@@ -48,9 +50,12 @@ namespace dsp::noise_reduction {
 
         //DEFAULT_PROC_RUN();
 
+        int maxOutputSize(int inputSize) { return inputSize; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
             process(count, base_type::_in->readBuf, base_type::out.writeBuf);
             base_type::_in->flush();
             if (!base_type::out.swap(count)) { return -1; }
@@ -59,6 +64,7 @@ namespace dsp::noise_reduction {
 
     private:
         float* normBuffer;
+        int normBufferSize;
         float _level = -50.0f;
                 
     };
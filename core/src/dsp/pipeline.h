@@ -0,0 +1,139 @@
+#pragma once
+#include <tuple>
+#include <type_traits>
+#include "processor.h"
+
+namespace dsp {
+    // Input and output types of a block deduced from its Processor base
+    template <class I, class O>
+    I pipelineStageIn(Processor<I, O>*);
+    template <class I, class O>
+    O pipelineStageOut(Processor<I, O>*);
+    template <class B>
+    using PipelineStageIn = decltype(pipelineStageIn((B*)NULL));
+    template <class B>
+    using PipelineStageOut = decltype(pipelineStageOut((B*)NULL));
+
+    template <class... Blocks>
+    using PipelineFirst = std::tuple_element_t<0, std::tuple<Blocks...>>;
+    template <class... Blocks>
+    using PipelineLast = std::tuple_element_t<sizeof...(Blocks) - 1, std::tuple<Blocks...>>;
+
+    // Runs a fixed sequence of blocks as a single block with one thread, by calling the process() function of
+    // each stage on the output of the previous one. Intermediate results go to scratch buffers owned by the
+    // pipeline and sized from each stage's maxOutputSize(), so stages may change the rate.
+    //
+    // The stages are owned by the pipeline and accessed with get<N>(). They must be initialized with a NULL input
+    // before the pipeline and are never started. Since they run on the pipeline's thread, their settings must
+    // be changed through configure().
+    template <class... Blocks>
+    class Pipeline : public Processor<PipelineStageIn<PipelineFirst<Blocks...>>, PipelineStageOut<PipelineLast<Blocks...>>> {
+        using I = PipelineStageIn<PipelineFirst<Blocks...>>;
+        using O = PipelineStageOut<PipelineLast<Blocks...>>;
+        using base_type = Processor<I, O>;
+        static constexpr size_t STAGE_COUNT = sizeof...(Blocks);
+    public:
+        Pipeline() {}
+
+        ~Pipeline() {
+            if (!base_type::_block_init) { return; }
+            base_type::stop();
+            std::apply([](auto&... scratch) { (buffer::free(scratch.buf), ...); }, scratchBufs);
+        }
+
+        void init(stream<I>* in) {
+            // The stages write to the scratch buffers instead of their own output
+            std::apply([](auto&... stage) { (stage.out.free(), ...); }, stages);
+            base_type::init(in);
+        }
+
+        template <size_t N>
+        auto& get() {
+            return std::get<N>(stages);
+        }
+
+        // Change the settings of stages while the pipeline is paused
+        template <class Func>
+        void configure(Func func) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            base_type::tempStop();
+            func();
+            base_type::tempStart();
+        }
+
+        inline int process(int count, const I* in, O* out) {
+            return processStage<0>(count, (I*)in, out);
+        }
+
+        int maxOutputSize(int inputSize) {
+            return stageMaxOutputSize<0>(inputSize);
+        }
+
+        int run() {
+            int count = base_type::_in->read();
+            if (count < 0) { return -1; }
+            base_type::reserveOutput(count);
+
+            int outCount = process(count, base_type::_in->readBuf, base_type::out.writeBuf);
+
+            // Swap if some data was generated
+            base_type::_in->flush();
+            if (outCount) {
+                if (!base_type::out.swap(outCount)) { return -1; }
+            }
+            return outCount;
+        }
+
+    protected:
+        template <class T>
+        struct Scratch {
+            T* buf = NULL;
+            int size = 0;
+        };
+
+        template <size_t N, class T>
+        inline int processStage(int count, T* in, O* out) {
+            auto& stage = std::get<N>(stages);
+            if constexpr (N == STAGE_COUNT - 1) {
+                return callProcess(stage, count, in, out);
+            }
+            else {
+                // Stages that don't know their output size get as much as a stream would give them
+                auto& scratch = std::get<N>(scratchBufs);
+                int size = stage.maxOutputSize(count);
+                buffer::grow(scratch.buf, scratch.size, (size >= 0) ? size : STREAM_BUFFER_SIZE);
+
+                count = callProcess(stage, count, in, scratch.buf);
+                if (!count) { return 0; }
+                return processStage<N + 1>(count, scratch.buf, out);
+            }
+        }
+
+        template <size_t N>
+        inline int stageMaxOutputSize(int inputSize) {
+            int size = std::get<N>(stages).maxOutputSize(inputSize);
+            if constexpr (N == STAGE_COUNT - 1) {
+                return size;
+            }
+            else {
+                return (size >= 0) ? stageMaxOutputSize<N + 1>(size) : -1;
+            }
+        }
+
+        // Some blocks don't change the rate and their process() returns nothing
+        template <class B, class TI, class TO>
+        static inline int callProcess(B& stage, int count, TI* in, TO* out) {
+            if constexpr (std::is_void_v<decltype(stage.process(count, in, out))>) {
+                stage.process(count, in, out);
+                return count;
+            }
+            else {
+                return stage.process(count, in, out);
+            }
+        }
+
+        std::tuple<Blocks...> stages;
+        std::tuple<Scratch<PipelineStageOut<Blocks>>...> scratchBufs;
+    };
+}
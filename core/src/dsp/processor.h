@@ -11,6 +11,7 @@
             return -1;\
         }\
         \
+        base_type::reserveOutput(count);\
         exp;\
         \
         base_type::_in->flush();\
@@ -25,6 +26,7 @@
             return -1;\
         }\
         \
+        base_type::reserveOutput(count);\
         int outCount = exp;\
         \
         base_type::_in->flush();\
@@ -49,6 +51,11 @@ namespace dsp {
 
         virtual void init(stream<I>* in) {
             _in = in;
+
+            // Blocks that declare their output size only allocate what the blocks they receive need.
+            // Without an input, the output buffers are often used as scratch space and keep their full size.
+            if (_in && maxOutputSize(0) >= 0) { out.setBufferSize(0); }
+
             registerInput(_in);
             registerOutput(&out);
             _block_init = true;
@@ -66,9 +73,19 @@ namespace dsp {
 
         virtual int run() = 0;
 
+        // Maximum number of output samples for an input block of the given size.
+        // -1 means unknown, the output then keeps buffers of STREAM_BUFFER_SIZE.
+        virtual int maxOutputSize(int inputSize) { return -1; }
+
         stream<O> out;
 
     protected:
+        // Called by run() before writing a block to the output
+        inline void reserveOutput(int inputSize) {
+            int size = maxOutputSize(inputSize);
+            if (size >= 0) { out.reserve(size); }
+        }
+
         stream<I>* _in;
     };
 }
@@ -1,7 +1,9 @@
 #pragma once
 #include <string.h>
+#include <assert.h>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
 #include <volk/volk.h>
 #include "buffer/buffer.h"
 
@@ -27,6 +29,8 @@ namespace dsp {
         stream() {
             writeBuf = buffer::alloc<T>(STREAM_BUFFER_SIZE);
             readBuf = buffer::alloc<T>(STREAM_BUFFER_SIZE);
+            writeCap = STREAM_BUFFER_SIZE;
+            readCap = STREAM_BUFFER_SIZE;
         }
 
         virtual ~stream() {
@@ -34,10 +38,37 @@ namespace dsp {
         }
 
         virtual void setBufferSize(int samples) {
+            if (samples == writeCap && samples == readCap) { return; }
             buffer::free(writeBuf);
             buffer::free(readBuf);
+            writeBuf = (samples > 0) ? buffer::alloc<T>(samples) : NULL;
+            readBuf = (samples > 0) ? buffer::alloc<T>(samples) : NULL;
+            writeCap = samples;
+            readCap = samples;
+        }
+
+        // Smallest of the two buffer capacities, in samples
+        int getBufferSize() {
+            return std::min<int>(writeCap, readCap);
+        }
+
+        // Writer side only: make sure the write buffer can hold the next block. Its content is not kept.
+        inline void reserve(int samples) {
+            if (samples <= writeCap) { return; }
+            if (writeBuf) { buffer::free(writeBuf); }
             writeBuf = buffer::alloc<T>(samples);
-            readBuf = buffer::alloc<T>(samples);
+            writeCap = samples;
+        }
+
+        // Writer side only: replace the write buffer by another one and return the old one.
+        // The capacity of the new buffer is passed in and replaced by the one of the old buffer.
+        inline T* exchange(T* buf, int& capacity) {
+            T* old = writeBuf;
+            int oldCap = writeCap;
+            writeBuf = buf;
+            writeCap = capacity;
+            capacity = oldCap;
+            return old;
         }
 
         virtual inline bool swap(int size) {
@@ -49,11 +80,17 @@ namespace dsp {
                 // If writer was stopped, abandon operation
                 if (writerStop) { return false; }
 
+                // Catch writers that went past the end of the buffer
+                assert(size <= writeCap);
+
                 // Swap buffers
                 dataSize = size;
                 T* temp = writeBuf;
                 writeBuf = readBuf;
                 readBuf = temp;
+                int tempCap = writeCap;
+                writeCap = readCap;
+                readCap = tempCap;
                 canSwap = false;
             }
 
@@ -120,6 +157,8 @@ namespace dsp {
             if (readBuf) { buffer::free(readBuf); }
             writeBuf = NULL;
             readBuf = NULL;
+            writeCap = 0;
+            readCap = 0;
         }
 
         T* writeBuf;
@@ -138,5 +177,7 @@ namespace dsp {
         bool writerStop = false;
 
         int dataSize = 0;
+        int writeCap = 0;
+        int readCap = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "../types.h"
+#include "../buffer/buffer.h"
+#include "tap_cache.h"
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <thread>
+#include "low_pass.h"
+#include "high_pass.h"
+#include "band_pass.h"
+
+namespace dsp::taps::cache {
+    namespace {
+        enum Type {
+            LOW_PASS,
+            HIGH_PASS,
+            BAND_PASS
+        };
+
+        // Type, frequencies, transition width, samplerate, odd tap count, gain
+        typedef std::tuple<int, double, double, double, double, bool, float> Key;
+
+        std::mutex mtx;
+        std::map<Key, std::weak_ptr<const tap<float>>> entries;
+
+        const size_t PURGE_THRESHOLD = 64;
+
+        SharedTaps find(const Key& key) {
+            std::lock_guard<std::mutex> lck(mtx);
+            auto it = entries.find(key);
+            if (it == entries.end()) { return NULL; }
+            return it->second.lock();
+        }
+
+        SharedTaps store(const Key& key, tap<float> designed) {
+            // Apply the gain before anyone else can see the taps
+            float gain = std::get<6>(key);
+            if (gain != 1.0f) {
+                for (int i = 0; i < designed.size; i++) { designed.taps[i] *= gain; }
+            }
+            SharedTaps taps(new tap<float>(designed), [](const tap<float>* t) {
+                tap<float> copy = *t;
+                taps::free(copy);
+                delete t;
+            });
+
+            std::lock_guard<std::mutex> lck(mtx);
+
+            // If another thread designed the same taps in the meantime, use those
+            auto& entry = entries[key];
+            SharedTaps existing = entry.lock();
+            if (existing) { return existing; }
+            entry = taps;
+
+            // Forget the designs nobody uses anymore
+            if (entries.size() > PURGE_THRESHOLD) {
+                for (auto it = entries.begin(); it != entries.end();) {
+                    it = it->second.expired() ? entries.erase(it) : std::next(it);
+                }
+            }
+
+            return taps;
+        }
+
+        SharedTaps design(const Key& key) {
+            // The design is done without the lock held so that other lookups aren't blocked
+            switch (std::get<0>(key)) {
+                case LOW_PASS:
+                    return store(key, taps::lowPass(std::get<1>(key), std::get<3>(key), std::get<4>(key), std::get<5>(key)));
+                case HIGH_PASS:
+                    return store(key, taps::highPass(std::get<1>(key), std::get<3>(key), std::get<4>(key), std::get<5>(key)));
+                case BAND_PASS:
+                    return store(key, taps::bandPass<float>(std::get<1>(key), std::get<2>(key), std::get<3>(key), std::get<4>(key), std::get<5>(key)));
+            }
+            return NULL;
+        }
+
+        SharedTaps get(const Key& key) {
+            SharedTaps taps = find(key);
+            return taps ? taps : design(key);
+        }
+    }
+
+    SharedTaps lowPass(double cutoff, double transWidth, double samplerate, bool oddTapCount, float gain) {
+        return get(Key(LOW_PASS, cutoff, 0.0, transWidth, samplerate, oddTapCount, gain));
+    }
+
+    SharedTaps highPass(double cutoff, double transWidth, double samplerate, bool oddTapCount, float gain) {
+        return get(Key(HIGH_PASS, cutoff, 0.0, transWidth, samplerate, oddTapCount, gain));
+    }
+
+    SharedTaps bandPass(double bandStart, double bandStop, double transWidth, double samplerate, bool oddTapCount, float gain) {
+        return get(Key(BAND_PASS, bandStart, bandStop, transWidth, samplerate, oddTapCount, gain));
+    }
+
+    std::shared_future<SharedTaps> lowPassAsync(double cutoff, double transWidth, double samplerate, bool oddTapCount, float gain) {
+        Key key(LOW_PASS, cutoff, 0.0, transWidth, samplerate, oddTapCount, gain);
+
+        // Return right away if the taps are already available
+        SharedTaps taps = find(key);
+        if (taps) {
+            std::promise<SharedTaps> ready;
+            ready.set_value(taps);
+            return ready.get_future().share();
+        }
+
+        std::promise<SharedTaps> promise;
+        std::shared_future<SharedTaps> future = promise.get_future().share();
+        std::thread([key](std::promise<SharedTaps> promise) { promise.set_value(design(key)); }, std::move(promise)).detach();
+        return future;
+    }
+}
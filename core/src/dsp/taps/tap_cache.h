@@ -0,0 +1,21 @@
+#pragma once
+#include <memory>
+#include <future>
+#include "tap.h"
+
+namespace dsp::taps {
+    // Designed taps never change, so blocks with the same filter settings can share them
+    typedef std::shared_ptr<const tap<float>> SharedTaps;
+
+    // Process wide cache of filter designs keyed by their parameters. Taps are scaled by gain after the design.
+    // An entry is kept only as long as some block holds its taps.
+    namespace cache {
+        SharedTaps lowPass(double cutoff, double transWidth, double samplerate, bool oddTapCount = false, float gain = 1.0f);
+        SharedTaps highPass(double cutoff, double transWidth, double samplerate, bool oddTapCount = false, float gain = 1.0f);
+        SharedTaps bandPass(double bandStart, double bandStop, double transWidth, double samplerate, bool oddTapCount = false, float gain = 1.0f);
+
+        // Same as lowPass but designed on a detached thread if the taps aren't in the cache yet.
+        // Unlike a future from std::async, dropping the returned future never waits for the design to finish.
+        std::shared_future<SharedTaps> lowPassAsync(double cutoff, double transWidth, double samplerate, bool oddTapCount = false, float gain = 1.0f);
+    }
+}
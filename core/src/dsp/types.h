@@ -1,5 +1,6 @@
 #pragma once
 #include <math.h>
+#include <stdint.h>
 #include "math/constants.h"
 
 namespace dsp {
@@ -125,4 +126,10 @@ namespace dsp {
         float l;
         float r;
     };
+
+    // Interleaved 16bit IQ, full scale is +/-32768
+    struct complex16_t {
+        int16_t re;
+        int16_t im;
+    };
 }
@@ -18,6 +18,9 @@ namespace icons {
     ImTextureID CENTER_TUNING;
 
     GLuint loadTexture(std::string path) {
+#ifdef SDRPP_HEADLESS
+        return 0;
+#else
         int w, h, n;
         stbi_uc* data = stbi_load(path.c_str(), &w, &h, &n, 0);
         GLuint texId;
@@ -29,6 +32,7 @@ namespace icons {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, (uint8_t*)data);
         stbi_image_free(data);
         return texId;
+#endif
     }
 
     bool load(std::string resDir) {
@@ -0,0 +1,271 @@
+#include <gui/menus/decoder_output.h>
+#include <imgui.h>
+#include <gui/gui.h>
+#include <gui/style.h>
+#include <gui/widgets/folder_select.h>
+#include <utils/decoder_sinks.h>
+#include <utils/flog.h>
+#include <core.h>
+#include <deque>
+#include <filesystem>
+#include <time.h>
+
+// Records kept for the list of the menu
+#define DECODER_OUTPUT_RING_SIZE    500
+
+namespace decoder_output_menu {
+    struct Entry {
+        std::string time;
+        std::string decoder;
+        double frequency;
+        std::string text;
+    };
+
+    RecordRingSink* ring = NULL;
+    RecordFileSink* fileSink = NULL;
+    RecordSocketSink* feedSink = NULL;
+
+    FolderSelect* folderSelect = NULL;
+    bool fileEnabled = false;
+    int fileFormat = RecordFileSink::FORMAT_JSONL;
+    int fileMaxSize = 16;
+    int fileMaxCount = 10;
+
+    bool feedEnabled = false;
+    int feedType = RecordSocketSink::TYPE_UDP;
+    char feedHost[1024];
+    int feedPort = 5270;
+    char feedPath[1024];
+    std::string feedError;
+
+    std::deque<Entry> entries;
+    uint64_t lastSeq = 0;
+
+    const char* FILE_FORMATS[] = { "jsonl", "csv" };
+    const char* FEED_TYPES[] = { "udp", "tcp", "unix" };
+
+    void saveConfig() {
+        core::configManager.acquire();
+        json& conf = core::configManager.conf["decoderOutput"];
+        conf["fileEnabled"] = fileEnabled;
+        conf["filePath"] = folderSelect->path;
+        conf["fileFormat"] = FILE_FORMATS[fileFormat];
+        conf["fileMaxSize"] = fileMaxSize;
+        conf["fileMaxCount"] = fileMaxCount;
+        conf["feedEnabled"] = feedEnabled;
+        conf["feedType"] = FEED_TYPES[feedType];
+        conf["feedHost"] = feedHost;
+        conf["feedPort"] = feedPort;
+        conf["feedPath"] = feedPath;
+        core::configManager.release(true);
+    }
+
+    void applyFile() {
+        if (fileSink) {
+            core::decoderBus.removeSink(fileSink);
+            delete fileSink;
+            fileSink = NULL;
+        }
+        if (!fileEnabled) { return; }
+
+        // The default directory is only created once used
+        std::string dir = folderSelect->expandString(folderSelect->path);
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (!std::filesystem::is_directory(dir)) {
+            flog::error("Decoder output directory doesn't exist: {0}", dir);
+            return;
+        }
+        fileSink = new RecordFileSink(dir, (RecordFileSink::Format)fileFormat, (uint64_t)fileMaxSize * 1000000, fileMaxCount);
+        core::decoderBus.addSink(fileSink);
+    }
+
+    void applyFeed() {
+        if (feedSink) {
+            core::decoderBus.removeSink(feedSink);
+            delete feedSink;
+            feedSink = NULL;
+        }
+        feedError.clear();
+        if (!feedEnabled) { return; }
+        try {
+            feedSink = new RecordSocketSink((RecordSocketSink::Type)feedType, feedHost, feedPort, feedPath);
+            core::decoderBus.addSink(feedSink);
+        }
+        catch (const std::exception& e) {
+            flog::error("Could not start the decoder feed: {0}", e.what());
+            feedError = e.what();
+            feedEnabled = false;
+        }
+    }
+
+    int findOption(const char** options, int count, const std::string& value) {
+        for (int i = 0; i < count; i++) {
+            if (value == options[i]) { return i; }
+        }
+        return 0;
+    }
+
+    void init() {
+        folderSelect = new FolderSelect("%ROOT%/decoders");
+
+        core::configManager.acquire();
+        json conf = core::configManager.conf["decoderOutput"];
+        core::configManager.release();
+        fileEnabled = conf["fileEnabled"];
+        folderSelect->setPath(conf["filePath"]);
+        fileFormat = findOption(FILE_FORMATS, 2, conf["fileFormat"]);
+        fileMaxSize = conf["fileMaxSize"];
+        fileMaxCount = conf["fileMaxCount"];
+        feedEnabled = conf["feedEnabled"];
+        feedType = findOption(FEED_TYPES, 3, conf["feedType"]);
+        std::string host = conf["feedHost"];
+        strncpy(feedHost, host.c_str(), sizeof(feedHost) - 1);
+        feedPort = conf["feedPort"];
+        std::string path = conf["feedPath"];
+        strncpy(feedPath, path.c_str(), sizeof(feedPath) - 1);
+
+        ring = new RecordRingSink(DECODER_OUTPUT_RING_SIZE);
+        core::decoderBus.addSink(ring);
+        applyFile();
+        applyFeed();
+        core::decoderBus.start();
+    }
+
+    void end() {
+        // Whatever is still queued goes to the sinks before they're deleted
+        core::decoderBus.stop();
+        fileEnabled = false;
+        feedEnabled = false;
+        applyFile();
+        applyFeed();
+        core::decoderBus.removeSink(ring);
+        delete ring;
+        ring = NULL;
+    }
+
+    void updateEntries() {
+        if (!ring) { return; }
+        std::vector<DecoderRecord> records;
+        lastSeq = ring->getRecords(records, lastSeq);
+        for (const auto& rec : records) {
+            Entry e;
+            time_t t = (time_t)rec.time;
+            tm* ltm = localtime(&t);
+            char timeStr[32];
+            strftime(timeStr, sizeof(timeStr), "%H:%M:%S", ltm);
+            e.time = timeStr;
+            e.decoder = rec.decoder;
+            e.frequency = rec.frequency;
+            for (auto& [key, val] : rec.fields.items()) {
+                if (!e.text.empty()) { e.text += ", "; }
+                e.text += key + ": " + (val.is_string() ? val.get<std::string>() : val.dump());
+            }
+            entries.push_back(e);
+            if (entries.size() > DECODER_OUTPUT_RING_SIZE) { entries.pop_front(); }
+        }
+    }
+
+    void draw(void* ctx) {
+        float menuWidth = ImGui::GetContentRegionAvail().x;
+
+        // Files
+        if (ImGui::Checkbox("Write to files##decoder_output_file", &fileEnabled)) {
+            applyFile();
+            saveConfig();
+        }
+        if (fileEnabled) { style::beginDisabled(); }
+        if (folderSelect->render("##decoder_output_path")) {
+            saveConfig();
+        }
+        ImGui::LeftLabel("Format");
+        ImGui::FillWidth();
+        if (ImGui::Combo("##decoder_output_format", &fileFormat, "JSON Lines\0CSV\0")) {
+            saveConfig();
+        }
+        ImGui::LeftLabel("Max file size (MB)");
+        ImGui::FillWidth();
+        if (ImGui::InputInt("##decoder_output_max_size", &fileMaxSize, 1, 10)) {
+            fileMaxSize = std::max<int>(fileMaxSize, 1);
+            saveConfig();
+        }
+        ImGui::LeftLabel("Files kept (0 for all)");
+        ImGui::FillWidth();
+        if (ImGui::InputInt("##decoder_output_max_count", &fileMaxCount, 1, 10)) {
+            fileMaxCount = std::max<int>(fileMaxCount, 0);
+            saveConfig();
+        }
+        if (fileEnabled) { style::endDisabled(); }
+        if (fileSink) {
+            std::string path = fileSink->getPath();
+            if (!path.empty()) { ImGui::TextWrapped("Writing to %s", std::filesystem::path(path).filename().string().c_str()); }
+        }
+
+        // Network feed
+        if (ImGui::Checkbox("Network feed##decoder_output_feed", &feedEnabled)) {
+            applyFeed();
+            saveConfig();
+        }
+        if (feedEnabled) { style::beginDisabled(); }
+        ImGui::LeftLabel("Protocol");
+        ImGui::FillWidth();
+        if (ImGui::Combo("##decoder_output_feed_type", &feedType, "UDP\0TCP server\0Unix socket\0")) {
+            saveConfig();
+        }
+        if (feedType == RecordSocketSink::TYPE_UNIX) {
+            ImGui::FillWidth();
+            if (ImGui::InputText("##decoder_output_feed_path", feedPath, 1023)) {
+                saveConfig();
+            }
+        }
+        else {
+            if (ImGui::InputText("##decoder_output_feed_host", feedHost, 1023)) {
+                saveConfig();
+            }
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputInt("##decoder_output_feed_port", &feedPort, 0, 0)) {
+                saveConfig();
+            }
+        }
+        if (feedEnabled) { style::endDisabled(); }
+        if (!feedError.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", feedError.c_str());
+        }
+        else if (feedSink && feedType != RecordSocketSink::TYPE_UDP) {
+            ImGui::Text("Clients: %d", feedSink->getClientCount());
+        }
+
+        uint64_t published, dropped;
+        core::decoderBus.getCounters(published, dropped);
+        ImGui::Text("Records: %llu (%llu dropped)", (unsigned long long)published, (unsigned long long)dropped);
+
+        // Latest records, newest first
+        updateEntries();
+        if (ImGui::BeginTable("##decoder_output_records", 4, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY, ImVec2(0, 200.0f * style::uiScale))) {
+            ImGui::TableSetupColumn("Time");
+            ImGui::TableSetupColumn("Decoder");
+            ImGui::TableSetupColumn("Frequency");
+            ImGui::TableSetupColumn("Data", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableHeadersRow();
+
+            for (auto it = entries.rbegin(); it != entries.rend(); it++) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(it->time.c_str());
+                ImGui::TableSetColumnIndex(1);
+                ImGui::TextUnformatted(it->decoder.c_str());
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.4lf", it->frequency / 1e6);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::TextUnformatted(it->text.c_str());
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::Button("Clear##decoder_output_clear", ImVec2(menuWidth, 0))) {
+            entries.clear();
+        }
+    }
+}
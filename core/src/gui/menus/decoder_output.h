@@ -0,0 +1,7 @@
+#pragma once
+
+namespace decoder_output_menu {
+    void init();
+    void end();
+    void draw(void* ctx);
+}
@@ -5,6 +5,7 @@
 #include <gui/main_window.h>
 #include <gui/style.h>
 #include <signal_path/signal_path.h>
+#include <time.h>
 
 namespace sourcemenu {
     int offsetMode = 0;
@@ -14,6 +15,10 @@ namespace sourcemenu {
     int decimationPower = 0;
     bool iqCorrection = false;
     bool invertIQ = false;
+    int bufferLatency = 0;
+    int bufferPolicy = 0;
+    bool captureZeroFill = false;
+    bool fixedPointInput = false;
 
     EventHandler<std::string> sourceRegisteredHandler;
     EventHandler<std::string> sourceUnregisterHandler;
@@ -52,6 +57,33 @@ namespace sourcemenu {
                                    "32\0"
                                    "64\0";
 
+    const char* bufferPoliciesTxt = "Drop oldest\0"
+                                    "Drop newest\0"
+                                    "Block\0";
+
+    void loadBufferSettings() {
+        // Use the source's own settings unless the user changed them
+        bufferLatency = sigpath::sourceManager.getBufferLatency();
+        bufferPolicy = sigpath::sourceManager.getBufferPolicy();
+        core::configManager.acquire();
+        if (core::configManager.conf["sourceBuffers"].contains(selectedSource)) {
+            bufferLatency = core::configManager.conf["sourceBuffers"][selectedSource]["latency"];
+            bufferPolicy = core::configManager.conf["sourceBuffers"][selectedSource]["policy"];
+        }
+        core::configManager.release();
+        sigpath::iqFrontEnd.setBufferLatency(bufferLatency);
+        sigpath::iqFrontEnd.setBufferPolicy((dsp::buffer::OverflowPolicy)bufferPolicy);
+
+        sigpath::sourceManager.setCaptureZeroFill(captureZeroFill);
+    }
+
+    void saveBufferSettings() {
+        core::configManager.acquire();
+        core::configManager.conf["sourceBuffers"][selectedSource]["latency"] = bufferLatency;
+        core::configManager.conf["sourceBuffers"][selectedSource]["policy"] = bufferPolicy;
+        core::configManager.release(true);
+    }
+
     void updateOffset() {
         if (offsetMode == OFFSET_MODE_CUSTOM) { effectiveOffset = customOffset; }
         else if (offsetMode == OFFSET_MODE_SPYVERTER) {
@@ -100,6 +132,7 @@ namespace sourcemenu {
         sourceId = std::distance(sourceNames.begin(), it);
         selectedSource = sourceNames[sourceId];
         sigpath::sourceManager.selectSource(sourceNames[sourceId]);
+        loadBufferSettings();
     }
 
     void onSourceRegistered(std::string name, void* ctx) {
@@ -145,6 +178,12 @@ namespace sourcemenu {
         decimationPower = core::configManager.conf["decimationPower"];
         iqCorrection = core::configManager.conf["iqCorrection"];
         invertIQ = core::configManager.conf["invertIQ"];
+        captureZeroFill = core::configManager.conf["captureZeroFill"];
+        fixedPointInput = core::configManager.conf["fixedPointInput"];
+        core::configManager.release();
+
+        sigpath::sourceManager.setFixedPointInput(fixedPointInput);
+
         sigpath::iqFrontEnd.setDCBlocking(iqCorrection);
         sigpath::iqFrontEnd.setInvertIQ(invertIQ);
         updateOffset();
@@ -159,8 +198,6 @@ namespace sourcemenu {
         sigpath::sourceManager.onSourceRegistered.bindHandler(&sourceRegisteredHandler);
         sigpath::sourceManager.onSourceUnregister.bindHandler(&sourceUnregisterHandler);
         sigpath::sourceManager.onSourceUnregistered.bindHandler(&sourceUnregisteredHandler);
-
-        core::configManager.release();
     }
 
     void draw(void* ctx) {
@@ -229,6 +266,65 @@ namespace sourcemenu {
             core::configManager.conf["decimationPower"] = decimationPower;
             core::configManager.release(true);
         }
+
+        // Only used by sources able to give 16bit IQ
+        if (ImGui::Checkbox("Fixed-point front-end##source_fixed_point", &fixedPointInput)) {
+            sigpath::sourceManager.setFixedPointInput(fixedPointInput);
+            core::configManager.acquire();
+            core::configManager.conf["fixedPointInput"] = fixedPointInput;
+            core::configManager.release(true);
+        }
         if (running) { style::endDisabled(); }
+
+        ImGui::LeftLabel("Buffer (ms)");
+        ImGui::SetNextItemWidth(itemWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputInt("##source_buffer_latency", &bufferLatency, 10, 100)) {
+            bufferLatency = std::clamp<int>(bufferLatency, 0, 10000);
+            sigpath::iqFrontEnd.setBufferLatency(bufferLatency);
+            saveBufferSettings();
+        }
+
+        ImGui::LeftLabel("Overflow");
+        ImGui::SetNextItemWidth(itemWidth - ImGui::GetCursorPosX());
+        if (ImGui::Combo("##source_buffer_policy", &bufferPolicy, bufferPoliciesTxt)) {
+            sigpath::iqFrontEnd.setBufferPolicy((dsp::buffer::OverflowPolicy)bufferPolicy);
+            saveBufferSettings();
+        }
+
+        uint64_t overflows, underflows, dropped;
+        sigpath::iqFrontEnd.getBufferCounters(overflows, underflows, dropped);
+        ImGui::Text("Overflows: %llu (%llu samples)", (unsigned long long)overflows, (unsigned long long)dropped);
+        ImGui::Text("Underflows: %llu", (unsigned long long)underflows);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##source_buffer_reset")) {
+            sigpath::iqFrontEnd.resetBufferCounters();
+        }
+
+        // Samples lost on the device side, only for sources capturing through a ring
+        auto ring = sigpath::sourceManager.getCaptureRing();
+        if (ring) {
+            uint64_t devOverflows, devDropped;
+            ring->getCounters(devOverflows, devDropped);
+            ImGui::Text("Device drops: %llu (%llu samples)", (unsigned long long)devOverflows, (unsigned long long)devDropped);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Reset##source_capture_reset")) {
+                ring->resetCounters();
+            }
+
+            auto events = ring->getOverflowLog();
+            if (!events.empty()) {
+                auto& last = events.back();
+                time_t t = std::chrono::system_clock::to_time_t(last.time);
+                tm* ltm = localtime(&t);
+                ImGui::Text("Last drop: %02d:%02d:%02d (%lld samples)", ltm->tm_hour, ltm->tm_min, ltm->tm_sec, (long long)last.droppedSamples);
+            }
+
+            if (ImGui::Checkbox("Zero-fill drops##source_capture_zero_fill", &captureZeroFill)) {
+                sigpath::sourceManager.setCaptureZeroFill(captureZeroFill);
+                core::configManager.acquire();
+                core::configManager.conf["captureZeroFill"] = captureZeroFill;
+                core::configManager.release(true);
+            }
+        }
     }
 }
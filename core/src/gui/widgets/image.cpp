@@ -8,8 +8,6 @@ namespace ImGui {
         activeBuffer = malloc(_width * _height * 4);
         memset(buffer, 0, _width * _height * 4);
         memset(activeBuffer, 0, _width * _height * 4);
-
-        glGenTextures(1, &textureId);
     }
 
     ImageDisplay::~ImageDisplay() {
@@ -54,11 +52,15 @@ namespace ImGui {
     }
 
     void ImageDisplay::updateTexture() {
+#ifndef SDRPP_HEADLESS
+        // Created on the first draw, there's no GL context when the decoders are built
+        if (!textureId) { glGenTextures(1, &textureId); }
         glBindTexture(GL_TEXTURE_2D, textureId);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, activeBuffer);
+#endif
     }
 
 }
\ No newline at end of file
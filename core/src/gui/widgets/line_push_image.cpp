@@ -6,8 +6,6 @@ namespace ImGui {
         _reservedIncrement = reservedIncrement;
         frameBuffer = (uint8_t*)malloc(_frameWidth * _reservedIncrement * 4);
         reservedCount = reservedIncrement;
-
-        glGenTextures(1, &textureId);
     }
 
     void LinePushImage::draw(const ImVec2& size_arg) {
@@ -79,11 +77,15 @@ namespace ImGui {
     }
 
     void LinePushImage::updateTexture() {
+#ifndef SDRPP_HEADLESS
+        // Created on the first draw, there's no GL context when the decoders are built
+        if (!textureId) { glGenTextures(1, &textureId); }
         glBindTexture(GL_TEXTURE_2D, textureId);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _frameWidth, _lineCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, frameBuffer);
+#endif
     }
 
 }
\ No newline at end of file
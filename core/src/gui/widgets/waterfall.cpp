@@ -136,7 +136,9 @@ namespace ImGui {
     }
 
     void WaterFall::init() {
+#ifndef SDRPP_HEADLESS
         glGenTextures(1, &textureId);
+#endif
     }
 
     void WaterFall::drawFFT() {
@@ -806,11 +808,13 @@ namespace ImGui {
 
     void WaterFall::updateWaterfallTexture() {
         std::lock_guard<std::mutex> lck(texMtx);
+#ifndef SDRPP_HEADLESS
         glBindTexture(GL_TEXTURE_2D, textureId);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, dataWidth, waterfallHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, (uint8_t*)waterfallFb);
+#endif
     }
 
     void WaterFall::onPositionChange() {
@@ -0,0 +1,358 @@
+#include "headless.h"
+#include "core.h"
+#include <utils/flog.h>
+#include <config.h>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <algorithm>
+#include <csignal>
+#include <signal_path/signal_path.h>
+#include <gui/gui.h>
+#include <gui/menus/decoder_output.h>
+
+// The graph file looks like this, every key is optional:
+// {
+//     "modules": ["/path/to/extra_module.so"],
+//     "instances": { "Radio": { "module": "radio", "enabled": true }, "Recorder": { "module": "recorder" } },
+//     "source": "RTL-SDR",
+//     "frequency": 100000000.0,
+//     "offset": 0.0,
+//     "vfos": { "Radio": 100100000.0 },
+//     "sinks": { "Radio": "None" },
+//     "fftSize": 1024,
+//     "fftRate": 10.0,
+//     "control": { "host": "127.0.0.1", "port": 5260 },
+//     "autostart": true
+// }
+// Instances default to the moduleInstances of the main config. Each module keeps reading its own
+// config file from the root directory, so one root directory per receiver keeps them independent.
+
+namespace headless {
+    dsp::stream<dsp::complex_t> dummyStream;
+    net::Listener listener;
+    net::Conn client;
+    uint8_t* rbuf = NULL;
+    std::string command;
+    std::mutex ctrlMtx;
+    std::atomic<bool> quit = false;
+    bool running = false;
+    double frequency = 100000000.0;
+
+    const int MAX_COMMAND_LENGTH = 8192;
+
+    static void signalHandler(int sig) {
+        quit = true;
+    }
+
+    // There is no waterfall, the spectrum is only given to the onSpectrum listeners
+    static float* acquireFFTBuffer(void* ctx) {
+        return NULL;
+    }
+
+    static void releaseFFTBuffer(void* ctx) {}
+
+    static void tune(double freq) {
+        // Modules read the center frequency from the waterfall state even without drawing it
+        frequency = freq;
+        gui::waterfall.setCenterFrequency(freq);
+        sigpath::sourceManager.tune(freq);
+    }
+
+    static void setRunning(bool run) {
+        if (run == running) { return; }
+        if (run) {
+            sigpath::iqFrontEnd.flushInputBuffer();
+            sigpath::sourceManager.start();
+            sigpath::sourceManager.tune(frequency);
+        }
+        else {
+            sigpath::sourceManager.stop();
+            sigpath::iqFrontEnd.flushInputBuffer();
+        }
+        running = run;
+    }
+
+    static bool loadModule(const std::string& name, const std::string& modulesDir, const std::vector<std::string>& configModules) {
+        if (core::moduleManager.modules.find(name) != core::moduleManager.modules.end()) { return true; }
+
+        // Only load what the graph uses, first from the module directory then from the paths of the main config
+        std::vector<std::string> candidates;
+        candidates.push_back(modulesDir + "/" + name + SDRPP_MOD_EXTENTSION);
+        for (const auto& path : configModules) {
+            if (std::filesystem::path(path).stem().string() == name) { candidates.push_back(std::filesystem::absolute(path).string()); }
+        }
+        for (const auto& path : candidates) {
+            if (!std::filesystem::is_regular_file(path)) { continue; }
+            flog::info("Loading {0}", path);
+            core::moduleManager.loadModule(path);
+            if (core::moduleManager.modules.find(name) != core::moduleManager.modules.end()) { return true; }
+        }
+
+        flog::error("Could not find module {0}", name);
+        return false;
+    }
+
+    int main(std::string graphPath) {
+        flog::info("=====| HEADLESS MODE |=====");
+
+        // Load the graph
+        json graph;
+        try {
+            std::ifstream file(graphPath);
+            if (!file.is_open()) {
+                flog::error("Could not open graph file {0}", graphPath);
+                return -1;
+            }
+            file >> graph;
+        }
+        catch (const std::exception& e) {
+            flog::error("Could not parse graph file {0}: {1}", graphPath, e.what());
+            return -1;
+        }
+
+        core::configManager.acquire();
+        std::string modulesDir = core::configManager.conf["modulesDirectory"];
+        std::vector<std::string> configModules = core::configManager.conf["modules"];
+        json instances = graph.contains("instances") ? graph["instances"] : core::configManager.conf["moduleInstances"];
+        core::configManager.release();
+        modulesDir = std::filesystem::absolute(modulesDir).string();
+
+        // Init DSP
+        int fftSize = graph.value("fftSize", 1024);
+        double fftRate = graph.value("fftRate", 10.0);
+        sigpath::iqFrontEnd.init(&dummyStream, 8000000, true, 1, false, fftSize, fftRate, IQFrontEnd::FFTWindow::NUTTALL, acquireFFTBuffer, releaseFFTBuffer, NULL);
+        sigpath::iqFrontEnd.start();
+        gui::waterfall.setBandwidth(8000000);
+        gui::waterfall.setViewBandwidth(8000000);
+
+        // Decoded records go to the files and the feed set in the main config
+        decoder_output_menu::init();
+
+        // Load modules
+        flog::info("Loading modules");
+        if (graph.contains("modules")) {
+            for (const auto& path : graph["modules"]) {
+                std::string apath = std::filesystem::absolute(path.get<std::string>()).string();
+                flog::info("Loading {0}", apath);
+                core::moduleManager.loadModule(apath);
+            }
+        }
+
+        // Create module instances
+        for (auto const& [name, inst] : instances.items()) {
+            std::string mod = inst.is_string() ? inst.get<std::string>() : inst.value("module", "");
+            bool enabled = inst.is_object() ? inst.value("enabled", true) : true;
+            if (!loadModule(mod, modulesDir, configModules)) { continue; }
+            flog::info("Initializing {0} ({1})", name, mod);
+            core::moduleManager.createInstance(name, mod);
+            if (!enabled) { core::moduleManager.disableInstance(name); }
+        }
+        core::moduleManager.doPostInitAll();
+
+        // Route the audio streams
+        core::configManager.acquire();
+        sigpath::sinkManager.loadSinksFromConfig();
+        core::configManager.release();
+        if (graph.contains("sinks")) {
+            for (auto const& [stream, provider] : graph["sinks"].items()) {
+                sigpath::sinkManager.setStreamSink(stream, provider);
+            }
+        }
+
+        // Select the source and tune
+        sigpath::sourceManager.setTuningOffset(graph.value("offset", 0.0));
+        std::string source = graph.value("source", "");
+        if (source.empty()) {
+            auto sources = sigpath::sourceManager.getSourceNames();
+            if (!sources.empty()) { source = sources[0]; }
+        }
+        if (!source.empty()) { sigpath::sourceManager.selectSource(source); }
+        tune(graph.value("frequency", frequency));
+
+        // Place the VFOs
+        if (graph.contains("vfos")) {
+            for (auto const& [name, freq] : graph["vfos"].items()) {
+                if (!sigpath::vfoManager.vfoExists(name)) {
+                    flog::warn("VFO {0} doesn't exist, not placing it", name);
+                    continue;
+                }
+                sigpath::vfoManager.setOffset(name, (double)freq - frequency);
+            }
+        }
+
+        if (graph.value("autostart", true)) { setRunning(true); }
+
+        // Start the control socket, local only unless configured otherwise
+        std::string host = "127.0.0.1";
+        int port = 5260;
+        if (graph.contains("control")) {
+            host = graph["control"].value("host", host);
+            port = graph["control"].value("port", port);
+        }
+        rbuf = new uint8_t[1024];
+        try {
+            listener = net::listen(host, port);
+            listener->acceptAsync(_clientHandler, NULL);
+            flog::info("Ready, control socket listening on {0}:{1}", host, port);
+        }
+        catch (const std::exception& e) {
+            flog::error("Could not start the control socket: {0}", e.what());
+        }
+
+        // Run until asked to quit
+        std::signal(SIGINT, signalHandler);
+        std::signal(SIGTERM, signalHandler);
+        while (!quit) { std::this_thread::sleep_for(std::chrono::milliseconds(100)); }
+
+        flog::info("Shutting down");
+        if (listener) { listener->close(); }
+        if (client && client->isOpen()) { client->close(); }
+        setRunning(false);
+        for (auto& [name, mod] : core::moduleManager.modules) {
+            mod.end();
+        }
+        decoder_output_menu::end();
+        sigpath::iqFrontEnd.stop();
+
+        core::configManager.disableAutoSave();
+        core::configManager.save();
+        delete[] rbuf;
+
+        flog::info("Exiting successfully");
+        return 0;
+    }
+
+    void setInputSampleRate(double samplerate) {
+        sigpath::iqFrontEnd.setSampleRate(samplerate);
+        double effectiveSr = sigpath::iqFrontEnd.getEffectiveSamplerate();
+
+        // Keep the baseband state used by the tuner and modules up to date
+        gui::waterfall.setBandwidth(effectiveSr);
+        gui::waterfall.setViewOffset(0);
+        gui::waterfall.setViewBandwidth(effectiveSr);
+
+        flog::info("New DSP samplerate: {0} (source samplerate is {1})", effectiveSr, samplerate);
+    }
+
+    void _clientHandler(net::Conn conn, void* ctx) {
+        // One client at a time, the next one is accepted once it disconnects
+        flog::info("Control client connected");
+        client = std::move(conn);
+        command.clear();
+        client->readAsync(1024, rbuf, _dataHandler, NULL, false);
+        client->waitForEnd();
+        client->close();
+        flog::info("Control client disconnected");
+
+        if (!quit) { listener->acceptAsync(_clientHandler, NULL); }
+    }
+
+    void _dataHandler(int count, uint8_t* buf, void* ctx) {
+        for (int i = 0; i < count; i++) {
+            if (buf[i] == '\n') {
+                if (!command.empty() && command.back() == '\r') { command.pop_back(); }
+
+                // Split the command word from its argument
+                size_t sep = command.find(' ');
+                std::string cmd = command.substr(0, sep);
+                std::string arg = (sep != std::string::npos) ? command.substr(sep + 1) : "";
+                command.clear();
+
+                std::string resp;
+                {
+                    std::lock_guard<std::mutex> lck(ctrlMtx);
+                    resp = commandHandler(cmd, arg) + "\n";
+                }
+                client->write(resp.size(), (uint8_t*)resp.c_str());
+                continue;
+            }
+            if (command.size() < MAX_COMMAND_LENGTH) { command += (char)buf[i]; }
+        }
+
+        client->readAsync(1024, rbuf, _dataHandler, NULL, false);
+    }
+
+    static std::string reply(bool ok, const std::string& error = "") {
+        json resp;
+        resp["ok"] = ok;
+        if (!ok) { resp["error"] = error; }
+        return resp.dump();
+    }
+
+    std::string commandHandler(const std::string& cmd, const std::string& arg) {
+        if (cmd == "status") {
+            return getStatus();
+        }
+        else if (cmd == "start" || cmd == "stop") {
+            setRunning(cmd == "start");
+            return reply(true);
+        }
+        else if (cmd == "tune") {
+            double freq;
+            try { freq = std::stod(arg); }
+            catch (const std::exception& e) { return reply(false, "Invalid frequency"); }
+            tune(freq);
+            return reply(true);
+        }
+        else if (cmd == "source") {
+            auto sources = sigpath::sourceManager.getSourceNames();
+            if (std::find(sources.begin(), sources.end(), arg) == sources.end()) { return reply(false, "Unknown source"); }
+            bool wasRunning = running;
+            setRunning(false);
+            sigpath::sourceManager.selectSource(arg);
+            tune(frequency);
+            setRunning(wasRunning);
+            return reply(true);
+        }
+        else if (cmd == "vfo") {
+            // The name can contain spaces, the frequency is the last word
+            size_t sep = arg.rfind(' ');
+            if (sep == std::string::npos) { return reply(false, "Usage: vfo <name> <frequency>"); }
+            std::string name = arg.substr(0, sep);
+            double freq;
+            try { freq = std::stod(arg.substr(sep + 1)); }
+            catch (const std::exception& e) { return reply(false, "Invalid frequency"); }
+            if (!sigpath::vfoManager.vfoExists(name)) { return reply(false, "Unknown VFO"); }
+            double offset = freq - frequency;
+            double halfBw = sigpath::iqFrontEnd.getEffectiveSamplerate() / 2.0;
+            if (offset < -halfBw || offset > halfBw) { return reply(false, "Frequency outside of the baseband"); }
+            sigpath::vfoManager.setOffset(name, offset);
+            return reply(true);
+        }
+        else if (cmd == "enable" || cmd == "disable") {
+            if (core::moduleManager.instances.find(arg) == core::moduleManager.instances.end()) { return reply(false, "Unknown instance"); }
+            if (cmd == "enable") { core::moduleManager.enableInstance(arg); }
+            else { core::moduleManager.disableInstance(arg); }
+            return reply(true);
+        }
+        else if (cmd == "quit") {
+            quit = true;
+            return reply(true);
+        }
+        return reply(false, "Unknown command");
+    }
+
+    std::string getStatus() {
+        json status;
+        status["ok"] = true;
+        status["running"] = running;
+        status["source"] = sigpath::sourceManager.getSelectedName();
+        status["frequency"] = frequency;
+        status["sampleRate"] = sigpath::iqFrontEnd.getEffectiveSamplerate();
+
+        status["instances"] = json::object();
+        for (auto const& [name, inst] : core::moduleManager.instances) {
+            status["instances"][name]["module"] = core::moduleManager.getInstanceModuleName(name);
+            status["instances"][name]["enabled"] = core::moduleManager.instanceEnabled(name);
+        }
+
+        status["vfos"] = json::object();
+        for (const auto& name : sigpath::vfoManager.getVFONames()) {
+            status["vfos"][name]["frequency"] = frequency + sigpath::vfoManager.getOffset(name);
+            status["vfos"][name]["bandwidth"] = sigpath::vfoManager.getBandwidth(name);
+        }
+
+        return status.dump();
+    }
+}
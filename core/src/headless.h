@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <utils/networking.h>
+
+// Runs the DSP without any window or render loop. The graph (modules, instances, source,
+// tuning and VFOs) is described by a JSON file and controlled through a local text socket.
+namespace headless {
+    int main(std::string graphPath);
+    void setInputSampleRate(double samplerate);
+
+    void _clientHandler(net::Conn conn, void* ctx);
+    void _dataHandler(int count, uint8_t* buf, void* ctx);
+
+    std::string commandHandler(const std::string& cmd, const std::string& arg);
+    std::string getStatus();
+}
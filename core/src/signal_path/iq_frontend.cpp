@@ -2,13 +2,13 @@
 #include "../dsp/window/blackman.h"
 #include "../dsp/window/nuttall.h"
 #include <utils/flog.h>
-#include <gui/gui.h>
 #include <core.h>
 
 IQFrontEnd::~IQFrontEnd() {
     if (!_init) { return; }
     stop();
     dsp::buffer::free(fftWindowBuf);
+    dsp::buffer::free(fftDbOut);
     fftwf_destroy_plan(fftwPlan);
     fftwf_free(fftInBuf);
     fftwf_free(fftOutBuf);
@@ -26,8 +26,11 @@ void IQFrontEnd::init(dsp::stream<dsp::complex_t>* in, double sampleRate, bool b
 
     effectiveSr = _sampleRate / _decimRatio;
 
-    inBuf.init(in);
-    inBuf.bypass = !buffering;
+    inBuf.init(in, _sampleRate, DEFAULT_BUFFER_LATENCY);
+    inBuf.setBypass(!buffering);
+    inBuf16.init(&nullIn16, _sampleRate, DEFAULT_BUFFER_LATENCY);
+    inBuf16.setBypass(!buffering);
+    decim16.init(&inBuf16.out, _decimRatio);
 
     decim.init(NULL, _decimRatio);
     dcBlock.init(NULL, genDCBlockRate(effectiveSr));
@@ -60,6 +63,7 @@ void IQFrontEnd::init(dsp::stream<dsp::complex_t>* in, double sampleRate, bool b
     fftInBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftOutBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftwPlan = fftwf_plan_dft_1d(_fftSize, fftInBuf, fftOutBuf, FFTW_FORWARD, FFTW_ESTIMATE);
+    fftDbOut = dsp::buffer::alloc<float>(_fftSize);
 
     // Clear the rest of the FFT input buffer
     dsp::buffer::clear(fftInBuf, _fftSize - _nzFFTSize, _nzFFTSize);
@@ -71,6 +75,20 @@ void IQFrontEnd::init(dsp::stream<dsp::complex_t>* in, double sampleRate, bool b
 
 void IQFrontEnd::setInput(dsp::stream<dsp::complex_t>* in) {
     inBuf.setInput(in);
+    if (fixedPoint) {
+        inBuf16.setInput(&nullIn16);
+        fixedPoint = false;
+        updatePreprocInput();
+    }
+}
+
+void IQFrontEnd::setInput16(dsp::stream<dsp::complex16_t>* in) {
+    inBuf16.setInput(in);
+    if (!fixedPoint) {
+        inBuf.setInput(&nullIn);
+        fixedPoint = true;
+        updatePreprocInput();
+    }
 }
 
 void IQFrontEnd::setSampleRate(double sampleRate) {
@@ -83,6 +101,8 @@ void IQFrontEnd::setSampleRate(double sampleRate) {
     // Update the samplerate
     _sampleRate = sampleRate;
     effectiveSr = _sampleRate / _decimRatio;
+    inBuf.setSamplerate(_sampleRate);
+    inBuf16.setSamplerate(_sampleRate);
     dcBlock.setRate(genDCBlockRate(effectiveSr));
     for (auto& [name, vfo] : vfos) {
         vfo->setInSamplerate(effectiveSr);
@@ -99,7 +119,32 @@ void IQFrontEnd::setSampleRate(double sampleRate) {
 }
 
 void IQFrontEnd::setBuffering(bool enabled) {
-    inBuf.bypass = !enabled;
+    inBuf.setBypass(!enabled);
+    inBuf16.setBypass(!enabled);
+}
+
+void IQFrontEnd::setBufferLatency(double latency) {
+    inBuf.setLatency((latency > 0.0) ? latency : DEFAULT_BUFFER_LATENCY);
+    inBuf16.setLatency((latency > 0.0) ? latency : DEFAULT_BUFFER_LATENCY);
+}
+
+void IQFrontEnd::setBufferPolicy(dsp::buffer::OverflowPolicy policy) {
+    inBuf.setPolicy(policy);
+    inBuf16.setPolicy(policy);
+}
+
+void IQFrontEnd::getBufferCounters(uint64_t& overflows, uint64_t& underflows, uint64_t& droppedSamples) {
+    if (fixedPoint) {
+        inBuf16.getCounters(overflows, underflows, droppedSamples);
+    }
+    else {
+        inBuf.getCounters(overflows, underflows, droppedSamples);
+    }
+}
+
+void IQFrontEnd::resetBufferCounters() {
+    inBuf.resetCounters();
+    inBuf16.resetCounters();
 }
 
 void IQFrontEnd::setDecimation(int ratio) {
@@ -109,13 +154,14 @@ void IQFrontEnd::setDecimation(int ratio) {
     // Update the decimation ratio
     _decimRatio = ratio;
     if (_decimRatio > 1) { decim.setRatio(_decimRatio); }
+    decim16.setRatio(_decimRatio);
     setSampleRate(_sampleRate);
 
     // Restart the decimator if it was running
     decim.tempStart();
 
-    // Enable or disable in the chain
-    preproc.setBlockEnabled(&decim, _decimRatio > 1, [=](dsp::stream<dsp::complex_t>* out){ split.setInput(out); });
+    // Enable or disable in the chain, the fixed point input does its own decimation
+    preproc.setBlockEnabled(&decim, !fixedPoint && _decimRatio > 1, [=](dsp::stream<dsp::complex_t>* out){ split.setInput(out); });
 
     // Update the DSP sample rate (TODO: Find a way to get rid of this)
     core::setInputSampleRate(_sampleRate);
@@ -146,6 +192,7 @@ dsp::channel::RxVFO* IQFrontEnd::addVFO(std::string name, double sampleRate, dou
 
     // Create VFO and its input stream
     dsp::stream<dsp::complex_t>* vfoIn = new dsp::stream<dsp::complex_t>;
+    vfoIn->setBufferSize(0); // Sized by the splitter to the blocks it forwards
     dsp::channel::RxVFO* vfo = new dsp::channel::RxVFO(vfoIn, effectiveSr, sampleRate, bandwidth, offset);
 
     // Register them
@@ -199,11 +246,14 @@ void IQFrontEnd::setFFTWindow(FFTWindow fftWindow) {
 
 void IQFrontEnd::flushInputBuffer() {
     inBuf.flush();
+    inBuf16.flush();
 }
 
 void IQFrontEnd::start() {
-    // Start input buffer
+    // Start input buffers
     inBuf.start();
+    inBuf16.start();
+    decim16.start();
 
     // Start pre-proc chain (automatically start all bound blocks)
     preproc.start();
@@ -222,8 +272,10 @@ void IQFrontEnd::start() {
 }
 
 void IQFrontEnd::stop() {
-    // Stop input buffer
+    // Stop input buffers
     inBuf.stop();
+    inBuf16.stop();
+    decim16.stop();
 
     // Stop pre-proc chain (automatically start all bound blocks)
     preproc.stop();
@@ -254,16 +306,35 @@ void IQFrontEnd::handler(dsp::complex_t* data, int count, void* ctx) {
     // Execute FFT
     fftwf_execute(_this->fftwPlan);
 
+    // Convert the complex output of the FFT to dB amplitude
+    volk_32fc_s32f_power_spectrum_32f(_this->fftDbOut, (lv_32fc_t*)_this->fftOutBuf, _this->_fftSize, _this->_fftSize);
+
     // Aquire buffer
     float* fftBuf = _this->_acquireFFTBuffer(_this->_fftCtx);
 
-    // Convert the complex output of the FFT to dB amplitude
+    // Copy the spectrum to the display
     if (fftBuf) {
-        volk_32fc_s32f_power_spectrum_32f(fftBuf, (lv_32fc_t*)_this->fftOutBuf, _this->_fftSize, _this->_fftSize);
+        memcpy(fftBuf, _this->fftDbOut, _this->_fftSize * sizeof(float));
     }
 
     // Release buffer
     _this->_releaseFFTBuffer(_this->_fftCtx);
+
+    // Give the full resolution spectrum to the detectors
+    _this->onSpectrum(_this->fftDbOut, _this->_fftSize, _this->effectiveSr);
+}
+
+void IQFrontEnd::updatePreprocInput() {
+    // Disable the float decimator first so that it is never fed by the fixed point one
+    auto onOutputChange = [=](dsp::stream<dsp::complex_t>* out){ split.setInput(out); };
+    if (fixedPoint) {
+        preproc.setBlockEnabled(&decim, false, onOutputChange);
+        preproc.setInput(&decim16.out, onOutputChange);
+    }
+    else {
+        preproc.setInput(&inBuf.out, onOutputChange);
+        preproc.setBlockEnabled(&decim, _decimRatio > 1, onOutputChange);
+    }
 }
 
 void IQFrontEnd::updateFFTPath(bool updateWaterfall) {
@@ -296,12 +367,14 @@ void IQFrontEnd::updateFFTPath(bool updateWaterfall) {
     fftInBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftOutBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftwPlan = fftwf_plan_dft_1d(_fftSize, fftInBuf, fftOutBuf, FFTW_FORWARD, FFTW_ESTIMATE);
+    dsp::buffer::free(fftDbOut);
+    fftDbOut = dsp::buffer::alloc<float>(_fftSize);
 
     // Clear the rest of the FFT input buffer
     dsp::buffer::clear(fftInBuf, _fftSize - _nzFFTSize, _nzFFTSize);
 
-    // Update waterfall (TODO: This is annoying, it makes this module non testable and will constantly clear the waterfall for any reason)
-    if (updateWaterfall) { gui::waterfall.setRawFFTSize(_fftSize); }
+    // Let the display resize its buffers while the FFT branch is stopped
+    if (updateWaterfall) { onFFTSizeChange(_fftSize); }
 
     // Restart branch
     reshape.tempStart();
@@ -1,13 +1,15 @@
 #pragma once
-#include "../dsp/buffer/frame_buffer.h"
+#include "../dsp/buffer/jitter_buffer.h"
 #include "../dsp/buffer/reshaper.h"
 #include "../dsp/multirate/power_decimator.h"
+#include "../dsp/multirate/fixed_power_decimator.h"
 #include "../dsp/correction/dc_blocker.h"
 #include "../dsp/chain.h"
 #include "../dsp/routing/splitter.h"
 #include "../dsp/channel/rx_vfo.h"
 #include "../dsp/sink/handler_sink.h"
 #include "../dsp/math/conjugate.h"
+#include <utils/new_event.h>
 #include <fftw3.h>
 
 class IQFrontEnd {
@@ -23,10 +25,18 @@ public:
     void init(dsp::stream<dsp::complex_t>* in, double sampleRate, bool buffering, int decimRatio, bool dcBlocking, int fftSize, double fftRate, FFTWindow fftWindow, float* (*acquireFFTBuffer)(void* ctx), void (*releaseFFTBuffer)(void* ctx), void* fftCtx);
 
     void setInput(dsp::stream<dsp::complex_t>* in);
+
+    // Take 16bit IQ instead, it is decimated in fixed point and only converted to float at the reduced rate
+    void setInput16(dsp::stream<dsp::complex16_t>* in);
+    inline bool isFixedPointInput() { return fixedPoint; }
     void setSampleRate(double sampleRate);
     inline double getSampleRate() { return _sampleRate / _decimRatio; }
 
     void setBuffering(bool enabled);
+    void setBufferLatency(double latency);
+    void setBufferPolicy(dsp::buffer::OverflowPolicy policy);
+    void getBufferCounters(uint64_t& overflows, uint64_t& underflows, uint64_t& droppedSamples);
+    void resetBufferCounters();
     void setDecimation(int ratio);
     void setInvertIQ(bool enabled);
     void setDCBlocking(bool enabled);
@@ -48,9 +58,19 @@ public:
 
     double getEffectiveSamplerate();
 
+    // Emitted from the FFT thread with the full resolution power spectrum (dB, DC in the middle) and its samplerate
+    NewEvent<const float*, int, double> onSpectrum;
+
+    // Emitted with the new FFT size when the display needs to resize its buffers
+    NewEvent<int> onFFTSizeChange;
+
 protected:
     static void handler(dsp::complex_t* data, int count, void* ctx);
     void updateFFTPath(bool updateWaterfall = false);
+    void updatePreprocInput();
+
+    // Input buffer length in ms when the source doesn't ask for a specific one
+    static constexpr double DEFAULT_BUFFER_LATENCY = 250.0;
 
     static inline double genDCBlockRate(double sampleRate) {
         return 50.0 / sampleRate;
@@ -63,7 +83,16 @@ protected:
     }
 
     // Input buffer
-    dsp::buffer::SampleFrameBuffer<dsp::complex_t> inBuf;
+    dsp::buffer::JitterBuffer<dsp::complex_t> inBuf;
+
+    // Fixed point input, feeds the pre-processing chain in place of the input buffer and decimator
+    dsp::buffer::JitterBuffer<dsp::complex16_t> inBuf16;
+    dsp::multirate::FixedPowerDecimator decim16;
+    bool fixedPoint = false;
+
+    // Inputs of the path not in use
+    dsp::stream<dsp::complex_t> nullIn;
+    dsp::stream<dsp::complex16_t> nullIn16;
 
     // Pre-processing chain
     dsp::multirate::PowerDecimator<dsp::complex_t> decim;
@@ -25,7 +25,13 @@ void SinkManager::Stream::init(dsp::stream<dsp::stereo_t>* in, EventHandler<floa
     splitter.init(_in);
     splitter.bindStream(&volumeInput);
     volumeAjust.init(&volumeInput, 1.0f, false);
-    sinkOut = &volumeAjust.out;
+
+    // Without drift compensation the resampler is left out and the buffer passes the audio through
+    driftResamp.init(&volumeAjust.out, _sampleRate, _sampleRate);
+    driftBuffer.init(driftComp ? &driftResamp.out : &volumeAjust.out, _sampleRate, targetLatency * DRIFT_BUFFER_RATIO);
+    driftBuffer.setPrefill(targetLatency);
+    driftBuffer.setBypass(!driftComp);
+    sinkOut = &driftBuffer.out;
 }
 
 void SinkManager::Stream::start() {
@@ -35,7 +41,10 @@ void SinkManager::Stream::start() {
 
     splitter.start();
     volumeAjust.start();
+    if (driftComp) { driftResamp.start(); }
+    driftBuffer.start();
     sink->start();
+    startDriftWorker();
     running = true;
 }
 
@@ -43,8 +52,11 @@ void SinkManager::Stream::stop() {
     if (!running) {
         return;
     }
+    stopDriftWorker();
     splitter.stop();
     volumeAjust.stop();
+    driftResamp.stop();
+    driftBuffer.stop();
     sink->stop();
     running = false;
 }
@@ -82,9 +94,93 @@ void SinkManager::Stream::unbindStream(dsp::stream<dsp::stereo_t>* stream) {
 void SinkManager::Stream::setSampleRate(float sampleRate) {
     std::lock_guard<std::mutex> lck(ctrlMtx);
     _sampleRate = sampleRate;
+    driftResamp.setRates(sampleRate, sampleRate);
+    driftBuffer.setSamplerate(sampleRate);
     srChange.emit(sampleRate);
 }
 
+void SinkManager::Stream::setDriftCompensation(bool enabled) {
+    std::lock_guard<std::mutex> ctrlLck(ctrlMtx);
+    {
+        std::lock_guard<std::mutex> lck(driftMtx);
+        if (enabled == driftComp) { return; }
+        driftComp = enabled;
+        driftIntegral = 0.0;
+        driftCorrection = 0.0;
+        driftPpm = 0.0;
+    }
+    driftResamp.setFineRatio(1.0);
+
+    // Without compensation the resampler is taken out and the sink paces the DSP directly like before
+    if (enabled) {
+        driftBuffer.setInput(&driftResamp.out);
+        if (running) { driftResamp.start(); }
+    }
+    else {
+        driftResamp.stop();
+        driftBuffer.setInput(&volumeAjust.out);
+    }
+    driftBuffer.setBypass(!enabled);
+}
+
+bool SinkManager::Stream::getDriftCompensation() {
+    std::lock_guard<std::mutex> lck(driftMtx);
+    return driftComp;
+}
+
+void SinkManager::Stream::setTargetLatency(double ms) {
+    std::lock_guard<std::mutex> lck(driftMtx);
+    targetLatency = ms;
+    driftBuffer.setLatency(targetLatency * DRIFT_BUFFER_RATIO);
+    driftBuffer.setPrefill(targetLatency);
+}
+
+double SinkManager::Stream::getTargetLatency() {
+    std::lock_guard<std::mutex> lck(driftMtx);
+    return targetLatency;
+}
+
+void SinkManager::Stream::getDriftStatus(double& latency, double& ppm) {
+    std::lock_guard<std::mutex> lck(driftMtx);
+    latency = filteredFill;
+    ppm = driftPpm;
+}
+
+void SinkManager::Stream::startDriftWorker() {
+    driftStop = false;
+    driftThread = std::thread(&SinkManager::Stream::driftWorker, this);
+}
+
+void SinkManager::Stream::stopDriftWorker() {
+    {
+        std::lock_guard<std::mutex> lck(driftMtx);
+        driftStop = true;
+    }
+    driftCnd.notify_all();
+    if (driftThread.joinable()) { driftThread.join(); }
+}
+
+void SinkManager::Stream::driftWorker() {
+    std::unique_lock<std::mutex> lck(driftMtx);
+    while (!driftCnd.wait_for(lck, std::chrono::milliseconds(DRIFT_UPDATE_PERIOD), [this]() { return driftStop; })) {
+        // Smooth out the fill variations due to the block size
+        double fill = driftBuffer.getFill();
+        filteredFill += (fill - filteredFill) * DRIFT_FILL_ALPHA;
+        if (!driftComp) { continue; }
+
+        // PI loop on the buffer fill, the integral converges to the clock drift
+        double dt = (double)DRIFT_UPDATE_PERIOD / 1000.0;
+        double error = (targetLatency - filteredFill) / 1000.0;
+        driftIntegral = std::clamp<double>(driftIntegral + error * dt * DRIFT_KI, -DRIFT_MAX_CORRECTION, DRIFT_MAX_CORRECTION);
+        double correction = std::clamp<double>(error * DRIFT_KP + driftIntegral, -DRIFT_MAX_CORRECTION, DRIFT_MAX_CORRECTION);
+
+        // A change of target latency would otherwise jump the ratio all at once
+        driftCorrection = std::clamp<double>(correction, driftCorrection - DRIFT_MAX_SLEW, driftCorrection + DRIFT_MAX_SLEW);
+        driftPpm = driftIntegral * 1e6;
+        driftResamp.setFineRatio(1.0 + driftCorrection);
+    }
+}
+
 void SinkManager::registerSinkProvider(std::string name, SinkProvider provider) {
     if (providers.find(name) != providers.end()) {
         flog::error("Cannot register sink provider '{0}', this name is already taken", name);
@@ -322,6 +418,8 @@ void SinkManager::loadStreamConfig(std::string name) {
     }
     stream->setVolume(conf["volume"]);
     stream->volumeAjust.setMuted(conf["muted"]);
+    if (conf.contains("driftComp")) { stream->setDriftCompensation(conf["driftComp"]); }
+    if (conf.contains("targetLatency")) { stream->setTargetLatency(conf["targetLatency"]); }
 }
 
 void SinkManager::saveStreamConfig(std::string name) {
@@ -330,6 +428,8 @@ void SinkManager::saveStreamConfig(std::string name) {
     conf["sink"] = providerNames[stream->providerId];
     conf["volume"] = stream->getVolume();
     conf["muted"] = stream->volumeAjust.getMuted();
+    conf["driftComp"] = stream->getDriftCompensation();
+    conf["targetLatency"] = stream->getTargetLatency();
     core::configManager.conf["streams"][name] = conf;
 }
 
@@ -368,6 +468,28 @@ void SinkManager::showMenu() {
 
         showVolumeSlider(name, "##_sdrpp_sink_menu_vol_", menuWidth);
 
+        bool driftComp = stream->getDriftCompensation();
+        if (ImGui::Checkbox(CONCAT("Drift compensation##_sdrpp_sink_drift_", name), &driftComp)) {
+            stream->setDriftCompensation(driftComp);
+            core::configManager.acquire();
+            saveStreamConfig(name);
+            core::configManager.release(true);
+        }
+        if (driftComp) {
+            int latency = stream->getTargetLatency();
+            ImGui::LeftLabel("Latency (ms)");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputInt(CONCAT("##_sdrpp_sink_latency_", name), &latency, 10, 50)) {
+                stream->setTargetLatency(std::clamp<int>(latency, 10, 1000));
+                core::configManager.acquire();
+                saveStreamConfig(name);
+                core::configManager.release(true);
+            }
+            double curLatency, ppm;
+            stream->getDriftStatus(curLatency, ppm);
+            ImGui::Text("Buffered: %.1f ms, drift: %+.1f ppm", curLatency, ppm);
+        }
+
         count++;
         if (count < maxCount) {
             ImGui::Spacing();
@@ -6,7 +6,11 @@
 #include "../dsp/routing/splitter.h"
 #include "../dsp/audio/volume.h"
 #include "../dsp/sink/null_sink.h"
+#include "../dsp/multirate/arbitrary_resampler.h"
+#include "../dsp/buffer/jitter_buffer.h"
 #include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <utils/event.h>
 #include <vector>
 
@@ -40,6 +44,16 @@ public:
 
         void setInput(dsp::stream<dsp::stereo_t>* in);
 
+        // Keep the audio buffered ahead of the sink at a target latency by trimming the
+        // resampling ratio, which compensates the drift between the SDR and sink clocks
+        void setDriftCompensation(bool enabled);
+        bool getDriftCompensation();
+        void setTargetLatency(double ms);
+        double getTargetLatency();
+
+        // Current amount of audio buffered ahead of the sink in ms, and estimated clock drift in ppm
+        void getDriftStatus(double& latency, double& ppm);
+
         dsp::stream<dsp::stereo_t>* bindStream();
         void unbindStream(dsp::stream<dsp::stereo_t>* stream);
 
@@ -56,7 +70,31 @@ public:
         SinkManager::Sink* sink;
         dsp::stream<dsp::stereo_t> volumeInput;
         dsp::audio::Volume volumeAjust;
+        dsp::multirate::ArbitraryResampler<dsp::stereo_t> driftResamp;
+        dsp::buffer::JitterBuffer<dsp::stereo_t> driftBuffer;
         std::mutex ctrlMtx;
+
+        void driftWorker();
+        void startDriftWorker();
+        void stopDriftWorker();
+        std::thread driftThread;
+        std::mutex driftMtx;
+        std::condition_variable driftCnd;
+        bool driftStop = false;
+        bool driftComp = false;
+        double targetLatency = 50.0;
+        double filteredFill = 0.0;
+        double driftIntegral = 0.0;
+        double driftCorrection = 0.0;
+        double driftPpm = 0.0;
+
+        static constexpr double DRIFT_BUFFER_RATIO = 4.0;      // Capacity of the buffer relative to the target latency
+        static constexpr int DRIFT_UPDATE_PERIOD = 100;         // ms
+        static constexpr double DRIFT_FILL_ALPHA = 0.05;
+        static constexpr double DRIFT_KP = 0.1;                 // Corrects a latency error over about 10s
+        static constexpr double DRIFT_KI = 0.002;
+        static constexpr double DRIFT_MAX_CORRECTION = 0.002;   // 2000 ppm
+        static constexpr double DRIFT_MAX_SLEW = 0.00002;       // 20 ppm per update
         float _sampleRate;
         int providerId = 0;
         std::string providerName = "";
@@ -39,6 +39,10 @@ std::vector<std::string> SourceManager::getSourceNames() {
     return names;
 }
 
+std::string SourceManager::getSelectedName() {
+    return selectedName;
+}
+
 void SourceManager::selectSource(std::string name) {
     if (sources.find(name) == sources.end()) {
         flog::error("Tried to select non existent source: {0}", name);
@@ -50,13 +54,31 @@ void SourceManager::selectSource(std::string name) {
     selectedHandler = sources[name];
     selectedHandler->selectHandler(selectedHandler->ctx);
     selectedName = name;
+    if (!core::args["server"].b()) {
+        sigpath::iqFrontEnd.setBufferLatency(selectedHandler->bufferLatency);
+        sigpath::iqFrontEnd.setBufferPolicy(selectedHandler->bufferPolicy);
+        sigpath::iqFrontEnd.resetBufferCounters();
+    }
+    updateInput();
+}
+
+void SourceManager::updateInput() {
+    if (selectedHandler == NULL) {
+        return;
+    }
     if (core::args["server"].b()) {
+        // The server only forwards float IQ
+        selectedHandler->useStream16 = false;
         server::setInput(selectedHandler->stream);
+        return;
+    }
+    selectedHandler->useStream16 = fixedPointInput && selectedHandler->stream16;
+    if (selectedHandler->useStream16) {
+        sigpath::iqFrontEnd.setInput16(selectedHandler->stream16);
     }
     else {
         sigpath::iqFrontEnd.setInput(selectedHandler->stream);
     }
-    // Set server input here
 }
 
 void SourceManager::showSelectedMenu() {
@@ -103,4 +125,52 @@ void SourceManager::setTuningMode(TuningMode mode) {
 void SourceManager::setPanadapterIF(double freq) {
     ifFreq = freq;
     tune(currentFreq);
+}
+
+double SourceManager::getRetuneLatency() {
+    if (selectedHandler == NULL) {
+        return 0.0;
+    }
+    return selectedHandler->retuneLatency;
+}
+
+double SourceManager::getBufferLatency() {
+    if (selectedHandler == NULL) {
+        return 0.0;
+    }
+    return selectedHandler->bufferLatency;
+}
+
+dsp::buffer::OverflowPolicy SourceManager::getBufferPolicy() {
+    if (selectedHandler == NULL) {
+        return dsp::buffer::OVERFLOW_DROP_OLDEST;
+    }
+    return selectedHandler->bufferPolicy;
+}
+
+void SourceManager::setFixedPointInput(bool enabled) {
+    fixedPointInput = enabled;
+    updateInput();
+}
+
+bool SourceManager::isFixedPointInput() {
+    return selectedHandler != NULL && selectedHandler->useStream16;
+}
+
+dsp::buffer::CaptureRingBase* SourceManager::getCaptureRing() {
+    if (selectedHandler == NULL) {
+        return NULL;
+    }
+    if (selectedHandler->useStream16) {
+        return selectedHandler->captureRing16;
+    }
+    return selectedHandler->captureRing;
+}
+
+void SourceManager::setCaptureZeroFill(bool zeroFill) {
+    if (selectedHandler == NULL) {
+        return;
+    }
+    if (selectedHandler->captureRing) { selectedHandler->captureRing->setZeroFill(zeroFill); }
+    if (selectedHandler->captureRing16) { selectedHandler->captureRing16->setZeroFill(zeroFill); }
 }
\ No newline at end of file
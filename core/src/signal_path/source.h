@@ -4,6 +4,8 @@
 #include <map>
 #include <dsp/stream.h>
 #include <dsp/types.h>
+#include <dsp/buffer/jitter_buffer.h>
+#include <dsp/buffer/capture_ring.h>
 #include <utils/event.h>
 
 class SourceManager {
@@ -19,6 +21,13 @@ public:
         void (*stopHandler)(void* ctx);
         void (*tuneHandler)(double freq, void* ctx);
         void* ctx;
+        double retuneLatency = 0.0; // Time in ms for the hardware to settle after a retune, 0 if unknown
+        double bufferLatency = 0.0; // Length in ms of the input buffer, 0 for the default
+        dsp::buffer::OverflowPolicy bufferPolicy = dsp::buffer::OVERFLOW_DROP_OLDEST;
+        dsp::buffer::CaptureRing<dsp::complex_t>* captureRing = NULL; // Ring fed by the device callback, if the source uses one
+        dsp::buffer::CaptureRing<dsp::complex16_t>* captureRing16 = NULL; // Ring feeding stream16, if the source uses one
+        dsp::stream<dsp::complex16_t>* stream16 = NULL; // 16bit IQ for the fixed point front-end, if the source can provide it
+        bool useStream16 = false; // Set by the source manager, the source must then write to stream16 instead of stream
     };
 
     enum TuningMode {
@@ -36,8 +45,22 @@ public:
     void setTuningOffset(double offset);
     void setTuningMode(TuningMode mode);
     void setPanadapterIF(double freq);
+    double getRetuneLatency();
+    double getBufferLatency();
+    dsp::buffer::OverflowPolicy getBufferPolicy();
+
+    // Ring of the stream currently feeding the front-end, NULL if the source doesn't capture through one
+    dsp::buffer::CaptureRingBase* getCaptureRing();
+
+    // Applied to both the float and the 16bit ring so that it survives switching the front-end
+    void setCaptureZeroFill(bool zeroFill);
+
+    // Feed 16bit IQ to the front-end for sources that support it, only change while the source is stopped
+    void setFixedPointInput(bool enabled);
+    bool isFixedPointInput();
 
     std::vector<std::string> getSourceNames();
+    std::string getSelectedName();
 
     Event<std::string> onSourceRegistered;
     Event<std::string> onSourceUnregister;
@@ -45,6 +68,8 @@ public:
     Event<double> onRetune;
 
 private:
+    void updateInput();
+
     std::map<std::string, SourceHandler*> sources;
     std::string selectedName;
     SourceHandler* selectedHandler = NULL;
@@ -52,5 +77,6 @@ private:
     double currentFreq;
     double ifFreq = 0.0;
     TuningMode tuneMode = TuningMode::NORMAL;
+    bool fixedPointInput = false;
     dsp::stream<dsp::complex_t> nullSource;
 };
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "sweeper.h"
+#include <signal_path/signal_path.h>
+#include <utils/flog.h>
+#include <math.h>
+
+Sweeper::~Sweeper() {
+    stop();
+}
+
+void Sweeper::start(double startFreq, double stopFreq) {
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (running) { return; }
+        _startFreq = std::min<double>(startFreq, stopFreq);
+        _stopFreq = std::max<double>(startFreq, stopFreq);
+        hops.clear();
+        planCount = 0;
+        planSampleRate = 0.0;
+        currentHop = 0;
+        state = STATE_TUNING;
+        running = true;
+    }
+    spectrumHandlerId = sigpath::iqFrontEnd.onSpectrum.bind(&Sweeper::spectrumHandler, this);
+    workerThread = std::thread(&Sweeper::worker, this);
+}
+
+void Sweeper::stop() {
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!running) { return; }
+        running = false;
+    }
+    cnd.notify_all();
+    sigpath::iqFrontEnd.onSpectrum.unbind(spectrumHandlerId);
+    if (workerThread.joinable()) { workerThread.join(); }
+}
+
+bool Sweeper::isRunning() {
+    std::lock_guard<std::mutex> lck(mtx);
+    return running;
+}
+
+void Sweeper::setUsableRatio(double ratio) {
+    std::lock_guard<std::mutex> lck(mtx);
+    _usableRatio = std::clamp<double>(ratio, 0.1, 1.0);
+
+    // Force a new hop plan
+    planCount = 0;
+}
+
+void Sweeper::setAveraging(int count) {
+    std::lock_guard<std::mutex> lck(mtx);
+    _averaging = std::max<int>(count, 1);
+}
+
+void Sweeper::setSettleTime(double ms) {
+    std::lock_guard<std::mutex> lck(mtx);
+    _settleTime = std::max<double>(ms, 0.0);
+}
+
+double Sweeper::getSweepTime() {
+    std::lock_guard<std::mutex> lck(mtx);
+    return lastSweepTime;
+}
+
+void Sweeper::spectrumHandler(const float* data, int count, double sampleRate) {
+    auto now = std::chrono::high_resolution_clock::now();
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (!running) { return; }
+
+        // Plan the hops again if the FFT size or samplerate changed
+        if (count != planCount || sampleRate != planSampleRate) {
+            plan(count, sampleRate);
+            lck.unlock();
+            cnd.notify_all();
+            return;
+        }
+
+        // Nothing to do while the worker is retuning
+        if (state == STATE_TUNING) { return; }
+
+        // Discard everything until the source has settled
+        if (state == STATE_SETTLING) {
+            double settle = std::max<double>(_settleTime, sigpath::sourceManager.getRetuneLatency());
+            double elapsed = (std::chrono::duration_cast<std::chrono::microseconds>(now - tuneTime)).count() / 1000.0;
+            if (elapsed < settle) { return; }
+
+            // The first spectrum after the settling time may still contain samples from before it, drop it too
+            std::fill(accum.begin(), accum.end(), 0.0f);
+            collected = 0;
+            state = STATE_COLLECTING;
+            return;
+        }
+
+        // Accumulate the usable part of the spectrum in linear power
+        int first = (count - usableBins) / 2;
+        for (int i = 0; i < usableBins; i++) {
+            accum[i] += powf(10.0f, data[first + i] / 10.0f);
+        }
+        if (++collected < _averaging) { return; }
+
+        // Place the averaged hop in the stitched spectrum
+        double hopStart = hops[currentHop] - (sampleRate / 2.0) + ((double)first * binWidth);
+        int offset = (int)round((hopStart - _startFreq) / binWidth);
+        for (int i = 0; i < usableBins; i++) {
+            int id = offset + i;
+            if (id < 0 || id >= (int)stitched.size()) { continue; }
+            stitched[id] = 10.0f * log10f(accum[i] / (float)collected);
+        }
+
+        // Go to the next hop
+        state = STATE_TUNING;
+        if (++currentHop < (int)hops.size()) {
+            lck.unlock();
+            cnd.notify_all();
+            return;
+        }
+
+        currentHop = 0;
+        lastSweepTime = (std::chrono::duration_cast<std::chrono::microseconds>(now - sweepStartTime)).count() / 1e6;
+        sweepStartTime = now;
+    }
+    cnd.notify_all();
+
+    // Only the FFT thread touches the stitched buffer, so it's safe to publish it without the lock
+    onSweep(stitched.data(), stitched.size(), _startFreq, binWidth);
+}
+
+void Sweeper::worker() {
+    while (true) {
+        double freq;
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            cnd.wait(lck, [this] { return (state == STATE_TUNING && !hops.empty()) || !running; });
+            if (!running) { return; }
+            freq = hops[currentHop];
+        }
+
+        // Retune and drop anything that was buffered at the previous frequency
+        sigpath::sourceManager.tune(freq);
+        sigpath::iqFrontEnd.flushInputBuffer();
+
+        {
+            // If the hops were planned again in the meantime, the retune must be redone
+            std::lock_guard<std::mutex> lck(mtx);
+            if (state != STATE_TUNING || hops.empty() || hops[currentHop] != freq) { continue; }
+            tuneTime = std::chrono::high_resolution_clock::now();
+            state = STATE_SETTLING;
+        }
+    }
+}
+
+void Sweeper::plan(int count, double sampleRate) {
+    planCount = count;
+    planSampleRate = sampleRate;
+    binWidth = sampleRate / (double)count;
+    usableBins = std::clamp<int>(round((double)count * _usableRatio), 1, count);
+
+    // Step by the usable bandwidth so that the hops are contiguous
+    double usableBw = (double)usableBins * binWidth;
+    hops.clear();
+    for (double f = _startFreq + (usableBw / 2.0); f - (usableBw / 2.0) < _stopFreq; f += usableBw) {
+        hops.push_back(f);
+    }
+
+    accum.resize(usableBins);
+    stitched.assign(std::max<int>(ceil((_stopFreq - _startFreq) / binWidth), 1), -200.0f);
+    currentHop = 0;
+    state = STATE_TUNING;
+    sweepStartTime = std::chrono::high_resolution_clock::now();
+
+    flog::info("[Sweeper] Sweeping {0} to {1} in {2} hops of {3} bins", _startFreq, _stopFreq, hops.size(), usableBins);
+}
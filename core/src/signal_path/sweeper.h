@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <utils/new_event.h>
+
+// Hops the selected source across a frequency range wider than its bandwidth and
+// stitches the spectra of each hop into a single wide spectrum (like rtl_power or hackrf_sweep)
+class Sweeper {
+public:
+    ~Sweeper();
+
+    void start(double startFreq, double stopFreq);
+    void stop();
+    bool isRunning();
+
+    // Fraction of the source bandwidth kept from each hop, the edges are discarded because of filter roll-off
+    void setUsableRatio(double ratio);
+
+    // Number of spectra averaged at each hop
+    void setAveraging(int count);
+
+    // Minimum time to wait after a retune, the source's own retune latency is used if greater
+    void setSettleTime(double ms);
+
+    // Time taken by the last complete sweep in seconds
+    double getSweepTime();
+
+    // Emitted from the FFT thread with the stitched spectrum (dB), its bin count, start frequency and bin width
+    NewEvent<const float*, int, double, double> onSweep;
+
+private:
+    void spectrumHandler(const float* data, int count, double sampleRate);
+    void worker();
+    void plan(int count, double sampleRate);
+
+    enum State {
+        STATE_TUNING,
+        STATE_SETTLING,
+        STATE_COLLECTING
+    };
+
+    double _startFreq;
+    double _stopFreq;
+    double _usableRatio = 0.75;
+    int _averaging = 2;
+    double _settleTime = 10.0;
+
+    // Hop plan
+    std::vector<double> hops;
+    int planCount = 0;
+    double planSampleRate = 0.0;
+    double binWidth;
+    int usableBins;
+    int currentHop = 0;
+
+    // Stitching
+    std::vector<float> accum;
+    std::vector<float> stitched;
+    int collected = 0;
+
+    State state = STATE_TUNING;
+    std::chrono::time_point<std::chrono::high_resolution_clock> tuneTime;
+    std::chrono::time_point<std::chrono::high_resolution_clock> sweepStartTime;
+    double lastSweepTime = 0.0;
+
+    HandlerID spectrumHandlerId;
+    std::thread workerThread;
+    std::mutex mtx;
+    std::condition_variable cnd;
+    bool running = false;
+
+};
@@ -30,6 +30,7 @@ VFOManager::VFO::~VFO() {
 void VFOManager::VFO::setOffset(double offset) {
     wtfVFO->setOffset(offset);
     dspVFO->setOffset(wtfVFO->centerOffset);
+    sigpath::vfoManager.onVfoOffsetChanged.emit(this);
 }
 
 double VFOManager::VFO::getOffset() {
@@ -39,6 +40,7 @@ double VFOManager::VFO::getOffset() {
 void VFOManager::VFO::setCenterOffset(double offset) {
     wtfVFO->setCenterOffset(offset);
     dspVFO->setOffset(offset);
+    sigpath::vfoManager.onVfoOffsetChanged.emit(this);
 }
 
 void VFOManager::VFO::setBandwidth(double bandwidth, bool updateWaterfall) {
@@ -200,11 +202,18 @@ bool VFOManager::vfoExists(std::string name) {
     return (vfos.find(name) != vfos.end());
 }
 
+std::vector<std::string> VFOManager::getVFONames() {
+    std::vector<std::string> names;
+    for (auto const& [name, vfo] : vfos) { names.push_back(name); }
+    return names;
+}
+
 void VFOManager::updateFromWaterfall(ImGui::WaterFall* wtf) {
     for (auto const& [name, vfo] : vfos) {
         if (vfo->wtfVFO->centerOffsetChanged) {
             vfo->wtfVFO->centerOffsetChanged = false;
             vfo->dspVFO->setOffset(vfo->wtfVFO->centerOffset);
+            onVfoOffsetChanged.emit(vfo);
         }
     }
 }
\ No newline at end of file
@@ -55,6 +55,7 @@ public:
     std::string getName();
     int getReference(std::string name);
     bool vfoExists(std::string name);
+    std::vector<std::string> getVFONames();
 
     void updateFromWaterfall(ImGui::WaterFall* wtf);
 
@@ -62,6 +63,9 @@ public:
     Event<VFOManager::VFO*> onVfoDelete;
     Event<std::string> onVfoDeleted;
 
+    // Emitted when a VFO moves, whether from code or by the user on the waterfall
+    Event<VFOManager::VFO*> onVfoOffsetChanged;
+
 private:
     std::map<std::string, VFO*> vfos;
 };
\ No newline at end of file
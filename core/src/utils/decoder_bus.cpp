@@ -0,0 +1,154 @@
+#include <utils/decoder_bus.h>
+#include <chrono>
+#include <algorithm>
+#include <math.h>
+
+void DecoderRecord::setRaw(const uint8_t* data, int bits) {
+    raw.assign(data, data + ((bits + 7) / 8));
+    rawBits = bits;
+}
+
+std::string DecoderRecord::rawHex() const {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    std::string hex;
+    hex.reserve(raw.size() * 2);
+    for (uint8_t b : raw) {
+        hex += HEX_DIGITS[b >> 4];
+        hex += HEX_DIGITS[b & 0xF];
+    }
+    return hex;
+}
+
+json DecoderRecord::toJSON() const {
+    json rec;
+    rec["time"] = round(time * 1000.0) / 1000.0;
+    rec["decoder"] = decoder;
+    rec["source"] = source;
+    rec["frequency"] = frequency;
+    rec["fields"] = fields;
+    if (rawBits) {
+        rec["raw"] = rawHex();
+        rec["rawBits"] = rawBits;
+    }
+    return rec;
+}
+
+DecoderBus::DecoderBus() {
+    cells = new Cell[DECODER_BUS_QUEUE_SIZE];
+    for (uint32_t i = 0; i < DECODER_BUS_QUEUE_SIZE; i++) {
+        cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+DecoderBus::~DecoderBus() {
+    stop();
+    delete[] cells;
+}
+
+void DecoderBus::start() {
+    std::lock_guard<std::mutex> lck(workerMtx);
+    if (running) { return; }
+    stopWorker = false;
+    workerThread = std::thread(&DecoderBus::worker, this);
+    running = true;
+}
+
+void DecoderBus::stop() {
+    {
+        std::lock_guard<std::mutex> lck(workerMtx);
+        if (!running) { return; }
+        stopWorker = true;
+    }
+    workerCnd.notify_all();
+    if (workerThread.joinable()) { workerThread.join(); }
+    running = false;
+}
+
+bool DecoderBus::publish(DecoderRecord&& record) {
+    // Claim a cell, the write index only moves forward once the cell at it has been read
+    uint32_t pos = writeIdx.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells[pos & (DECODER_BUS_QUEUE_SIZE - 1)];
+        int32_t diff = (int32_t)(cell->seq.load(std::memory_order_acquire) - pos);
+        if (!diff) {
+            if (writeIdx.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+        }
+        else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            pos = writeIdx.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Hand the cell to the worker
+    cell->record = std::move(record);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    published.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool DecoderBus::publish(const std::string& decoder, const std::string& source, double frequency, json fields, const uint8_t* raw, int rawBits) {
+    DecoderRecord record;
+    record.time = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    record.frequency = frequency;
+    record.decoder = decoder;
+    record.source = source;
+    record.fields = std::move(fields);
+    if (raw) { record.setRaw(raw, rawBits); }
+    return publish(std::move(record));
+}
+
+void DecoderBus::addSink(Sink* sink) {
+    std::lock_guard<std::mutex> lck(sinkMtx);
+    sinks.push_back(sink);
+}
+
+void DecoderBus::removeSink(Sink* sink) {
+    std::lock_guard<std::mutex> lck(sinkMtx);
+    sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+}
+
+void DecoderBus::getCounters(uint64_t& published, uint64_t& dropped) {
+    published = this->published.load(std::memory_order_relaxed);
+    dropped = this->dropped.load(std::memory_order_relaxed);
+}
+
+bool DecoderBus::pop(DecoderRecord& record) {
+    // Only the worker reads so the read index needs no synchronisation
+    Cell* cell = &cells[readIdx & (DECODER_BUS_QUEUE_SIZE - 1)];
+    if (cell->seq.load(std::memory_order_acquire) != readIdx + 1) { return false; }
+    record = std::move(cell->record);
+    cell->seq.store(readIdx + DECODER_BUS_QUEUE_SIZE, std::memory_order_release);
+    readIdx++;
+    return true;
+}
+
+void DecoderBus::worker() {
+    std::vector<DecoderRecord> batch;
+    while (true) {
+        // Publishers never wake the worker, it collects whatever came in during the interval
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lck(workerMtx);
+            workerCnd.wait_for(lck, std::chrono::milliseconds(DECODER_BUS_BATCH_INTERVAL), [=]() { return stopWorker; });
+            stopping = stopWorker;
+        }
+
+        batch.clear();
+        DecoderRecord record;
+        while (pop(record)) { batch.push_back(std::move(record)); }
+
+        {
+            std::lock_guard<std::mutex> lck(sinkMtx);
+            for (auto& sink : sinks) {
+                if (!batch.empty()) { sink->write(batch); }
+                sink->poll();
+            }
+        }
+
+        if (stopping) { break; }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <json.hpp>
+
+using nlohmann::json;
+
+// Records waiting to be written, must be a power of two
+#define DECODER_BUS_QUEUE_SIZE      4096
+
+// Time the sinks are given to accumulate records before being written to
+#define DECODER_BUS_BATCH_INTERVAL  100
+
+// Something decoded, as published by a decoder
+struct DecoderRecord {
+    double time = 0.0;          // Unix time in seconds
+    double frequency = 0.0;     // Hz
+    std::string decoder;        // Type of decoder, ex: "pocsag"
+    std::string source;         // Name of the module instance
+    json fields = json::object();
+    std::vector<uint8_t> raw;   // Raw bits, packed MSB first
+    int rawBits = 0;
+
+    void setRaw(const uint8_t* data, int bits);
+    std::string rawHex() const;
+    json toJSON() const;
+};
+
+// Collects the records of every decoder and hands them to the sinks in batches. Decoders publish from
+// their DSP thread without taking a lock, the sinks are only ever called from the bus' own thread so
+// that file and network I/O can't hold the DSP.
+class DecoderBus {
+public:
+    class Sink {
+    public:
+        virtual ~Sink() {}
+
+        // Records published since the last batch, oldest first
+        virtual void write(const std::vector<DecoderRecord>& records) = 0;
+
+        // Called once per batch interval even if there are no records
+        virtual void poll() {}
+    };
+
+    DecoderBus();
+    ~DecoderBus();
+
+    void start();
+    void stop();
+
+    // Can be called from any thread. Returns false if the queue is full, the record is then dropped.
+    bool publish(DecoderRecord&& record);
+
+    // Stamps the record with the current time. Move the fields in unless they're still needed, to avoid copying them.
+    bool publish(const std::string& decoder, const std::string& source, double frequency, json fields, const uint8_t* raw = NULL, int rawBits = 0);
+
+    // Sinks aren't used anymore once removed
+    void addSink(Sink* sink);
+    void removeSink(Sink* sink);
+
+    void getCounters(uint64_t& published, uint64_t& dropped);
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> seq;
+        DecoderRecord record;
+    };
+
+    bool pop(DecoderRecord& record);
+    void worker();
+
+    // Multi-producer queue, each cell's sequence number says whether it's free or holds a record
+    Cell* cells;
+    std::atomic<uint32_t> writeIdx { 0 };
+    uint32_t readIdx = 0;
+
+    std::atomic<uint64_t> published { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+
+    std::mutex sinkMtx;
+    std::vector<Sink*> sinks;
+
+    std::thread workerThread;
+    std::mutex workerMtx;
+    std::condition_variable workerCnd;
+    bool running = false;
+    bool stopWorker = false;
+};
@@ -0,0 +1,316 @@
+#include <utils/decoder_sinks.h>
+#include <utils/flog.h>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <sys/un.h>
+#include <signal.h>
+#include <errno.h>
+#endif
+
+namespace {
+    std::string formatUTC(double time) {
+        time_t t = (time_t)time;
+        tm utc;
+#ifdef _WIN32
+        gmtime_s(&utc, &t);
+#else
+        gmtime_r(&t, &utc);
+#endif
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                 utc.tm_hour, utc.tm_min, utc.tm_sec, std::min<int>((time - floor(time)) * 1000.0, 999));
+        return buf;
+    }
+
+    // Quotes doubled inside a quoted field
+    std::string csvField(const std::string& str) {
+        std::string out = "\"";
+        for (char c : str) {
+            if (c == '"') { out += '"'; }
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    std::string formatRecord(const DecoderRecord& rec, RecordFileSink::Format format) {
+        if (format == RecordFileSink::FORMAT_JSONL) {
+            json obj = rec.toJSON();
+            obj["utc"] = formatUTC(rec.time);
+            return obj.dump() + "\n";
+        }
+
+        // The fields differ from decoder to decoder, they're kept as a single JSON column
+        char freqStr[64];
+        snprintf(freqStr, sizeof(freqStr), "%.0lf", rec.frequency);
+        return formatUTC(rec.time) + "," + csvField(rec.decoder) + "," + csvField(rec.source) + "," + freqStr + "," +
+               csvField(rec.fields.dump()) + "," + rec.rawHex() + "\n";
+    }
+}
+
+// ======== File sink ========
+
+RecordFileSink::RecordFileSink(const std::string& dir, Format format, uint64_t maxSize, int maxFiles) {
+    this->dir = dir;
+    this->format = format;
+    this->maxSize = maxSize;
+    this->maxFiles = maxFiles;
+}
+
+RecordFileSink::~RecordFileSink() {
+    if (file.is_open()) { file.close(); }
+}
+
+void RecordFileSink::write(const std::vector<DecoderRecord>& records) {
+    for (const auto& rec : records) {
+        if (!file.is_open() || (maxSize && size >= maxSize)) { rotate(); }
+        if (!file.is_open()) { return; }
+        std::string line = formatRecord(rec, format);
+        file << line;
+        size += line.size();
+    }
+    file.flush();
+}
+
+std::string RecordFileSink::getPath() {
+    std::lock_guard<std::mutex> lck(pathMtx);
+    return path;
+}
+
+void RecordFileSink::rotate() {
+    if (file.is_open()) { file.close(); }
+
+    // Named after the time it was started, same as the recorder
+    time_t now = time(0);
+    tm* ltm = localtime(&now);
+    char name[128];
+    sprintf(name, "decoders_%02d-%02d-%02d_%02d-%02d-%02d", ltm->tm_hour, ltm->tm_min, ltm->tm_sec, ltm->tm_mday, ltm->tm_mon + 1, ltm->tm_year + 1900);
+    std::string ext = (format == FORMAT_JSONL) ? ".jsonl" : ".csv";
+    std::string newPath = dir + "/" + name + ext;
+    for (int i = 1; std::filesystem::exists(newPath); i++) {
+        newPath = dir + "/" + name + "_" + std::to_string(i) + ext;
+    }
+
+    file = std::ofstream(newPath, std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        flog::error("Could not create decoder output file: {0}", newPath);
+        return;
+    }
+    if (format == FORMAT_CSV) {
+        std::string header = "utc,decoder,source,frequency,fields,raw\n";
+        file << header;
+        size = header.size();
+    }
+    else {
+        size = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lck(pathMtx);
+        path = newPath;
+    }
+
+    removeOld();
+}
+
+void RecordFileSink::removeOld() {
+    if (!maxFiles) { return; }
+
+    // Only this sink's files of the same format are candidates
+    std::string ext = (format == FORMAT_JSONL) ? ".jsonl" : ".csv";
+    std::vector<std::filesystem::directory_entry> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (!entry.is_regular_file() || name.rfind("decoders_", 0) || entry.path().extension() != ext) { continue; }
+        files.push_back(entry);
+    }
+    if (files.size() <= (size_t)maxFiles) { return; }
+
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.last_write_time() < b.last_write_time(); });
+    for (size_t i = 0; i < files.size() - maxFiles; i++) {
+        std::filesystem::remove(files[i].path(), ec);
+    }
+}
+
+// ======== Socket sink ========
+
+RecordSocketSink::RecordSocketSink(Type type, const std::string& host, int port, const std::string& path) {
+    this->type = type;
+
+#ifndef _WIN32
+    // Don't close when a client disconnects
+    if (type != TYPE_UDP) { signal(SIGPIPE, SIG_IGN); }
+#endif
+
+    if (type == TYPE_UDP) {
+        udp = net::openudp(host, port);
+    }
+    else if (type == TYPE_TCP) {
+        listener = net::listen(host, port);
+    }
+    else {
+#ifdef _WIN32
+        throw std::runtime_error("Unix sockets aren't supported on Windows");
+#else
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) { throw std::runtime_error("Invalid socket path"); }
+        strcpy(addr.sun_path, path.c_str());
+
+        // A socket file left by a previous run would prevent binding
+        unlink(path.c_str());
+        unixListener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (unixListener < 0) { throw std::runtime_error("Could not create socket"); }
+        if (bind(unixListener, (sockaddr*)&addr, sizeof(addr)) || listen(unixListener, 4)) {
+            close(unixListener);
+            throw std::runtime_error("Could not listen on " + path);
+        }
+        fcntl(unixListener, F_SETFL, fcntl(unixListener, F_GETFL) | O_NONBLOCK);
+        unixPath = path;
+#endif
+    }
+}
+
+RecordSocketSink::~RecordSocketSink() {
+    if (udp) { udp->close(); }
+    if (listener) { listener->stop(); }
+    for (auto& client : clients) { closeClient(client); }
+#ifndef _WIN32
+    if (unixListener >= 0) {
+        close(unixListener);
+        unlink(unixPath.c_str());
+    }
+#endif
+}
+
+void RecordSocketSink::write(const std::vector<DecoderRecord>& records) {
+    // One datagram per record
+    if (type == TYPE_UDP) {
+        if (!udp->isOpen()) { return; }
+        for (const auto& rec : records) {
+            udp->sendstr(rec.toJSON().dump() + "\n");
+        }
+        return;
+    }
+
+    std::string lines;
+    for (const auto& rec : records) { lines += rec.toJSON().dump() + "\n"; }
+
+    // A client that stops reading is let go once too far behind instead of holding up the other sinks
+    for (auto& client : clients) {
+        client.pending += lines;
+        if (client.pending.size() > RECORD_SOCKET_MAX_BACKLOG) {
+            flog::warn("Decoder feed client too slow, disconnecting");
+            closeClient(client);
+        }
+    }
+}
+
+void RecordSocketSink::poll() {
+    // Take the clients that connected since the last batch
+    if (listener) {
+        while (true) {
+            auto sock = listener->accept(NULL, net::NONBLOCKING);
+            if (!sock) { break; }
+            Client client;
+            client.sock = sock;
+            clients.push_back(client);
+        }
+    }
+
+#ifndef _WIN32
+    if (unixListener >= 0) {
+        while (true) {
+            int fd = accept(unixListener, NULL, NULL);
+            if (fd < 0) { break; }
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            Client client;
+            client.fd = fd;
+            clients.push_back(client);
+        }
+    }
+#endif
+
+    for (auto& client : clients) {
+        if (!flush(client)) { closeClient(client); }
+    }
+    clients.erase(std::remove_if(clients.begin(), clients.end(), [](const Client& c) { return !c.sock && c.fd < 0; }), clients.end());
+    clientCount = clients.size();
+}
+
+int RecordSocketSink::getClientCount() {
+    return clientCount;
+}
+
+bool RecordSocketSink::flush(Client& client) {
+    // Send as much as the socket takes without blocking, the rest waits for the next batch
+    size_t sent = 0;
+    while (sent < client.pending.size()) {
+        int n;
+        if (client.sock) {
+            if (!client.sock->isOpen()) { return false; }
+            n = client.sock->send((const uint8_t*)client.pending.data() + sent, client.pending.size() - sent);
+        }
+        else if (client.fd >= 0) {
+#ifdef _WIN32
+            return false;
+#else
+            n = ::send(client.fd, client.pending.data() + sent, client.pending.size() - sent, 0);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) { return false; }
+#endif
+        }
+        else {
+            return false;
+        }
+        if (n <= 0) { break; }
+        sent += n;
+    }
+    client.pending.erase(0, sent);
+    return !client.sock || client.sock->isOpen();
+}
+
+void RecordSocketSink::closeClient(Client& client) {
+    if (client.sock) {
+        client.sock->close();
+        client.sock.reset();
+    }
+#ifndef _WIN32
+    if (client.fd >= 0) {
+        close(client.fd);
+        client.fd = -1;
+    }
+#endif
+    client.pending.clear();
+}
+
+// ======== Ring sink ========
+
+RecordRingSink::RecordRingSink(int size) {
+    this->size = size;
+}
+
+void RecordRingSink::write(const std::vector<DecoderRecord>& records) {
+    std::lock_guard<std::mutex> lck(mtx);
+    for (const auto& rec : records) {
+        ring.push_back(rec);
+        if (ring.size() > (size_t)size) { ring.pop_front(); }
+    }
+    seq += records.size();
+}
+
+uint64_t RecordRingSink::getRecords(std::vector<DecoderRecord>& records, uint64_t since) {
+    std::lock_guard<std::mutex> lck(mtx);
+    uint64_t newCount = std::min<uint64_t>(seq - std::min<uint64_t>(since, seq), ring.size());
+    records.insert(records.end(), ring.end() - newCount, ring.end());
+    return seq;
+}
+
+void RecordRingSink::clear() {
+    std::lock_guard<std::mutex> lck(mtx);
+    ring.clear();
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <utils/decoder_bus.h>
+#include <utils/net.h>
+#include <deque>
+#include <memory>
+#include <fstream>
+
+// Appends the records to files in a directory, a new file is started when the current one is full
+class RecordFileSink : public DecoderBus::Sink {
+public:
+    enum Format {
+        FORMAT_JSONL,
+        FORMAT_CSV
+    };
+
+    // maxSize is in bytes, maxFiles is the number of files kept in the directory, 0 for no limit
+    RecordFileSink(const std::string& dir, Format format, uint64_t maxSize, int maxFiles);
+    ~RecordFileSink();
+
+    void write(const std::vector<DecoderRecord>& records);
+
+    std::string getPath();
+
+private:
+    void rotate();
+    void removeOld();
+
+    std::string dir;
+    Format format;
+    uint64_t maxSize;
+    int maxFiles;
+
+    std::ofstream file;
+    std::string path;
+    uint64_t size = 0;
+    std::mutex pathMtx;
+};
+
+// Data a stream client can fall behind by before being disconnected
+#define RECORD_SOCKET_MAX_BACKLOG   (1 << 20)
+
+// Sends the records as JSON lines, as UDP datagrams or to every client of a TCP or Unix socket server
+class RecordSocketSink : public DecoderBus::Sink {
+public:
+    enum Type {
+        TYPE_UDP,
+        TYPE_TCP,
+        TYPE_UNIX
+    };
+
+    // Throws runtime_error if the socket can't be opened. The path is only used by Unix sockets.
+    RecordSocketSink(Type type, const std::string& host, int port, const std::string& path = "");
+    ~RecordSocketSink();
+
+    void write(const std::vector<DecoderRecord>& records);
+    void poll();
+
+    int getClientCount();
+
+private:
+    // Either a TCP socket or a Unix socket descriptor, both non-blocking
+    struct Client {
+        std::shared_ptr<net::Socket> sock;
+        int fd = -1;
+        std::string pending;
+    };
+
+    bool flush(Client& client);
+    void closeClient(Client& client);
+
+    Type type;
+    std::string unixPath;
+
+    std::shared_ptr<net::Socket> udp;
+    std::shared_ptr<net::Listener> listener;
+    std::vector<Client> clients;
+
+#ifndef _WIN32
+    int unixListener = -1;
+#endif
+
+    std::atomic<int> clientCount { 0 };
+};
+
+// Keeps the latest records in memory for the UI
+class RecordRingSink : public DecoderBus::Sink {
+public:
+    RecordRingSink(int size);
+
+    void write(const std::vector<DecoderRecord>& records);
+
+    // Appends the records newer than the sequence number given and returns the latest one
+    uint64_t getRecords(std::vector<DecoderRecord>& records, uint64_t since = 0);
+    void clear();
+
+private:
+    int size;
+    std::deque<DecoderRecord> ring;
+    uint64_t seq = 0;
+    std::mutex mtx;
+};
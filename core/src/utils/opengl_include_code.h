@@ -1,6 +1,9 @@
 #pragma once
 
-#if defined(_WIN32)
+#if defined(SDRPP_HEADLESS)
+// Headless builds don't link to OpenGL, nothing is ever drawn
+typedef unsigned int GLuint;
+#elif defined(_WIN32)
 #include <windows.h>
 #include <GL/gl.h>
 #elif defined(__APPLE__)
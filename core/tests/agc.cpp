@@ -0,0 +1,99 @@
+#include <dsp/loop/agc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Same gain law as the look-ahead AGC, with the window maximum found by scanning the whole window
+class ReferenceAGC {
+public:
+    ReferenceAGC(float setPoint, float attack, float decay, float maxGain, float maxOutputAmp, int lookAhead) {
+        this->setPoint = setPoint;
+        this->attack = attack;
+        this->decay = decay;
+        this->maxGain = maxGain;
+        this->maxOutputAmp = maxOutputAmp;
+        this->lookAhead = lookAhead;
+        amp = setPoint;
+        history.resize(lookAhead, 0.0f);
+    }
+
+    float process(float in) {
+        history.push_back(in);
+        float peak = 0.0f;
+        for (int i = history.size() - lookAhead - 1; i < (int)history.size(); i++) {
+            peak = std::max<float>(peak, fabsf(history[i]));
+        }
+
+        float delayed = history[history.size() - lookAhead - 1];
+        float inAmp = fabsf(delayed);
+        float gain;
+        if (inAmp != 0.0f) {
+            amp = (inAmp > amp) ? ((amp * (1.0f - attack)) + (inAmp * attack)) : ((amp * (1.0f - decay)) + (inAmp * decay));
+            gain = std::min<float>(setPoint / amp, maxGain);
+        }
+        else {
+            gain = 1.0f;
+        }
+        if (peak * gain > maxOutputAmp) {
+            amp = peak;
+            gain = std::min<float>(setPoint / amp, maxGain);
+        }
+        return delayed * gain;
+    }
+
+private:
+    float setPoint, attack, decay, maxGain, maxOutputAmp;
+    int lookAhead;
+    float amp;
+    std::vector<float> history;
+};
+
+// Runs the AGC on blocks of varying size and compares every output to the reference
+int test(const std::vector<float>& input, int lookAhead, const char* name) {
+    dsp::loop::AGC<float> agc;
+    agc.init(NULL, 1.0, 0.05, 0.001, 1e6, 10.0);
+    agc.setLookAhead(lookAhead);
+    ReferenceAGC ref(1.0, 0.05, 0.001, 1e6, 10.0, lookAhead);
+
+    std::vector<float> out(input.size());
+    int pos = 0;
+    for (int k = 0; pos < (int)input.size(); k++) {
+        int count = std::min<int>(input.size() - pos, 1 + (k * 37) % 97);
+        agc.process(count, (float*)&input[pos], &out[pos]);
+        pos += count;
+    }
+
+    int errors = 0;
+    for (int i = 0; i < (int)input.size(); i++) {
+        float expected = ref.process(input[i]);
+        if (fabsf(out[i] - expected) > 1e-5f * std::max<float>(1.0f, fabsf(expected))) {
+            if (!errors) { printf("%s: first mismatch at %d, got %f expected %f\n", name, i, out[i], expected); }
+            errors++;
+        }
+    }
+    printf("%s, look-ahead %d: %d/%d outputs differ\n", name, lookAhead, errors, (int)input.size());
+    return errors;
+}
+
+int main() {
+    const int count = 20000;
+    srand(1);
+
+    // Long decreasing runs are what fill the peak deque the most
+    std::vector<float> decreasing(count);
+    for (int i = 0; i < count; i++) { decreasing[i] = (float)(100 - (i % 100)) * ((i & 1) ? -0.1f : 0.1f); }
+
+    std::vector<float> noise(count);
+    for (int i = 0; i < count; i++) { noise[i] = ((float)rand() / (float)RAND_MAX - 0.5f) * ((i % 1000 < 50) ? 40.0f : 1.0f); }
+
+    std::vector<float> bursts(count, 0.0f);
+    for (int i = 0; i < count; i++) { if ((i % 500) < 20) { bursts[i] = 30.0f * sinf(0.3f * (float)i); } }
+
+    int errors = 0;
+    for (int lookAhead : { 1, 2, 7, 48, 480 }) {
+        errors += test(decreasing, lookAhead, "decreasing");
+        errors += test(noise, lookAhead, "noise");
+        errors += test(bursts, lookAhead, "bursts");
+    }
+    return errors ? 1 : 0;
+}
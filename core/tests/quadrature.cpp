@@ -0,0 +1,100 @@
+#include <dsp/demod/quadrature.h>
+#include <dsp/math/normalize_phase.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#define TEST_SAMPLES        100000
+#define BENCH_SAMPLES       (1 << 20)
+#define BENCH_ROUNDS        20
+
+// Largest error allowed on the phase step, in radians
+#define MAX_PHASE_ERROR     1e-4
+
+// Per-sample discriminator the block had before it used volk's atan2
+void scalarQuadrature(int count, dsp::complex_t* in, float* out, float& phase, float invDeviation) {
+    for (int i = 0; i < count; i++) {
+        float cphase = in[i].phase();
+        out[i] = dsp::math::normalizePhase(cphase - phase) * invDeviation;
+        phase = cphase;
+    }
+}
+
+// FM tone with a slowly varying amplitude, some steps close to +-pi and a few zero samples
+std::vector<dsp::complex_t> makeSignal(int count) {
+    std::vector<dsp::complex_t> sig(count);
+    double phase = 0.0;
+    for (int i = 0; i < count; i++) {
+        double step = 3.1 * sin(2.0 * M_PI * (double)i / 977.0);
+        phase = fmod(phase + step, 2.0 * M_PI);
+        float amp = (i % 5000 == 0) ? 0.0f : (float)(0.001 + fabs(sin((double)i / 3000.0)) * 10.0);
+        sig[i] = { amp * (float)cos(phase), amp * (float)sin(phase) };
+    }
+    return sig;
+}
+
+int main() {
+    const float deviation = 0.5f;
+    std::vector<dsp::complex_t> sig = makeSignal(TEST_SAMPLES);
+    std::vector<float> out(TEST_SAMPLES);
+
+    // Uneven blocks to check the sample kept between them
+    dsp::demod::Quadrature demod;
+    demod.init(NULL, deviation);
+    int pos = 0;
+    for (int k = 0; pos < TEST_SAMPLES; k++) {
+        int count = std::min<int>(TEST_SAMPLES - pos, 1 + (k * 389) % 3000);
+        demod.process(count, &sig[pos], &out[pos]);
+        pos += count;
+    }
+
+    // Compare to atan2f of the same product in double precision
+    double maxError = 0.0;
+    int maxErrorIdx = 0;
+    dsp::complex_t last = { 1.0f, 0.0f };
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        double re = (double)sig[i].re * last.re + (double)sig[i].im * last.im;
+        double im = (double)sig[i].im * last.re - (double)sig[i].re * last.im;
+        last = sig[i];
+
+        // The phase step is undefined next to a zero sample
+        if (re == 0.0 && im == 0.0) { continue; }
+        double expected = atan2(im, re);
+        double error = fabs((double)out[i] * deviation - expected);
+        error = std::min<double>(error, 2.0 * M_PI - error);
+        if (error > maxError) {
+            maxError = error;
+            maxErrorIdx = i;
+        }
+    }
+    printf("Maximum error against atan2: %g rad at sample %d\n", maxError, maxErrorIdx);
+
+    // Same comparison for the previous per-sample implementation, for reference only
+    std::vector<float> scalarOut(TEST_SAMPLES);
+    float phase = 0.0f;
+    scalarQuadrature(TEST_SAMPLES, sig.data(), scalarOut.data(), phase, 1.0f / deviation);
+    double scalarMaxDiff = 0.0;
+    for (int i = 1; i < TEST_SAMPLES; i++) {
+        if (sig[i].amplitude() == 0.0f || sig[i - 1].amplitude() == 0.0f) { continue; }
+        double diff = fabs((double)(scalarOut[i] - out[i]) * deviation);
+        scalarMaxDiff = std::max<double>(scalarMaxDiff, std::min<double>(diff, 2.0 * M_PI - diff));
+    }
+    printf("Maximum difference with the per-sample implementation: %g rad\n", scalarMaxDiff);
+
+    // Throughput of both
+    std::vector<dsp::complex_t> benchIn = makeSignal(BENCH_SAMPLES);
+    std::vector<float> benchOut(BENCH_SAMPLES);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < BENCH_ROUNDS; i++) { demod.process(BENCH_SAMPLES, benchIn.data(), benchOut.data()); }
+    double vecTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < BENCH_ROUNDS; i++) { scalarQuadrature(BENCH_SAMPLES, benchIn.data(), benchOut.data(), phase, 1.0f / deviation); }
+    double scalarTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    double total = (double)BENCH_SAMPLES * BENCH_ROUNDS / 1e6;
+    printf("Quadrature: %.1f MS/s, per-sample: %.1f MS/s\n", total / vecTime, total / scalarTime);
+
+    return (maxError <= MAX_PHASE_ERROR) ? 0 : 1;
+}
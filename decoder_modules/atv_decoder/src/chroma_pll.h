@@ -1,63 +1,80 @@
 #pragma once
+#include <algorithm>
 #include <dsp/loop/pll.h>
 #include "chrominance_filter.h"
 
+// Position of the burst in the line
 // TODO: Should be 60 but had to try something
-#define BURST_START (63+CHROMA_FIR_DELAY)
+#define BURST_START 63
 #define BURST_END   (BURST_START+28)
+#define BURST_SIZE  (BURST_END-BURST_START)
 
 #define A_PHASE     ((135.0/180.0)*FL_M_PI)
 #define B_PHASE     ((-135.0/180.0)*FL_M_PI)
 
 namespace dsp::loop {
+    // Carrier of a line, the burst corrects it part way through
+    struct ChromaCarrier {
+        // From the start of the line to the end of the burst
+        float startPhase;
+        float startFreq;
+
+        // From the end of the burst to the end of the line
+        float phase;
+        float freq;
+    };
+
     class ChromaPLL : public PLL {
         using base_type = PLL;
     public:
         ChromaPLL() {}
 
         ChromaPLL(stream<complex_t>* in, double bandwidth, double initPhase = 0.0, double initFreq = 0.0, double minFreq = -FL_M_PI, double maxFreq = FL_M_PI) {
-            base_type::init(in, bandwidth, initFreq, initPhase, minFreq, maxFreq);
+            init(in, bandwidth, initPhase, initFreq, minFreq, maxFreq);
+        }
+
+        // The bandwidth is relative to the line rate since the loop is only corrected once per line
+        void init(stream<complex_t>* in, double bandwidth, double initPhase = 0.0, double initFreq = 0.0, double minFreq = -FL_M_PI, double maxFreq = FL_M_PI) {
+            PhaseControlLoop<float>::criticallyDamped(bandwidth, lineAlpha, lineBeta);
+            _minFreq = minFreq;
+            _maxFreq = maxFreq;
+            base_type::init(in, bandwidth, initPhase, initFreq, minFreq, maxFreq);
         }
 
-        inline int process(int count, complex_t* in, complex_t* out, bool aphase = false) {
-            // Process the pre-burst section
+        // Only the burst goes through the loop, the carrier for the rest of the line is given
+        // back so that the chroma can be demodulated separately.
+        inline void track(complex_t* burst, int lineSize, ChromaCarrier& carrier, bool aphase = false) {
+            carrier.startPhase = pcl.phase;
+            carrier.startFreq = pcl.freq;
+
+            // Skip the pre-burst section
             for (int i = 0; i < BURST_START; i++) {
-                out[i] = in[i] * math::phasor(-pcl.phase);
                 pcl.advancePhase();
             }
 
-            // Process the burst itself
-            if (aphase) {
-                for (int i = BURST_START; i < BURST_END; i++) {
-                    complex_t outVal = in[i] * math::phasor(-pcl.phase);
-                    out[i] = outVal;
-                    pcl.advance(math::normalizePhase(outVal.phase() - A_PHASE));
-                }
-            }
-            else {
-                for (int i = BURST_START; i < BURST_END; i++) {
-                    complex_t outVal = in[i] * math::phasor(-pcl.phase);
-                    out[i] = outVal;
-                    pcl.advance(math::normalizePhase(outVal.phase() - B_PHASE));
-                }
-            }
-            
-            
-            // Process the post-burst section
-            for (int i = BURST_END; i < count; i++) {
-                out[i] = in[i] * math::phasor(-pcl.phase);
+            // Average the burst, a single correction per line keeps the frequency steady between bursts
+            complex_t sum = { 0.0f, 0.0f };
+            for (int i = 0; i < BURST_SIZE; i++) {
+                sum += burst[i] * math::phasor(-pcl.phase);
                 pcl.advancePhase();
             }
+            float error = math::normalizePhase(sum.phase() - (aphase ? A_PHASE : B_PHASE));
+            pcl.freq = std::clamp<float>(pcl.freq + (lineBeta * error / (float)lineSize), _minFreq, _maxFreq);
+            pcl.phase = math::normalizePhase(pcl.phase + (lineAlpha * error));
 
-            return count;
-        }
+            carrier.phase = pcl.phase;
+            carrier.freq = pcl.freq;
 
-        inline int processBlank(int count, complex_t* in, complex_t* out) {
-            for (int i = 0; i < count; i++) {
-                out[i] = in[i] * math::phasor(-pcl.phase);
+            // Skip the post-burst section
+            for (int i = BURST_END; i < lineSize; i++) {
                 pcl.advancePhase();
             }
-            return count;
         }
+
+    protected:
+        float lineAlpha;
+        float lineBeta;
+        float _minFreq;
+        float _maxFreq;
     };
-}
\ No newline at end of file
+}
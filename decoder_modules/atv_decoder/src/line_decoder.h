@@ -0,0 +1,232 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <volk/volk.h>
+#include <dsp/types.h>
+#include <dsp/buffer/buffer.h>
+#include <dsp/math/phasor.h>
+#include "chrominance_filter.h"
+#include "chroma_pll.h"
+
+#define ATV_LINE_SIZE               720
+
+// A line and the samples the chroma filter needs on each side of it
+#define ATV_LINE_WINDOW_SIZE        (ATV_LINE_SIZE + CHROMA_FIR_SIZE - 1)
+
+#define LINE_DECODER_SLOTS          64
+#define LINE_DECODER_MAX_WORKERS    8
+
+// Chroma bandpass of the real signal. The taps are split for real dot products and flipped
+// so that the subcarrier comes out at a positive frequency, like taps::bandPass does.
+class ChromaFilter {
+public:
+    ChromaFilter() {
+        tapsRe = dsp::buffer::alloc<float>(CHROMA_FIR_SIZE);
+        tapsIm = dsp::buffer::alloc<float>(CHROMA_FIR_SIZE);
+        for (int i = 0; i < CHROMA_FIR_SIZE; i++) {
+            tapsRe[i] = CHROMA_FIR[CHROMA_FIR_SIZE - 1 - i].re;
+            tapsIm[i] = CHROMA_FIR[CHROMA_FIR_SIZE - 1 - i].im;
+        }
+    }
+
+    ChromaFilter(const ChromaFilter&) = delete;
+    ChromaFilter& operator=(const ChromaFilter&) = delete;
+
+    ~ChromaFilter() {
+        dsp::buffer::free(tapsRe);
+        dsp::buffer::free(tapsIm);
+    }
+
+    // Chroma of the sample in the middle of the CHROMA_FIR_SIZE given
+    inline dsp::complex_t filter(const float* in) const {
+        dsp::complex_t out;
+        volk_32f_x2_dot_prod_32f(&out.re, in, tapsRe, CHROMA_FIR_SIZE);
+        volk_32f_x2_dot_prod_32f(&out.im, in, tapsIm, CHROMA_FIR_SIZE);
+        return out;
+    }
+
+private:
+    float* tapsRe;
+    float* tapsIm;
+};
+
+struct ATVLine {
+    // The line starts at CHROMA_FIR_DELAY, before and after are the ends of the lines around it
+    float samples[ATV_LINE_WINDOW_SIZE];
+
+    dsp::loop::ChromaCarrier carrier;
+    bool aphase;
+    bool color;
+
+    float minLvl;
+    float spanLvl;
+    float saturation;
+
+    // Where the line is drawn
+    uint32_t* dst;
+};
+
+// Colour decoding of whole lines, done by a pool of workers. Lines only depend on the carrier
+// tracked beforehand so they can be drawn in any order.
+class LineDecoder {
+public:
+    ~LineDecoder() {
+        stop();
+    }
+
+    void start(int workerCount) {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (running) { return; }
+        running = true;
+        workerCount = std::clamp<int>(workerCount, 1, LINE_DECODER_MAX_WORKERS);
+        for (int i = 0; i < workerCount; i++) {
+            workers.push_back(std::thread(&LineDecoder::worker, this));
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            if (!running) { return; }
+            running = false;
+        }
+        workCnd.notify_all();
+        for (auto& w : workers) {
+            if (w.joinable()) { w.join(); }
+        }
+        workers.clear();
+
+        // Whatever wasn't drawn is dropped
+        queued = 0;
+        pending = 0;
+        readIdx = writeIdx;
+        for (auto& b : busy) { b = false; }
+    }
+
+    // Next line to fill, waits for it to be drawn if the workers are behind
+    ATVLine* acquire() {
+        std::unique_lock<std::mutex> lck(mtx);
+        doneCnd.wait(lck, [=]() { return !busy[writeIdx]; });
+        return &lines[writeIdx];
+    }
+
+    // Hands the acquired line to the workers
+    void submit() {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            busy[writeIdx] = true;
+            writeIdx = (writeIdx + 1) % LINE_DECODER_SLOTS;
+            queued++;
+            pending++;
+        }
+        workCnd.notify_one();
+    }
+
+    // Waits for every submitted line to be drawn
+    void wait() {
+        std::unique_lock<std::mutex> lck(mtx);
+        doneCnd.wait(lck, [=]() { return !pending || !running; });
+    }
+
+private:
+    void worker() {
+        dsp::complex_t* chroma = dsp::buffer::alloc<dsp::complex_t>(ATV_LINE_SIZE);
+        float* luma = dsp::buffer::alloc<float>(ATV_LINE_SIZE);
+        float* u = dsp::buffer::alloc<float>(ATV_LINE_SIZE);
+        float* v = dsp::buffer::alloc<float>(ATV_LINE_SIZE);
+
+        while (true) {
+            int idx;
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                workCnd.wait(lck, [=]() { return queued || !running; });
+                if (!running) { break; }
+                idx = readIdx;
+                readIdx = (readIdx + 1) % LINE_DECODER_SLOTS;
+                queued--;
+            }
+
+            decode(lines[idx], chroma, luma, u, v);
+
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                busy[idx] = false;
+                pending--;
+            }
+            doneCnd.notify_all();
+        }
+
+        dsp::buffer::free(chroma);
+        dsp::buffer::free(luma);
+        dsp::buffer::free(u);
+        dsp::buffer::free(v);
+    }
+
+    void decode(const ATVLine& line, dsp::complex_t* chroma, float* luma, float* u, float* v) {
+        const float* in = &line.samples[CHROMA_FIR_DELAY];
+
+        if (line.color) {
+            // Separate the chroma, what's left is the luma
+            for (int i = 0; i < ATV_LINE_SIZE; i++) {
+                chroma[i] = filter.filter(&line.samples[i]);
+            }
+            volk_32fc_deinterleave_real_32f(luma, (lv_32fc_t*)chroma, ATV_LINE_SIZE);
+            volk_32f_s32f_multiply_32f(luma, luma, -2.0f, ATV_LINE_SIZE);
+            volk_32f_x2_add_32f(luma, luma, in, ATV_LINE_SIZE);
+
+            // Bring the chroma to baseband with the carrier from the PLL, the burst corrects it at BURST_END
+            const dsp::loop::ChromaCarrier& c = line.carrier;
+            rotate(chroma, chroma, c.startPhase, c.startFreq, BURST_END);
+            rotate(&chroma[BURST_END], &chroma[BURST_END], c.phase, c.freq, ATV_LINE_SIZE - BURST_END);
+            volk_32fc_deinterleave_32f_x2(u, v, (lv_32fc_t*)chroma, ATV_LINE_SIZE);
+        }
+        else {
+            memcpy(luma, in, ATV_LINE_SIZE * sizeof(float));
+            memset(u, 0, ATV_LINE_SIZE * sizeof(float));
+            memset(v, 0, ATV_LINE_SIZE * sizeof(float));
+        }
+
+        // YUV to RGB (BT.601), V is inverted on every other line
+        float yScale = 255.0f / line.spanLvl;
+        float uScale = 2.0f * yScale * line.saturation;
+        float vScale = line.aphase ? uScale : -uScale;
+        float yOffset = line.minLvl;
+        uint32_t* out = line.dst;
+        for (int i = 0; i < ATV_LINE_SIZE; i++) {
+            float y = (luma[i] - yOffset) * yScale;
+            float uv = u[i] * uScale;
+            float vv = v[i] * vScale;
+            uint32_t r = std::clamp<float>(y + 1.140f * vv, 0.0f, 255.0f);
+            uint32_t g = std::clamp<float>(y - 0.395f * uv - 0.581f * vv, 0.0f, 255.0f);
+            uint32_t b = std::clamp<float>(y + 2.032f * uv, 0.0f, 255.0f);
+            out[i] = 0xFF000000 | (b << 16) | (g << 8) | r;
+        }
+    }
+
+    static inline void rotate(dsp::complex_t* out, const dsp::complex_t* in, float phase, float freq, int count) {
+        lv_32fc_t ph = lv_cmake(cosf(-phase), sinf(-phase));
+        lv_32fc_t phaseDelta = lv_cmake(cosf(-freq), sinf(-freq));
+#if VOLK_VERSION >= 030100
+        volk_32fc_s32fc_x2_rotator2_32fc((lv_32fc_t*)out, (lv_32fc_t*)in, &phaseDelta, &ph, count);
+#else
+        volk_32fc_s32fc_x2_rotator_32fc((lv_32fc_t*)out, (lv_32fc_t*)in, phaseDelta, &ph, count);
+#endif
+    }
+
+    ChromaFilter filter;
+    ATVLine lines[LINE_DECODER_SLOTS];
+    bool busy[LINE_DECODER_SLOTS] = { false };
+    int writeIdx = 0;
+    int readIdx = 0;
+    int queued = 0;
+    int pending = 0;
+
+    bool running = false;
+    std::mutex mtx;
+    std::condition_variable workCnd;
+    std::condition_variable doneCnd;
+    std::vector<std::thread> workers;
+};
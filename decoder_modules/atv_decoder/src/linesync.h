@@ -110,17 +110,11 @@ public:
             float error = 0;
             if (outCount >= 720) {
                 // Compute averages.
-                float left = 0.0f, right = 0.0f;
-                for (int i = (720-17); i < 720; i++) {
-                    left += base_type::out.writeBuf[i];
-                }
-                for (int i = 0; i < 27; i++) {
-                    left += base_type::out.writeBuf[i];
-                }
-                for (int i = 27; i < (54+17); i++) {
-                    right += base_type::out.writeBuf[i];
-                }
-                left *= (1.0f/44.0f);
+                float left, leftEnd, right;
+                volk_32f_accumulator_s32f(&leftEnd, &base_type::out.writeBuf[720-17], 17);
+                volk_32f_accumulator_s32f(&left, base_type::out.writeBuf, 27);
+                volk_32f_accumulator_s32f(&right, &base_type::out.writeBuf[27], 54+17-27);
+                left = (left + leftEnd) * (1.0f/44.0f);
                 right *= (1.0f/44.0f);
 
                 // If the sync is present, compute error
@@ -12,14 +12,13 @@
 #include <dsp/sink/handler_sink.h>
 #include "linesync.h"
 #include <dsp/loop/pll.h>
-#include <dsp/convert/real_to_complex.h>
-#include <dsp/filter/fir.h>
-#include <dsp/taps/from_array.h>
 
 #include "chrominance_filter.h"
 
 #include "chroma_pll.h"
 
+#include "line_decoder.h"
+
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
 SDRPP_MOD_INFO{/* Name:            */ "atv_decoder",
@@ -33,7 +32,7 @@ SDRPP_MOD_INFO{/* Name:            */ "atv_decoder",
 
 class ATVDecoderModule : public ModuleManager::Instance {
   public:
-    ATVDecoderModule(std::string name) : img(720, 625) {
+    ATVDecoderModule(std::string name) : img(ATV_LINE_SIZE, 625) {
         this->name = name;
 
         vfo = sigpath::vfoManager.createVFO(name, ImGui::WaterfallVFO::REF_CENTER, 0, 8000000.0f, SAMPLE_RATE, SAMPLE_RATE, SAMPLE_RATE, true);
@@ -42,11 +41,11 @@ class ATVDecoderModule : public ModuleManager::Instance {
         sync.init(&demod.out, 1.0f, 1e-6, 1.0, 0.05);
         sink.init(&sync.out, handler, this);
 
-        r2c.init(NULL);
-        chromaTaps = dsp::taps::fromArray(CHROMA_FIR_SIZE, CHROMA_FIR);
-        fir.init(NULL, chromaTaps);
         pll.init(NULL, 0.01, 0.0, dsp::math::hzToRads(4433618.75, SAMPLE_RATE), dsp::math::hzToRads(4433618.75*0.90, SAMPLE_RATE), dsp::math::hzToRads(4433618.75*1.1, SAMPLE_RATE));
 
+        // One core is left for the sync
+        lineDecoder.start(std::thread::hardware_concurrency() - 1);
+
         demod.start();
         sync.start();
         sink.start();
@@ -59,6 +58,9 @@ class ATVDecoderModule : public ModuleManager::Instance {
             sigpath::vfoManager.deleteVFO(vfo);
         }
         demod.stop();
+        sync.stop();
+        sink.stop();
+        lineDecoder.stop();
         gui::menu.removeEntry(name);
     }
 
@@ -99,6 +101,12 @@ class ATVDecoderModule : public ModuleManager::Instance {
         ImGui::FillWidth();
         ImGui::SliderFloat("##spanLvl", &_this->spanLvl, 0, 1.0);
 
+        ImGui::LeftLabel("Saturation");
+        ImGui::FillWidth();
+        ImGui::SliderFloat("##saturation", &_this->saturation, 0, 2.0);
+
+        ImGui::Checkbox("Color", &_this->color);
+
         ImGui::LeftLabel("Sync Bias");
         ImGui::FillWidth();
         ImGui::SliderFloat("##syncBias", &_this->sync.syncBias,-0.1, 0.1);
@@ -126,33 +134,45 @@ class ATVDecoderModule : public ModuleManager::Instance {
         }
     }
 
+    // Sync front end, only what depends on the previous lines is done here. The lines are then
+    // colour decoded by the workers straight into the image.
     static void handler(float *data, int count, void *ctx) {
         ATVDecoderModule *_this = (ATVDecoderModule *)ctx;
 
-        // Convert line to complex
-        _this->r2c.process(720, data, _this->r2c.out.writeBuf);
-
-        // Isolate the chroma subcarrier
-        _this->fir.process(720, _this->r2c.out.writeBuf, _this->fir.out.writeBuf);
-
-        // Run chroma carrier through the PLL
-        _this->pll.process(720, _this->fir.out.writeBuf, _this->pll.out.writeBuf, ((_this->ypos%2)==1) ^ _this->evenFrame);
-
-        // Render line to the image without color
-        int lypos = _this->ypos - 1;
-        if (lypos < 0) { lypos = 624; }
-        uint32_t* lastLine = &((uint32_t *)_this->img.buffer)[(lypos < 313) ? (lypos*720*2) : ((((lypos - 313)*2)+1)*720) ];
-        uint32_t* currentLine = &((uint32_t *)_this->img.buffer)[(_this->ypos < 313) ? (_this->ypos*720*2) : ((((_this->ypos - 313)*2)+1)*720) ];
+        // The filter needs the start of this line to finish the previous one
+        if (_this->line) {
+            memcpy(&_this->line->samples[CHROMA_FIR_DELAY + ATV_LINE_SIZE], data, CHROMA_FIR_DELAY * sizeof(float));
+            _this->lineDecoder.submit();
+            _this->line = NULL;
+        }
 
-        //uint32_t* currentLine = &((uint32_t *)_this->img.buffer)[_this->ypos*720];
+        // Swap once every line of the frame is drawn
+        if (_this->swapPending) {
+            _this->lineDecoder.wait();
+            _this->img.swap();
+            _this->swapPending = false;
+        }
 
-        for (int i = 0; i < count; i++) {
-            int imval = std::clamp<float>((data[i] - _this->minLvl) * 255.0 / _this->spanLvl, 0, 255);
-            // uint32_t re = std::clamp<float>((_this->pll.out.writeBuf[i].re - _this->minLvl) * 255.0 / _this->spanLvl, 0, 255);
-            // uint32_t im = std::clamp<float>((_this->pll.out.writeBuf[i].im - _this->minLvl) * 255.0 / _this->spanLvl, 0, 255);
-            // currentLine[i] = 0xFF000000 | (im << 8) | re;
-            currentLine[i] = 0xFF000000 | (imval << 16) | (imval << 8) | imval;
+        // Copy the line after the end of the previous one
+        ATVLine* line = _this->lineDecoder.acquire();
+        memcpy(line->samples, _this->lineHistory, CHROMA_FIR_DELAY * sizeof(float));
+        memcpy(&line->samples[CHROMA_FIR_DELAY], data, ATV_LINE_SIZE * sizeof(float));
+        memcpy(_this->lineHistory, &data[ATV_LINE_SIZE - CHROMA_FIR_DELAY], CHROMA_FIR_DELAY * sizeof(float));
+
+        // Run the burst through the PLL, the carrier is then used to demodulate the whole line
+        line->aphase = ((_this->ypos%2)==1) ^ _this->evenFrame;
+        line->color = _this->color;
+        if (line->color) {
+            for (int i = 0; i < BURST_SIZE; i++) {
+                _this->burst[i] = _this->burstFilter.filter(&line->samples[BURST_START + i]);
+            }
+            _this->pll.track(_this->burst, ATV_LINE_SIZE, line->carrier, line->aphase);
         }
+        line->minLvl = _this->minLvl;
+        line->spanLvl = _this->spanLvl;
+        line->saturation = _this->saturation;
+        line->dst = &((uint32_t *)_this->img.buffer)[(_this->ypos < 313) ? (_this->ypos*ATV_LINE_SIZE*2) : ((((_this->ypos - 313)*2)+1)*ATV_LINE_SIZE) ];
+        _this->line = line;
     
         // Vertical scan logic
         _this->ypos++;
@@ -163,17 +183,13 @@ class ATVDecoderModule : public ModuleManager::Instance {
                 _this->evenFrame = !_this->evenFrame;
             }
             _this->ypos = 0;
-            _this->img.swap();
+            _this->swapPending = true;
         }
 
         // Measure vsync levels
-        float sync0 = 0.0f, sync1 = 0.0f;
-        for (int i = 0; i < 306; i++) {
-            sync0 += data[i];
-        }
-        for (int i = (720/2); i < ((720/2)+306); i++) {
-            sync1 += data[i];
-        }
+        float sync0, sync1;
+        volk_32f_accumulator_s32f(&sync0, data, 306);
+        volk_32f_accumulator_s32f(&sync1, &data[720/2], 306);
         sync0 *= (1.0f/305.0f);
         sync1 *= (1.0f/305.0f);
 
@@ -189,7 +205,7 @@ class ATVDecoderModule : public ModuleManager::Instance {
                 _this->evenFrame = !_this->evenFrame;
             }
             _this->ypos = 0;
-            _this->img.swap();
+            _this->swapPending = true;
         }
     }
 
@@ -200,12 +216,17 @@ class ATVDecoderModule : public ModuleManager::Instance {
     dsp::demod::Quadrature demod;
     LineSync sync;
     dsp::sink::Handler<float> sink;
-    dsp::convert::RealToComplex r2c;
-    dsp::tap<dsp::complex_t> chromaTaps;
-    dsp::filter::FIR<dsp::complex_t, dsp::complex_t> fir;
     dsp::loop::ChromaPLL pll;
+    ChromaFilter burstFilter;
+    dsp::complex_t burst[BURST_SIZE];
+    LineDecoder lineDecoder;
     int ypos = 0;
 
+    // Line waiting for the start of the next one
+    ATVLine* line = NULL;
+    float lineHistory[CHROMA_FIR_DELAY] = { 0 };
+    bool swapPending = false;
+
     bool evenFrame = false;
     std::mutex evenFrameMtx;
 
@@ -215,6 +236,8 @@ class ATVDecoderModule : public ModuleManager::Instance {
 
     float minLvl = 0.0f;
     float spanLvl = 1.0f;
+    float saturation = 1.0f;
+    bool color = true;
 
     bool lockedLines = 0;
     uint16_t syncHistory = 0;
@@ -0,0 +1,69 @@
+#include <golay.h>
+
+#define GOLAY_POLY          0xC75
+#define GOLAY_UNCORRECTABLE 0xFFFFFFFF
+
+namespace {
+    int popcount(uint32_t n) {
+        int count = 0;
+        for (; n; n &= n - 1) { count++; }
+        return count;
+    }
+
+    // Check bits of the [23, 12] code followed by the overall parity
+    uint16_t computeParity(uint16_t data) {
+        uint32_t check = data;
+        for (int i = 0; i < 12; i++) {
+            if (check & 1) { check ^= GOLAY_POLY; }
+            check >>= 1;
+        }
+        uint32_t cw23 = check | ((uint32_t)data << 11);
+        return ((check << 1) | (popcount(cw23) & 1)) & 0xFFF;
+    }
+
+    struct GolayTables {
+        GolayTables() {
+            for (uint32_t i = 0; i < 4096; i++) {
+                parity[i] = computeParity(i);
+                errors[i] = GOLAY_UNCORRECTABLE;
+            }
+
+            // Every pattern of up to 3 errors has its own syndrome
+            errors[0] = 0;
+            for (int i = 0; i < 24; i++) {
+                addError(1 << i);
+                for (int j = i + 1; j < 24; j++) {
+                    addError((1 << i) | (1 << j));
+                    for (int k = j + 1; k < 24; k++) {
+                        addError((1 << i) | (1 << j) | (1 << k));
+                    }
+                }
+            }
+        }
+
+        inline uint16_t syndrome(uint32_t codeword) const {
+            return parity[(codeword >> 12) & 0xFFF] ^ (codeword & 0xFFF);
+        }
+
+        void addError(uint32_t error) {
+            errors[syndrome(error)] = error;
+        }
+
+        uint16_t parity[4096];
+        uint32_t errors[4096];
+    };
+
+    const GolayTables tables;
+}
+
+uint32_t M17EncodeGolay24(uint16_t data) {
+    data &= 0xFFF;
+    return ((uint32_t)data << 12) | tables.parity[data];
+}
+
+bool M17DecodeGolay24(uint32_t codeword, uint16_t& data) {
+    uint32_t error = tables.errors[tables.syndrome(codeword)];
+    if (error == GOLAY_UNCORRECTABLE) { return false; }
+    data = ((codeword ^ error) >> 12) & 0xFFF;
+    return true;
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <stdint.h>
+
+// Extended Golay(24, 12) of the LICH, the data is in the upper 12 bits of the codeword
+uint32_t M17EncodeGolay24(uint16_t data);
+
+// Corrects up to 3 errors with a table lookup, false if there were more
+bool M17DecodeGolay24(uint32_t codeword, uint16_t& data);
@@ -0,0 +1,345 @@
+#pragma once
+#include <dsp/block.h>
+#include <dsp/demod/gfsk.h>
+#include <golay.h>
+#include <lsf_decode.h>
+
+extern "C" {
+#include <correct.h>
+}
+
+#define M17_DEVIATION     2400.0f
+#define M17_BAUDRATE      4800.0f
+#define M17_RRC_ALPHA     0.5f
+#define M17_4FSK_HIGH_CUT ((1.0f + (1.0f/3.0f)) / 2.0f)
+
+#define M17_SYNC_SIZE            16
+#define M17_LICH_SIZE            96
+#define M17_PAYLOAD_SIZE         144
+#define M17_PAYLOAD_BYTES        (M17_PAYLOAD_SIZE / 8)
+#define M17_ENCODED_PAYLOAD_SIZE 296
+#define M17_LSF_SIZE             240
+#define M17_ENCODED_LSF_SIZE     488
+#define M17_LSF_BYTES            (M17_LSF_SIZE / 8)
+#define M17_RAW_FRAME_SIZE       384
+#define M17_CUT_FRAME_SIZE       368
+#define M17_LICH_CHUNK_SIZE      40
+#define M17_LICH_CHUNK_COUNT     6
+
+#define M17_MAX_FN          0x7FFF
+#define M17_END_FN          0x8000
+#define M17_STREAM_TIMEOUT  500
+
+#define M17_LSF_SYNC    0x55F7
+#define M17_STF_SYNC    0xFF5D
+#define M17_PKF_SYNC    0x75FF
+
+// Bits that may be wrong in a syncword when searching for one, and when it's expected right after a frame
+#define M17_SEARCH_SYNC_ERRORS  0
+#define M17_LOCKED_SYNC_ERRORS  2
+
+// Soft bits are 0 for a certain 0 and 255 for a certain 1, punctured bits are erased
+#define M17_SOFT_SIGN_SCALE     192.0f
+#define M17_SOFT_OUTER_SCALE    384.0f
+#define M17_SOFT_ERASURE        128
+
+const uint8_t M17_SCRAMBLER[368] = { 1, 1, 0, 1, 0, 1, 1, 0, 1, 0, 1, 1, 0, 1, 0, 1,
+                                     1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0,
+                                     1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                     1, 0, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 1, 0,
+                                     1, 0, 1, 1, 1, 0, 1, 0, 0, 1, 0, 0, 1, 1, 1, 0,
+                                     1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 0, 0, 0,
+                                     1, 1, 0, 1, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0,
+                                     1, 1, 0, 1, 1, 1, 0, 1, 0, 1, 0, 1, 1, 1, 0, 1,
+                                     0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 0, 0, 0,
+                                     0, 1, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1,
+                                     1, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 1, 0, 1,
+                                     1, 1, 1, 1, 1, 0, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0,
+                                     0, 1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 1, 1, 1, 1,
+                                     0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 0, 1, 1, 0, 1, 0,
+                                     0, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0, 1, 0, 1, 0,
+                                     1, 1, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 0, 1, 1, 0,
+                                     0, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1,
+                                     1, 1, 0, 1, 0, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+                                     1, 1, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 1,
+                                     1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1, 1,
+                                     0, 1, 0, 1, 0, 1, 1, 1, 0, 0, 0, 1, 1, 0, 0, 0,
+                                     0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1,
+                                     0, 1, 1, 1, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 1 };
+
+const uint16_t M17_INTERLEAVER[368] = { 0, 137, 90, 227, 180, 317, 270, 39, 360, 129, 82, 219, 172, 309, 262, 31,
+                                        352, 121, 74, 211, 164, 301, 254, 23, 344, 113, 66, 203, 156, 293, 246, 15,
+                                        336, 105, 58, 195, 148, 285, 238, 7, 328, 97, 50, 187, 140, 277, 230, 367,
+                                        320, 89, 42, 179, 132, 269, 222, 359, 312, 81, 34, 171, 124, 261, 214, 351,
+                                        304, 73, 26, 163, 116, 253, 206, 343, 296, 65, 18, 155, 108, 245, 198, 335,
+                                        288, 57, 10, 147, 100, 237, 190, 327, 280, 49, 2, 139, 92, 229, 182, 319,
+                                        272, 41, 362, 131, 84, 221, 174, 311, 264, 33, 354, 123, 76, 213, 166, 303,
+                                        256, 25, 346, 115, 68, 205, 158, 295, 248, 17, 338, 107, 60, 197, 150, 287,
+                                        240, 9, 330, 99, 52, 189, 142, 279, 232, 1, 322, 91, 44, 181, 134, 271,
+                                        224, 361, 314, 83, 36, 173, 126, 263, 216, 353, 306, 75, 28, 165, 118, 255,
+                                        208, 345, 298, 67, 20, 157, 110, 247, 200, 337, 290, 59, 12, 149, 102, 239,
+                                        192, 329, 282, 51, 4, 141, 94, 231, 184, 321, 274, 43, 364, 133, 86, 223,
+                                        176, 313, 266, 35, 356, 125, 78, 215, 168, 305, 258, 27, 348, 117, 70, 207,
+                                        160, 297, 250, 19, 340, 109, 62, 199, 152, 289, 242, 11, 332, 101, 54, 191,
+                                        144, 281, 234, 3, 324, 93, 46, 183, 136, 273, 226, 363, 316, 85, 38, 175,
+                                        128, 265, 218, 355, 308, 77, 30, 167, 120, 257, 210, 347, 300, 69, 22, 159,
+                                        112, 249, 202, 339, 292, 61, 14, 151, 104, 241, 194, 331, 284, 53, 6, 143,
+                                        96, 233, 186, 323, 276, 45, 366, 135, 88, 225, 178, 315, 268, 37, 358, 127,
+                                        80, 217, 170, 307, 260, 29, 350, 119, 72, 209, 162, 299, 252, 21, 342, 111,
+                                        64, 201, 154, 291, 244, 13, 334, 103, 56, 193, 146, 283, 236, 5, 326, 95,
+                                        48, 185, 138, 275, 228, 365, 318, 87, 40, 177, 130, 267, 220, 357, 310, 79,
+                                        32, 169, 122, 259, 212, 349, 302, 71, 24, 161, 114, 251, 204, 341, 294, 63,
+                                        16, 153, 106, 243, 196, 333, 286, 55, 8, 145, 98, 235, 188, 325, 278, 47 };
+
+const uint8_t M17_PUNCTURING_P1[61] = { 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1,
+                                        1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1,
+                                        1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1,
+                                        1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1 };
+
+const uint8_t M17_PUNCTURING_P2[12] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0 };
+
+static const correct_convolutional_polynomial_t correct_conv_m17_polynomial[] = { 0b11001, 0b10111 };
+
+namespace dsp {
+    // The whole M17 receive chain up to the codec2 frames, in a single block. The symbols are sliced into
+    // soft bits and a state machine follows the frames from syncword to syncword. Each frame goes through
+    // the soft Viterbi decoder as soon as it's complete, and link setup frames are given to the handler.
+    class M17Receiver : public block {
+    public:
+        M17Receiver() {}
+
+        M17Receiver(stream<complex_t>* in, float sampleRate, void (*handler)(M17LSF& lsf, void* ctx), void* ctx) { init(in, sampleRate, handler, ctx); }
+
+        ~M17Receiver() {
+            if (!block::_block_init) { return; }
+            block::stop();
+            correct_convolutional_destroy(conv);
+        }
+
+        void init(stream<complex_t>* in, float sampleRate, void (*handler)(M17LSF& lsf, void* ctx), void* ctx) {
+            _in = in;
+            _handler = handler;
+            _ctx = ctx;
+
+            demod.init(NULL, M17_BAUDRATE, sampleRate, M17_DEVIATION, 31, M17_RRC_ALPHA, 1e-6f, 0.01f, 0.01f);
+            demod.out.free();
+
+            conv = correct_convolutional_create(2, 5, correct_conv_m17_polynomial);
+
+            block::registerInput(_in);
+            block::registerOutput(&out);
+            block::registerOutput(&diagOut);
+            block::_block_init = true;
+        }
+
+        void setInput(stream<complex_t>* in) {
+            assert(block::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(block::ctrlMtx);
+            block::tempStop();
+            block::unregisterInput(_in);
+            _in = in;
+            block::registerInput(_in);
+            block::tempStart();
+        }
+
+        void reset() {
+            assert(block::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(block::ctrlMtx);
+            block::tempStop();
+            demod.reset();
+            syncReg = 0;
+            inFrame = false;
+            locked = false;
+            lichValid = false;
+            block::tempStart();
+        }
+
+        // Demodulates the samples into symbols. The payloads of the stream frames, M17_PAYLOAD_BYTES each,
+        // are written one after the other unless payloads is NULL.
+        inline int process(int count, complex_t* in, float* symbols, uint8_t* payloads, int& payloadCount) {
+            count = demod.process(count, in, symbols);
+            payloadCount = 0;
+
+            for (int i = 0; i < count; i++) {
+                // Slice the symbol, +3 is 01, +1 is 00, -1 is 10 and -3 is 11
+                float sym = symbols[i];
+                uint8_t signBit = std::clamp<float>(128.0f - (sym * M17_SOFT_SIGN_SCALE), 0.0f, 255.0f);
+                uint8_t outerBit = std::clamp<float>(128.0f + ((fabsf(sym) - M17_4FSK_HIGH_CUT) * M17_SOFT_OUTER_SCALE), 0.0f, 255.0f);
+                syncReg = (syncReg << 2) | ((signBit >= 128) << 1) | (outerBit >= 128);
+
+                if (inFrame) {
+                    pushBit(signBit);
+                    pushBit(outerBit);
+                    if (bitCount < M17_CUT_FRAME_SIZE) { continue; }
+
+                    // The next syncword is expected right after the frame
+                    inFrame = false;
+                    locked = true;
+                    symsSinceFrame = 0;
+                    if (decodeFrame() && payloads) {
+                        memcpy(&payloads[payloadCount * M17_PAYLOAD_BYTES], payload, M17_PAYLOAD_BYTES);
+                        payloadCount++;
+                    }
+                    continue;
+                }
+
+                int maxErrors = M17_SEARCH_SYNC_ERRORS;
+                if (locked) {
+                    if (++symsSinceFrame < M17_SYNC_SIZE / 2) { continue; }
+                    maxErrors = M17_LOCKED_SYNC_ERRORS;
+                    locked = false;
+                }
+                if (detectSync(maxErrors)) {
+                    inFrame = true;
+                    bitCount = 0;
+                }
+            }
+
+            return count;
+        }
+
+        int run() {
+            int count = _in->read();
+            if (count < 0) { return -1; }
+
+            int payloadCount;
+            int symCount = process(count, _in->readBuf, diagOut.writeBuf, out.writeBuf, payloadCount);
+
+            _in->flush();
+
+            if (symCount && !diagOut.swap(symCount)) { return -1; }
+            if (payloadCount && !out.swap(payloadCount * M17_PAYLOAD_BYTES)) { return -1; }
+            return count;
+        }
+
+        // Payloads of the stream frames: frame number then the two codec2 frames
+        stream<uint8_t> out;
+
+        // Symbols for the constellation diagram
+        stream<float> diagOut;
+
+    private:
+        enum FrameType {
+            M17_FRAME_LSF,
+            M17_FRAME_STREAM,
+            M17_FRAME_PACKET
+        };
+
+        static inline int bitErrors(uint16_t a, uint16_t b) {
+            int count = 0;
+            for (uint16_t n = a ^ b; n; n &= n - 1) { count++; }
+            return count;
+        }
+
+        inline bool detectSync(int maxErrors) {
+            if (bitErrors(syncReg, M17_LSF_SYNC) <= maxErrors) { frameType = M17_FRAME_LSF; }
+            else if (bitErrors(syncReg, M17_STF_SYNC) <= maxErrors) { frameType = M17_FRAME_STREAM; }
+            else if (bitErrors(syncReg, M17_PKF_SYNC) <= maxErrors) { frameType = M17_FRAME_PACKET; }
+            else { return false; }
+            return true;
+        }
+
+        // Descrambles and deinterleaves the bits as they come
+        inline void pushBit(uint8_t soft) {
+            frame[M17_INTERLEAVER[bitCount]] = M17_SCRAMBLER[bitCount] ? (255 - soft) : soft;
+            bitCount++;
+        }
+
+        // True if the frame had a payload
+        bool decodeFrame() {
+            if (frameType == M17_FRAME_LSF) {
+                depuncture(frame, M17_CUT_FRAME_SIZE, M17_PUNCTURING_P1, 61, depunctured, M17_ENCODED_LSF_SIZE);
+                correct_convolutional_decode_soft(conv, depunctured, M17_ENCODED_LSF_SIZE, lsf);
+                M17LSF decLsf = M17DecodeLSF(lsf);
+                if (decLsf.valid) { _handler(decLsf, _ctx); }
+                return false;
+            }
+            if (frameType != M17_FRAME_STREAM) { return false; }
+
+            decodeLICH();
+
+            depuncture(&frame[M17_LICH_SIZE], M17_CUT_FRAME_SIZE - M17_LICH_SIZE, M17_PUNCTURING_P2, 12, depunctured, M17_ENCODED_PAYLOAD_SIZE);
+            correct_convolutional_decode_soft(conv, depunctured, M17_ENCODED_PAYLOAD_SIZE, payload);
+            return true;
+        }
+
+        static void depuncture(const uint8_t* in, int inCount, const uint8_t* pattern, int patternLen, uint8_t* out, int outCount) {
+            int inOffset = 0;
+            for (int i = 0; i < outCount; i++) {
+                out[i] = (pattern[i % patternLen] && inOffset < inCount) ? in[inOffset++] : M17_SOFT_ERASURE;
+            }
+        }
+
+        // The LICH carries the link setup in six chunks spread over as many frames
+        void decodeLICH() {
+            // Decode the 4 Golay(24, 12) blocks into the 48 bits of the chunk
+            uint64_t chunk = 0;
+            for (int b = 0; b < 4; b++) {
+                uint32_t codeword = 0;
+                for (int i = 0; i < 24; i++) { codeword = (codeword << 1) | (frame[(b * 24) + i] >= 128); }
+
+                uint16_t data;
+                if (!M17DecodeGolay24(codeword, data)) {
+                    lichValid = false;
+                    return;
+                }
+                chunk = (chunk << 12) | data;
+            }
+
+            // The chunk number follows the 40 bits of link setup data
+            int partId = (chunk >> 5) & 0b111;
+            if (partId >= M17_LICH_CHUNK_COUNT) {
+                lichValid = false;
+                return;
+            }
+
+            // Start over on the first chunk, cancel on a discontinuity
+            if (partId == 0) {
+                lichValid = true;
+            }
+            else if (!lichValid || partId != lastPartId + 1) {
+                lichValid = false;
+                return;
+            }
+            lastPartId = partId;
+            for (int i = 0; i < 5; i++) {
+                lich[(partId * 5) + i] = chunk >> (40 - (8 * i));
+            }
+
+            // Send out the link setup once complete, it only replaces the last one if its CRC passes
+            if (partId == M17_LICH_CHUNK_COUNT - 1) {
+                lichValid = false;
+                M17LSF decLsf = M17DecodeLSF(lich);
+                if (!decLsf.valid) { return; }
+                memcpy(lsf, lich, sizeof(lich));
+                _handler(decLsf, _ctx);
+            }
+        }
+
+        stream<complex_t>* _in;
+        void (*_handler)(M17LSF& lsf, void* ctx);
+        void* _ctx;
+
+        demod::GFSK demod;
+        correct_convolutional* conv;
+
+        // Frame state machine
+        uint16_t syncReg = 0;
+        bool inFrame = false;
+        bool locked = false;
+        int symsSinceFrame = 0;
+        FrameType frameType;
+        int bitCount = 0;
+
+        uint8_t frame[M17_CUT_FRAME_SIZE];
+        uint8_t depunctured[M17_ENCODED_LSF_SIZE];
+        // The decoder also gives out the flush bits
+        uint8_t payload[(M17_ENCODED_PAYLOAD_SIZE / 16) + 1];
+
+        uint8_t lsf[(M17_ENCODED_LSF_SIZE / 16) + 1];
+        // Built up from the LICH chunks apart from full link setup frames
+        uint8_t lich[M17_LICH_CHUNK_COUNT * 5];
+        bool lichValid = false;
+        int lastPartId = 0;
+    };
+}
@@ -18,6 +18,9 @@
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
+// Silence after which a repeated link setup counts as a new transmission, in seconds
+#define M17_TRANSMISSION_GAP    2.0
+
 SDRPP_MOD_INFO{
     /* Name:            */ "m17_decoder",
     /* Description:     */ "M17 Digital Voice Decoder for SDR++",
@@ -258,10 +261,41 @@ private:
     static void lsfHandler(M17LSF& lsf, void* ctx) {
         M17DecoderModule* _this = (M17DecoderModule*)ctx;
         std::lock_guard lck(_this->lsfMtx);
-        _this->lastUpdated = std::chrono::high_resolution_clock::now();
+        auto now = std::chrono::high_resolution_clock::now();
+
+        // The link setup is repeated all through a transmission, only its first appearance is published
+        bool same = _this->lsf.valid && lsf.src == _this->lsf.src && lsf.dst == _this->lsf.dst && lsf.rawType == _this->lsf.rawType;
+        bool gap = std::chrono::duration<double>(now - _this->lastUpdated).count() > M17_TRANSMISSION_GAP;
+        if (!same || gap) { _this->publishLSF(lsf); }
+
+        _this->lastUpdated = now;
         _this->lsf = lsf;
     }
 
+    void publishLSF(const M17LSF& lsf) {
+        json fields;
+        fields["src"] = lsf.src;
+        fields["dst"] = lsf.dst;
+        fields["mode"] = lsf.isStream ? "stream" : "packet";
+        fields["dataType"] = M17DataTypesTxt[lsf.dataType];
+        fields["encryption"] = M17EncryptionTypesTxt[lsf.encryptionType];
+        fields["can"] = lsf.channelAccessNum;
+
+        // Rebuild the 240 bit link setup frame as it was received
+        uint8_t raw[30];
+        for (int i = 0; i < 6; i++) {
+            raw[i] = lsf.rawDst >> (40 - (i * 8));
+            raw[6 + i] = lsf.rawSrc >> (40 - (i * 8));
+        }
+        raw[12] = lsf.rawType >> 8;
+        raw[13] = lsf.rawType;
+        memcpy(&raw[14], lsf.meta, 14);
+        raw[28] = lsf.rawCRC >> 8;
+        raw[29] = lsf.rawCRC;
+
+        core::decoderBus.publish("m17", name, gui::waterfall.getCenterFrequency() + vfo->getOffset(), std::move(fields), raw, 240);
+    }
+
     std::string name;
     bool enabled = true;
 
@@ -0,0 +1,164 @@
+#include "ccsds.h"
+#include <string.h>
+#include <utils/flog.h>
+
+#define LRPT_RS_NROOTS          32
+#define LRPT_RS_FIRST_ROOT      112
+#define LRPT_RS_ROOT_GAP        11
+
+#define LRPT_MPDU_HEADER_OFFSET 8
+#define LRPT_MPDU_DATA_OFFSET   10
+#define LRPT_MPDU_NO_HEADER     0x7FF
+#define LRPT_PACKET_HEADER_SIZE 6
+#define LRPT_IDLE_APID          2047
+
+namespace lrpt {
+    const correct_convolutional_polynomial_t CONV_POLY[2] = { 0117, 0155 };
+
+    // Tables that don't depend on the data, computed once
+    struct Tables {
+        Tables() {
+            // CCSDS pseudo-random sequence, h(x) = x^8 + x^7 + x^5 + x^3 + 1 starting from all ones
+            uint8_t sr = 0xFF;
+            for (int i = 0; i < LRPT_CADU_SIZE - 4; i++) {
+                uint8_t byte = 0;
+                for (int j = 0; j < 8; j++) {
+                    byte = (byte << 1) | (sr & 1);
+                    uint8_t fb = (sr ^ (sr >> 3) ^ (sr >> 5) ^ (sr >> 7)) & 1;
+                    sr = (sr >> 1) | (fb << 7);
+                }
+                pn[i] = byte;
+            }
+
+            // Conversion between the conventional and dual basis representation of the RS symbols
+            const uint8_t tal[8] = { 0x8D, 0xEF, 0xEC, 0x86, 0xFA, 0x99, 0xAF, 0x7B };
+            for (int i = 0; i < 256; i++) {
+                uint8_t dual = 0;
+                for (int j = 0; j < 8; j++) {
+                    if (i & (1 << j)) { dual ^= tal[7 - j]; }
+                }
+                toDual[i] = dual;
+                fromDual[dual] = i;
+            }
+        }
+
+        uint8_t pn[LRPT_CADU_SIZE - 4];
+        uint8_t toDual[256];
+        uint8_t fromDual[256];
+    };
+
+    static const Tables tables;
+
+    static inline int popcount(uint32_t n) {
+        int count = 0;
+        for (; n; n &= n - 1) { count++; }
+        return count;
+    }
+
+    void getEncodedASM(uint8_t* bits) {
+        uint32_t sr = 0;
+        for (int i = 0; i < 32; i++) {
+            sr = ((sr << 1) | ((LRPT_ASM >> (31 - i)) & 1)) & 0x7F;
+            bits[2 * i] = popcount(sr & CONV_POLY[0]) & 1;
+            bits[(2 * i) + 1] = popcount(sr & CONV_POLY[1]) & 1;
+        }
+    }
+
+    FrameDecoder::FrameDecoder() {
+        // libcorrect picks the fastest Viterbi kernel the cpu supports
+        conv = correct_convolutional_create(2, 7, CONV_POLY);
+        rs = correct_reed_solomon_create(correct_rs_primitive_polynomial_ccsds, LRPT_RS_FIRST_ROOT, LRPT_RS_ROOT_GAP, LRPT_RS_NROOTS);
+        if (!conv || !rs) { flog::error("Could not create the LRPT FEC decoders"); }
+    }
+
+    FrameDecoder::~FrameDecoder() {
+        correct_convolutional_destroy(conv);
+        correct_reed_solomon_destroy(rs);
+    }
+
+    bool FrameDecoder::decode(const uint8_t* soft, uint8_t* vcdu) {
+        // The decoder assumes the encoder starts and ends zeroed, which is only true inside the frame, hence the margins
+        correct_convolutional_decode_soft(conv, soft, LRPT_FRAME_SOFT_BITS, decoded);
+        const uint8_t* cadu = &decoded[LRPT_VITERBI_MARGIN / 8];
+
+        uint32_t asmWord = ((uint32_t)cadu[0] << 24) | ((uint32_t)cadu[1] << 16) | ((uint32_t)cadu[2] << 8) | cadu[3];
+        asmErrors = popcount(asmWord ^ LRPT_ASM);
+
+        // Each codeword is spread over every LRPT_RS_DEPTH bytes and sent in dual basis
+        const uint8_t* data = &cadu[4];
+        bool ok = true;
+        for (int i = 0; i < LRPT_RS_DEPTH; i++) {
+            for (int j = 0; j < LRPT_RS_BLOCK_SIZE; j++) {
+                int k = (j * LRPT_RS_DEPTH) + i;
+                codeword[j] = tables.fromDual[data[k] ^ tables.pn[k]];
+            }
+            if (correct_reed_solomon_decode(rs, codeword, LRPT_RS_BLOCK_SIZE, corrected) < 0) {
+                ok = false;
+                continue;
+            }
+            for (int j = 0; j < LRPT_RS_DATA_SIZE; j++) {
+                vcdu[(j * LRPT_RS_DEPTH) + i] = tables.toDual[corrected[j]];
+            }
+        }
+        return ok;
+    }
+
+    void VCDUDemux::process(const uint8_t* vcdu) {
+        int vcid = vcdu[1] & 0x3F;
+        if (vcid == LRPT_VCDU_FILL_VCID) { return; }
+        uint32_t counter = ((uint32_t)vcdu[2] << 16) | ((uint32_t)vcdu[3] << 8) | vcdu[4];
+
+        // A packet can't be completed if a VCDU is missing
+        VirtualChannel& vc = channels[vcid];
+        if (vc.synced && counter != ((vc.lastCounter + 1) & 0xFFFFFF)) {
+            vc.synced = false;
+            vc.pending.clear();
+        }
+        vc.lastCounter = counter;
+
+        const uint8_t* data = &vcdu[LRPT_MPDU_DATA_OFFSET];
+        int dataLen = LRPT_VCDU_SIZE - LRPT_MPDU_DATA_OFFSET;
+        int firstHeader = ((vcdu[LRPT_MPDU_HEADER_OFFSET] & 0x07) << 8) | vcdu[LRPT_MPDU_HEADER_OFFSET + 1];
+
+        // The whole zone continues the current packet
+        if (firstHeader == LRPT_MPDU_NO_HEADER) {
+            if (!vc.synced) { return; }
+            vc.pending.insert(vc.pending.end(), data, &data[dataLen]);
+            extractPackets(vc);
+            return;
+        }
+        if (firstHeader >= dataLen) {
+            vc.synced = false;
+            vc.pending.clear();
+            return;
+        }
+
+        // Finish the current packet, anything left over means it was inconsistent and is dropped
+        if (vc.synced) {
+            vc.pending.insert(vc.pending.end(), data, &data[firstHeader]);
+            extractPackets(vc);
+        }
+        vc.pending.assign(&data[firstHeader], &data[dataLen]);
+        vc.synced = true;
+        extractPackets(vc);
+    }
+
+    void VCDUDemux::reset() {
+        channels.clear();
+    }
+
+    void VCDUDemux::extractPackets(VirtualChannel& vc) {
+        int offset = 0;
+        int available = vc.pending.size();
+        while (available - offset >= LRPT_PACKET_HEADER_SIZE) {
+            const uint8_t* pkt = &vc.pending[offset];
+            int apid = ((pkt[0] & 0x07) << 8) | pkt[1];
+            int seq = ((pkt[2] & 0x3F) << 8) | pkt[3];
+            int len = (((int)pkt[4] << 8) | pkt[5]) + 1;
+            if (available - offset < LRPT_PACKET_HEADER_SIZE + len) { break; }
+            if (apid != LRPT_IDLE_APID) { onPacket(apid, seq, &pkt[LRPT_PACKET_HEADER_SIZE], len); }
+            offset += LRPT_PACKET_HEADER_SIZE + len;
+        }
+        vc.pending.erase(vc.pending.begin(), vc.pending.begin() + offset);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <utils/new_event.h>
+
+extern "C" {
+#include <correct.h>
+}
+
+#define LRPT_ASM                0x1ACFFC1D
+#define LRPT_CADU_SIZE          1024
+#define LRPT_CADU_BITS          (LRPT_CADU_SIZE * 8)
+#define LRPT_RS_DEPTH           4
+#define LRPT_RS_BLOCK_SIZE      255
+#define LRPT_RS_DATA_SIZE       223
+#define LRPT_VCDU_SIZE          (LRPT_RS_DEPTH * LRPT_RS_DATA_SIZE)
+#define LRPT_VCDU_FILL_VCID     63
+
+// Number of symbols decoded before and after a frame so that the Viterbi decoder has settled at its borders
+#define LRPT_VITERBI_MARGIN     64
+#define LRPT_FRAME_SOFT_BITS    ((LRPT_CADU_BITS + 2 * LRPT_VITERBI_MARGIN) * 2)
+
+namespace lrpt {
+    // CCSDS K=7 rate 1/2 code, in the bit order used by libcorrect
+    extern const correct_convolutional_polynomial_t CONV_POLY[2];
+
+    // Encoded bits of the ASM (1 = bit set), starting from a zeroed encoder. The first 12 depend on the end of the previous frame.
+    void getEncodedASM(uint8_t* bits);
+
+    // Decodes the soft bits of a single CADU with the Viterbi decoder, removes the randomisation and corrects it with
+    // the four interleaved RS(255,223) codewords. Each thread must have its own instance.
+    class FrameDecoder {
+    public:
+        FrameDecoder();
+        ~FrameDecoder();
+
+        // Soft bits (0 = bit 0, 255 = bit 1) of the frame starting LRPT_VITERBI_MARGIN symbols before the ASM,
+        // LRPT_FRAME_SOFT_BITS long. Gives the VCDU and returns false if any of the codewords could not be corrected.
+        bool decode(const uint8_t* soft, uint8_t* vcdu);
+
+        // Bits of the decoded ASM that were wrong in the last frame
+        int getASMErrors() { return asmErrors; }
+
+    private:
+        correct_convolutional* conv;
+        correct_reed_solomon* rs;
+
+        uint8_t decoded[LRPT_FRAME_SOFT_BITS / 8];
+        uint8_t codeword[LRPT_RS_BLOCK_SIZE];
+        uint8_t corrected[LRPT_RS_BLOCK_SIZE];
+        int asmErrors = 0;
+    };
+
+    // Reassembles the CCSDS packets spread over the VCDUs of each virtual channel
+    class VCDUDemux {
+    public:
+        // VCDUs must be given in the order they were received
+        void process(const uint8_t* vcdu);
+
+        // Drop packets being assembled, for when VCDUs were lost
+        void reset();
+
+        // APID, sequence count, packet data field and its length
+        NewEvent<int, int, const uint8_t*, int> onPacket;
+
+    private:
+        struct VirtualChannel {
+            uint32_t lastCounter;
+            bool synced = false;
+            std::vector<uint8_t> pending;
+        };
+
+        void extractPackets(VirtualChannel& vc);
+
+        std::map<int, VirtualChannel> channels;
+    };
+}
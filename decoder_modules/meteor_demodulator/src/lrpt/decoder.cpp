@@ -0,0 +1,344 @@
+#include "decoder.h"
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+// The first 6 encoded symbols of the ASM depend on the end of the previous frame
+#define LRPT_ASM_SKIP           6
+#define LRPT_ASM_SYMBOLS        32
+
+// Normalised correlation needed to sync and to keep the sync, and how far the next ASM is looked for
+#define LRPT_HUNT_THRESHOLD     0.6f
+#define LRPT_TRACK_THRESHOLD    0.45f
+#define LRPT_SYNC_TOLERANCE     2
+#define LRPT_MAX_SYNC_MISSES    4
+
+#define LRPT_MAX_QUEUED_FRAMES  32
+#define LRPT_MAX_WORKERS        4
+
+// Nominal amplitude of the soft symbols
+#define LRPT_SOFT_SCALE         84
+
+namespace lrpt {
+    // The eight ways the constellation can be rotated or mirrored. A received (I, Q) pair is turned back into the bits
+    // of the encoder by optionally swapping it then flipping the sign of each part.
+    const bool VARIANT_SWAP[8] = { false, false, true, true, true, true, false, false };
+    const int VARIANT_SIGN_A[8] = { 1, -1, -1, 1, 1, -1, 1, -1 };
+    const int VARIANT_SIGN_B[8] = { 1, -1, 1, -1, 1, -1, -1, 1 };
+
+    Decoder::Decoder(int workerCount) {
+        if (workerCount <= 0) {
+            workerCount = std::clamp<int>((int)std::thread::hardware_concurrency() - 1, 1, LRPT_MAX_WORKERS);
+        }
+        this->workerCount = workerCount;
+
+        uint8_t bits[64];
+        getEncodedASM(bits);
+        for (int i = 0; i < 64; i++) { asmPattern[i] = bits[i] ? 1.0f : -1.0f; }
+
+        for (int i = 0; i < LRPT_MAX_QUEUED_FRAMES; i++) {
+            jobPool.push_back(std::make_unique<Job>());
+            freeJobs.push_back(jobPool.back().get());
+        }
+
+        demux.onPacket.bind([=](int apid, int seq, const uint8_t* data, int len) {
+            imager.process(apid, data, len);
+        });
+        imager.onStrip.bind([=](const MSUMR::Strip& strip) {
+            onStrip(strip);
+        });
+    }
+
+    Decoder::~Decoder() {
+        stop();
+    }
+
+    void Decoder::start() {
+        if (running) { return; }
+        running = true;
+        for (int i = 0; i < workerCount; i++) {
+            workers.push_back(std::thread(&Decoder::worker, this));
+        }
+    }
+
+    void Decoder::stop() {
+        if (!running) { return; }
+        {
+            std::lock_guard<std::mutex> lck(jobMtx);
+            running = false;
+        }
+        jobCnd.notify_all();
+        freeCnd.notify_all();
+        for (auto& w : workers) { w.join(); }
+        workers.clear();
+
+        // Drop the frames that weren't decoded, the following ones start a new sequence
+        std::lock_guard<std::mutex> rlck(resultMtx);
+        std::lock_guard<std::mutex> lck(jobMtx);
+        for (Job* job : jobs) { freeJobs.push_back(job); }
+        jobs.clear();
+        for (auto& [index, job] : results) {
+            if (job) { freeJobs.push_back(job); }
+        }
+        results.clear();
+        nextResult = jobIndex;
+        demux.reset();
+    }
+
+    void Decoder::process(const int8_t* in, int count) {
+        if (!running) { return; }
+
+        int old = symbols.size();
+        symbols.resize(old + (count * 2));
+        int8_t* dst = &symbols[old];
+        if (differential) {
+            // Each bit is the change of the matching bit of the previous symbol, which one depends on its quadrant
+            for (int i = 0; i < count; i++) {
+                int8_t I = in[2 * i];
+                int8_t Q = in[(2 * i) + 1];
+                int a = ((int)I * (int)lastI) / LRPT_SOFT_SCALE;
+                int b = ((int)Q * (int)lastQ) / LRPT_SOFT_SCALE;
+                bool cross = (lastI >= 0) != (lastQ >= 0);
+                dst[2 * i] = std::clamp<int>(-(cross ? b : a), -127, 127);
+                dst[(2 * i) + 1] = std::clamp<int>(-(cross ? a : b), -127, 127);
+                lastI = I;
+                lastQ = Q;
+            }
+        }
+        else {
+            memcpy(dst, in, count * 2);
+        }
+
+        int total = symbols.size() / 2;
+        while (true) {
+            if (!locked) {
+                int last = total - LRPT_ASM_SYMBOLS;
+                int v;
+                for (; searchPos <= last; searchPos++) {
+                    if (correlate(searchPos, v) >= LRPT_HUNT_THRESHOLD) { break; }
+                }
+                if (searchPos > last) { break; }
+                locked = true;
+                confirmed = false;
+                frameStart = searchPos;
+                variant = v;
+                misses = 0;
+            }
+
+            // Wait for the whole frame and its margin, the next ASM is within it
+            if (frameStart + LRPT_CADU_BITS + LRPT_VITERBI_MARGIN > total) { break; }
+            int next = frameStart + LRPT_CADU_BITS;
+
+            // A new sync is only trusted once the next ASM is found exactly where it should be
+            if (!confirmed) {
+                int v;
+                if (correlate(next, v) < LRPT_TRACK_THRESHOLD || v != variant) {
+                    locked = false;
+                    searchPos = frameStart + 1;
+                    continue;
+                }
+                confirmed = true;
+            }
+
+            pushFrame(frameStart, variant);
+
+            // Follow small timing slips and phase jumps, or keep going on the expected position for a few frames
+            int pos, v;
+            if (findASM(next - LRPT_SYNC_TOLERANCE, next + LRPT_SYNC_TOLERANCE, pos, v) >= LRPT_TRACK_THRESHOLD) {
+                frameStart = pos;
+                variant = v;
+                misses = 0;
+            }
+            else if (++misses > LRPT_MAX_SYNC_MISSES) {
+                locked = false;
+                searchPos = next - LRPT_SYNC_TOLERANCE;
+            }
+            else {
+                frameStart = next;
+            }
+        }
+        syncLocked = locked && confirmed;
+
+        // Only keep what the next frame might need
+        int keep = (locked ? frameStart : searchPos) - LRPT_VITERBI_MARGIN - LRPT_SYNC_TOLERANCE;
+        if (keep > 0) {
+            symbols.erase(symbols.begin(), symbols.begin() + (keep * 2));
+            frameStart -= keep;
+            searchPos -= keep;
+        }
+    }
+
+    void Decoder::setDifferential(bool differential) {
+        this->differential = differential;
+    }
+
+    void Decoder::setBlocking(bool blocking) {
+        this->blocking = blocking;
+    }
+
+    void Decoder::flush() {
+        {
+            std::unique_lock<std::mutex> lck(jobMtx);
+            freeCnd.wait(lck, [=]() { return freeJobs.size() == jobPool.size() || !running; });
+        }
+        std::lock_guard<std::mutex> lck(resultMtx);
+        imager.flush();
+    }
+
+    void Decoder::reset() {
+        bool wasRunning = running;
+        stop();
+        symbols.clear();
+        lastI = 0;
+        lastQ = 0;
+        locked = false;
+        searchPos = 0;
+        syncLocked = false;
+        imager.reset();
+        frames = 0;
+        framesOK = 0;
+        framesDropped = 0;
+        if (wasRunning) { start(); }
+    }
+
+    Decoder::Stats Decoder::getStats() {
+        Stats stats;
+        stats.locked = syncLocked;
+        stats.frames = frames;
+        stats.framesOK = framesOK;
+        stats.framesDropped = framesDropped;
+        std::lock_guard<std::mutex> lck(resultMtx);
+        stats.strips = imager.getStripCount();
+        return stats;
+    }
+
+    float Decoder::correlate(int pos, int& variant) {
+        const int8_t* s = &symbols[2 * pos];
+        float a = 0.0f, b = 0.0f, c = 0.0f, d = 0.0f;
+        float energy = 0.0f;
+        for (int i = LRPT_ASM_SKIP; i < LRPT_ASM_SYMBOLS; i++) {
+            float I = s[2 * i];
+            float Q = s[(2 * i) + 1];
+            float pI = asmPattern[2 * i];
+            float pQ = asmPattern[(2 * i) + 1];
+            a += pI * I;
+            b += pQ * Q;
+            c += pI * Q;
+            d += pQ * I;
+            energy += fabsf(I) + fabsf(Q);
+        }
+        if (energy == 0.0f) { return 0.0f; }
+
+        // Correlation for each variant, in the order of the variant tables
+        const float scores[8] = { a + b, -(a + b), d - c, c - d, c + d, -(c + d), a - b, b - a };
+        variant = 0;
+        for (int i = 1; i < 8; i++) {
+            if (scores[i] > scores[variant]) { variant = i; }
+        }
+        return scores[variant] / energy;
+    }
+
+    float Decoder::findASM(int from, int to, int& pos, int& variant) {
+        float best = -INFINITY;
+        for (int i = from; i <= to; i++) {
+            int v;
+            float score = correlate(i, v);
+            if (score > best) {
+                best = score;
+                pos = i;
+                variant = v;
+            }
+        }
+        return best;
+    }
+
+    void Decoder::pushFrame(int pos, int variant) {
+        uint64_t index = jobIndex++;
+        Job* job = NULL;
+        {
+            std::unique_lock<std::mutex> lck(jobMtx);
+            if (blocking) { freeCnd.wait(lck, [=]() { return !freeJobs.empty() || !running; }); }
+            if (!freeJobs.empty()) {
+                job = freeJobs.back();
+                freeJobs.pop_back();
+            }
+        }
+
+        // If the workers can't keep up, the frame is lost but must still take its place in the sequence
+        if (!job) {
+            finishJob(index, NULL);
+            return;
+        }
+
+        // Turn the symbols back into the encoded bits, with erasures where the frame begins before the buffer
+        job->index = index;
+        bool swap = VARIANT_SWAP[variant];
+        int signA = VARIANT_SIGN_A[variant];
+        int signB = VARIANT_SIGN_B[variant];
+        int start = pos - LRPT_VITERBI_MARGIN;
+        for (int i = 0; i < LRPT_FRAME_SOFT_BITS / 2; i++) {
+            int n = start + i;
+            if (n < 0) {
+                job->soft[2 * i] = 128;
+                job->soft[(2 * i) + 1] = 128;
+                continue;
+            }
+            int I = symbols[2 * n];
+            int Q = symbols[(2 * n) + 1];
+            job->soft[2 * i] = (swap ? Q : I) * signA + 128;
+            job->soft[(2 * i) + 1] = (swap ? I : Q) * signB + 128;
+        }
+
+        {
+            std::lock_guard<std::mutex> lck(jobMtx);
+            jobs.push_back(job);
+        }
+        jobCnd.notify_one();
+    }
+
+    void Decoder::finishJob(uint64_t index, Job* job) {
+        std::lock_guard<std::mutex> lck(resultMtx);
+        results[index] = job;
+
+        // Handle all results that are now in order
+        while (true) {
+            auto it = results.find(nextResult);
+            if (it == results.end()) { break; }
+            Job* done = it->second;
+            results.erase(it);
+            nextResult++;
+
+            frames++;
+            if (!done) {
+                framesDropped++;
+                continue;
+            }
+            if (done->ok) {
+                framesOK++;
+                demux.process(done->vcdu);
+            }
+
+            {
+                std::lock_guard<std::mutex> jlck(jobMtx);
+                freeJobs.push_back(done);
+            }
+            freeCnd.notify_one();
+        }
+    }
+
+    void Decoder::worker() {
+        FrameDecoder fec;
+        while (true) {
+            Job* job;
+            {
+                std::unique_lock<std::mutex> lck(jobMtx);
+                jobCnd.wait(lck, [=]() { return !jobs.empty() || !running; });
+                if (!running) { return; }
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            job->ok = fec.decode(job->soft, job->vcdu);
+            finishJob(job->index, job);
+        }
+    }
+}
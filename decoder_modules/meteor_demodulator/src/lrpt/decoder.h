@@ -0,0 +1,106 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "ccsds.h"
+#include "msumr.h"
+
+namespace lrpt {
+    // Decodes Meteor LRPT from the soft symbols of the demodulator up to the MSU-MR image strips.
+    // Frame sync runs on the caller's thread. The Viterbi and Reed-Solomon decoding of each frame, the costly part, is
+    // handed to a pool of workers. Their results are put back in order before the packets and images are assembled.
+    class Decoder {
+    public:
+        struct Stats {
+            bool locked;
+            uint64_t frames;
+            uint64_t framesOK;
+            uint64_t framesDropped;
+            int strips;
+        };
+
+        // A worker count of 0 uses all cores but one
+        Decoder(int workerCount = 0);
+        ~Decoder();
+
+        void start();
+        void stop();
+
+        // Soft symbols as I/Q pairs scaled to +/-127, the format of the symbol recordings
+        void process(const int8_t* symbols, int count);
+
+        // Undo the differential coding used by the newer satellites. Can be changed while running.
+        void setDifferential(bool differential);
+
+        // Wait for the workers instead of dropping frames when they can't keep up, for decoding faster than real time
+        void setBlocking(bool blocking);
+
+        // Wait for the frames being decoded and give out the strip being assembled, for the end of a recording
+        void flush();
+
+        // Forget the sync and everything being assembled, for a new pass
+        void reset();
+
+        Stats getStats();
+
+        NewEvent<const MSUMR::Strip&> onStrip;
+
+    private:
+        struct Job {
+            uint64_t index;
+            uint8_t soft[LRPT_FRAME_SOFT_BITS];
+            uint8_t vcdu[LRPT_VCDU_SIZE];
+            bool ok;
+        };
+
+        float correlate(int pos, int& variant);
+        float findASM(int from, int to, int& pos, int& variant);
+        void pushFrame(int pos, int variant);
+        void finishJob(uint64_t index, Job* job);
+        void worker();
+
+        // Sync
+        std::vector<int8_t> symbols;
+        int8_t lastI = 0;
+        int8_t lastQ = 0;
+        std::atomic<bool> differential = false;
+        bool locked = false;
+        bool confirmed = false;
+        int searchPos = 0;
+        int frameStart = 0;
+        int variant = 0;
+        int misses = 0;
+        float asmPattern[64];
+
+        // Workers
+        int workerCount;
+        std::vector<std::thread> workers;
+        std::mutex jobMtx;
+        std::condition_variable jobCnd;
+        std::condition_variable freeCnd;
+        std::deque<Job*> jobs;
+        std::vector<std::unique_ptr<Job>> jobPool;
+        std::vector<Job*> freeJobs;
+        bool running = false;
+        bool blocking = false;
+        uint64_t jobIndex = 0;
+
+        // Results in order
+        std::mutex resultMtx;
+        std::map<uint64_t, Job*> results;
+        uint64_t nextResult = 0;
+        VCDUDemux demux;
+        MSUMR imager;
+
+        std::atomic<uint64_t> frames = 0;
+        std::atomic<uint64_t> framesOK = 0;
+        std::atomic<uint64_t> framesDropped = 0;
+        std::atomic<bool> syncLocked = false;
+    };
+}
@@ -0,0 +1,274 @@
+#include "msumr.h"
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#define MSUMR_TIMESTAMP_SIZE    8
+#define MSUMR_HEADER_SIZE       6
+#define MSUMR_MS_PER_DAY        86400000
+
+// Bounds of the time between two strips, other values come from broken timestamps
+#define MSUMR_MIN_STRIP_PERIOD  500
+#define MSUMR_MAX_STRIP_PERIOD  3000
+#define MSUMR_MAX_LOST_STRIPS   16
+
+namespace lrpt {
+    const int ZIGZAG[64] = {
+        0, 1, 8, 16, 9, 2, 3, 10,
+        17, 24, 32, 25, 18, 11, 4, 5,
+        12, 19, 26, 33, 40, 48, 41, 34,
+        27, 20, 13, 6, 7, 14, 21, 28,
+        35, 42, 49, 56, 57, 50, 43, 36,
+        29, 22, 15, 23, 30, 37, 44, 51,
+        58, 59, 52, 45, 38, 31, 39, 46,
+        53, 60, 61, 54, 47, 55, 62, 63
+    };
+
+    // Standard JPEG luminance quantization table, in natural order
+    const int STD_QUANT[64] = {
+        16, 11, 10, 16, 24, 40, 51, 61,
+        12, 12, 14, 19, 26, 58, 60, 55,
+        14, 13, 16, 24, 40, 57, 69, 56,
+        14, 17, 22, 29, 51, 87, 80, 62,
+        18, 22, 37, 56, 68, 109, 103, 77,
+        24, 35, 55, 64, 81, 104, 113, 92,
+        49, 64, 78, 87, 103, 121, 120, 101,
+        72, 92, 95, 98, 112, 100, 103, 99
+    };
+
+    // Standard JPEG luminance Huffman tables, code count per length and values
+    const uint8_t DC_BITS[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+    const uint8_t DC_VALS[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    const uint8_t AC_BITS[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D };
+    const uint8_t AC_VALS[162] = {
+        0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+        0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+        0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+        0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+        0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+        0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+        0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+        0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+        0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+        0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+        0xF9, 0xFA
+    };
+
+    // Canonical Huffman decoding tables as in the JPEG standard (F.2.2.3)
+    struct HuffmanTable {
+        HuffmanTable(const uint8_t* bits, const uint8_t* vals) {
+            this->vals = vals;
+            int code = 0;
+            int index = 0;
+            for (int len = 1; len <= 16; len++) {
+                valPtr[len] = index;
+                minCode[len] = code;
+                code += bits[len - 1];
+                index += bits[len - 1];
+                maxCode[len] = bits[len - 1] ? (code - 1) : -1;
+                code <<= 1;
+            }
+        }
+
+        int minCode[17];
+        int maxCode[17];
+        int valPtr[17];
+        const uint8_t* vals;
+    };
+
+    static const HuffmanTable dcTable(DC_BITS, DC_VALS);
+    static const HuffmanTable acTable(AC_BITS, AC_VALS);
+
+    // Basis of the separable 8x8 inverse DCT
+    struct IDCTTable {
+        IDCTTable() {
+            for (int x = 0; x < 8; x++) {
+                for (int u = 0; u < 8; u++) {
+                    float cu = (u == 0) ? (1.0f / sqrtf(2.0f)) : 1.0f;
+                    cos[x][u] = 0.5f * cu * cosf((float)((2 * x + 1) * u) * 3.14159265358979f / 16.0f);
+                }
+            }
+        }
+
+        float cos[8][8];
+    };
+
+    static const IDCTTable idct;
+
+    class BitReader {
+    public:
+        BitReader(const uint8_t* data, int len) {
+            this->data = data;
+            bitsLeft = len * 8;
+        }
+
+        // Returns -1 once the data is exhausted
+        inline int bit() {
+            if (bitsLeft <= 0) { return -1; }
+            int b = (data[pos >> 3] >> (7 - (pos & 7))) & 1;
+            pos++;
+            bitsLeft--;
+            return b;
+        }
+
+        inline int bits(int count) {
+            int val = 0;
+            for (int i = 0; i < count; i++) {
+                int b = bit();
+                if (b < 0) { return -1; }
+                val = (val << 1) | b;
+            }
+            return val;
+        }
+
+        inline int decode(const HuffmanTable& table) {
+            int code = 0;
+            for (int len = 1; len <= 16; len++) {
+                int b = bit();
+                if (b < 0) { return -1; }
+                code = (code << 1) | b;
+                if (table.maxCode[len] >= 0 && code <= table.maxCode[len]) {
+                    return table.vals[table.valPtr[len] + code - table.minCode[len]];
+                }
+            }
+            return -1;
+        }
+
+    private:
+        const uint8_t* data;
+        int pos = 0;
+        int bitsLeft;
+    };
+
+    // Sign extension of a coefficient of the given size
+    static inline int extend(int val, int size) {
+        return (val < (1 << (size - 1))) ? (val - (1 << size) + 1) : val;
+    }
+
+    MSUMR::MSUMR() {
+        strip = std::make_unique<Strip>();
+        reset();
+    }
+
+    void MSUMR::process(int apid, const uint8_t* data, int len) {
+        int ch = apid - MSUMR_FIRST_APID;
+        if (ch < 0 || ch >= MSUMR_CHANNEL_COUNT) { return; }
+        if (len < MSUMR_TIMESTAMP_SIZE + MSUMR_HEADER_SIZE) { return; }
+
+        uint32_t time = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 8) | data[5];
+        const uint8_t* hdr = &data[MSUMR_TIMESTAMP_SIZE];
+        int mcu = hdr[0];
+        int quality = hdr[5];
+        if ((mcu % MSUMR_MCU_PER_PACKET) || mcu >= MSUMR_MCU_PER_LINE) { return; }
+
+        // A channel going back to the left edge, or a packet much later than the start of the strip, begins a new one
+        uint32_t dt = haveTime ? ((time + MSUMR_MS_PER_DAY - lastTime) % MSUMR_MS_PER_DAY) : 0;
+        bool restart = strip->present[ch] && mcu <= lastMCU[ch];
+        bool late = period && dt > (period / 2);
+        if (!empty && (restart || late)) {
+            emitStrip();
+            if (dt >= MSUMR_MIN_STRIP_PERIOD && dt <= MSUMR_MAX_STRIP_PERIOD && (!period || dt < period)) { period = dt; }
+            if (period) {
+                int lost = std::clamp<int>(((dt + (period / 2)) / period) - 1, 0, MSUMR_MAX_LOST_STRIPS);
+                for (int i = 0; i < lost; i++) { emitStrip(); }
+            }
+        }
+        if (empty) {
+            lastTime = time;
+            haveTime = true;
+        }
+
+        lastMCU[ch] = mcu;
+        strip->present[ch] = true;
+        empty = false;
+        const uint8_t* jpeg = &hdr[MSUMR_HEADER_SIZE];
+        decodePacket(jpeg, len - MSUMR_TIMESTAMP_SIZE - MSUMR_HEADER_SIZE, quality, &strip->pixels[ch][mcu * 8]);
+    }
+
+    void MSUMR::flush() {
+        if (!empty) { emitStrip(); }
+    }
+
+    void MSUMR::reset() {
+        memset(strip->present, 0, sizeof(strip->present));
+        memset(strip->pixels, 0, sizeof(strip->pixels));
+        for (int i = 0; i < MSUMR_CHANNEL_COUNT; i++) { lastMCU[i] = -1; }
+        empty = true;
+        stripCount = 0;
+        haveTime = false;
+        period = 0;
+    }
+
+    bool MSUMR::decodePacket(const uint8_t* data, int len, int quality, uint8_t* dst) {
+        // Quantization table scaled by the quality of the packet
+        float f = (quality > 20 && quality < 50) ? (5000.0f / (float)quality) : (200.0f - 2.0f * (float)quality);
+        int quant[64];
+        for (int i = 0; i < 64; i++) {
+            quant[i] = std::max<int>(1, roundf(f / 100.0f * (float)STD_QUANT[i]));
+        }
+
+        BitReader br(data, len);
+        int dc = 0;
+        for (int m = 0; m < MSUMR_MCU_PER_PACKET; m++) {
+            float coefs[64] = { 0 };
+
+            // DC is coded as a difference to the previous block of the packet
+            int size = br.decode(dcTable);
+            if (size < 0) { return false; }
+            if (size) {
+                int val = br.bits(size);
+                if (val < 0) { return false; }
+                dc += extend(val, size);
+            }
+            coefs[0] = (float)(dc * quant[0]);
+
+            // AC is coded as runs of zeros followed by a value
+            for (int k = 1; k < 64;) {
+                int rs = br.decode(acTable);
+                if (rs < 0) { return false; }
+                int run = rs >> 4;
+                size = rs & 0x0F;
+                if (!size) {
+                    if (run != 15) { break; }
+                    k += 16;
+                    continue;
+                }
+                k += run;
+                if (k >= 64) { return false; }
+                int val = br.bits(size);
+                if (val < 0) { return false; }
+                int n = ZIGZAG[k];
+                coefs[n] = (float)(extend(val, size) * quant[n]);
+                k++;
+            }
+
+            // Inverse DCT of the rows then the columns
+            float tmp[64];
+            for (int v = 0; v < 8; v++) {
+                for (int x = 0; x < 8; x++) {
+                    float acc = 0.0f;
+                    for (int u = 0; u < 8; u++) { acc += idct.cos[x][u] * coefs[v * 8 + u]; }
+                    tmp[v * 8 + x] = acc;
+                }
+            }
+            uint8_t* block = &dst[m * 8];
+            for (int y = 0; y < 8; y++) {
+                for (int x = 0; x < 8; x++) {
+                    float acc = 0.0f;
+                    for (int v = 0; v < 8; v++) { acc += idct.cos[y][v] * tmp[v * 8 + x]; }
+                    block[y * MSUMR_WIDTH + x] = std::clamp<int>(roundf(acc + 128.0f), 0, 255);
+                }
+            }
+        }
+        return true;
+    }
+
+    void MSUMR::emitStrip() {
+        onStrip(*strip);
+        stripCount++;
+        memset(strip->present, 0, sizeof(strip->present));
+        memset(strip->pixels, 0, sizeof(strip->pixels));
+        for (int i = 0; i < MSUMR_CHANNEL_COUNT; i++) { lastMCU[i] = -1; }
+        empty = true;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <utils/new_event.h>
+
+#define MSUMR_FIRST_APID        64
+#define MSUMR_CHANNEL_COUNT     6
+#define MSUMR_MCU_PER_PACKET    14
+#define MSUMR_MCU_PER_LINE      196
+#define MSUMR_WIDTH             (MSUMR_MCU_PER_LINE * 8)
+#define MSUMR_STRIP_HEIGHT      8
+
+namespace lrpt {
+    // Assembles the JPEG compressed packets of the MSU-MR imager into strips of 8 lines for each of its six channels.
+    // Each packet holds 14 blocks of 8x8 pixels of a single channel, a strip is complete once the blocks of every channel
+    // restart from the left edge.
+    class MSUMR {
+    public:
+        struct Strip {
+            bool present[MSUMR_CHANNEL_COUNT];
+            uint8_t pixels[MSUMR_CHANNEL_COUNT][MSUMR_WIDTH * MSUMR_STRIP_HEIGHT];
+        };
+
+        MSUMR();
+
+        // Packets of other APIDs are ignored
+        void process(int apid, const uint8_t* data, int len);
+
+        // Give out the strip being assembled
+        void flush();
+
+        void reset();
+
+        int getStripCount() { return stripCount; }
+
+        // Strips are given in order, blank strips stand in for the ones that were lost
+        NewEvent<const Strip&> onStrip;
+
+    private:
+        bool decodePacket(const uint8_t* data, int len, int quality, uint8_t* dst);
+        void emitStrip();
+
+        std::unique_ptr<Strip> strip;
+        bool empty = true;
+        int lastMCU[MSUMR_CHANNEL_COUNT];
+        int stripCount = 0;
+
+        // Scan timing, used to find how many strips were lost
+        bool haveTime = false;
+        uint32_t lastTime;
+        uint32_t period = 0;
+    };
+}
@@ -13,8 +13,11 @@
 #include <meteor_demodulator_interface.h>
 #include <gui/widgets/folder_select.h>
 #include <gui/widgets/constellation_diagram.h>
-
-#include <fstream>
+#include <gui/widgets/line_push_image.h>
+#include <utils/optionlist.h>
+#include <array>
+#include "symbol_writer.h"
+#include "lrpt/decoder.h"
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
@@ -40,10 +43,16 @@ std::string genFileName(std::string prefix, std::string suffix) {
 
 class MeteorDemodulatorModule : public ModuleManager::Instance {
 public:
-    MeteorDemodulatorModule(std::string name) : folderSelect("%ROOT%/recordings") {
+    MeteorDemodulatorModule(std::string name) : image(MSUMR_WIDTH, 512), folderSelect("%ROOT%/recordings") {
         this->name = name;
 
-        writeBuffer = new int8_t[STREAM_BUFFER_SIZE];
+        // Channels shown as red, green and blue
+        composites.define("123", "RGB 123", { 0, 1, 2 });
+        composites.define("221", "RGB 221", { 1, 1, 0 });
+        composites.define("125", "RGB 125", { 0, 1, 4 });
+        for (int i = 0; i < MSUMR_CHANNEL_COUNT; i++) {
+            composites.define(std::to_string(i + 1), "Channel " + std::to_string(i + 1), { i, i, i });
+        }
 
         // Load config
         config.acquire();
@@ -60,7 +69,23 @@ public:
         if (config.conf[name].contains("oqpsk")) {
             oqpsk = config.conf[name]["oqpsk"];
         }
+        if (config.conf[name].contains("decode")) {
+            decode = config.conf[name]["decode"].get<bool>();
+        }
+        if (config.conf[name].contains("differential")) {
+            differential = config.conf[name]["differential"];
+        }
+        std::string composite = "123";
+        if (config.conf[name].contains("composite")) {
+            composite = config.conf[name]["composite"];
+        }
         config.release();
+        if (!composites.keyExists(composite)) { composite = "123"; }
+        compositeId = composites.keyId(composite);
+        stripCompositeId = compositeId;
+
+        decoder.setDifferential(differential);
+        decoder.onStrip.bind(&MeteorDemodulatorModule::stripHandler, this);
 
         vfo = sigpath::vfoManager.createVFO(name, ImGui::WaterfallVFO::REF_CENTER, 0, INPUT_SAMPLE_RATE, INPUT_SAMPLE_RATE, INPUT_SAMPLE_RATE, INPUT_SAMPLE_RATE, true);
         demod.init(vfo->output, 72000.0f, INPUT_SAMPLE_RATE, 33, 0.6f, 0.1f, 0.005f, brokenModulation, oqpsk, 1e-6, 0.01);
@@ -71,6 +96,7 @@ public:
         symSink.init(&reshape.out, symSinkHandler, this);
         sink.init(&sinkStream, sinkHandler, this);
 
+        decoder.start();
         demod.start();
         split.start();
         reshape.start();
@@ -92,6 +118,7 @@ public:
         reshape.stop();
         symSink.stop();
         sink.stop();
+        decoder.stop();
         sigpath::vfoManager.deleteVFO(vfo);
         gui::menu.removeEntry(name);
     }
@@ -105,6 +132,7 @@ public:
         demod.setBrokenModulation(brokenModulation);
         demod.setInput(vfo->output);
 
+        decoder.start();
         demod.start();
         split.start();
         reshape.start();
@@ -120,6 +148,7 @@ public:
         reshape.stop();
         symSink.stop();
         sink.stop();
+        decoder.stop();
 
         sigpath::vfoManager.deleteVFO(vfo);
         enabled = false;
@@ -168,7 +197,11 @@ private:
             if (ImGui::Button(CONCAT("Stop##meteor_rec_", _this->name), ImVec2(menuWidth, 0))) {
                 _this->stopRecording();
             }
-            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Recording %.2fMB", (float)_this->dataWritten / 1000000.0f);
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Recording %.2fMB", (float)_this->recFile.getWritten() / 1000000.0f);
+            if (_this->recFile.getDropped()) {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "(%.2fMB lost)", (float)_this->recFile.getDropped() / 1000000.0f);
+            }
         }
         else {
             if (ImGui::Button(CONCAT("Record##meteor_rec_", _this->name), ImVec2(menuWidth, 0))) {
@@ -179,6 +212,62 @@ private:
 
         if (!_this->folderSelect.pathIsValid() && _this->enabled) { style::endDisabled(); }
 
+        // Read by the DSP thread, hence the copy for ImGui
+        bool decode = _this->decode;
+        if (ImGui::Checkbox(CONCAT("Decode LRPT##meteor_decode_", _this->name), &decode)) {
+            _this->decode = decode;
+            config.acquire();
+            config.conf[_this->name]["decode"] = decode;
+            config.release(true);
+        }
+
+        if (decode) {
+            if (ImGui::Checkbox(CONCAT("Differential##meteor_diff_", _this->name), &_this->differential)) {
+                _this->decoder.setDifferential(_this->differential);
+                config.acquire();
+                config.conf[_this->name]["differential"] = _this->differential;
+                config.release(true);
+            }
+
+            ImGui::LeftLabel("Composite");
+            ImGui::FillWidth();
+            if (ImGui::Combo(CONCAT("##meteor_composite_", _this->name), &_this->compositeId, _this->composites.txt)) {
+                config.acquire();
+                _this->stripCompositeId = _this->compositeId;
+                config.conf[_this->name]["composite"] = _this->composites.key(_this->compositeId);
+                config.release(true);
+            }
+
+            lrpt::Decoder::Stats stats = _this->decoder.getStats();
+            if (stats.locked) {
+                ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Locked");
+            }
+            else {
+                ImGui::TextUnformatted("Searching");
+            }
+            ImGui::SameLine();
+            ImGui::Text("Frames: %llu/%llu, Lines: %d", (unsigned long long)stats.framesOK, (unsigned long long)stats.frames, stats.strips * MSUMR_STRIP_HEIGHT);
+            if (stats.framesDropped) {
+                ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "%llu frames dropped, decoding too slow", (unsigned long long)stats.framesDropped);
+            }
+
+            // Keep showing the newest lines unless scrolled up
+            if (ImGui::BeginChild(CONCAT("##meteor_image_", _this->name), ImVec2(menuWidth, 300.0f * style::uiScale), true)) {
+                bool follow = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+                ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+                _this->image.draw();
+                if (follow) { ImGui::SetScrollHereY(1.0f); }
+            }
+            ImGui::EndChild();
+
+            if (ImGui::Button(CONCAT("Reset##meteor_reset_", _this->name), ImVec2(menuWidth, 0))) {
+                _this->sink.stop();
+                _this->decoder.reset();
+                _this->image.clear();
+                _this->sink.start();
+            }
+        }
+
         if (!_this->enabled) { style::endDisabled(); }
     }
 
@@ -192,22 +281,38 @@ private:
 
     static void sinkHandler(dsp::complex_t* data, int count, void* ctx) {
         MeteorDemodulatorModule* _this = (MeteorDemodulatorModule*)ctx;
-        std::lock_guard<std::mutex> lck(_this->recMtx);
-        if (!_this->recording) { return; }
+        if (!_this->decode && !_this->recording) { return; }
+
+        // Soft symbols in the format of the recordings, also used by the decoder
+        _this->softBuffer.resize(count * 2);
+        int8_t* soft = _this->softBuffer.data();
         for (int i = 0; i < count; i++) {
-            _this->writeBuffer[(2 * i)] = std::clamp<int>(data[i].re * 84.0f, -127, 127);
-            _this->writeBuffer[(2 * i) + 1] = std::clamp<int>(data[i].im * 84.0f, -127, 127);
+            soft[(2 * i)] = std::clamp<int>(data[i].re * 84.0f, -127, 127);
+            soft[(2 * i) + 1] = std::clamp<int>(data[i].im * 84.0f, -127, 127);
         }
-        _this->recFile.write((char*)_this->writeBuffer, count * 2);
-        _this->dataWritten += count * 2;
+
+        if (_this->decode) { _this->decoder.process(soft, count); }
+
+        std::lock_guard<std::mutex> lck(_this->recMtx);
+        if (_this->recording) { _this->recFile.write(soft, count * 2); }
+    }
+
+    void stripHandler(const lrpt::MSUMR::Strip& strip) {
+        const std::array<int, 3>& chans = composites.value(stripCompositeId);
+        uint8_t* line = image.acquireNextLine(MSUMR_STRIP_HEIGHT);
+        for (int i = 0; i < MSUMR_WIDTH * MSUMR_STRIP_HEIGHT; i++) {
+            line[(4 * i)] = strip.present[chans[0]] ? strip.pixels[chans[0]][i] : 0;
+            line[(4 * i) + 1] = strip.present[chans[1]] ? strip.pixels[chans[1]][i] : 0;
+            line[(4 * i) + 2] = strip.present[chans[2]] ? strip.pixels[chans[2]][i] : 0;
+            line[(4 * i) + 3] = 255;
+        }
+        image.releaseNextLine();
     }
 
     void startRecording() {
         std::lock_guard<std::mutex> lck(recMtx);
-        dataWritten = 0;
         std::string filename = genFileName(folderSelect.expandString(folderSelect.path) + "/meteor", ".s");
-        recFile = std::ofstream(filename, std::ios::binary);
-        if (recFile.is_open()) {
+        if (recFile.open(filename)) {
             flog::info("Recording to '{0}'", filename);
             recording = true;
         }
@@ -220,7 +325,6 @@ private:
         std::lock_guard<std::mutex> lck(recMtx);
         recording = false;
         recFile.close();
-        dataWritten = 0;
     }
 
     static void moduleInterfaceHandler(int code, void* in, void* out, void* ctx) {
@@ -247,17 +351,25 @@ private:
     dsp::sink::Handler<dsp::complex_t> symSink;
     dsp::sink::Handler<dsp::complex_t> sink;
 
+    lrpt::Decoder decoder;
+
     ImGui::ConstellationDiagram constDiagram;
+    ImGui::LinePushImage image;
 
     FolderSelect folderSelect;
 
     std::mutex recMtx;
     bool recording = false;
-    uint64_t dataWritten = 0;
-    std::ofstream recFile;
+    SymbolWriter recFile;
+    std::vector<int8_t> softBuffer;
     bool brokenModulation = false;
     bool oqpsk = false;
-    int8_t* writeBuffer;
+    std::atomic<bool> decode = true;
+    bool differential = false;
+
+    OptionList<std::string, std::array<int, 3>> composites;
+    int compositeId = 0;
+    std::atomic<int> stripCompositeId = 0;  // Copy of compositeId read by the decoder thread
 };
 
 MOD_EXPORT void _INIT_() {
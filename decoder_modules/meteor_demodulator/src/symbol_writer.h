@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <stdint.h>
+
+#define SYMBOL_WRITER_MAX_QUEUED    256
+
+// Writes soft symbols to a file from its own thread so that a slow disk never stalls the DSP.
+// Blocks are queued up to a limit, past which they are dropped and counted.
+class SymbolWriter {
+public:
+    ~SymbolWriter() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        file = std::ofstream(path, std::ios::binary);
+        if (!file.is_open()) { return false; }
+        written = 0;
+        dropped = 0;
+        stopWorker = false;
+        workerThread = std::thread(&SymbolWriter::worker, this);
+        return true;
+    }
+
+    // Everything already queued is written before the file is closed
+    void close() {
+        if (!workerThread.joinable()) { return; }
+        {
+            std::lock_guard<std::mutex> lck(queueMtx);
+            stopWorker = true;
+        }
+        queueCnd.notify_all();
+        workerThread.join();
+        file.close();
+    }
+
+    void write(const int8_t* data, int count) {
+        {
+            std::lock_guard<std::mutex> lck(queueMtx);
+            if (stopWorker || !workerThread.joinable()) { return; }
+            if (queue.size() >= SYMBOL_WRITER_MAX_QUEUED) {
+                dropped += count;
+                return;
+            }
+
+            // Reuse the blocks already written to avoid allocating on the DSP thread
+            std::vector<int8_t> block;
+            if (!spares.empty()) {
+                block = std::move(spares.back());
+                spares.pop_back();
+            }
+            block.assign(data, &data[count]);
+            queue.push_back(std::move(block));
+        }
+        queueCnd.notify_one();
+    }
+
+    uint64_t getWritten() { return written; }
+    uint64_t getDropped() { return dropped; }
+
+private:
+    void worker() {
+        while (true) {
+            std::vector<int8_t> block;
+            {
+                std::unique_lock<std::mutex> lck(queueMtx);
+                queueCnd.wait(lck, [=]() { return !queue.empty() || stopWorker; });
+                if (queue.empty()) { return; }
+                block = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            file.write((char*)block.data(), block.size());
+            written += block.size();
+
+            std::lock_guard<std::mutex> lck(queueMtx);
+            if (spares.size() < SYMBOL_WRITER_MAX_QUEUED) { spares.push_back(std::move(block)); }
+        }
+    }
+
+    std::ofstream file;
+    std::thread workerThread;
+    std::mutex queueMtx;
+    std::condition_variable queueCnd;
+    std::deque<std::vector<int8_t>> queue;
+    std::vector<std::vector<int8_t>> spares;
+    bool stopWorker = false;
+
+    std::atomic<uint64_t> written = 0;
+    std::atomic<uint64_t> dropped = 0;
+};
@@ -9,6 +9,7 @@
 #include <utils/optionlist.h>
 #include "decoder.h"
 #include "pocsag/decoder.h"
+#include "pocsag/multi_decoder.h"
 #include "flex/decoder.h"
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
@@ -26,6 +27,7 @@ ConfigManager config;
 enum Protocol {
     PROTOCOL_INVALID = -1,
     PROTOCOL_POCSAG,
+    PROTOCOL_POCSAG_MULTI,
     PROTOCOL_FLEX
 };
 
@@ -36,6 +38,7 @@ public:
 
         // Define protocols
         protocols.define("POCSAG", PROTOCOL_POCSAG);
+        protocols.define("POCSAG (Multi-channel)", PROTOCOL_POCSAG_MULTI);
         //protocols.define("FLEX", PROTOCOL_FLEX);
 
         // Initialize VFO with default values
@@ -98,6 +101,9 @@ public:
         case PROTOCOL_POCSAG:
             decoder = std::make_unique<POCSAGDecoder>(name, vfo);
             break;
+        case PROTOCOL_POCSAG_MULTI:
+            decoder = std::make_unique<POCSAGMultiDecoder>(name, vfo, &config);
+            break;
         case PROTOCOL_FLEX:
             decoder = std::make_unique<FLEXDecoder>(name, vfo);
             break;
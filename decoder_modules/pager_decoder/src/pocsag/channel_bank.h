@@ -0,0 +1,291 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <fftw3.h>
+#include <dsp/sink.h>
+#include <dsp/pipeline.h>
+#include <dsp/demod/quadrature.h>
+#include <dsp/filter/fir.h>
+#include <dsp/clock_recovery/mm.h>
+#include <dsp/taps/tap_cache.h>
+#include <utils/new_event.h>
+#include "pocsag.h"
+
+#define POCSAG_CHANNEL_SAMPLERATE   24000.0
+#define POCSAG_CHANNEL_BANDWIDTH    12500.0
+
+// Decodes POCSAG on a list of channels out of one wideband stream at a multiple of the channel samplerate.
+// The channels are cut out by a fast convolution filter bank: a single forward FFT of the input is shared by all
+// channels, each channel then only filters the bins around its frequency and runs a small inverse FFT at the
+// channel rate. Every channel has its own discriminator followed by a detector for each enabled baudrate.
+class POCSAGChannelBank : public dsp::Sink<dsp::complex_t> {
+    using base_type = dsp::Sink<dsp::complex_t>;
+public:
+    struct Message {
+        std::chrono::system_clock::time_point time;
+        double frequency;
+        int baudrate;
+        pocsag::Address address;
+        pocsag::MessageType type;
+        std::string text;
+    };
+
+    POCSAGChannelBank() {}
+
+    POCSAGChannelBank(dsp::stream<dsp::complex_t>* in, int decimation) { init(in, decimation); }
+
+    ~POCSAGChannelBank() {
+        if (!base_type::_block_init) { return; }
+        base_type::stop();
+        channels.clear();
+        freeFFT();
+        fftwf_destroy_plan(chanPlan);
+        fftwf_free(chanIn);
+        fftwf_free(chanOut);
+        dsp::buffer::free(chanResp);
+        dsp::buffer::free(iq);
+        dsp::buffer::free(fm);
+        dsp::buffer::free(soft);
+    }
+
+    void init(dsp::stream<dsp::complex_t>* in, int decimation) {
+        _decimation = decimation;
+
+        // Per channel work buffers, shared since the channels are processed one after the other
+        chanIn = (fftwf_complex*)fftwf_malloc(CHANNEL_FFT_SIZE * sizeof(fftwf_complex));
+        chanOut = (fftwf_complex*)fftwf_malloc(CHANNEL_FFT_SIZE * sizeof(fftwf_complex));
+        chanPlan = fftwf_plan_dft_1d(CHANNEL_FFT_SIZE, chanIn, chanOut, FFTW_BACKWARD, FFTW_ESTIMATE);
+        chanResp = dsp::buffer::alloc<dsp::complex_t>(CHANNEL_FFT_SIZE);
+        iq = dsp::buffer::alloc<dsp::complex_t>(CHANNEL_BLOCK_SIZE);
+        fm = dsp::buffer::alloc<float>(CHANNEL_BLOCK_SIZE);
+        soft = dsp::buffer::alloc<float>(CHANNEL_BLOCK_SIZE);
+
+        allocFFT();
+        base_type::init(in);
+    }
+
+    // The input samplerate is the channel samplerate times the decimation
+    void setDecimation(int decimation) {
+        assert(base_type::_block_init);
+        std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+        base_type::tempStop();
+        _decimation = decimation;
+        freeFFT();
+        allocFFT();
+        updateBins();
+        base_type::tempStart();
+    }
+
+    static inline double getInputSamplerate(int decimation) {
+        return POCSAG_CHANNEL_SAMPLERATE * (double)decimation;
+    }
+
+    // Frequency at the center of the input, used to place the channels
+    void setCenterFrequency(double frequency) {
+        assert(base_type::_block_init);
+        std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+        base_type::tempStop();
+        centerFreq = frequency;
+        updateBins();
+        base_type::tempStart();
+    }
+
+    // Replaces all channels, each one gets a detector for every baudrate given
+    void setChannels(const std::vector<double>& frequencies, const std::vector<int>& baudrates) {
+        assert(base_type::_block_init);
+        std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+        base_type::tempStop();
+        channels.clear();
+        for (double freq : frequencies) {
+            auto chan = std::make_unique<Channel>();
+            chan->frequency = freq;
+            chan->demod.init(NULL, -4500.0, POCSAG_CHANNEL_SAMPLERATE);
+            chan->demod.out.free();
+            for (int baud : baudrates) {
+                chan->detectors.push_back(std::make_unique<Detector>(baud));
+                Detector* det = chan->detectors.back().get();
+                det->decoder.onMessage.bind([=](pocsag::Address addr, pocsag::MessageType type, const std::string& msg) {
+                    onMessage({ std::chrono::system_clock::now(), freq, baud, addr, type, msg });
+                });
+            }
+            channels.push_back(std::move(chan));
+        }
+        updateBins();
+        base_type::tempStart();
+    }
+
+    // True if the channel lies inside the input band
+    bool isChannelInBand(int id) {
+        std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+        if (id < 0 || id >= channels.size()) { return false; }
+        return channels[id]->inBand;
+    }
+
+    int run() {
+        int count = base_type::_in->read();
+        if (count < 0) { return -1; }
+
+        // Accumulate the input until a full FFT block is available
+        const dsp::complex_t* data = base_type::_in->readBuf;
+        while (count > 0) {
+            int toCopy = std::min<int>(count, fftSize - fill);
+            memcpy(&fftIn[fill], data, toCopy * sizeof(dsp::complex_t));
+            fill += toCopy;
+            data += toCopy;
+            count -= toCopy;
+            if (fill < fftSize) { break; }
+
+            processBlock();
+
+            // Keep the overlap for the next block
+            int keep = fftSize - hopSize;
+            memmove(fftIn, &fftIn[hopSize], keep * sizeof(dsp::complex_t));
+            fill = keep;
+        }
+
+        base_type::_in->flush();
+        return count;
+    }
+
+    NewEvent<const Message&> onMessage;
+
+private:
+    struct Detector {
+        Detector(int baudrate) {
+            this->baudrate = baudrate;
+
+            // Integrate over one symbol before the clock recovery
+            double sps = POCSAG_CHANNEL_SAMPLERATE / (double)baudrate;
+            int shapeLen = std::max<int>(1, round(sps));
+            shape = dsp::taps::alloc<float>(shapeLen);
+            for (int i = 0; i < shapeLen; i++) { shape.taps[i] = 1.0f / (float)shapeLen; }
+
+            chain.get<0>().init(NULL, shape);
+            chain.get<1>().init(NULL, sps, 1e-4, 1.0, 0.05);
+            chain.init(NULL);
+            chain.out.free();
+        }
+
+        ~Detector() {
+            dsp::taps::free(shape);
+        }
+
+        int baudrate;
+        dsp::tap<float> shape;
+        dsp::Pipeline<dsp::filter::FIR<float, float>, dsp::clock_recovery::MM<float>> chain;
+        pocsag::Decoder decoder;
+    };
+
+    struct Channel {
+        double frequency;
+        int bin = 0;
+        bool inBand = false;
+
+        // Phase correction between FFT blocks
+        dsp::complex_t rot = { 1.0f, 0.0f };
+        dsp::complex_t rotStep = { 1.0f, 0.0f };
+
+        dsp::demod::Quadrature demod;
+        std::vector<std::unique_ptr<Detector>> detectors;
+    };
+
+    void processBlock() {
+        fftwf_execute(fftPlan);
+
+        for (auto& chan : channels) {
+            if (!chan->inBand) { continue; }
+
+            // Take the bins around the channel and filter them, the small FFT has the same bin spacing
+            for (int i = 0; i < CHANNEL_FFT_SIZE; i++) {
+                int rel = (i < CHANNEL_FFT_SIZE / 2) ? i : (i - CHANNEL_FFT_SIZE);
+                int src = (chan->bin + rel + fftSize) % fftSize;
+                const dsp::complex_t& h = chanResp[i];
+                chanIn[i][0] = fftOut[src][0] * h.re - fftOut[src][1] * h.im;
+                chanIn[i][1] = fftOut[src][0] * h.im + fftOut[src][1] * h.re;
+            }
+            fftwf_execute(chanPlan);
+
+            // Drop the wrapped around part and make the phase continuous from one block to the next
+            const dsp::complex_t* valid = (const dsp::complex_t*)&chanOut[CHANNEL_FFT_SIZE - CHANNEL_BLOCK_SIZE];
+            volk_32fc_s32fc_multiply_32fc((lv_32fc_t*)iq, (const lv_32fc_t*)valid, *(lv_32fc_t*)&chan->rot, CHANNEL_BLOCK_SIZE);
+            chan->rot = chan->rot * chan->rotStep;
+            chan->rot = chan->rot / chan->rot.amplitude();
+
+            // Demodulate and run every detector on the discriminator output
+            chan->demod.process(CHANNEL_BLOCK_SIZE, iq, fm);
+            for (auto& det : chan->detectors) {
+                int count = det->chain.process(CHANNEL_BLOCK_SIZE, fm, soft);
+                det->decoder.process(soft, count);
+            }
+        }
+    }
+
+    void allocFFT() {
+        fftSize = CHANNEL_FFT_SIZE * _decimation;
+        hopSize = CHANNEL_BLOCK_SIZE * _decimation;
+        fftIn = (dsp::complex_t*)fftwf_malloc(fftSize * sizeof(fftwf_complex));
+        fftOut = (fftwf_complex*)fftwf_malloc(fftSize * sizeof(fftwf_complex));
+        fftPlan = fftwf_plan_dft_1d(fftSize, (fftwf_complex*)fftIn, fftOut, FFTW_FORWARD, FFTW_ESTIMATE);
+        fill = fftSize - hopSize;
+        dsp::buffer::clear(fftIn, fill);
+
+        // Frequency response of the channel filter, scaled for both FFTs being unnormalized
+        dsp::taps::SharedTaps lpf = dsp::taps::cache::lowPass(7000.0, 2000.0, POCSAG_CHANNEL_SAMPLERATE);
+        assert(lpf->size <= CHANNEL_FFT_SIZE - CHANNEL_BLOCK_SIZE + 1);
+        for (int i = 0; i < CHANNEL_FFT_SIZE; i++) {
+            dsp::complex_t acc = { 0.0f, 0.0f };
+            for (int j = 0; j < lpf->size; j++) {
+                float phase = -2.0f * FL_M_PI * (float)(((int64_t)i * j) % CHANNEL_FFT_SIZE) / (float)CHANNEL_FFT_SIZE;
+                acc += dsp::complex_t{ cosf(phase), sinf(phase) } * lpf->taps[j];
+            }
+            chanResp[i] = acc / (float)fftSize;
+        }
+    }
+
+    void freeFFT() {
+        fftwf_destroy_plan(fftPlan);
+        fftwf_free(fftIn);
+        fftwf_free(fftOut);
+    }
+
+    void updateBins() {
+        double samplerate = getInputSamplerate(_decimation);
+        double binWidth = samplerate / (double)fftSize;
+        double maxOffset = (samplerate - POCSAG_CHANNEL_BANDWIDTH) / 2.0;
+        for (auto& chan : channels) {
+            double offset = chan->frequency - centerFreq;
+            chan->inBand = (fabs(offset) <= maxOffset);
+            chan->bin = (int)round(offset / binWidth);
+
+            // Shifting by a number of bins is a frequency shift relative to the start of each FFT block
+            float phase = -2.0f * FL_M_PI * (float)(((int64_t)chan->bin * hopSize) % fftSize) / (float)fftSize;
+            chan->rotStep = { cosf(phase), sinf(phase) };
+            chan->rot = { 1.0f, 0.0f };
+        }
+    }
+
+    // Inverse FFT size of a channel and number of new samples it gives, the rest is the overlap
+    static constexpr int CHANNEL_FFT_SIZE = 512;
+    static constexpr int CHANNEL_BLOCK_SIZE = 384;
+
+    int _decimation;
+    double centerFreq = 0.0;
+
+    int fftSize;
+    int hopSize;
+    int fill = 0;
+    dsp::complex_t* fftIn = NULL;
+    fftwf_complex* fftOut = NULL;
+    fftwf_plan fftPlan;
+
+    fftwf_complex* chanIn;
+    fftwf_complex* chanOut;
+    fftwf_plan chanPlan;
+    dsp::complex_t* chanResp;
+    dsp::complex_t* iq;
+    float* fm;
+    float* soft;
+
+    std::vector<std::unique_ptr<Channel>> channels;
+};
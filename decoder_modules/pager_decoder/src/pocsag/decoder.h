@@ -5,6 +5,8 @@
 #include <gui/widgets/symbol_diagram.h>
 #include <gui/style.h>
 #include <dsp/sink/handler_sink.h>
+#include <gui/gui.h>
+#include <core.h>
 #include "dsp.h"
 #include "pocsag.h"
 
@@ -26,8 +28,9 @@ public:
         vfo->setBandwidthLimits(12500, 12500, true);
         vfo->setSampleRate(SAMPLERATE, 12500);
         dsp.init(vfo->output, SAMPLERATE, BAUDRATE);
-        reshape.init(&dsp.soft, BAUDRATE, (BAUDRATE / 30.0) - BAUDRATE);
-        dataHandler.init(&dsp.out, _dataHandler, this);
+        split.init(&dsp.out);
+        reshape.init(&split.outA, BAUDRATE, (BAUDRATE / 30.0) - BAUDRATE);
+        dataHandler.init(&split.outB, _dataHandler, this);
         diagHandler.init(&reshape.out, _diagHandler, this);
 
         // Init decoder
@@ -58,6 +61,7 @@ public:
 
     void start() {
         dsp.start();
+        split.start();
         reshape.start();
         dataHandler.start();
         diagHandler.start();
@@ -65,13 +69,14 @@ public:
 
     void stop() {
         dsp.stop();
+        split.stop();
         reshape.stop();
         dataHandler.stop();
         diagHandler.stop();
     }
 
 private:
-    static void _dataHandler(uint8_t* data, int count, void* ctx) {
+    static void _dataHandler(float* data, int count, void* ctx) {
         POCSAGDecoder* _this = (POCSAGDecoder*)ctx;
         _this->decoder.process(data, count);
     }
@@ -85,14 +90,22 @@ private:
 
     void messageHandler(pocsag::Address addr, pocsag::MessageType type, const std::string& msg) {
         flog::debug("[{}]: '{}'", (uint32_t)addr, msg);
+
+        json fields;
+        fields["address"] = (uint32_t)addr;
+        fields["type"] = (type == pocsag::MESSAGE_TYPE_ALPHANUMERIC) ? "alphanumeric" : "numeric";
+        fields["baudrate"] = baudrates.value(brId);
+        fields["message"] = msg;
+        core::decoderBus.publish("pocsag", name, gui::waterfall.getCenterFrequency() + vfo->getOffset(), std::move(fields));
     }
 
     std::string name;
     VFOManager::VFO* vfo;
 
     POCSAGDSP dsp;
+    dsp::routing::Doubler<float> split;
     dsp::buffer::Reshaper<float> reshape;
-    dsp::sink::Handler<uint8_t> dataHandler;
+    dsp::sink::Handler<float> dataHandler;
     dsp::sink::Handler<float> diagHandler;
 
     pocsag::Decoder decoder;
@@ -1,5 +1,6 @@
 #pragma once
 #include <dsp/stream.h>
+#include <dsp/pipeline.h>
 #include <dsp/buffer/reshaper.h>
 #include <dsp/multirate/rational_resampler.h>
 #include <dsp/sink/handler_sink.h>
@@ -11,8 +12,9 @@
 #include <dsp/digital/binary_slicer.h>
 #include <dsp/routing/doubler.h>
 
-class POCSAGDSP : public dsp::Processor<dsp::complex_t, uint8_t> {
-    using base_type = dsp::Processor<dsp::complex_t, uint8_t>;
+// Outputs the soft symbols, the decoder slices them itself and uses their magnitude for error correction
+class POCSAGDSP : public dsp::Processor<dsp::complex_t, float> {
+    using base_type = dsp::Processor<dsp::complex_t, float>;
 public:
     POCSAGDSP() {}
     POCSAGDSP(dsp::stream<dsp::complex_t>* in, double samplerate, double baudrate) { init(in, samplerate, baudrate); }
@@ -22,26 +24,22 @@ public:
         _samplerate = samplerate;
 
         // Configure blocks
-        demod.init(NULL, -4500.0, samplerate);
+        chain.get<0>().init(NULL, -4500.0, samplerate);
         float taps[] = { 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f, 0.1f };
         shape = dsp::taps::fromArray<float>(10, taps);
-        fir.init(NULL, shape);
-        recov.init(NULL, samplerate/baudrate, 1e-4, 1.0, 0.05);
+        chain.get<1>().init(NULL, shape);
+        chain.get<2>().init(NULL, samplerate/baudrate, 1e-4, 1.0, 0.05);
+        chain.init(NULL);
 
         // Free useless buffers
-        fir.out.free();
-        recov.out.free();
+        chain.out.free();
 
         // Init base
         base_type::init(in);
     }
 
-    int process(int count, dsp::complex_t* in, float* softOut, uint8_t* out) {
-        count = demod.process(count, in, demod.out.readBuf);
-        count = fir.process(count, demod.out.readBuf, demod.out.readBuf);
-        count = recov.process(count, demod.out.readBuf, softOut);
-        dsp::digital::BinarySlicer::process(count, softOut, out);
-        return count;
+    int process(int count, dsp::complex_t* in, float* out) {
+        return chain.process(count, in, out);
     }
 
     void setBaudrate(double baudrate) {
@@ -56,21 +54,17 @@ public:
         int count = base_type::_in->read();
         if (count < 0) { return -1; }
 
-        count = process(count, base_type::_in->readBuf, soft.writeBuf, base_type::out.writeBuf);
+        count = process(count, base_type::_in->readBuf, base_type::out.writeBuf);
 
         base_type::_in->flush();
-        if (!base_type::out.swap(count)) { return -1; }
-        if (count) { if (!soft.swap(count)) { return -1; } }
+        if (count) { if (!base_type::out.swap(count)) { return -1; } }
         return count;
     }
 
-    dsp::stream<float> soft;
-
 private:
-    dsp::demod::Quadrature demod;
+    // Discriminator, pulse shaping and clock recovery
+    dsp::Pipeline<dsp::demod::Quadrature, dsp::filter::FIR<float, float>, dsp::clock_recovery::MM<float>> chain;
     dsp::tap<float> shape;
-    dsp::filter::FIR<float, float> fir;
-    dsp::clock_recovery::MM<float> recov;
 
     double _samplerate;
 };
\ No newline at end of file
@@ -0,0 +1,263 @@
+#pragma once
+#include "../decoder.h"
+#include <deque>
+#include <mutex>
+#include <ctime>
+#include <signal_path/signal_path.h>
+#include <gui/gui.h>
+#include <gui/style.h>
+#include <utils/optionlist.h>
+#include <utils/flog.h>
+#include <config.h>
+#include <core.h>
+#include "channel_bank.h"
+
+#define POCSAG_MULTI_MAX_MESSAGES   1000
+
+// Decodes a list of POCSAG channels that fit in the band of a single wide VFO, at all baudrates at once.
+// Messages of all channels are merged into one list in the order they are decoded.
+class POCSAGMultiDecoder : public Decoder {
+public:
+    POCSAGMultiDecoder(const std::string& name, VFOManager::VFO* vfo, ConfigManager* config) {
+        this->name = name;
+        this->vfo = vfo;
+        this->config = config;
+
+        // Define span options, the span is the channel samplerate times the decimation
+        for (int dec = 2; dec <= 32; dec *= 2) {
+            double span = POCSAGChannelBank::getInputSamplerate(dec);
+            spans.define(dec, std::to_string((int)(span / 1000.0)) + " KHz", dec);
+        }
+
+        // Load config
+        int decimation = 8;
+        config->acquire();
+        if (config->conf[name].contains("multi")) {
+            json& conf = config->conf[name]["multi"];
+            if (conf.contains("decimation")) { decimation = conf["decimation"]; }
+            if (conf.contains("channels")) { channels = conf["channels"].get<std::vector<double>>(); }
+            if (conf.contains("baud512")) { baud512 = conf["baud512"]; }
+            if (conf.contains("baud1200")) { baud1200 = conf["baud1200"]; }
+            if (conf.contains("baud2400")) { baud2400 = conf["baud2400"]; }
+        }
+        config->release();
+        if (!spans.keyExists(decimation)) { decimation = 8; }
+        spanId = spans.keyId(decimation);
+
+        // Init DSP
+        bank.init(vfo->output, decimation);
+        bank.onMessage.bind(&POCSAGMultiDecoder::messageHandler, this);
+        applyVFO();
+        bank.setChannels(channels, getBaudrates());
+
+        // Keep the channels in place when the VFO or the tuning moves, even with the menu hidden
+        retuneHandler.handler = retuneEventHandler;
+        retuneHandler.ctx = this;
+        vfoMovedHandler.handler = vfoMovedEventHandler;
+        vfoMovedHandler.ctx = this;
+        sigpath::sourceManager.onRetune.bindHandler(&retuneHandler);
+        sigpath::vfoManager.onVfoOffsetChanged.bindHandler(&vfoMovedHandler);
+    }
+
+    ~POCSAGMultiDecoder() {
+        sigpath::sourceManager.onRetune.unbindHandler(&retuneHandler);
+        sigpath::vfoManager.onVfoOffsetChanged.unbindHandler(&vfoMovedHandler);
+        stop();
+    }
+
+    void showMenu() {
+        float menuWidth = ImGui::GetContentRegionAvail().x;
+
+        ImGui::LeftLabel("Span");
+        ImGui::FillWidth();
+        if (ImGui::Combo(("##pager_decoder_pocsag_multi_span_" + name).c_str(), &spanId, spans.txt)) {
+            bank.setDecimation(spans.value(spanId));
+            applyVFO();
+            saveConfig();
+        }
+
+        bool baudsChanged = false;
+        baudsChanged |= ImGui::Checkbox(("512##pager_decoder_pocsag_multi_512_" + name).c_str(), &baud512);
+        ImGui::SameLine();
+        baudsChanged |= ImGui::Checkbox(("1200##pager_decoder_pocsag_multi_1200_" + name).c_str(), &baud1200);
+        ImGui::SameLine();
+        baudsChanged |= ImGui::Checkbox(("2400 Baud##pager_decoder_pocsag_multi_2400_" + name).c_str(), &baud2400);
+        if (baudsChanged) {
+            bank.setChannels(channels, getBaudrates());
+            saveConfig();
+        }
+
+        // Channel list
+        int toRemove = -1;
+        if (ImGui::BeginTable(("##pager_decoder_pocsag_multi_chans_" + name).c_str(), 2, ImGuiTableFlags_SizingStretchProp | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+            for (int i = 0; i < channels.size(); i++) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                if (bank.isChannelInBand(i)) {
+                    ImGui::Text("%.4lf MHz", channels[i] / 1e6);
+                }
+                else {
+                    ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "%.4lf MHz (out of span)", channels[i] / 1e6);
+                }
+                ImGui::TableSetColumnIndex(1);
+                if (ImGui::SmallButton(("Remove##pager_decoder_pocsag_multi_rm_" + name + std::to_string(i)).c_str())) { toRemove = i; }
+            }
+            ImGui::EndTable();
+        }
+        if (toRemove >= 0) {
+            channels.erase(channels.begin() + toRemove);
+            bank.setChannels(channels, getBaudrates());
+            saveConfig();
+        }
+
+        ImGui::LeftLabel("Frequency");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX() - ImGui::CalcTextSize("Add").x - 2.0f * ImGui::GetStyle().FramePadding.x - ImGui::GetStyle().ItemSpacing.x);
+        ImGui::InputDouble(("##pager_decoder_pocsag_multi_freq_" + name).c_str(), &newChannel, 0.0, 0.0, "%.4f MHz");
+        ImGui::SameLine();
+        if (ImGui::Button(("Add##pager_decoder_pocsag_multi_add_" + name).c_str())) {
+            channels.push_back(newChannel * 1e6);
+            bank.setChannels(channels, getBaudrates());
+            saveConfig();
+        }
+
+        // Merged message list, newest first
+        if (ImGui::BeginTable(("##pager_decoder_pocsag_multi_msgs_" + name).c_str(), 4, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY, ImVec2(0, 200.0f * style::uiScale))) {
+            ImGui::TableSetupColumn("Time");
+            ImGui::TableSetupColumn("Frequency");
+            ImGui::TableSetupColumn("Address");
+            ImGui::TableSetupColumn("Message", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableHeadersRow();
+
+            std::lock_guard<std::mutex> lck(msgMtx);
+            for (auto it = messages.rbegin(); it != messages.rend(); it++) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(it->timeStr.c_str());
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.4lf (%d)", it->msg.frequency / 1e6, it->msg.baudrate);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%u", (uint32_t)it->msg.address);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::TextUnformatted(it->msg.text.c_str());
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::Button(("Clear##pager_decoder_pocsag_multi_clear_" + name).c_str(), ImVec2(menuWidth, 0))) {
+            std::lock_guard<std::mutex> lck(msgMtx);
+            messages.clear();
+        }
+    }
+
+    void setVFO(VFOManager::VFO* vfo) {
+        this->vfo = vfo;
+        applyVFO();
+        bank.setInput(vfo->output);
+    }
+
+    void start() {
+        updateCenter();
+        bank.start();
+        running = true;
+    }
+
+    void stop() {
+        running = false;
+        bank.stop();
+    }
+
+private:
+    struct Entry {
+        POCSAGChannelBank::Message msg;
+        std::string timeStr;
+    };
+
+    void applyVFO() {
+        double span = POCSAGChannelBank::getInputSamplerate(spans.value(spanId));
+        vfo->setBandwidthLimits(span, span, true);
+        vfo->setSampleRate(span, span);
+        lastCenter = NAN;
+        updateCenter();
+    }
+
+    static void retuneEventHandler(double freq, void* ctx) {
+        POCSAGMultiDecoder* _this = (POCSAGMultiDecoder*)ctx;
+        // While stopped the VFO might already be deleted
+        if (_this->running) { _this->updateCenter(); }
+    }
+
+    static void vfoMovedEventHandler(VFOManager::VFO* vfo, void* ctx) {
+        POCSAGMultiDecoder* _this = (POCSAGMultiDecoder*)ctx;
+        if (_this->running && vfo == _this->vfo) { _this->updateCenter(); }
+    }
+
+    void updateCenter() {
+        double center = gui::waterfall.getCenterFrequency() + vfo->getOffset();
+        if (center == lastCenter) { return; }
+        lastCenter = center;
+        bank.setCenterFrequency(center);
+    }
+
+    std::vector<int> getBaudrates() {
+        std::vector<int> bauds;
+        if (baud512) { bauds.push_back(512); }
+        if (baud1200) { bauds.push_back(1200); }
+        if (baud2400) { bauds.push_back(2400); }
+        return bauds;
+    }
+
+    void saveConfig() {
+        config->acquire();
+        json& conf = config->conf[name]["multi"];
+        conf["decimation"] = spans.value(spanId);
+        conf["channels"] = channels;
+        conf["baud512"] = baud512;
+        conf["baud1200"] = baud1200;
+        conf["baud2400"] = baud2400;
+        config->release(true);
+    }
+
+    void messageHandler(const POCSAGChannelBank::Message& msg) {
+        char timeStr[32];
+        time_t t = std::chrono::system_clock::to_time_t(msg.time);
+        strftime(timeStr, sizeof(timeStr), "%H:%M:%S", localtime(&t));
+        flog::info("[{} {:.4f}MHz {}bd] [{}]: '{}'", timeStr, msg.frequency / 1e6, msg.baudrate, (uint32_t)msg.address, msg.text);
+
+        DecoderRecord rec;
+        rec.time = std::chrono::duration<double>(msg.time.time_since_epoch()).count();
+        rec.frequency = msg.frequency;
+        rec.decoder = "pocsag";
+        rec.source = name;
+        rec.fields["address"] = (uint32_t)msg.address;
+        rec.fields["type"] = (msg.type == pocsag::MESSAGE_TYPE_ALPHANUMERIC) ? "alphanumeric" : "numeric";
+        rec.fields["baudrate"] = msg.baudrate;
+        rec.fields["message"] = msg.text;
+        core::decoderBus.publish(std::move(rec));
+
+        std::lock_guard<std::mutex> lck(msgMtx);
+        messages.push_back({ msg, timeStr });
+        if (messages.size() > POCSAG_MULTI_MAX_MESSAGES) { messages.pop_front(); }
+    }
+
+    std::string name;
+    VFOManager::VFO* vfo;
+    ConfigManager* config;
+
+    POCSAGChannelBank bank;
+    double lastCenter = NAN;
+    bool running = false;
+    EventHandler<double> retuneHandler;
+    EventHandler<VFOManager::VFO*> vfoMovedHandler;
+
+    OptionList<int, int> spans;
+    int spanId = 0;
+    std::vector<double> channels;
+    double newChannel = 0.0;
+    bool baud512 = true;
+    bool baud1200 = true;
+    bool baud2400 = true;
+
+    std::mutex msgMtx;
+    std::deque<Entry> messages;
+};
@@ -1,5 +1,7 @@
 #include "pocsag.h"
 #include <string.h>
+#include <math.h>
+#include <algorithm>
 #include <utils/flog.h>
 
 #define POCSAG_FRAME_SYNC_CODEWORD  ((uint32_t)(0b01111100110100100001010111011000))
@@ -8,8 +10,73 @@
 #define POCSAG_DATA_BITS_PER_CW     20
 
 #define POCSAG_GEN_POLY             ((uint32_t)(0b11101101001))
+#define POCSAG_SYNDROME_BITS        10
+#define POCSAG_CHASE_BITS           5
+#define POCSAG_CHASE_MAX_METRIC     1.0f
+#define POCSAG_CHASE_MAX_FLIPS      2
+#define POCSAG_SOFT_MAX_ERRORS      3
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace pocsag {
+    static inline int popcount(uint32_t n) {
+#ifdef _MSC_VER
+        return __popcnt(n);
+#else
+        return __builtin_popcount(n);
+#endif
+    }
+
+    static inline int ctz(uint32_t n) {
+#ifdef _MSC_VER
+        unsigned long i;
+        _BitScanForward(&i, n);
+        return i;
+#else
+        return __builtin_ctz(n);
+#endif
+    }
+
+    // Remainder of the 31 BCH bits of a codeword (without the parity bit) divided by the generator polynomial
+    static uint32_t polyMod(uint32_t bits) {
+        for (int i = 30; i >= POCSAG_SYNDROME_BITS; i--) {
+            if ((bits >> i) & 1) { bits ^= POCSAG_GEN_POLY << (i - POCSAG_SYNDROME_BITS); }
+        }
+        return bits;
+    }
+
+    // The syndrome is linear, so it is the XOR of the syndromes of each byte of the codeword.
+    // Any pattern of up to two bit errors gives a distinct syndrome and is looked up directly.
+    struct BCHTables {
+        BCHTables() {
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 256; j++) {
+                    syndrome[i][j] = polyMod(((uint32_t)j << (8 * i)) & 0x7FFFFFFF);
+                }
+            }
+
+            memset(errors, 0, sizeof(errors));
+            for (int i = 0; i < 31; i++) {
+                errors[polyMod(1u << i)] = 1u << i;
+                for (int j = i + 1; j < 31; j++) {
+                    errors[polyMod((1u << i) | (1u << j))] = (1u << i) | (1u << j);
+                }
+            }
+        }
+
+        inline uint32_t compute(Codeword cw) const {
+            uint32_t bits = cw >> 1;
+            return syndrome[0][bits & 0xFF] ^ syndrome[1][(bits >> 8) & 0xFF] ^ syndrome[2][(bits >> 16) & 0xFF] ^ syndrome[3][bits >> 24];
+        }
+
+        uint16_t syndrome[4][256];
+        uint32_t errors[1 << POCSAG_SYNDROME_BITS];
+    };
+
+    static const BCHTables bch;
+
     const char NUMERIC_CHARSET[] = {
         '0',
         '1',
@@ -35,51 +102,123 @@ namespace pocsag {
     }
 
     void Decoder::process(uint8_t* symbols, int count) {
+        softBatch = false;
         for (int i = 0; i < count; i++) {
-            // Get symbol
-            uint32_t s = symbols[i];
+            processSymbol(symbols[i], 0.0f);
+        }
+    }
 
-            // If not sync, try to acquire sync (TODO: sync confidence)
-            if (!synced) {
-                // Append new symbol to sync shift register
-                syncSR = (syncSR << 1) | s;
+    void Decoder::process(const float* soft, int count) {
+        softBatch = true;
+        for (int i = 0; i < count; i++) {
+            processSymbol(soft[i] > 0.0f, fabsf(soft[i]));
+        }
+    }
 
-                // Test for sync
-                synced = (distance(syncSR, POCSAG_FRAME_SYNC_CODEWORD) <= POCSAG_SYNC_DIST);
+    void Decoder::processSymbol(uint32_t s, float reliability) {
+        // If not sync, try to acquire sync (TODO: sync confidence)
+        if (!synced) {
+            // Append new symbol to sync shift register
+            syncSR = (syncSR << 1) | s;
 
-                // Go to next symbol
-                continue;
-            }
+            // Test for sync
+            synced = (distance(syncSR, POCSAG_FRAME_SYNC_CODEWORD) <= POCSAG_SYNC_DIST);
+
+            // Go to next symbol
+            return;
+        }
 
-            // TODO: Flush message on desync
+        // TODO: Flush message on desync
 
-            // Append bit to batch
-            batch[batchOffset >> 5] |= (s << (31 - (batchOffset & 0b11111)));
-            batchOffset++;
+        // Append bit to batch
+        batch[batchOffset >> 5] |= (s << (31 - (batchOffset & 0b11111)));
+        this->reliability[batchOffset] = reliability;
+        batchOffset++;
 
-            // On end of batch, decode and reset
-            if (batchOffset >= POCSAG_BATCH_BIT_COUNT) {
-                decodeBatch();
-                batchOffset = 0;
-                synced = false;
-                memset(batch, 0, sizeof(batch));
-            }
+        // On end of batch, decode and reset
+        if (batchOffset >= POCSAG_BATCH_BIT_COUNT) {
+            decodeBatch();
+            batchOffset = 0;
+            synced = false;
+            memset(batch, 0, sizeof(batch));
         }
     }
 
     int Decoder::distance(uint32_t a, uint32_t b) {
-        uint32_t diff = a ^ b;
-        int dist = 0;
-        for (int i = 0; i < 32; i++) {
-            dist += (diff >> i ) & 1;
-        }
-        return dist;
+        return popcount(a ^ b);
     }
 
     bool Decoder::correctCodeword(Codeword in, Codeword& out) {
+        // Fix up to two errors in the BCH part
+        uint32_t err = 0;
+        uint32_t syn = bch.compute(in);
+        if (syn) {
+            err = bch.errors[syn];
+            if (!err) { return false; }
+            in ^= err << 1;
+        }
 
+        // The last bit gives even parity over the whole codeword, if wrong it is an extra error
+        if (popcount(in) & 1) {
+            if (popcount(err) >= 2) { return false; }
+            in ^= 1;
+        }
 
-        return true; // TODO
+        out = in;
+        return true;
+    }
+
+    bool Decoder::correctCodeword(Codeword in, const float* reliability, Codeword& out) {
+        // Nothing to weigh if the codeword has no error
+        if (!bch.compute(in) && !(popcount(in) & 1)) {
+            out = in;
+            return true;
+        }
+
+        // Find the least reliable bits (reliability[0] is the MSB)
+        int weakest[32];
+        float total = 0.0f;
+        for (int i = 0; i < 32; i++) {
+            weakest[i] = i;
+            total += reliability[i];
+        }
+        std::partial_sort(weakest, weakest + POCSAG_CHASE_BITS, weakest + 32, [=](int a, int b) { return reliability[a] < reliability[b]; });
+
+        // Try the codeword as is, then with up to POCSAG_CHASE_MAX_FLIPS of the weakest bits flipped, and keep the valid
+        // codeword closest to the soft symbols. The bits fixed by the hard decoder count in the distance as well.
+        bool valid = false;
+        float bestMetric = INFINITY;
+        for (int pattern = 0; pattern < (1 << POCSAG_CHASE_BITS); pattern++) {
+            if (popcount(pattern) > POCSAG_CHASE_MAX_FLIPS) { continue; }
+            Codeword trial = in;
+            for (int i = 0; i < POCSAG_CHASE_BITS; i++) {
+                if ((pattern >> i) & 1) { trial ^= 1u << (31 - weakest[i]); }
+            }
+            Codeword fixed;
+            if (!correctCodeword(trial, fixed)) { continue; }
+
+            // Beyond the flipped bits, only allow as many hard corrections as the code can still check
+            uint32_t diff = fixed ^ in;
+            if (popcount(diff) > POCSAG_SOFT_MAX_ERRORS) { continue; }
+
+            float metric = 0.0f;
+            for (; diff; diff &= diff - 1) {
+                metric += reliability[31 - ctz(diff)];
+            }
+            if (metric < bestMetric) {
+                bestMetric = metric;
+                out = fixed;
+                valid = true;
+            }
+        }
+
+        // Noise can often be turned into some valid codeword, only accept it if the changed bits are
+        // together no more reliable than an average bit times POCSAG_CHASE_MAX_METRIC
+        if (valid && bestMetric > POCSAG_CHASE_MAX_METRIC * total / 32.0f) {
+            stats.chaseRejected++;
+            return false;
+        }
+        return valid;
     }
 
     void Decoder::flushMessage() {
@@ -113,7 +252,14 @@ namespace pocsag {
             Codeword cw = batch[i];
 
             // Correct errors. If corrupted, skip
-            if (!correctCodeword(cw, cw)) { continue; }
+            Codeword raw = cw;
+            bool ok = softBatch ? correctCodeword(cw, &reliability[i * 32], cw) : correctCodeword(cw, cw);
+            stats.codewords++;
+            if (!ok) {
+                stats.uncorrectable++;
+                continue;
+            }
+            if (cw != raw) { stats.corrected++; }
             // TODO: End message if two consecutive are corrupt
 
             // Get codeword type
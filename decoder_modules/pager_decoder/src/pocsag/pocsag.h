@@ -21,17 +21,34 @@ namespace pocsag {
     using Codeword = uint32_t;
     using Address = uint32_t;
 
+    // Codeword counters, only to be read from the thread running the decoder
+    struct Stats {
+        uint64_t codewords = 0;
+        uint64_t corrected = 0;
+        uint64_t uncorrectable = 0;
+        // Uncorrectable codewords for which a soft correction was found but rejected for flipping too many reliable bits
+        uint64_t chaseRejected = 0;
+    };
+
     class Decoder {
     public:
         Decoder();
 
         void process(uint8_t* symbols, int count);
 
+        // Same from soft symbols (positive is a 1). Their magnitude is used to fix codewords with more errors than the code can correct.
+        void process(const float* soft, int count);
+
+        const Stats& getStats() { return stats; }
+        void resetStats() { stats = Stats(); }
+
         NewEvent<Address, MessageType, const std::string&> onMessage;
 
     private:
+        inline void processSymbol(uint32_t s, float reliability);
         static int distance(uint32_t a, uint32_t b);
-        bool correctCodeword(Codeword in, Codeword& out);
+        static bool correctCodeword(Codeword in, Codeword& out);
+        bool correctCodeword(Codeword in, const float* reliability, Codeword& out);
         void flushMessage();
         void decodeBatch();
 
@@ -40,6 +57,10 @@ namespace pocsag {
         int batchOffset = 0;
 
         Codeword batch[POCSAG_BATCH_CODEWORD_COUNT];
+        float reliability[POCSAG_BATCH_CODEWORD_COUNT*32];
+        bool softBatch = false;
+
+        Stats stats;
 
         Address addr;
         MessageType msgType;
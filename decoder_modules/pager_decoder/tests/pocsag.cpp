@@ -0,0 +1,189 @@
+#include <pocsag/pocsag.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#define SYNC_CODEWORD       ((uint32_t)(0b01111100110100100001010111011000))
+#define IDLE_CODEWORD       ((uint32_t)(0b01111010100010011100000110010111))
+#define GEN_POLY            ((uint32_t)(0b11101101001))
+#define MESSAGES_PER_SNR    2000
+#define BENCH_BATCHES       20000
+#define NOISE_SAMPLES       (1 << 22)
+
+// Reference encoder, bit by bit
+uint32_t encode(uint32_t data21) {
+    uint32_t bits = data21 << 10;
+    for (int i = 30; i >= 10; i--) {
+        if ((bits >> i) & 1) { bits ^= GEN_POLY << (i - 10); }
+    }
+    uint32_t cw = ((data21 << 10) | bits) << 1;
+    return cw | (__builtin_popcount(cw) & 1);
+}
+
+struct Transmission {
+    pocsag::Address addr;
+    std::string msg;
+    std::vector<uint32_t> codewords;
+};
+
+// One batch with a single alphanumeric message, ended by idle codewords. The address is in one
+// of the first 6 frames so that the message and an idle codeword fit after it.
+Transmission makeTransmission(std::mt19937& rng) {
+    Transmission t;
+    int frame = rng() % 6;
+    t.addr = (rng() & 0x1FFFF8) | frame;
+    for (int i = 0; i < 8; i++) { t.msg += (char)('A' + rng() % 26); }
+
+    t.codewords.push_back(SYNC_CODEWORD);
+    for (int i = 0; i < frame * 2; i++) { t.codewords.push_back(IDLE_CODEWORD); }
+    t.codewords.push_back(encode(((t.addr >> 3) << 2) | 0b11));
+
+    // Characters are sent 7 bits at a time, LSB first
+    std::vector<int> bits;
+    for (char c : t.msg) {
+        for (int i = 0; i < 7; i++) { bits.push_back((c >> i) & 1); }
+    }
+    while (bits.size() % 20) { bits.push_back(0); }
+    for (size_t i = 0; i < bits.size(); i += 20) {
+        uint32_t data = 0;
+        for (int j = 0; j < 20; j++) { data = (data << 1) | bits[i + j]; }
+        t.codewords.push_back(encode((1u << 20) | data));
+    }
+    while (t.codewords.size() < 17) { t.codewords.push_back(IDLE_CODEWORD); }
+    return t;
+}
+
+// BPSK with gaussian noise, positive is a 1
+void modulate(const std::vector<uint32_t>& codewords, float snr, std::mt19937& rng, std::vector<float>& soft) {
+    std::normal_distribution<float> noise(0.0f, powf(10.0f, -snr / 20.0f));
+    soft.clear();
+    for (uint32_t cw : codewords) {
+        for (int i = 31; i >= 0; i--) { soft.push_back((((cw >> i) & 1) ? 1.0f : -1.0f) + noise(rng)); }
+    }
+}
+
+struct Result {
+    int intact = 0;
+    int wrong = 0;
+    pocsag::Stats stats;
+};
+
+Result run(float snr, bool useSoft) {
+    std::mt19937 rng(1234);
+    pocsag::Decoder decoder;
+    const Transmission* current;
+    Result res;
+    decoder.onMessage.bind([&](pocsag::Address addr, pocsag::MessageType type, const std::string& msg) {
+        if (addr == current->addr && msg == current->msg) { res.intact++; }
+        else { res.wrong++; }
+    });
+
+    std::vector<float> soft;
+    std::vector<uint8_t> hard;
+    for (int i = 0; i < MESSAGES_PER_SNR; i++) {
+        Transmission t = makeTransmission(rng);
+        current = &t;
+        modulate(t.codewords, snr, rng, soft);
+        if (useSoft) {
+            decoder.process(soft.data(), soft.size());
+        }
+        else {
+            hard.resize(soft.size());
+            for (size_t j = 0; j < soft.size(); j++) { hard[j] = soft[j] > 0.0f; }
+            decoder.process(hard.data(), hard.size());
+        }
+    }
+    res.stats = decoder.getStats();
+    return res;
+}
+
+int main() {
+    bool pass = true;
+
+    // Every 1 and 2 bit error in the address codeword must be corrected
+    std::mt19937 rng(42);
+    int missed = 0;
+    for (int k = 0; k < 200; k++) {
+        Transmission t = makeTransmission(rng);
+        uint32_t& cw = t.codewords[1 + (t.addr & 7) * 2];
+        uint32_t orig = cw;
+        for (int i = 0; i < 32; i++) {
+            for (int j = i; j < 32; j++) {
+                cw = orig ^ (1u << i) ^ (1u << j);
+                pocsag::Decoder decoder;
+                bool ok = false;
+                decoder.onMessage.bind([&](pocsag::Address addr, pocsag::MessageType type, const std::string& msg) {
+                    ok = (addr == t.addr && msg == t.msg);
+                });
+                std::vector<uint8_t> bits;
+                for (uint32_t c : t.codewords) {
+                    for (int b = 31; b >= 0; b--) { bits.push_back((c >> b) & 1); }
+                }
+                decoder.process(bits.data(), bits.size());
+                if (!ok) { missed++; }
+            }
+        }
+        cw = orig;
+    }
+    printf("Single and double errors not corrected: %d\n", missed);
+    if (missed) { pass = false; }
+
+    // Correction rate of hard and soft decoding
+    printf("SNR    hard intact  hard wrong  soft intact  soft wrong  chase rejected\n");
+    for (float snr : { 8.0f, 6.0f, 5.0f, 4.0f, 2.0f }) {
+        Result hard = run(snr, false);
+        Result soft = run(snr, true);
+        printf("%3.0fdB  %10.1f%%  %10d  %10.1f%%  %10d  %14llu\n", snr, 100.0 * hard.intact / MESSAGES_PER_SNR, hard.wrong,
+               100.0 * soft.intact / MESSAGES_PER_SNR, soft.wrong, (unsigned long long)soft.stats.chaseRejected);
+        // Soft decoding must recover more messages without getting more of them wrong
+        if (soft.intact < hard.intact || soft.wrong > hard.wrong) { pass = false; }
+        if (snr >= 8.0f && soft.intact < MESSAGES_PER_SNR * 99 / 100) { pass = false; }
+    }
+
+    // Pure noise, anything accepted after a false sync is garbage
+    {
+        std::mt19937 nrng(99);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        std::vector<float> buf(NOISE_SAMPLES);
+        for (float& s : buf) { s = noise(nrng); }
+        pocsag::Decoder softDecoder;
+        pocsag::Decoder hardDecoder;
+        int softFalse = 0;
+        int hardFalse = 0;
+        softDecoder.onMessage.bind([&](pocsag::Address addr, pocsag::MessageType type, const std::string& msg) { softFalse++; });
+        hardDecoder.onMessage.bind([&](pocsag::Address addr, pocsag::MessageType type, const std::string& msg) { hardFalse++; });
+        softDecoder.process(buf.data(), buf.size());
+        std::vector<uint8_t> bits(buf.size());
+        for (size_t i = 0; i < buf.size(); i++) { bits[i] = buf[i] > 0.0f; }
+        hardDecoder.process(bits.data(), bits.size());
+        const pocsag::Stats& st = softDecoder.getStats();
+        printf("Noise: hard %d messages, soft %d messages, soft accepted %llu of %llu codewords, chase rejected %llu\n", hardFalse, softFalse,
+               (unsigned long long)(st.codewords - st.uncorrectable), (unsigned long long)st.codewords, (unsigned long long)st.chaseRejected);
+        if (softFalse > hardFalse) { pass = false; }
+    }
+
+    // Throughput on noisy batches, including hunting for sync
+    std::vector<float> soft;
+    std::vector<uint8_t> hard;
+    std::vector<float> allSoft;
+    for (int i = 0; i < 64; i++) {
+        Transmission t = makeTransmission(rng);
+        modulate(t.codewords, 6.0f, rng, soft);
+        allSoft.insert(allSoft.end(), soft.begin(), soft.end());
+    }
+    for (float s : allSoft) { hard.push_back(s > 0.0f); }
+    pocsag::Decoder decoder;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < BENCH_BATCHES / 64; i++) { decoder.process(hard.data(), hard.size()); }
+    double hardTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < BENCH_BATCHES / 64; i++) { decoder.process(allSoft.data(), allSoft.size()); }
+    double softTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    double mbits = (double)allSoft.size() * (BENCH_BATCHES / 64) / 1e6;
+    printf("Throughput: hard %.1f Mbit/s, soft %.1f Mbit/s\n", mbits / hardTime, mbits / softTime);
+
+    return pass ? 0 : 1;
+}
@@ -5,6 +5,8 @@
 #include <gui/widgets/symbol_diagram.h>
 #include <fstream>
 #include <rds.h>
+#include <core.h>
+#include <signal_path/signal_path.h>
 
 namespace demod {
     enum RDSRegion {
@@ -75,6 +77,7 @@ namespace demod {
             demod.init(input, bandwidth / 2.0f, getIFSampleRate(), _stereo, _lowPass, _rds);
             rdsDemod.init(&demod.rdsOut, _rdsInfo);
             hs.init(&rdsDemod.out, rdsHandler, this);
+            rdsDecode.onUpdate.bind(&WFM::publishRDS, this);
             reshape.init(&rdsDemod.soft, 4096, (1187 / 30) - 4096);
             diagHandler.init(&reshape.out, _diagHandler, this);
 
@@ -285,11 +288,39 @@ namespace demod {
         }
 
     private:
-        static void rdsHandler(uint8_t* data, int count, void* ctx) {
+        static void rdsHandler(float* data, int count, void* ctx) {
             WFM* _this = (WFM*)ctx;
             _this->rdsDecode.process(data, count);
         }
 
+        // Called by the RDS decoder only when something it decoded changed
+        void publishRDS() {
+            bool northAmerica = (rdsRegion == RDS_REGION_NORTH_AMERICA);
+            json rec;
+            if (rdsDecode.piCodeValid()) {
+                char pi[8];
+                snprintf(pi, sizeof(pi), "%04X", rdsDecode.getPICode());
+                rec["pi"] = pi;
+                if (northAmerica) { rec["callsign"] = rdsDecode.getCallsign(); }
+            }
+            if (rdsDecode.programTypeValid()) {
+                int pty = rdsDecode.getProgramType();
+                rec["pty"] = northAmerica ? rds::PROGRAM_TYPE_US_TO_STR[pty] : rds::PROGRAM_TYPE_EU_TO_STR[pty];
+            }
+            if (rdsDecode.PSNameValid()) { rec["ps"] = rdsDecode.getPSName(); }
+            if (rdsDecode.radioTextValid()) {
+                std::string rt = rdsDecode.getRadioText();
+                rt.erase(rt.find_last_not_of(' ') + 1);
+                rec["rt"] = rt;
+            }
+
+            // A new PI code means another station, nothing of the previous one applies.
+            // Information going stale isn't a change, so the last known values are kept.
+            if (rec.contains("pi") && rdsLast.contains("pi") && rec["pi"] != rdsLast["pi"]) { rdsLast = json::object(); }
+            rdsLast.update(rec);
+            core::decoderBus.publish("rds", name, gui::waterfall.getCenterFrequency() + sigpath::vfoManager.getOffset(name), rdsLast);
+        }
+
         static void _diagHandler(float* data, int count, void* ctx) {
             WFM* _this = (WFM*)ctx;
             float* buf = _this->diag.acquireBuffer();
@@ -339,7 +370,7 @@ namespace demod {
 
         dsp::demod::BroadcastFM demod;
         RDSDemod rdsDemod;
-        dsp::sink::Handler<uint8_t> hs;
+        dsp::sink::Handler<float> hs;
         EventHandler<ImGui::WaterFall::FFTRedrawArgs> fftRedrawHandler;
 
         dsp::buffer::Reshaper<float> reshape;
@@ -347,6 +378,7 @@ namespace demod {
         ImGui::SymbolDiagram diag;
 
         rds::Decoder rdsDecode;
+        json rdsLast = json::object();
 
         ConfigManager* _config = NULL;
 
@@ -1,25 +1,18 @@
 #include "rds.h"
 #include <string.h>
+#include <math.h>
 #include <map>
 #include <algorithm>
 
 #include <utils/flog.h>
 
 namespace rds {
-    std::map<uint16_t, BlockType> SYNDROMES = {
-        { 0b1111011000, BLOCK_TYPE_A  },
-        { 0b1111010100, BLOCK_TYPE_B  },
-        { 0b1001011100, BLOCK_TYPE_C  },
-        { 0b1111001100, BLOCK_TYPE_CP },
-        { 0b1001011000, BLOCK_TYPE_D  }
-    };
-
-    std::map<BlockType, uint16_t> OFFSETS = {
-        { BLOCK_TYPE_A,  0b0011111100 },
-        { BLOCK_TYPE_B,  0b0110011000 },
-        { BLOCK_TYPE_C,  0b0101101000 },
-        { BLOCK_TYPE_CP, 0b1101010000 },
-        { BLOCK_TYPE_D,  0b0110110100 }
+    const uint16_t OFFSETS[_BLOCK_TYPE_COUNT] = {
+        0b0011111100, // A
+        0b0110011000, // B
+        0b0101101000, // C
+        0b1101010000, // C'
+        0b0110110100  // D
     };
 
     std::map<uint16_t, const char*> THREE_LETTER_CALLS = {
@@ -121,109 +114,201 @@ namespace rds {
     const int BLOCK_LEN = 26;
     const int DATA_LEN = 16;
     const int POLY_LEN = 10;
+    const int MAX_BURST_LEN = 5;
+    const int CHASE_BITS = 3;
 
-    void Decoder::process(uint8_t* symbols, int count) {
-        for (int i = 0; i < count; i++) {
-            // Shift in the bit
-            shiftReg = ((shiftReg << 1) & 0x3FFFFFF) | (symbols[i] & 1);
-
-            // Skip if we need to shift in new data
-            if (--skip > 0) { continue; }
-
-            // Calculate the syndrome and update sync status
-            uint16_t syn = calcSyndrome(shiftReg);
-            auto synIt = SYNDROMES.find(syn);
-            bool knownSyndrome = synIt != SYNDROMES.end();
-            sync = std::clamp<int>(knownSyndrome ? ++sync : --sync, 0, 4);
-            
-            // If we're still no longer in sync, try to resync
-            if (!sync) { continue; }
-
-            // Figure out which block we've got
-            BlockType type;
-            if (knownSyndrome) {
-                type = SYNDROMES[syn];
-            }
-            else {
-                type = (BlockType)((lastType + 1) % _BLOCK_TYPE_COUNT);
-            }
+    // Reference syndrome computation with a LFSR, one bit at a time
+    static uint16_t lfsrSyndrome(uint32_t block) {
+        uint16_t syn = 0;
+        for (int i = BLOCK_LEN - 1; i >= 0; i--) {
+            // Shift the syndrome and keep the output
+            uint8_t outBit = (syn >> (POLY_LEN - 1)) & 1;
+            syn = (syn << 1) & 0b1111111111;
+
+            // Apply LFSR polynomial
+            syn ^= LFSR_POLY * outBit;
 
-            // Save block while correcting errors (NOT YET) <- idk why the "not yet is here", TODO: find why
-            blocks[type] = correctErrors(shiftReg, type, blockAvail[type]);
+            // Apply input polynomial.
+            syn ^= IN_POLY * ((block >> i) & 1);
+        }
+        return syn;
+    }
 
-            // If block type is A, decode it directly, otherwise, update continous count
-            if (type == BLOCK_TYPE_A) {
-                decodeBlockA();
+    // The syndrome is linear, so it is the XOR of the syndromes of the low 10 bits and of the two upper bytes.
+    // A syndrome identifies the block type when it is the one of an offset word, and the error burst otherwise.
+    struct SyndromeTables {
+        SyndromeTables() {
+            for (int i = 0; i < 1024; i++) { low[i] = lfsrSyndrome(i); }
+            for (int i = 0; i < 256; i++) {
+                mid[i] = lfsrSyndrome((uint32_t)i << 10);
+                high[i] = lfsrSyndrome((uint32_t)i << 18);
             }
-            else if (type == BLOCK_TYPE_B) { contGroup = 1; }
-            else if ((type == BLOCK_TYPE_C || type == BLOCK_TYPE_CP) && lastType == BLOCK_TYPE_B) { contGroup++; }
-            else if (type == BLOCK_TYPE_D && (lastType == BLOCK_TYPE_C || lastType == BLOCK_TYPE_CP)) { contGroup++; }
-            else {
-                // If block B is available, decode it alone.
-                if (contGroup == 1) {
-                    decodeBlockB();
+
+            memset(types, -1, sizeof(types));
+            for (int i = 0; i < _BLOCK_TYPE_COUNT; i++) { types[lfsrSyndrome(OFFSETS[i])] = i; }
+
+            // All bursts up to 5 bits, shortest first so that they win over longer ones with the same syndrome
+            memset(bursts, 0, sizeof(bursts));
+            for (int len = 1; len <= MAX_BURST_LEN; len++) {
+                // A burst starts and ends with an error
+                int inner = std::max<int>(len - 2, 0);
+                for (uint32_t mid = 0; mid < (1u << inner); mid++) {
+                    uint32_t burst = (len == 1) ? 1 : ((1u << (len - 1)) | (mid << 1) | 1);
+                    for (int pos = 0; pos + len <= BLOCK_LEN; pos++) {
+                        uint16_t syn = lfsrSyndrome(burst << pos);
+                        if (!bursts[syn]) { bursts[syn] = burst << pos; }
+                    }
                 }
-                contGroup = 0;
             }
+        }
 
-            // If we've got an entire group, process it
-            if (contGroup >= 3) {
-                contGroup = 0;
-                decodeGroup();
-            }
+        uint16_t low[1024];
+        uint16_t mid[256];
+        uint16_t high[256];
+        int8_t types[1024];
+        uint32_t bursts[1024];
+    };
 
-            // // Remember the last block type and skip to new block
-            lastType = type;
-            skip = BLOCK_LEN;
+    static const SyndromeTables SYN_TABLES;
+
+    void Decoder::process(uint8_t* symbols, int count) {
+        for (int i = 0; i < count; i++) {
+            processBit(symbols[i] & 1, 0.0f, false);
         }
     }
 
-    uint16_t Decoder::calcSyndrome(uint32_t block) {
-        uint16_t syn = 0;
+    void Decoder::process(const float* symbols, int count) {
+        for (int i = 0; i < count; i++) {
+            processBit(symbols[i] > 0.0f, fabsf(symbols[i]), true);
+        }
+    }
 
-        // Calculate the syndrome using a LFSR
-        for (int i = BLOCK_LEN - 1; i >= 0; i--) {
-            // Shift the syndrome and keep the output
-            uint8_t outBit = (syn >> (POLY_LEN - 1)) & 1;
-            syn = (syn << 1) & 0b1111111111;
+    void Decoder::processBit(uint8_t bit, float reliability, bool soft) {
+        // Shift in the bit
+        shiftReg = ((shiftReg << 1) & 0x3FFFFFF) | bit;
+        bitReliability[bitCount++ % BLOCK_LEN] = reliability;
 
-            // Apply LFSR polynomial
-            syn ^= LFSR_POLY * outBit;
+        // Skip if we need to shift in new data
+        if (--skip > 0) { return; }
 
-            // Apply input polynomial.
-            syn ^= IN_POLY * ((block >> i) & 1);
+        // Calculate the syndrome and update sync status
+        uint32_t block = shiftReg;
+        int synType = SYN_TABLES.types[calcSyndrome(block)];
+        bool knownSyndrome = (synType >= 0);
+
+        // While in sync, the soft symbols can reveal the expected block when the hard decisions don't
+        if (!knownSyndrome && sync && soft) {
+            synType = softSync(block);
+            knownSyndrome = (synType >= 0);
         }
 
-        return syn;
-    }
+        sync = std::clamp<int>(knownSyndrome ? (sync + 1) : (sync - 1), 0, 4);
 
-    uint32_t Decoder::correctErrors(uint32_t block, BlockType type, bool& recovered) {        
-        // Subtract the offset from block
-        block ^= (uint32_t)OFFSETS[type];
-        uint32_t out = block;
+        // If we're still no longer in sync, try to resync
+        if (!sync) { return; }
 
-        // Calculate syndrome of corrected block
-        uint16_t syn = calcSyndrome(block);
+        // Figure out which block we've got
+        BlockType type;
+        if (knownSyndrome) {
+            type = (BlockType)synType;
+        }
+        else {
+            type = (BlockType)((lastType + 1) % _BLOCK_TYPE_COUNT);
+        }
+
+        // Save block while correcting errors
+        blocks[type] = correctErrors(block, type, blockAvail[type]);
+
+        // If block type is A, decode it directly, otherwise, update continous count
+        if (type == BLOCK_TYPE_A) {
+            decodeBlockA();
+        }
+        else if (type == BLOCK_TYPE_B) { contGroup = 1; }
+        else if ((type == BLOCK_TYPE_C || type == BLOCK_TYPE_CP) && lastType == BLOCK_TYPE_B) { contGroup++; }
+        else if (type == BLOCK_TYPE_D && (lastType == BLOCK_TYPE_C || lastType == BLOCK_TYPE_CP)) { contGroup++; }
+        else {
+            // If block B is available, decode it alone.
+            if (contGroup == 1) {
+                decodeBlockB();
+            }
+            contGroup = 0;
+        }
+
+        // If we've got an entire group, process it
+        if (contGroup >= 3) {
+            contGroup = 0;
+            decodeGroup();
+        }
+
+        // // Remember the last block type and skip to new block
+        lastType = type;
+        skip = BLOCK_LEN;
+
+        // Notify once the locks are released if the block changed anything
+        if (updated) {
+            updated = false;
+            onUpdate();
+        }
+    }
 
-        // Use the syndrome register to do error correction if errors are present
-        uint8_t errorFound = 0;
-        if (syn) {
-            for (int i = DATA_LEN - 1; i >= 0; i--) {
-                // Check if the 5 leftmost bits are all zero
-                errorFound |= !(syn & 0b11111);
+    int Decoder::softSync(uint32_t& block) {
+        // Block types that can follow the last one
+        BlockType expected[2];
+        int expectedCount = 1;
+        if (lastType == BLOCK_TYPE_B) {
+            expected[0] = BLOCK_TYPE_C;
+            expected[1] = BLOCK_TYPE_CP;
+            expectedCount = 2;
+        }
+        else if (lastType == BLOCK_TYPE_C || lastType == BLOCK_TYPE_CP) {
+            expected[0] = BLOCK_TYPE_D;
+        }
+        else {
+            expected[0] = (BlockType)((lastType + 1) % _BLOCK_TYPE_COUNT);
+        }
 
-                // Write output
-                uint8_t outBit = (syn >> (POLY_LEN - 1)) & 1;
-                out ^= (errorFound & outBit) << (i + POLY_LEN);
+        // Find the least reliable bits of the block (bit 0 is the newest)
+        int weakest[BLOCK_LEN];
+        for (int i = 0; i < BLOCK_LEN; i++) { weakest[i] = i; }
+        std::partial_sort(weakest, weakest + CHASE_BITS, weakest + BLOCK_LEN, [this](int a, int b) {
+            return bitReliability[(bitCount - 1 - a) % BLOCK_LEN] < bitReliability[(bitCount - 1 - b) % BLOCK_LEN];
+        });
 
-                // Shift syndrome
-                syn = (syn << 1) & 0b1111111111;
-                syn ^= LFSR_POLY * outBit * !errorFound;
+        // Accept the block if flipping some of them gives exactly the offset word of an expected block
+        uint16_t syn = calcSyndrome(block);
+        for (int pattern = 1; pattern < (1 << CHASE_BITS); pattern++) {
+            uint32_t flips = 0;
+            for (int i = 0; i < CHASE_BITS; i++) {
+                if ((pattern >> i) & 1) { flips |= 1u << weakest[i]; }
+            }
+            int type = SYN_TABLES.types[syn ^ calcSyndrome(flips)];
+            for (int i = 0; i < expectedCount; i++) {
+                if (type == expected[i]) {
+                    block ^= flips;
+                    return type;
+                }
             }
         }
-        recovered = !(syn & 0b11111);
+        return -1;
+    }
 
-        return out;
+    uint16_t Decoder::calcSyndrome(uint32_t block) {
+        return SYN_TABLES.low[block & 0x3FF] ^ SYN_TABLES.mid[(block >> 10) & 0xFF] ^ SYN_TABLES.high[(block >> 18) & 0xFF];
+    }
+
+    uint32_t Decoder::correctErrors(uint32_t block, BlockType type, bool& recovered) {
+        // Subtract the offset from block
+        block ^= (uint32_t)OFFSETS[type];
+
+        // Look up the error burst matching the syndrome, if any
+        uint16_t syn = calcSyndrome(block);
+        if (!syn) {
+            recovered = true;
+            return block;
+        }
+        uint32_t burst = SYN_TABLES.bursts[syn];
+        recovered = (burst != 0);
+        return block ^ burst;
     }
 
     void Decoder::decodeBlockA() {
@@ -234,7 +319,9 @@ namespace rds {
         if (!blockAvail[BLOCK_TYPE_A]) { return; }
 
         // Decode PI code
-        piCode = (blocks[BLOCK_TYPE_A] >> 10) & 0xFFFF;
+        uint16_t pi = (blocks[BLOCK_TYPE_A] >> 10) & 0xFFFF;
+        if (!blockAValid() || pi != piCode) { updated = true; }
+        piCode = pi;
         countryCode = (blocks[BLOCK_TYPE_A] >> 22) & 0xF;
         programCoverage = (AreaCoverage)((blocks[BLOCK_TYPE_A] >> 18) & 0xF);
         programRefNumber = (blocks[BLOCK_TYPE_A] >> 10) & 0xFF;
@@ -257,7 +344,9 @@ namespace rds {
 
         // Decode traffic program and program type
         trafficProgram = (blocks[BLOCK_TYPE_B] >> 20) & 1;
-        programType = (ProgramType)((blocks[BLOCK_TYPE_B] >> 15) & 0x1F);
+        ProgramType pty = (ProgramType)((blocks[BLOCK_TYPE_B] >> 15) & 0x1F);
+        if (!blockBValid() || pty != programType) { updated = true; }
+        programType = pty;
 
         // Update timeout
         blockBLastUpdate = std::chrono::high_resolution_clock::now();
@@ -286,9 +375,9 @@ namespace rds {
 
         // Write chars at offset the PSName
         if (blockAvail[BLOCK_TYPE_D]) {
-            programServiceName[psOffset] = (blocks[BLOCK_TYPE_D] >> 18) & 0xFF;
-            programServiceName[psOffset + 1] = (blocks[BLOCK_TYPE_D] >> 10) & 0xFF;
+            writeChars(programServiceName, psOffset, blocks[BLOCK_TYPE_D]);
         }
+        if (!group0Valid()) { updated = true; }
 
         // Update timeout
         group0LastUpdate = std::chrono::high_resolution_clock::now();
@@ -305,26 +394,25 @@ namespace rds {
         // Clear text field if the A/B flag changed
         if (nAB != rtAB) {
             radioText = "                                                                ";
+            updated = true;
         }
+        if (!group2Valid()) { updated = true; }
         rtAB = nAB;
 
         // Write char at offset in Radiotext
         if (groupVer == GROUP_VER_A) {
             uint8_t rtOffset = offset * 4;
             if (blockAvail[BLOCK_TYPE_C]) {
-                radioText[rtOffset] = (blocks[BLOCK_TYPE_C] >> 18) & 0xFF;
-                radioText[rtOffset + 1] = (blocks[BLOCK_TYPE_C] >> 10) & 0xFF;
+                writeChars(radioText, rtOffset, blocks[BLOCK_TYPE_C]);
             }
             if (blockAvail[BLOCK_TYPE_D]) {
-                radioText[rtOffset + 2] = (blocks[BLOCK_TYPE_D] >> 18) & 0xFF;
-                radioText[rtOffset + 3] = (blocks[BLOCK_TYPE_D] >> 10) & 0xFF;
+                writeChars(radioText, rtOffset + 2, blocks[BLOCK_TYPE_D]);
             }
         }
         else {
             uint8_t rtOffset = offset * 2;
             if (blockAvail[BLOCK_TYPE_D]) {
-                radioText[rtOffset] = (blocks[BLOCK_TYPE_D] >> 18) & 0xFF;
-                radioText[rtOffset + 1] = (blocks[BLOCK_TYPE_D] >> 10) & 0xFF;
+                writeChars(radioText, rtOffset, blocks[BLOCK_TYPE_D]);
             }
         }
 
@@ -332,6 +420,14 @@ namespace rds {
         group2LastUpdate = std::chrono::high_resolution_clock::now();
     }
 
+    void Decoder::writeChars(std::string& str, int offset, uint32_t block) {
+        char a = (block >> 18) & 0xFF;
+        char b = (block >> 10) & 0xFF;
+        if (str[offset] != a || str[offset + 1] != b) { updated = true; }
+        str[offset] = a;
+        str[offset + 1] = b;
+    }
+
     void Decoder::decodeGroup10() {
         // Acquire lock
         std::lock_guard<std::mutex> lck(group10Mtx);
@@ -3,6 +3,7 @@
 #include <string>
 #include <chrono>
 #include <mutex>
+#include <utils/new_event.h>
 
 #define RDS_BLOCK_A_TIMEOUT_MS  5000.0
 #define RDS_BLOCK_B_TIMEOUT_MS  5000.0
@@ -215,6 +216,9 @@ namespace rds {
     public:
         void process(uint8_t* symbols, int count);
 
+        // Soft symbols after differential decoding, positive is a 1. Their magnitude helps keeping sync on weak signals.
+        void process(const float* symbols, int count);
+
         bool piCodeValid() { std::lock_guard<std::mutex> lck(blockAMtx); return blockAValid(); }
         uint16_t getPICode() { std::lock_guard<std::mutex> lck(blockAMtx); return piCode; }
         uint8_t getCountryCode() { std::lock_guard<std::mutex> lck(blockAMtx); return countryCode; }
@@ -236,7 +240,12 @@ namespace rds {
         bool programTypeNameValid() { std::lock_guard<std::mutex> lck(group10Mtx); return group10Valid(); }
         std::string getProgramTypeName() { std::lock_guard<std::mutex> lck(group10Mtx); return programTypeName; }
 
+        // Called from the decoding thread when the PI code, program type, PS name or radiotext changed, or became valid again
+        NewEvent<> onUpdate;
+
     private:
+        void processBit(uint8_t bit, float reliability, bool soft);
+        int softSync(uint32_t& block);
         static uint16_t calcSyndrome(uint32_t block);
         static uint32_t correctErrors(uint32_t block, BlockType type, bool& recovered);
         void decodeBlockA();
@@ -244,6 +253,7 @@ namespace rds {
         void decodeGroup0();
         void decodeGroup2();
         void decodeGroup10();
+        void writeChars(std::string& str, int offset, uint32_t block);
         void decodeGroup();
 
         static std::string base26ToCall(uint16_t pi);
@@ -257,12 +267,15 @@ namespace rds {
 
         // State machine
         uint32_t shiftReg = 0;
+        float bitReliability[26];
+        uint32_t bitCount = 0;
         int sync = 0;
         int skip = 0;
         BlockType lastType = BLOCK_TYPE_A;
         int contGroup = 0;
         uint32_t blocks[_BLOCK_TYPE_COUNT];
         bool blockAvail[_BLOCK_TYPE_COUNT];
+        bool updated = false;
 
         // Block A (All groups)
         std::mutex blockAMtx;
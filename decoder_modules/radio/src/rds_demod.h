@@ -6,11 +6,10 @@
 #include <dsp/filter/fir.h>
 #include <dsp/convert/complex_to_real.h>
 #include <dsp/clock_recovery/mm.h>
-#include <dsp/digital/binary_slicer.h>
-#include <dsp/digital/differential_decoder.h>
 
-class RDSDemod : public dsp::Processor<dsp::complex_t, uint8_t> {
-    using base_type = dsp::Processor<dsp::complex_t, uint8_t>;
+// Outputs soft symbols after differential decoding, positive is a 1
+class RDSDemod : public dsp::Processor<dsp::complex_t, float> {
+    using base_type = dsp::Processor<dsp::complex_t, float>;
 public:
     RDSDemod() {}
     RDSDemod(dsp::stream<dsp::complex_t>* in, bool enableSoft) { init(in, enableSoft); }
@@ -28,7 +27,6 @@ public:
         double baudfreq = dsp::math::hzToRads(2375.0/2.0, 5000);
         costas2.init(NULL, 0.01, 0.0, baudfreq, baudfreq - (baudfreq*0.1), baudfreq + (baudfreq*0.1));
         recov.init(NULL, 5000.0 / (2375.0 / 2.0), 1e-6, 0.01, 0.01);
-        diff.init(NULL, 2);
 
         // Free useless buffers
         agc.out.free();
@@ -57,19 +55,23 @@ public:
         fir.reset();
         costas2.reset();
         recov.reset();
-        diff.reset();
+        lastSoft = 0.0f;
         base_type::tempStart();
     }
 
-    inline int process(int count, dsp::complex_t* in, float* softOut, uint8_t* hardOut) {
+    inline int process(int count, dsp::complex_t* in, float* softOut, float* out) {
         count = agc.process(count, in, costas.out.readBuf);
         count = costas.process(count, costas.out.readBuf, costas.out.writeBuf);
         count = fir.process(count, costas.out.writeBuf, costas.out.writeBuf);
         count = costas2.process(count, costas.out.writeBuf, costas.out.readBuf);
         count = dsp::convert::ComplexToReal::process(count, costas.out.readBuf, softOut);
         count = recov.process(count, softOut, softOut);
-        count = dsp::digital::BinarySlicer::process(count, softOut, diff.out.readBuf);
-        count = diff.process(count, diff.out.readBuf, hardOut);
+
+        // Differential decoding, the product of two symbols is positive when they are equal (a 0)
+        for (int i = 0; i < count; i++) {
+            out[i] = -softOut[i] * lastSoft;
+            lastSoft = softOut[i];
+        }
         return count;
     }
 
@@ -98,5 +100,5 @@ private:
     dsp::filter::FIR<dsp::complex_t, dsp::complex_t> fir;
     dsp::loop::Costas<2> costas2;
     dsp::clock_recovery::MM<float> recov;
-    dsp::digital::DifferentialDecoder diff;
+    float lastSoft = 0.0f;
 };
\ No newline at end of file
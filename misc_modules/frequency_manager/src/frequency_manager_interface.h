@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <vector>
+
+enum {
+    FREQ_MANAGER_IFACE_CMD_GET_LIST_NAMES,
+    FREQ_MANAGER_IFACE_CMD_GET_BOOKMARKS
+};
+
+struct FreqManagerBookmark {
+    std::string name;
+    double frequency;
+    double bandwidth;
+    int mode;
+};
@@ -6,6 +6,7 @@
 #include <core.h>
 #include <thread>
 #include <radio_interface.h>
+#include <frequency_manager_interface.h>
 #include <signal_path/signal_path.h>
 #include <vector>
 #include <gui/tuner.h>
@@ -81,9 +82,12 @@ public:
         gui::menu.registerEntry(name, menuHandler, this, NULL);
         gui::waterfall.onFFTRedraw.bindHandler(&fftRedrawHandler);
         gui::waterfall.onInputProcess.bindHandler(&inputHandler);
+
+        core::modComManager.registerInterface("frequency_manager", name, moduleInterfaceHandler, this);
     }
 
     ~FrequencyManagerModule() {
+        core::modComManager.unregisterInterface(name);
         gui::menu.removeEntry(name);
         gui::waterfall.onFFTRedraw.unbindHandler(&fftRedrawHandler);
         gui::waterfall.onInputProcess.unbindHandler(&inputHandler);
@@ -346,6 +350,35 @@ private:
         config.release(true);
     }
 
+    static void moduleInterfaceHandler(int code, void* in, void* out, void* ctx) {
+        if (code == FREQ_MANAGER_IFACE_CMD_GET_LIST_NAMES) {
+            std::vector<std::string>* _out = (std::vector<std::string>*)out;
+            _out->clear();
+            config.acquire();
+            for (auto [listName, list] : config.conf["lists"].items()) {
+                _out->push_back(listName);
+            }
+            config.release();
+        }
+        else if (code == FREQ_MANAGER_IFACE_CMD_GET_BOOKMARKS) {
+            std::string* _in = (std::string*)in;
+            std::vector<FreqManagerBookmark>* _out = (std::vector<FreqManagerBookmark>*)out;
+            _out->clear();
+            config.acquire();
+            if (config.conf["lists"].contains(*_in)) {
+                for (auto [bmName, bm] : config.conf["lists"][*_in]["bookmarks"].items()) {
+                    FreqManagerBookmark fbm;
+                    fbm.name = bmName;
+                    fbm.frequency = bm["frequency"];
+                    fbm.bandwidth = bm["bandwidth"];
+                    fbm.mode = bm["mode"];
+                    _out->push_back(fbm);
+                }
+            }
+            config.release();
+        }
+    }
+
     static void menuHandler(void* ctx) {
         FrequencyManagerModule* _this = (FrequencyManagerModule*)ctx;
         float menuWidth = ImGui::GetContentRegionAvail().x;
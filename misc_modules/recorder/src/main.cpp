@@ -102,6 +102,7 @@ public:
         basebandSink.init(NULL, complexHandler, this);
         stereoSink.init(&stereoStream, stereoHandler, this);
         monoSink.init(&s2m.out, monoHandler, this);
+        preRollSink.init(&preRollStream, preRollHandler, this);
 
         gui::menu.registerEntry(name, menuHandler, this);
         core::modComManager.registerInterface("recorder", name, moduleInterfaceHandler, this);
@@ -151,6 +152,10 @@ public:
     }
 
     void start() {
+        start(nameTemplate);
+    }
+
+    void start(const std::string& templ) {
         std::lock_guard<std::recursive_mutex> lck(recMtx);
         if (recording) { return; }
 
@@ -171,11 +176,12 @@ public:
         std::string type = (recMode == RECORDER_MODE_AUDIO) ? "audio" : "baseband";
         std::string vfoName = (recMode == RECORDER_MODE_AUDIO) ? selectedStreamName : "";
         std::string extension = ".wav";
-        std::string expandedPath = expandString(folderSelect.path + "/" + genFileName(nameTemplate, type, vfoName) + extension);
+        std::string expandedPath = expandString(folderSelect.path + "/" + genFileName(templ, type, vfoName) + extension);
         if (!writer.open(expandedPath)) {
             flog::error("Failed to open file for recording: {0}", expandedPath);
             return;
         }
+        recPath = expandedPath;
 
         // Open audio stream or baseband
         if (recMode == RECORDER_MODE_AUDIO) {
@@ -187,6 +193,11 @@ public:
                 s2m.start();
                 monoSink.start();
             }
+
+            // Write the pre-roll first, holding the lock until the live stream is bound so that nothing is duplicated.
+            // If the samplerate changed since the ring was sized, its content is at the wrong rate and is dropped.
+            std::lock_guard<std::mutex> plck(preRollMtx);
+            if (preRollSampleRate == samplerate) { writePreRoll(); }
             splitter.bindStream(&stereoStream);
         }
         else {
@@ -221,6 +232,13 @@ public:
 
         // Close file
         writer.close();
+
+        // Drop whatever the pre-roll caught while the recording was starting
+        {
+            std::lock_guard<std::mutex> plck(preRollMtx);
+            preRollWrite = 0;
+            preRollFill = 0;
+        }
         
         recording = false;
     }
@@ -230,6 +248,15 @@ private:
         RecorderModule* _this = (RecorderModule*)ctx;
         float menuWidth = ImGui::GetContentRegionAvail().x;
 
+        // Resize the pre-roll if the samplerate of the stream changed
+        {
+            std::lock_guard<std::recursive_mutex> lck(_this->recMtx);
+            if (_this->preRollBound && !_this->recording) {
+                uint64_t sr = sigpath::sinkManager.getStreamSampleRate(_this->selectedStreamName);
+                if (sr != _this->preRollSampleRate) { _this->resizePreRoll(sr); }
+            }
+        }
+
         // Recording mode
         if (_this->recording) { style::beginDisabled(); }
         ImGui::BeginGroup();
@@ -388,14 +415,68 @@ private:
         volume.start();
         splitter.start();
         meter.start();
+        if (preRoll > 0) {
+            resizePreRoll(sigpath::sinkManager.getStreamSampleRate(selectedStreamName));
+            splitter.bindStream(&preRollStream);
+            preRollSink.start();
+            preRollBound = true;
+        }
     }
 
     void stopAudioPath() {
+        if (preRollBound) {
+            splitter.unbindStream(&preRollStream);
+            preRollSink.stop();
+            preRollBound = false;
+        }
         volume.stop();
         splitter.stop();
         meter.stop();
     }
 
+    void setPreRoll(int ms) {
+        std::lock_guard<std::recursive_mutex> lck(recMtx);
+        bool audioPathRunning = !selectedStreamName.empty() && audioStream;
+        if (audioPathRunning) { stopAudioPath(); }
+        {
+            std::lock_guard<std::mutex> plck(preRollMtx);
+            preRoll = std::max<int>(ms, 0);
+        }
+        if (audioPathRunning) { startAudioPath(); }
+    }
+
+    void resizePreRoll(uint64_t sampleRate) {
+        // Sized here and not in the handler so that the DSP thread never allocates or queries the sink manager
+        std::lock_guard<std::mutex> plck(preRollMtx);
+        preRollSampleRate = sampleRate;
+        preRollBuf.clear();
+        preRollBuf.resize(std::max<int64_t>(((int64_t)preRoll * (int64_t)sampleRate) / 1000, 0));
+        preRollWrite = 0;
+        preRollFill = 0;
+    }
+
+    void writePreRoll() {
+        // Must be called with preRollMtx held
+        if (!preRollFill) { return; }
+
+        // Unroll the ring buffer so that the oldest sample comes first
+        std::vector<dsp::stereo_t> ordered;
+        if (preRollFill == preRollBuf.size()) { ordered.insert(ordered.end(), preRollBuf.begin() + preRollWrite, preRollBuf.end()); }
+        ordered.insert(ordered.end(), preRollBuf.begin(), preRollBuf.begin() + preRollWrite);
+        if (stereo) {
+            writer.write((float*)ordered.data(), ordered.size());
+        }
+        else {
+            std::vector<float> mono(ordered.size());
+            for (int i = 0; i < ordered.size(); i++) {
+                mono[i] = (ordered[i].l + ordered[i].r) / 2.0f;
+            }
+            writer.write(mono.data(), mono.size());
+        }
+        preRollWrite = 0;
+        preRollFill = 0;
+    }
+
     static void streamRegisteredHandler(std::string name, void* ctx) {
         RecorderModule* _this = (RecorderModule*)ctx;
 
@@ -534,6 +615,20 @@ private:
         _this->writer.write(data, count);
     }
 
+    static void preRollHandler(dsp::stereo_t* data, int count, void* ctx) {
+        RecorderModule* _this = (RecorderModule*)ctx;
+        std::lock_guard<std::mutex> lck(_this->preRollMtx);
+        if (_this->recording || _this->preRollBuf.empty()) { return; }
+
+        // Keep the last pre-roll worth of audio in a ring buffer
+        int size = _this->preRollBuf.size();
+        for (int i = 0; i < count; i++) {
+            _this->preRollBuf[_this->preRollWrite] = data[i];
+            _this->preRollWrite = (_this->preRollWrite + 1) % size;
+        }
+        _this->preRollFill = std::min<int>(_this->preRollFill + count, size);
+    }
+
     static void moduleInterfaceHandler(int code, void* in, void* out, void* ctx) {
         RecorderModule* _this = (RecorderModule*)ctx;
         std::lock_guard lck(_this->recMtx);
@@ -552,6 +647,23 @@ private:
         else if (code == RECORDER_IFACE_CMD_STOP) {
             if (_this->recording) { _this->stop(); }
         }
+        else if (code == RECORDER_IFACE_CMD_SET_STREAM) {
+            if (_this->recording) { return; }
+            std::string* _in = (std::string*)in;
+            if (*_in != _this->selectedStreamName) { _this->selectStream(*_in); }
+        }
+        else if (code == RECORDER_IFACE_CMD_SET_PRE_ROLL) {
+            int* _in = (int*)in;
+            if (*_in != _this->preRoll) { _this->setPreRoll(*_in); }
+        }
+        else if (code == RECORDER_IFACE_CMD_START_NAMED) {
+            std::string* _in = (std::string*)in;
+            if (!_this->recording) { _this->start(*_in); }
+        }
+        else if (code == RECORDER_IFACE_CMD_GET_PATH) {
+            std::string* _out = (std::string*)out;
+            *_out = _this->recPath;
+        }
     }
 
     std::string name;
@@ -581,6 +693,18 @@ private:
     dsp::sink::Handler<dsp::complex_t> basebandSink;
     dsp::sink::Handler<dsp::stereo_t> stereoSink;
     dsp::sink::Handler<float> monoSink;
+    std::string recPath;
+
+    // Pre-roll
+    int preRoll = 0;
+    std::vector<dsp::stereo_t> preRollBuf;
+    int preRollWrite = 0;
+    int preRollFill = 0;
+    uint64_t preRollSampleRate = 0;
+    bool preRollBound = false;
+    std::mutex preRollMtx;
+    dsp::stream<dsp::stereo_t> preRollStream;
+    dsp::sink::Handler<dsp::stereo_t> preRollSink;
 
     OptionList<std::string, std::string> audioStreams;
     int streamId = 0;
@@ -4,10 +4,14 @@ enum {
     RECORDER_IFACE_CMD_GET_MODE,
     RECORDER_IFACE_CMD_SET_MODE,
     RECORDER_IFACE_CMD_START,
-    RECORDER_IFACE_CMD_STOP
+    RECORDER_IFACE_CMD_STOP,
+    RECORDER_IFACE_CMD_SET_STREAM,      // in: std::string* name of the audio stream
+    RECORDER_IFACE_CMD_SET_PRE_ROLL,    // in: int* audio kept before the start of a recording in ms, 0 to disable
+    RECORDER_IFACE_CMD_START_NAMED,     // in: std::string* name template used for this recording only
+    RECORDER_IFACE_CMD_GET_PATH         // out: std::string* path of the current or last recording
 };
 
 enum {
     RECORDER_MODE_BASEBAND,
     RECORDER_MODE_AUDIO
-};
\ No newline at end of file
+};
@@ -0,0 +1,224 @@
+#include "channel_monitor.h"
+#include <signal_path/signal_path.h>
+#include <gui/gui.h>
+#include <core.h>
+#include <radio_interface.h>
+#include <algorithm>
+
+ChannelMonitor::~ChannelMonitor() {
+    stop();
+}
+
+void ChannelMonitor::start() {
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (running) { return; }
+        detector.reset();
+        newSpectrum = false;
+        running = true;
+
+        // Start buffering the pre-roll of every recorder
+        if (_hits) {
+            for (const auto& r : _receivers) { _hits->arm(r.recorder, r.radio); }
+        }
+    }
+    spectrumHandlerId = sigpath::iqFrontEnd.onSpectrum.bind(&ChannelMonitor::spectrumHandler, this);
+    workerThread = std::thread(&ChannelMonitor::worker, this);
+}
+
+void ChannelMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!running) { return; }
+        running = false;
+    }
+    cnd.notify_all();
+    sigpath::iqFrontEnd.onSpectrum.unbind(spectrumHandlerId);
+    if (workerThread.joinable()) { workerThread.join(); }
+
+    // Free all receivers
+    std::lock_guard<std::mutex> lck(mtx);
+    for (int i = 0; i < _receivers.size(); i++) {
+        if (_receivers[i].channel >= 0) { detach(i); }
+        if (_hits) { _hits->disarm(_receivers[i].recorder); }
+    }
+}
+
+bool ChannelMonitor::isRunning() {
+    std::lock_guard<std::mutex> lck(mtx);
+    return running;
+}
+
+void ChannelMonitor::setChannels(const std::vector<Channel>& channels) {
+    std::lock_guard<std::mutex> lck(mtx);
+    for (int i = 0; i < _receivers.size(); i++) {
+        if (_receivers[i].channel >= 0) { detach(i); }
+    }
+    _channels = channels;
+}
+
+void ChannelMonitor::setReceivers(const std::vector<Receiver>& receivers) {
+    std::lock_guard<std::mutex> lck(mtx);
+    for (int i = 0; i < _receivers.size(); i++) {
+        if (_receivers[i].channel >= 0) { detach(i); }
+        if (running && _hits) { _hits->disarm(_receivers[i].recorder); }
+    }
+    _receivers = receivers;
+    if (running && _hits) {
+        for (const auto& r : _receivers) { _hits->arm(r.recorder, r.radio); }
+    }
+}
+
+void ChannelMonitor::setHitRecorder(HitRecorder* hits) {
+    std::lock_guard<std::mutex> lck(mtx);
+    _hits = hits;
+}
+
+void ChannelMonitor::setSquelch(int channel, float squelch) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (channel < 0 || channel >= _channels.size()) { return; }
+    _channels[channel].squelch = squelch;
+}
+
+void ChannelMonitor::setPriority(int channel, int priority) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (channel < 0 || channel >= _channels.size()) { return; }
+    _channels[channel].priority = priority;
+}
+
+void ChannelMonitor::setDwellTime(int ms) {
+    std::lock_guard<std::mutex> lck(mtx);
+    _dwellTime = ms;
+}
+
+void ChannelMonitor::setHangTime(int ms) {
+    std::lock_guard<std::mutex> lck(mtx);
+    _hangTime = ms;
+}
+
+void ChannelMonitor::getState(std::vector<Channel>& channels, std::vector<Receiver>& receivers) {
+    std::lock_guard<std::mutex> lck(mtx);
+    channels = _channels;
+    receivers = _receivers;
+}
+
+void ChannelMonitor::spectrumHandler(const float* data, int count, double sampleRate) {
+    // Runs in the FFT thread, every channel in the baseband is evaluated at once
+    auto now = std::chrono::high_resolution_clock::now();
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        detector.process(data, count, sampleRate);
+        const float* floor = detector.getNoiseFloor();
+
+        double center = gui::waterfall.getCenterFrequency();
+        double binsPerHz = (double)count / sampleRate;
+        for (auto& ch : _channels) {
+            double offset = ch.frequency - center;
+            ch.inBand = (fabs(offset) + (ch.bandwidth / 2.0)) <= (sampleRate / 2.0);
+            if (!ch.inBand) {
+                ch.active = false;
+                ch.snr = -INFINITY;
+                continue;
+            }
+
+            // Peak level above the average noise floor over the channel
+            int lowId = std::clamp<int>(((offset - (ch.bandwidth / 2.0)) * binsPerHz) + (count / 2), 0, count - 1);
+            int highId = std::clamp<int>(((offset + (ch.bandwidth / 2.0)) * binsPerHz) + (count / 2), lowId, count - 1);
+            float peak = -INFINITY;
+            float floorSum = 0.0f;
+            for (int i = lowId; i <= highId; i++) {
+                if (data[i] > peak) { peak = data[i]; }
+                floorSum += floor[i];
+            }
+            ch.snr = peak - (floorSum / (float)(highId - lowId + 1));
+
+            // Squelch with hysteresis
+            ch.active = ch.active ? (ch.snr >= ch.squelch - SQUELCH_HYSTERESIS) : (ch.snr >= ch.squelch);
+            if (ch.active) { ch.lastActive = now; }
+            if (ch.receiver >= 0 && _hits) { _hits->update(_receivers[ch.receiver].recorder, ch.snr); }
+        }
+        newSpectrum = true;
+    }
+    cnd.notify_all();
+}
+
+void ChannelMonitor::worker() {
+    std::unique_lock<std::mutex> lck(mtx);
+    while (true) {
+        cnd.wait(lck, [this] { return newSpectrum || !running; });
+        if (!running) { return; }
+        newSpectrum = false;
+        assign(std::chrono::high_resolution_clock::now());
+    }
+}
+
+void ChannelMonitor::assign(std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    // Release receivers whose channel went quiet for longer than the hang time
+    for (int i = 0; i < _receivers.size(); i++) {
+        int ch = _receivers[i].channel;
+        if (ch < 0) { continue; }
+        const Channel& c = _channels[ch];
+        bool expired = (std::chrono::duration_cast<std::chrono::milliseconds>(now - c.lastActive)).count() > _hangTime;
+        if (!c.inBand || (!c.active && expired)) { detach(i); }
+    }
+
+    // List the active channels without a receiver, most important first
+    std::vector<int> pending;
+    for (int i = 0; i < _channels.size(); i++) {
+        if (_channels[i].active && _channels[i].receiver < 0) { pending.push_back(i); }
+    }
+    std::sort(pending.begin(), pending.end(), [this](int a, int b) {
+        if (_channels[a].priority != _channels[b].priority) { return _channels[a].priority > _channels[b].priority; }
+        return _channels[a].snr > _channels[b].snr;
+    });
+
+    for (int ch : pending) {
+        // Take a free receiver if there is one
+        int rx = -1;
+        for (int i = 0; i < _receivers.size(); i++) {
+            if (_receivers[i].channel < 0) { rx = i; break; }
+        }
+
+        // Otherwise preempt the lowest priority receiver that has dwelt long enough
+        if (rx < 0) {
+            for (int i = 0; i < _receivers.size(); i++) {
+                const Receiver& r = _receivers[i];
+                if (_channels[r.channel].priority >= _channels[ch].priority) { continue; }
+                if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - r.assignedTime)).count() < _dwellTime) { continue; }
+                if (rx < 0 || _channels[r.channel].priority < _channels[_receivers[rx].channel].priority) { rx = i; }
+            }
+            if (rx < 0) { continue; }
+            detach(rx);
+        }
+
+        attach(rx, ch, now);
+    }
+}
+
+void ChannelMonitor::attach(int rx, int ch, std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+    Receiver& r = _receivers[rx];
+    Channel& c = _channels[ch];
+    r.channel = ch;
+    r.assignedTime = now;
+    c.receiver = rx;
+
+    // Configure the radio for the channel and move its VFO without retuning the source
+    if (core::modComManager.getModuleName(r.radio) == "radio") {
+        int mode = (_hits && _hits->isIQ()) ? RADIO_IFACE_MODE_RAW : c.mode;
+        float bandwidth = c.bandwidth;
+        core::modComManager.callInterface(r.radio, RADIO_IFACE_CMD_SET_MODE, &mode, NULL);
+        core::modComManager.callInterface(r.radio, RADIO_IFACE_CMD_SET_BANDWIDTH, &bandwidth, NULL);
+    }
+    sigpath::vfoManager.setCenterOffset(r.radio, c.frequency - gui::waterfall.getCenterFrequency());
+
+    if (_hits) { _hits->begin(r.recorder, r.radio, c.name, c.frequency); }
+}
+
+void ChannelMonitor::detach(int rx) {
+    Receiver& r = _receivers[rx];
+    if (_hits) { _hits->end(r.recorder); }
+    if (r.channel >= 0 && r.channel < _channels.size()) {
+        _channels[r.channel].receiver = -1;
+    }
+    r.channel = -1;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <dsp/detector/carrier_detector.h>
+#include <utils/new_event.h>
+#include "hit_recorder.h"
+
+// Watches a list of channels at once from the full resolution spectrum and hands
+// the active ones out to a pool of radio VFOs (and optionally their recorders)
+class ChannelMonitor {
+public:
+    struct Channel {
+        std::string name;
+        double frequency;
+        double bandwidth;
+        int mode;
+        float squelch = 10.0f;  // SNR in dB above which the channel is considered active
+        int priority = 0;       // Higher priority channels can take receivers from lower priority ones
+
+        // State
+        bool inBand = false;
+        bool active = false;
+        float snr = -INFINITY;
+        int receiver = -1;
+        std::chrono::time_point<std::chrono::high_resolution_clock> lastActive;
+    };
+
+    struct Receiver {
+        std::string radio;
+        std::string recorder;   // Empty if the receiver doesn't record
+
+        // State
+        int channel = -1;
+        std::chrono::time_point<std::chrono::high_resolution_clock> assignedTime;
+    };
+
+    ~ChannelMonitor();
+
+    void start();
+    void stop();
+    bool isRunning();
+
+    void setChannels(const std::vector<Channel>& channels);
+    void setReceivers(const std::vector<Receiver>& receivers);
+    void setHitRecorder(HitRecorder* hits);
+    void setSquelch(int channel, float squelch);
+    void setPriority(int channel, int priority);
+
+    // Minimum time a receiver stays on a channel before it can be preempted by a higher priority one
+    void setDwellTime(int ms);
+
+    // Time a receiver stays on a channel after the signal disappeared
+    void setHangTime(int ms);
+
+    // Copy of the current state for display
+    void getState(std::vector<Channel>& channels, std::vector<Receiver>& receivers);
+
+private:
+    void spectrumHandler(const float* data, int count, double sampleRate);
+    void worker();
+    void assign(std::chrono::time_point<std::chrono::high_resolution_clock> now);
+    void attach(int rx, int ch, std::chrono::time_point<std::chrono::high_resolution_clock> now);
+    void detach(int rx);
+
+    std::vector<Channel> _channels;
+    std::vector<Receiver> _receivers;
+    int _dwellTime = 2000;
+    int _hangTime = 1000;
+    HitRecorder* _hits = NULL;
+
+    dsp::detector::CarrierDetector detector;
+    HandlerID spectrumHandlerId;
+    std::thread workerThread;
+    std::mutex mtx;
+    std::condition_variable cnd;
+    bool newSpectrum = false;
+    bool running = false;
+
+    static constexpr float SQUELCH_HYSTERESIS = 3.0f;
+};
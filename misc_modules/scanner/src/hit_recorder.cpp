@@ -0,0 +1,167 @@
+#include "hit_recorder.h"
+#include <core.h>
+#include <config.h>
+#include <utils/flog.h>
+#include <radio_interface.h>
+#include <recorder_interface.h>
+#include <filesystem>
+#include <fstream>
+#include <ctime>
+
+static std::string formatTime(std::chrono::system_clock::time_point tp) {
+    time_t t = std::chrono::system_clock::to_time_t(tp);
+    tm* ltm = localtime(&t);
+    char buf[64];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", ltm);
+    return buf;
+}
+
+// Quotes doubled inside a quoted field
+static std::string csvField(const std::string& str) {
+    std::string out = "\"";
+    for (char c : str) {
+        if (c == '"') { out += '"'; }
+        out += c;
+    }
+    return out + "\"";
+}
+
+static bool isRecorder(const std::string& name) {
+    return !name.empty() && core::modComManager.getModuleName(name) == "recorder";
+}
+
+void HitRecorder::setPreRoll(int ms) {
+    std::lock_guard<std::mutex> lck(mtx);
+    preRoll = ms;
+    for (auto& [recorder, a] : armed) {
+        core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_SET_PRE_ROLL, &preRoll, NULL);
+    }
+}
+
+void HitRecorder::setIQ(bool enabled) {
+    std::lock_guard<std::mutex> lck(mtx);
+    iq = enabled;
+}
+
+void HitRecorder::setIndex(const std::string& path, IndexFormat format) {
+    std::lock_guard<std::mutex> lck(mtx);
+    indexPath = path;
+    indexFormat = format;
+}
+
+bool HitRecorder::isIQ() {
+    std::lock_guard<std::mutex> lck(mtx);
+    return iq;
+}
+
+void HitRecorder::arm(const std::string& recorder, const std::string& radio) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (!isRecorder(recorder)) { return; }
+
+    // Record the audio output of the radio
+    int mode = RECORDER_MODE_AUDIO;
+    std::string stream = radio;
+    core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_SET_MODE, &mode, NULL);
+    core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_SET_STREAM, &stream, NULL);
+    core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_SET_PRE_ROLL, &preRoll, NULL);
+
+    // For IQ snippets, the radio outputs the raw narrowband IQ of its VFO instead of audio
+    Armed a;
+    a.radio = radio;
+    a.savedMode = -1;
+    if (iq && core::modComManager.getModuleName(radio) == "radio") {
+        int raw = RADIO_IFACE_MODE_RAW;
+        core::modComManager.callInterface(radio, RADIO_IFACE_CMD_GET_MODE, NULL, &a.savedMode);
+        core::modComManager.callInterface(radio, RADIO_IFACE_CMD_SET_MODE, &raw, NULL);
+    }
+    armed[recorder] = a;
+}
+
+void HitRecorder::disarm(const std::string& recorder) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (hits.find(recorder) != hits.end()) { endHit(recorder); }
+    auto it = armed.find(recorder);
+    if (it == armed.end()) { return; }
+
+    int noPreRoll = 0;
+    core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_SET_PRE_ROLL, &noPreRoll, NULL);
+    if (it->second.savedMode >= 0) {
+        core::modComManager.callInterface(it->second.radio, RADIO_IFACE_CMD_SET_MODE, &it->second.savedMode, NULL);
+    }
+    armed.erase(it);
+}
+
+void HitRecorder::begin(const std::string& recorder, const std::string& radio, const std::string& channel, double frequency) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (!isRecorder(recorder)) { return; }
+    if (hits.find(recorder) != hits.end()) { endHit(recorder); }
+
+    Hit hit;
+    hit.radio = radio;
+    hit.channel = channel;
+    hit.frequency = frequency;
+    hit.start = std::chrono::system_clock::now();
+    hit.peakSnr = -INFINITY;
+
+    // One file per hit, named after the channel
+    std::string safeName = channel;
+    for (auto& c : safeName) {
+        if (!isalnum((unsigned char)c) && c != '-') { c = '_'; }
+    }
+    std::string templ = std::string(iq ? "iq" : "$t") + "_" + safeName + "_$f_$y$M$d_$h$m$s";
+    core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_START_NAMED, &templ, NULL);
+    core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_GET_PATH, NULL, &hit.path);
+
+    hits[recorder] = hit;
+}
+
+void HitRecorder::update(const std::string& recorder, float snr) {
+    std::lock_guard<std::mutex> lck(mtx);
+    auto it = hits.find(recorder);
+    if (it == hits.end()) { return; }
+    if (snr > it->second.peakSnr) { it->second.peakSnr = snr; }
+}
+
+void HitRecorder::end(const std::string& recorder) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (hits.find(recorder) == hits.end()) { return; }
+    endHit(recorder);
+}
+
+void HitRecorder::endHit(const std::string& recorder) {
+    core::modComManager.callInterface(recorder, RECORDER_IFACE_CMD_STOP, NULL, NULL);
+    writeIndex(hits[recorder], std::chrono::system_clock::now());
+    hits.erase(recorder);
+}
+
+void HitRecorder::writeIndex(const Hit& hit, std::chrono::system_clock::time_point end) {
+    if (indexPath.empty()) { return; }
+    bool isNew = !std::filesystem::exists(indexPath);
+    std::ofstream file(indexPath, std::ios::out | std::ios::app);
+    if (!file.is_open()) {
+        flog::error("Could not open hit index file: {0}", indexPath);
+        return;
+    }
+
+    double duration = (std::chrono::duration_cast<std::chrono::milliseconds>(end - hit.start)).count() / 1000.0;
+    if (indexFormat == INDEX_FORMAT_JSON) {
+        // One JSON object per line so that the file can be appended to
+        json entry;
+        entry["start"] = formatTime(hit.start);
+        entry["end"] = formatTime(end);
+        entry["duration"] = duration;
+        entry["channel"] = hit.channel;
+        entry["frequency"] = hit.frequency;
+        entry["peakSnr"] = std::isfinite(hit.peakSnr) ? hit.peakSnr : 0.0f;
+        entry["radio"] = hit.radio;
+        entry["file"] = hit.path;
+        file << entry.dump() << std::endl;
+    }
+    else {
+        if (isNew) { file << "start,end,duration,channel,frequency,peak_snr,radio,file" << std::endl; }
+        char freqStr[64];
+        sprintf(freqStr, "%.0lf", hit.frequency);
+        file << formatTime(hit.start) << "," << formatTime(end) << "," << duration << "," << csvField(hit.channel) << "," << freqStr << ",";
+        file << (std::isfinite(hit.peakSnr) ? hit.peakSnr : 0.0f) << "," << csvField(hit.radio) << "," << csvField(hit.path) << std::endl;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <string>
+#include <map>
+#include <mutex>
+#include <chrono>
+
+// Drives recorder instances through their module-com interface so that every
+// scanner hit gets its own file, and keeps an index of all hits
+class HitRecorder {
+public:
+    enum IndexFormat {
+        INDEX_FORMAT_CSV,
+        INDEX_FORMAT_JSON
+    };
+
+    void setPreRoll(int ms);
+    void setIQ(bool enabled);
+    void setIndex(const std::string& path, IndexFormat format);
+    bool isIQ();
+
+    // Prepare a recorder to follow a radio so that it starts buffering its pre-roll
+    void arm(const std::string& recorder, const std::string& radio);
+    void disarm(const std::string& recorder);
+
+    // Start recording the audio of a radio on a recorder instance
+    void begin(const std::string& recorder, const std::string& radio, const std::string& channel, double frequency);
+
+    // Report the current SNR of the hit being recorded
+    void update(const std::string& recorder, float snr);
+
+    // Stop the recording and append it to the index
+    void end(const std::string& recorder);
+
+private:
+    struct Hit {
+        std::string radio;
+        std::string channel;
+        double frequency;
+        std::chrono::system_clock::time_point start;
+        float peakSnr;
+        std::string path;
+    };
+
+    struct Armed {
+        std::string radio;
+        int savedMode;
+    };
+
+    void endHit(const std::string& recorder);
+
+    void writeIndex(const Hit& hit, std::chrono::system_clock::time_point end);
+
+    std::map<std::string, Hit> hits;
+    std::map<std::string, Armed> armed;
+    std::string indexPath;
+    IndexFormat indexFormat = INDEX_FORMAT_CSV;
+    int preRoll = 0;
+    bool iq = false;
+    std::mutex mtx;
+
+};
@@ -3,6 +3,14 @@
 #include <gui/gui.h>
 #include <gui/style.h>
 #include <signal_path/signal_path.h>
+#include <signal_path/sweeper.h>
+#include <dsp/detector/carrier_detector.h>
+#include <condition_variable>
+#include <config.h>
+#include <core.h>
+#include <frequency_manager_interface.h>
+#include "channel_monitor.h"
+#include "hit_recorder.h"
 
 SDRPP_MOD_INFO{
     /* Name:            */ "scanner",
@@ -12,10 +20,51 @@ SDRPP_MOD_INFO{
     /* Max instances    */ 1
 };
 
+ConfigManager config;
+
 class ScannerModule : public ModuleManager::Instance {
 public:
     ScannerModule(std::string name) {
         this->name = name;
+
+        // Load config
+        config.acquire();
+        if (config.conf[name].contains("channelList")) {
+            channelList = config.conf[name]["channelList"];
+        }
+        if (config.conf[name].contains("dwellTime")) {
+            dwellTime = config.conf[name]["dwellTime"];
+        }
+        if (config.conf[name].contains("hangTime")) {
+            hangTime = config.conf[name]["hangTime"];
+        }
+        if (config.conf[name].contains("scanRecorder")) {
+            scanRecorder = config.conf[name]["scanRecorder"];
+        }
+        if (config.conf[name].contains("preRoll")) {
+            preRoll = config.conf[name]["preRoll"];
+        }
+        if (config.conf[name].contains("snippetIQ")) {
+            snippetIQ = config.conf[name]["snippetIQ"];
+        }
+        if (config.conf[name].contains("indexPath")) {
+            std::string path = config.conf[name]["indexPath"];
+            snprintf(indexPath, sizeof(indexPath), "%s", path.c_str());
+        }
+        else {
+            std::string path = core::args["root"].s() + "/recordings/scanner_hits.csv";
+            snprintf(indexPath, sizeof(indexPath), "%s", path.c_str());
+        }
+        if (config.conf[name].contains("indexFormat")) {
+            indexFormat = config.conf[name]["indexFormat"];
+        }
+        config.release();
+
+        hits.setPreRoll(preRoll);
+        hits.setIQ(snippetIQ);
+        hits.setIndex(indexPath, (HitRecorder::IndexFormat)indexFormat);
+        monitor.setHitRecorder(&hits);
+
         gui::menu.registerEntry(name, menuHandler, this, NULL);
     }
 
@@ -24,7 +73,11 @@ public:
         stop();
     }
 
-    void postInit() {}
+    void postInit() {
+        // The frequency manager and radios only exist once all instances are created
+        refreshChannelSources();
+        loadChannels();
+    }
 
     void enable() {
         enabled = true;
@@ -44,6 +97,16 @@ private:
         float menuWidth = ImGui::GetContentRegionAvail().x;
         
         if (_this->running) { ImGui::BeginDisabled(); }
+        ImGui::LeftLabel("Mode");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        ImGui::Combo(("##scanner_mode_" + _this->name).c_str(), &_this->mode, "Scan\0Sweep\0Channels\0");
+        if (_this->mode == MODE_CHANNELS) {
+            _this->drawChannelSettings(menuWidth);
+            _this->drawRecordingSettings(menuWidth);
+            if (_this->running) { ImGui::EndDisabled(); }
+            _this->drawChannels(menuWidth);
+            return;
+        }
         ImGui::LeftLabel("Start");
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
         if (ImGui::InputDouble("##start_freq_scanner", &_this->startFreq, 100.0, 100000.0, "%0.0f")) {
@@ -54,31 +117,86 @@ private:
         if (ImGui::InputDouble("##stop_freq_scanner", &_this->stopFreq, 100.0, 100000.0, "%0.0f")) {
             _this->stopFreq = round(_this->stopFreq);
         }
-        ImGui::LeftLabel("Interval");
-        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
-        if (ImGui::InputDouble("##interval_scanner", &_this->interval, 100.0, 100000.0, "%0.0f")) {
-            _this->interval = round(_this->interval);
+        if (_this->mode == MODE_SCAN) {
+            ImGui::LeftLabel("Interval");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputDouble("##interval_scanner", &_this->interval, 100.0, 100000.0, "%0.0f")) {
+                _this->interval = round(_this->interval);
+            }
+            ImGui::LeftLabel("Passband Ratio (%)");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputDouble("##pb_ratio_scanner", &_this->passbandRatio, 1.0, 10.0, "%0.0f")) {
+                _this->passbandRatio = std::clamp<double>(round(_this->passbandRatio), 1.0, 100.0);
+            }
+            ImGui::LeftLabel("Tuning Time (ms)");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputInt("##tuning_time_scanner", &_this->tuningTime, 100, 1000)) {
+                _this->tuningTime = std::clamp<int>(_this->tuningTime, 100, 10000.0);
+            }
+            ImGui::LeftLabel("Linger Time (ms)");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputInt("##linger_time_scanner", &_this->lingerTime, 100, 1000)) {
+                _this->lingerTime = std::clamp<int>(_this->lingerTime, 100, 10000.0);
+            }
+            ImGui::LeftLabel("Recorder");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::Combo(("##scanner_scan_rec_" + _this->name).c_str(), &_this->scanRecorderId, _this->recorderNamesTxt.c_str())) {
+                _this->scanRecorder = (_this->scanRecorderId > 0) ? _this->recorderNames[_this->scanRecorderId - 1] : "";
+                config.acquire();
+                config.conf[_this->name]["scanRecorder"] = _this->scanRecorder;
+                config.release(true);
+            }
+            if (_this->scanRecorderId > 0) { _this->drawRecordingSettings(menuWidth); }
         }
-        ImGui::LeftLabel("Passband Ratio (%)");
-        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
-        if (ImGui::InputDouble("##pb_ratio_scanner", &_this->passbandRatio, 1.0, 10.0, "%0.0f")) {
-            _this->passbandRatio = std::clamp<double>(round(_this->passbandRatio), 1.0, 100.0);
+        else {
+            ImGui::LeftLabel("Usable Bandwidth (%)");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputDouble("##usable_bw_scanner", &_this->usableRatio, 1.0, 10.0, "%0.0f")) {
+                _this->usableRatio = std::clamp<double>(round(_this->usableRatio), 10.0, 100.0);
+            }
+            ImGui::LeftLabel("Averaging");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputInt("##averaging_scanner", &_this->averaging, 1, 10)) {
+                _this->averaging = std::clamp<int>(_this->averaging, 1, 100);
+            }
+            ImGui::LeftLabel("Settle Time (ms)");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::InputInt("##settle_time_scanner", &_this->settleTime, 1, 10)) {
+                _this->settleTime = std::clamp<int>(_this->settleTime, 0, 1000);
+            }
         }
-        ImGui::LeftLabel("Tuning Time (ms)");
-        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
-        if (ImGui::InputInt("##tuning_time_scanner", &_this->tuningTime, 100, 1000)) {
-            _this->tuningTime = std::clamp<int>(_this->tuningTime, 100, 10000.0);
+        if (_this->running) { ImGui::EndDisabled(); }
+
+        if (_this->mode == MODE_SCAN) {
+            ImGui::LeftLabel("Level");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            ImGui::SliderFloat("##scanner_level", &_this->level, -150.0, 0.0);
         }
-        ImGui::LeftLabel("Linger Time (ms)");
+
+        ImGui::LeftLabel("Min SNR (dB)");
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
-        if (ImGui::InputInt("##linger_time_scanner", &_this->lingerTime, 100, 1000)) {
-            _this->lingerTime = std::clamp<int>(_this->lingerTime, 100, 10000.0);
+        if (ImGui::SliderFloat("##scanner_min_snr", &_this->minSnr, 0.0, 50.0)) {
+            std::lock_guard<std::mutex> lck(_this->scanMtx);
+            std::lock_guard<std::mutex> lck2(_this->sweepMtx);
+            _this->detector.setThresholds(_this->minSnr, _this->minSnr - SNR_HYSTERESIS);
         }
-        if (_this->running) { ImGui::EndDisabled(); }
 
-        ImGui::LeftLabel("Level");
-        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
-        ImGui::SliderFloat("##scanner_level", &_this->level, -150.0, 0.0);
+        if (_this->mode == MODE_SWEEP) {
+            _this->drawSweep(menuWidth);
+            if (!_this->running) {
+                if (ImGui::Button("Start##scanner_start", ImVec2(menuWidth, 0))) {
+                    _this->start();
+                }
+                ImGui::Text("Status: Idle");
+            }
+            else {
+                if (ImGui::Button("Stop##scanner_start", ImVec2(menuWidth, 0))) {
+                    _this->stop();
+                }
+                ImGui::TextColored(ImVec4(0, 1, 1, 1), "Status: Sweeping (%.2fs per sweep)", _this->sweeper.getSweepTime());
+            }
+            return;
+        }
 
         ImGui::BeginTable(("scanner_bottom_btn_table" + _this->name).c_str(), 2);
         ImGui::TableNextRow();
@@ -120,115 +238,469 @@ private:
         }
     }
 
+    void drawChannelSettings(float menuWidth) {
+        ImGui::LeftLabel("List");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::Combo(("##scanner_channel_list_" + name).c_str(), &channelListId, channelListsTxt.c_str())) {
+            channelList = channelLists[channelListId];
+            loadChannels();
+            config.acquire();
+            config.conf[name]["channelList"] = channelList;
+            config.release(true);
+        }
+        ImGui::LeftLabel("Dwell Time (ms)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputInt("##dwell_time_scanner", &dwellTime, 100, 1000)) {
+            dwellTime = std::clamp<int>(dwellTime, 0, 60000);
+            monitor.setDwellTime(dwellTime);
+            config.acquire();
+            config.conf[name]["dwellTime"] = dwellTime;
+            config.release(true);
+        }
+        ImGui::LeftLabel("Hang Time (ms)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputInt("##hang_time_scanner", &hangTime, 100, 1000)) {
+            hangTime = std::clamp<int>(hangTime, 0, 60000);
+            monitor.setHangTime(hangTime);
+            config.acquire();
+            config.conf[name]["hangTime"] = hangTime;
+            config.release(true);
+        }
+
+        // Receiver pool, each radio can optionally drive a recorder
+        if (ImGui::BeginTable(("scanner_rx_table" + name).c_str(), 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Radio");
+            ImGui::TableSetupColumn("Recorder");
+            ImGui::TableHeadersRow();
+            bool changed = false;
+            for (auto& rx : receiverOptions) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                changed |= ImGui::Checkbox((rx.radio + "##scanner_rx_" + name).c_str(), &rx.enabled);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+                changed |= ImGui::Combo(("##scanner_rx_rec_" + rx.radio + name).c_str(), &rx.recorderId, recorderNamesTxt.c_str());
+            }
+            ImGui::EndTable();
+            if (changed) {
+                applyReceivers();
+                saveReceivers();
+            }
+        }
+
+        if (ImGui::Button(("Refresh##scanner_channel_refresh_" + name).c_str(), ImVec2(menuWidth, 0))) {
+            refreshChannelSources();
+            loadChannels();
+        }
+    }
+
+    void drawChannels(float menuWidth) {
+        std::vector<ChannelMonitor::Channel> channels;
+        std::vector<ChannelMonitor::Receiver> receivers;
+        monitor.getState(channels, receivers);
+
+        if (ImGui::BeginTable(("scanner_channel_table" + name).c_str(), 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 200.0f * style::uiScale))) {
+            ImGui::TableSetupColumn("Name");
+            ImGui::TableSetupColumn("SNR");
+            ImGui::TableSetupColumn("Squelch");
+            ImGui::TableSetupColumn("Priority");
+            ImGui::TableSetupColumn("Receiver");
+            ImGui::TableSetupScrollFreeze(5, 1);
+            ImGui::TableHeadersRow();
+            for (int i = 0; i < channels.size(); i++) {
+                auto& ch = channels[i];
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextColored(ch.active ? ImVec4(0, 1, 0, 1) : ImGui::GetStyleColorVec4(ImGuiCol_Text), "%s", ch.name.c_str());
+                ImGui::TableSetColumnIndex(1);
+                if (ch.inBand) { ImGui::Text("%.1f", ch.snr); }
+                else { ImGui::TextDisabled("--"); }
+                ImGui::TableSetColumnIndex(2);
+                ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+                if (ImGui::InputFloat(("##scanner_ch_sq_" + ch.name + name).c_str(), &ch.squelch, 0.0f, 0.0f, "%.0f")) {
+                    monitor.setSquelch(i, ch.squelch);
+                    saveChannelSetting(ch.name, "squelch", ch.squelch);
+                }
+                ImGui::TableSetColumnIndex(3);
+                ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+                if (ImGui::InputInt(("##scanner_ch_prio_" + ch.name + name).c_str(), &ch.priority, 0, 0)) {
+                    monitor.setPriority(i, ch.priority);
+                    saveChannelSetting(ch.name, "priority", ch.priority);
+                }
+                ImGui::TableSetColumnIndex(4);
+                if (ch.receiver >= 0) { ImGui::Text("%s", receivers[ch.receiver].radio.c_str()); }
+                else if (!ch.inBand) { ImGui::TextDisabled("Out of band"); }
+                else { ImGui::TextDisabled("-"); }
+            }
+            ImGui::EndTable();
+        }
+
+        if (!running) {
+            if (ImGui::Button("Start##scanner_start", ImVec2(menuWidth, 0))) {
+                start();
+            }
+            ImGui::Text("Status: Idle");
+        }
+        else {
+            if (ImGui::Button("Stop##scanner_start", ImVec2(menuWidth, 0))) {
+                stop();
+            }
+            int busy = 0;
+            for (const auto& rx : receivers) { busy += (rx.channel >= 0); }
+            ImGui::TextColored(ImVec4(0, 1, 1, 1), "Status: Monitoring (%d/%d receivers busy)", busy, (int)receivers.size());
+        }
+    }
+
+    void drawRecordingSettings(float menuWidth) {
+        ImGui::LeftLabel("Pre-roll (ms)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputInt(("##scanner_pre_roll_" + name).c_str(), &preRoll, 100, 1000)) {
+            preRoll = std::clamp<int>(preRoll, 0, 10000);
+            hits.setPreRoll(preRoll);
+            config.acquire();
+            config.conf[name]["preRoll"] = preRoll;
+            config.release(true);
+        }
+        ImGui::LeftLabel("Snippets");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        int snippetType = snippetIQ;
+        if (ImGui::Combo(("##scanner_snippet_type_" + name).c_str(), &snippetType, "Audio\0IQ\0")) {
+            snippetIQ = snippetType;
+            hits.setIQ(snippetIQ);
+            config.acquire();
+            config.conf[name]["snippetIQ"] = snippetIQ;
+            config.release(true);
+        }
+        ImGui::LeftLabel("Hit Index");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputText(("##scanner_index_path_" + name).c_str(), indexPath, 1023)) {
+            hits.setIndex(indexPath, (HitRecorder::IndexFormat)indexFormat);
+            config.acquire();
+            config.conf[name]["indexPath"] = indexPath;
+            config.release(true);
+        }
+        ImGui::LeftLabel("Index Format");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::Combo(("##scanner_index_format_" + name).c_str(), &indexFormat, "CSV\0JSON Lines\0")) {
+            hits.setIndex(indexPath, (HitRecorder::IndexFormat)indexFormat);
+            config.acquire();
+            config.conf[name]["indexFormat"] = indexFormat;
+            config.release(true);
+        }
+    }
+
+    void refreshChannelSources() {
+        // Find the frequency manager and its lists
+        freqManagerName.clear();
+        radioNames.clear();
+        recorderNames.clear();
+        for (const auto& [instName, inst] : core::moduleManager.instances) {
+            std::string modName = core::moduleManager.getInstanceModuleName(instName);
+            if (modName == "frequency_manager") { freqManagerName = instName; }
+            else if (modName == "radio") { radioNames.push_back(instName); }
+            else if (modName == "recorder") { recorderNames.push_back(instName); }
+        }
+        channelLists.clear();
+        if (!freqManagerName.empty()) {
+            core::modComManager.callInterface(freqManagerName, FREQ_MANAGER_IFACE_CMD_GET_LIST_NAMES, NULL, &channelLists);
+        }
+        channelListsTxt.clear();
+        channelListId = 0;
+        for (int i = 0; i < channelLists.size(); i++) {
+            channelListsTxt += channelLists[i];
+            channelListsTxt += '\0';
+            if (channelLists[i] == channelList) { channelListId = i; }
+        }
+        if (!channelLists.empty()) { channelList = channelLists[channelListId]; }
+
+        // List the possible receivers and load their config
+        recorderNamesTxt = "None";
+        recorderNamesTxt += '\0';
+        for (const auto& rec : recorderNames) {
+            recorderNamesTxt += rec;
+            recorderNamesTxt += '\0';
+        }
+        scanRecorderId = 0;
+        auto scanIt = std::find(recorderNames.begin(), recorderNames.end(), scanRecorder);
+        if (scanIt != recorderNames.end()) { scanRecorderId = 1 + std::distance(recorderNames.begin(), scanIt); }
+
+        receiverOptions.clear();
+        config.acquire();
+        for (const auto& radio : radioNames) {
+            ReceiverOption opt;
+            opt.radio = radio;
+            if (config.conf[name]["receivers"].contains(radio)) {
+                opt.enabled = true;
+                std::string rec = config.conf[name]["receivers"][radio];
+                auto it = std::find(recorderNames.begin(), recorderNames.end(), rec);
+                if (it != recorderNames.end()) { opt.recorderId = 1 + std::distance(recorderNames.begin(), it); }
+            }
+            receiverOptions.push_back(opt);
+        }
+        config.release();
+        applyReceivers();
+    }
+
+    void loadChannels() {
+        std::vector<FreqManagerBookmark> bookmarks;
+        if (!freqManagerName.empty() && !channelList.empty()) {
+            core::modComManager.callInterface(freqManagerName, FREQ_MANAGER_IFACE_CMD_GET_BOOKMARKS, &channelList, &bookmarks);
+        }
+
+        std::vector<ChannelMonitor::Channel> channels;
+        config.acquire();
+        json& settings = config.conf[name]["channelSettings"][channelList];
+        for (const auto& bm : bookmarks) {
+            ChannelMonitor::Channel ch;
+            ch.name = bm.name;
+            ch.frequency = bm.frequency;
+            ch.bandwidth = bm.bandwidth;
+            ch.mode = bm.mode;
+            if (settings.contains(bm.name)) {
+                if (settings[bm.name].contains("squelch")) { ch.squelch = settings[bm.name]["squelch"]; }
+                if (settings[bm.name].contains("priority")) { ch.priority = settings[bm.name]["priority"]; }
+            }
+            channels.push_back(ch);
+        }
+        config.release();
+        monitor.setChannels(channels);
+    }
+
+    void applyReceivers() {
+        std::vector<ChannelMonitor::Receiver> receivers;
+        for (const auto& opt : receiverOptions) {
+            if (!opt.enabled) { continue; }
+            ChannelMonitor::Receiver rx;
+            rx.radio = opt.radio;
+            if (opt.recorderId > 0) { rx.recorder = recorderNames[opt.recorderId - 1]; }
+            receivers.push_back(rx);
+        }
+        monitor.setReceivers(receivers);
+    }
+
+    void saveReceivers() {
+        config.acquire();
+        config.conf[name]["receivers"] = json::object();
+        for (const auto& opt : receiverOptions) {
+            if (!opt.enabled) { continue; }
+            config.conf[name]["receivers"][opt.radio] = (opt.recorderId > 0) ? recorderNames[opt.recorderId - 1] : "";
+        }
+        config.release(true);
+    }
+
+    template <class T>
+    void saveChannelSetting(const std::string& channel, const std::string& key, T value) {
+        config.acquire();
+        config.conf[name]["channelSettings"][channelList][channel][key] = value;
+        config.release(true);
+    }
+
+    void drawSweep(float menuWidth) {
+        std::lock_guard<std::mutex> lck(sweepMtx);
+        if (sweepDisplay.empty()) { return; }
+
+        ImGui::PlotLines(("##scanner_sweep_plot_" + name).c_str(), sweepDisplay.data(), sweepDisplay.size(), 0, NULL, -150.0f, 0.0f, ImVec2(menuWidth, 100.0f * style::uiScale));
+
+        // List the strongest carriers of the last sweep
+        ImGui::Text("Carriers: %d", (int)sweepCarriers.size());
+        int shown = std::min<int>(sweepCarriers.size(), MAX_LISTED_CARRIERS);
+        for (int i = 0; i < shown; i++) {
+            const auto& c = sweepCarriers[i];
+            ImGui::Text("%.3f MHz  %.1f kHz  %.1f dB", (sweepCenter + c.offset) / 1e6, c.bandwidth / 1e3, c.snr);
+        }
+    }
+
     void start() {
         if (running) { return; }
+        if (mode == MODE_CHANNELS) {
+            monitor.setDwellTime(dwellTime);
+            monitor.setHangTime(hangTime);
+            monitor.start();
+            running = true;
+            return;
+        }
+        if (mode == MODE_SWEEP) {
+            startSweep();
+            return;
+        }
+        if (workerThread.joinable()) { stop(); }
         current = startFreq;
+        detector.init(minSnr, minSnr - SNR_HYSTERESIS);
+        newSpectrum = false;
+        hitActive = false;
+        hitVFO.clear();
+        if (scanRecorderId > 0 && !gui::waterfall.selectedVFO.empty()) {
+            hitVFO = gui::waterfall.selectedVFO;
+            hits.arm(scanRecorder, hitVFO);
+        }
         running = true;
+        spectrumHandlerId = sigpath::iqFrontEnd.onSpectrum.bind(&ScannerModule::spectrumHandler, this);
         workerThread = std::thread(&ScannerModule::worker, this);
     }
 
-    void stop() {
-        if (!running) { return; }
+    void startSweep() {
+        detector.init(minSnr, minSnr - SNR_HYSTERESIS);
+        sweeper.setUsableRatio(usableRatio * 0.01);
+        sweeper.setAveraging(averaging);
+        sweeper.setSettleTime(settleTime);
+        sweepHandlerId = sweeper.onSweep.bind(&ScannerModule::sweepHandler, this);
+        sweeper.start(startFreq, stopFreq);
+        running = true;
+    }
+
+    void stopSweep() {
+        sweeper.stop();
+        sweeper.onSweep.unbind(sweepHandlerId);
         running = false;
+
+        // Go back to where the waterfall is
+        sigpath::sourceManager.tune(gui::waterfall.getCenterFrequency());
+    }
+
+    void sweepHandler(const float* data, int count, double start, double binWidth) {
+        // Runs in the FFT thread, once per complete sweep
+        std::lock_guard<std::mutex> lck(sweepMtx);
+        detector.process(data, count, binWidth * (double)count);
+        sweepCenter = start + (binWidth * (double)count / 2.0);
+        sweepCarriers = detector.carriers;
+        std::sort(sweepCarriers.begin(), sweepCarriers.end(), [](const auto& a, const auto& b) { return a.snr > b.snr; });
+
+        // Max-hold decimation down to a displayable number of points
+        int points = std::min<int>(count, MAX_SWEEP_POINTS);
+        sweepDisplay.resize(points);
+        for (int i = 0; i < points; i++) {
+            int first = (int)((int64_t)i * count / points);
+            int last = std::max<int>((int)((int64_t)(i + 1) * count / points), first + 1);
+            sweepDisplay[i] = *std::max_element(&data[first], &data[last]);
+        }
+    }
+
+    void stop() {
+        if (mode == MODE_CHANNELS) {
+            monitor.stop();
+            running = false;
+            return;
+        }
+        if (mode == MODE_SWEEP) {
+            if (running) { stopSweep(); }
+            return;
+        }
+        if (!workerThread.joinable()) { return; }
+        sigpath::iqFrontEnd.onSpectrum.unbind(spectrumHandlerId);
+        {
+            std::lock_guard<std::mutex> lck(scanMtx);
+            running = false;
+        }
+        spectrumCnd.notify_all();
         if (workerThread.joinable()) {
             workerThread.join();
         }
+        hits.disarm(scanRecorder);
+    }
+
+    void spectrumHandler(const float* data, int count, double sampleRate) {
+        // Runs in the FFT thread, once per FFT
+        {
+            std::lock_guard<std::mutex> lck(scanMtx);
+            if (resetDetector) {
+                detector.reset();
+                resetDetector = false;
+            }
+            detector.process(data, count, sampleRate);
+            spectrumSampleRate = sampleRate;
+            newSpectrum = true;
+        }
+        spectrumCnd.notify_all();
     }
 
     void worker() {
-        // 10Hz scan loop
-        while (running) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            {
-                std::lock_guard<std::mutex> lck(scanMtx);
-                auto now = std::chrono::high_resolution_clock::now();
-
-                // Enforce tuning
-                if (gui::waterfall.selectedVFO.empty()) {
-                    running = false;
-                    return;
+        // Woken up by the detector on every new spectrum
+        std::unique_lock<std::mutex> lck(scanMtx);
+        while (true) {
+            spectrumCnd.wait(lck, [this] { return newSpectrum || !running; });
+            if (!running) { return; }
+            newSpectrum = false;
+            auto now = std::chrono::high_resolution_clock::now();
+
+            // Enforce tuning
+            if (gui::waterfall.selectedVFO.empty()) {
+                running = false;
+                return;
+            }
+            tuner::normalTuning(gui::waterfall.selectedVFO, current);
+
+            // Check if we are waiting for a tune
+            if (tuning) {
+                if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTuneTime)).count() > tuningTime) {
+                    tuning = false;
+                    resetDetector = true;
                 }
-                tuner::normalTuning(gui::waterfall.selectedVFO, current);
+                continue;
+            }
 
-                // Check if we are waiting for a tune
-                if (tuning) {
-                    flog::warn("Tuning");
-                    if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTuneTime)).count() > tuningTime) {
-                        tuning = false;
-                    }
-                    continue;
+            // Gather the bounds of the baseband, the detector sees all of it regardless of the zoom
+            double bbCenter = gui::waterfall.getCenterFrequency();
+            double bbStart = bbCenter - (spectrumSampleRate / 2.0);
+            double bbEnd = bbCenter + (spectrumSampleRate / 2.0);
+
+            // Gather VFO data
+            double vfoWidth = sigpath::vfoManager.getBandwidth(gui::waterfall.selectedVFO);
+
+            // Record every signal the scanner stops on
+            if (receiving != hitActive) {
+                if (receiving && !hitVFO.empty()) { hits.begin(scanRecorder, hitVFO, "scan", current); }
+                else { hits.end(scanRecorder); }
+                hitActive = receiving;
+            }
+
+            if (receiving) {
+                float snr;
+                float maxLevel = getMaxLevel(current, vfoWidth, bbCenter, &snr);
+                if (maxLevel >= level) {
+                    lastSignalTime = now;
+                    hits.update(scanRecorder, snr);
                 }
+                else if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSignalTime)).count() > lingerTime) {
+                    receiving = false;
+                }
+            }
+            else {
+                double bottomLimit = current;
+                double topLimit = current;
 
-                // Get FFT data
-                int dataWidth = 0;
-                float* data = gui::waterfall.acquireLatestFFT(dataWidth);
-                if (!data) { continue; }
-
-                // Get gather waterfall data
-                double wfCenter = gui::waterfall.getViewOffset() + gui::waterfall.getCenterFrequency();
-                double wfWidth = gui::waterfall.getViewBandwidth();
-                double wfStart = wfCenter - (wfWidth / 2.0);
-                double wfEnd = wfCenter + (wfWidth / 2.0);
-
-                // Gather VFO data
-                double vfoWidth = sigpath::vfoManager.getBandwidth(gui::waterfall.selectedVFO);
-
-                if (receiving) {
-                    flog::warn("Receiving");
-                
-                    float maxLevel = getMaxLevel(data, current, vfoWidth, dataWidth, wfStart, wfWidth);
-                    if (maxLevel >= level) {
-                        lastSignalTime = now;
-                    }
-                    else if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSignalTime)).count() > lingerTime) {
-                        receiving = false;
-                    }
+                // Search for a signal in scan direction
+                if (findSignal(scanUp, bottomLimit, topLimit, bbStart, bbEnd, bbCenter, vfoWidth)) {
+                    continue;
                 }
-                else {
-                    flog::warn("Seeking signal");
-                    double bottomLimit = current;
-                    double topLimit = current;
-                    
-                    // Search for a signal in scan direction
-                    if (findSignal(scanUp, bottomLimit, topLimit, wfStart, wfEnd, wfWidth, vfoWidth, data, dataWidth)) {
-                        gui::waterfall.releaseLatestFFT();
-                        continue;
-                    }
-                    
-                    // Search for signal in the inverse scan direction if direction isn't enforced
-                    if (!reverseLock) {
-                        if (findSignal(!scanUp, bottomLimit, topLimit, wfStart, wfEnd, wfWidth, vfoWidth, data, dataWidth)) {
-                            gui::waterfall.releaseLatestFFT();
-                            continue;
-                        }
-                    }
-                    else { reverseLock = false; }
-                    
 
-                    // There is no signal on the visible spectrum, tune in scan direction and retry
-                    if (scanUp) {
-                        current = topLimit + interval;
-                        if (current > stopFreq) { current = startFreq; }
-                    }
-                    else {
-                        current = bottomLimit - interval;
-                        if (current < startFreq) { current = stopFreq; }
+                // Search for signal in the inverse scan direction if direction isn't enforced
+                if (!reverseLock) {
+                    if (findSignal(!scanUp, bottomLimit, topLimit, bbStart, bbEnd, bbCenter, vfoWidth)) {
+                        continue;
                     }
+                }
+                else { reverseLock = false; }
 
-                    // If the new current frequency is outside the visible bandwidth, wait for retune
-                    if (current - (vfoWidth/2.0) < wfStart || current + (vfoWidth/2.0) > wfEnd) {
-                        lastTuneTime = now;
-                        tuning = true;
-                    }
+                // There is no signal in the baseband, tune in scan direction and retry
+                if (scanUp) {
+                    current = topLimit + interval;
+                    if (current > stopFreq) { current = startFreq; }
+                }
+                else {
+                    current = bottomLimit - interval;
+                    if (current < startFreq) { current = stopFreq; }
                 }
 
-                // Release FFT Data
-                gui::waterfall.releaseLatestFFT();
+                // If the new current frequency is outside the baseband, wait for retune
+                if (current - (vfoWidth/2.0) < bbStart || current + (vfoWidth/2.0) > bbEnd) {
+                    lastTuneTime = now;
+                    tuning = true;
+                }
             }
         }
     }
 
-    bool findSignal(bool scanDir, double& bottomLimit, double& topLimit, double wfStart, double wfEnd, double wfWidth, double vfoWidth, float* data, int dataWidth) {
+    bool findSignal(bool scanDir, double& bottomLimit, double& topLimit, double bbStart, double bbEnd, double bbCenter, double vfoWidth) {
         bool found = false;
         double freq = current;
         for (freq += scanDir ? interval : -interval;
@@ -236,14 +708,14 @@ private:
             freq += scanDir ? interval : -interval) {
 
             // Check if signal is within bounds
-            if (freq - (vfoWidth/2.0) < wfStart) { break; }
-            if (freq + (vfoWidth/2.0) > wfEnd) { break; }
+            if (freq - (vfoWidth/2.0) < bbStart) { break; }
+            if (freq + (vfoWidth/2.0) > bbEnd) { break; }
 
             if (freq < bottomLimit) { bottomLimit = freq; }
             if (freq > topLimit) { topLimit = freq; }
             
             // Check signal level
-            float maxLevel = getMaxLevel(data, freq, vfoWidth * (passbandRatio * 0.01f), dataWidth, wfStart, wfWidth);
+            float maxLevel = getMaxLevel(freq, vfoWidth * (passbandRatio * 0.01f), bbCenter);
             if (maxLevel >= level) {
                 found = true;
                 receiving = true;
@@ -254,20 +726,38 @@ private:
         return found;
     }
 
-    float getMaxLevel(float* data, double freq, double width, int dataWidth, double wfStart, double wfWidth) {
+    float getMaxLevel(double freq, double width, double bbCenter, float* snr = NULL) {
+        // Find the strongest detected carrier overlapping the given range
         double low = freq - (width/2.0);
         double high = freq + (width/2.0);
-        int lowId = std::clamp<int>((low - wfStart) * (double)dataWidth / wfWidth, 0, dataWidth - 1);
-        int highId = std::clamp<int>((high - wfStart) * (double)dataWidth / wfWidth, 0, dataWidth - 1);
         float max = -INFINITY;
-        for (int i = lowId; i <= highId; i++) {
-            if (data[i] > max) { max = data[i]; }
+        for (const auto& c : detector.carriers) {
+            double cLow = bbCenter + c.offset - (c.bandwidth / 2.0);
+            double cHigh = bbCenter + c.offset + (c.bandwidth / 2.0);
+            if (cHigh < low || cLow > high) { continue; }
+            if (c.level > max) {
+                max = c.level;
+                if (snr) { *snr = c.snr; }
+            }
         }
         return max;
     }
 
+    enum {
+        MODE_SCAN,
+        MODE_SWEEP,
+        MODE_CHANNELS
+    };
+
+    struct ReceiverOption {
+        std::string radio;
+        bool enabled = false;
+        int recorderId = 0;
+    };
+
     std::string name;
     bool enabled = true;
+    int mode = MODE_SCAN;
     
     bool running = false;
     //std::string selectedVFO = "Radio";
@@ -279,6 +769,7 @@ private:
     int tuningTime = 250;
     int lingerTime = 1000.0;
     float level = -50.0;
+    float minSnr = 10.0f;
     bool receiving = true;
     bool tuning = false;
     bool scanUp = true;
@@ -287,10 +778,60 @@ private:
     std::chrono::time_point<std::chrono::high_resolution_clock> lastTuneTime;
     std::thread workerThread;
     std::mutex scanMtx;
+
+    dsp::detector::CarrierDetector detector;
+    HandlerID spectrumHandlerId;
+    std::condition_variable spectrumCnd;
+    double spectrumSampleRate = 1.0;
+    bool newSpectrum = false;
+    bool resetDetector = false;
+
+    // Sweep mode
+    Sweeper sweeper;
+    HandlerID sweepHandlerId;
+    double usableRatio = 75.0;
+    int averaging = 2;
+    int settleTime = 10;
+    std::mutex sweepMtx;
+    std::vector<float> sweepDisplay;
+    std::vector<dsp::detector::Carrier> sweepCarriers;
+    double sweepCenter = 0.0;
+
+    // Hit recording
+    HitRecorder hits;
+    std::string scanRecorder;
+    int scanRecorderId = 0;
+    std::string hitVFO;
+    bool hitActive = false;
+    int preRoll = 0;
+    bool snippetIQ = false;
+    char indexPath[1024];
+    int indexFormat = HitRecorder::INDEX_FORMAT_CSV;
+
+    // Channel mode
+    ChannelMonitor monitor;
+    std::string freqManagerName;
+    std::vector<std::string> channelLists;
+    std::string channelListsTxt;
+    std::string channelList;
+    int channelListId = 0;
+    std::vector<std::string> radioNames;
+    std::vector<std::string> recorderNames;
+    std::string recorderNamesTxt;
+    std::vector<ReceiverOption> receiverOptions;
+    int dwellTime = 2000;
+    int hangTime = 1000;
+
+    static constexpr float SNR_HYSTERESIS = 3.0f;
+    static constexpr int MAX_SWEEP_POINTS = 1024;
+    static constexpr int MAX_LISTED_CARRIERS = 10;
 };
 
 MOD_EXPORT void _INIT_() {
-    // Nothing here
+    json def = json({});
+    config.setPath(core::args["root"].s() + "/scanner_config.json");
+    config.load(def);
+    config.enableAutoSave();
 }
 
 MOD_EXPORT ModuleManager::Instance* _CREATE_INSTANCE_(std::string name) {
@@ -302,5 +843,6 @@ MOD_EXPORT void _DELETE_INSTANCE_(void* instance) {
 }
 
 MOD_EXPORT void _END_() {
-    // Nothing here
+    config.disableAutoSave();
+    config.save();
 }
\ No newline at end of file
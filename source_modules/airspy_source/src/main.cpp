@@ -15,6 +15,9 @@
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
+// Samples per transfer given by libairspy for the IQ sample types
+#define AIRSPY_TRANSFER_SAMPLES 65536
+
 SDRPP_MOD_INFO{
     /* Name:            */ "airspy_source",
     /* Description:     */ "Airspy source module for SDR++",
@@ -41,7 +44,11 @@ public:
         handler.startHandler = start;
         handler.stopHandler = stop;
         handler.tuneHandler = tune;
-        handler.stream = &stream;
+        handler.stream = &ring.out;
+        handler.captureRing = &ring;
+        handler.stream16 = &ring16.out;
+        handler.captureRing16 = &ring16;
+        handler.retuneLatency = 10.0;
 
         refresh();
         if (sampleRateList.size() > 0) {
@@ -310,6 +317,20 @@ private:
 
         airspy_set_rf_bias(_this->openDev, _this->biasT);
 
+        // The library can give the 12bit samples scaled to 16bit for the fixed point front-end
+        _this->int16Mode = _this->handler.useStream16;
+        airspy_set_sample_type(_this->openDev, _this->int16Mode ? AIRSPY_SAMPLE_INT16_IQ : AIRSPY_SAMPLE_FLOAT32_IQ);
+
+        // Only the ring in use gets its slots
+        if (_this->int16Mode) {
+            _this->ring16.setSlotSize(AIRSPY_TRANSFER_SAMPLES);
+        }
+        else {
+            _this->ring.setSlotSize(AIRSPY_TRANSFER_SAMPLES);
+        }
+
+        _this->ring.start();
+        _this->ring16.start();
         airspy_start_rx(_this->openDev, callback, _this);
 
         _this->running = true;
@@ -320,9 +341,9 @@ private:
         AirspySourceModule* _this = (AirspySourceModule*)ctx;
         if (!_this->running) { return; }
         _this->running = false;
-        _this->stream.stopWriter();
         airspy_close(_this->openDev);
-        _this->stream.clearWriteStop();
+        _this->ring.stop();
+        _this->ring16.stop();
         flog::info("AirspySourceModule '{0}': Stop!", _this->name);
     }
 
@@ -564,15 +585,21 @@ private:
 
     static int callback(airspy_transfer_t* transfer) {
         AirspySourceModule* _this = (AirspySourceModule*)transfer->ctx;
-        memcpy(_this->stream.writeBuf, transfer->samples, transfer->sample_count * sizeof(dsp::complex_t));
-        if (!_this->stream.swap(transfer->sample_count)) { return -1; }
+        if (_this->int16Mode) {
+            _this->ring16.write((dsp::complex16_t*)transfer->samples, transfer->sample_count);
+        }
+        else {
+            _this->ring.write((dsp::complex_t*)transfer->samples, transfer->sample_count);
+        }
         return 0;
     }
 
     std::string name;
     airspy_device* openDev;
     bool enabled = true;
-    dsp::stream<dsp::complex_t> stream;
+    dsp::buffer::CaptureRing<dsp::complex_t> ring { 32 };
+    dsp::buffer::CaptureRing<dsp::complex16_t> ring16 { 32 };
+    bool int16Mode = false;
     double sampleRate;
     SourceManager::SourceHandler handler;
     bool running = false;
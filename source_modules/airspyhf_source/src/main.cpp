@@ -42,6 +42,7 @@ public:
         handler.stopHandler = stop;
         handler.tuneHandler = tune;
         handler.stream = &stream;
+        handler.retuneLatency = 10.0;
 
         refresh();
 
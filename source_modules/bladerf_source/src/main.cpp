@@ -4,6 +4,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <config.h>
 #include <gui/widgets/stepped_slider.h>
@@ -547,7 +548,7 @@ private:
             if (ret != 0) { break; }
 
             // Convert to complex float and swap buffers
-            volk_16i_s32f_convert_32f((float*)stream.writeBuf, buffer, 32768.0f, bufferSize * 2);
+            conv.process(bufferSize, buffer, stream.writeBuf);
             if (!stream.swap(bufferSize)) { break; }
         }
 
@@ -558,6 +559,7 @@ private:
     bladerf* openDev;
     bool enabled = true;
     dsp::stream<dsp::complex_t> stream;
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f };
     double sampleRate;
     SourceManager::SourceHandler handler;
     bool running = false;
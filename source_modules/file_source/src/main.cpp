@@ -6,6 +6,7 @@
 #include <signal_path/signal_path.h>
 #include <wavreader.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/widgets/file_select.h>
 #include <filesystem>
 #include <regex>
@@ -159,7 +160,7 @@ private:
 
         while (true) {
             _this->reader->readSamples(inBuf, blockSize * 2 * sizeof(int16_t));
-            volk_16i_s32f_convert_32f((float*)_this->stream.writeBuf, inBuf, 32768.0f, blockSize * 2);
+            _this->conv.process(blockSize, inBuf, _this->stream.writeBuf);
             if (!_this->stream.swap(blockSize)) { break; };
         }
 
@@ -192,6 +193,7 @@ private:
     FileSelect fileSelect;
     std::string name;
     dsp::stream<dsp::complex_t> stream;
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f };
     SourceManager::SourceHandler handler;
     WavReader* reader = NULL;
     bool running = false;
@@ -3,6 +3,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <config.h>
 #include <gui/widgets/stepped_slider.h>
@@ -17,6 +18,9 @@
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
+// Samples per transfer, libhackrf transfers 262144 bytes of 8bit IQ
+#define HACKRF_TRANSFER_SAMPLES (262144 / 2)
+
 SDRPP_MOD_INFO{
     /* Name:            */ "hackrf_source",
     /* Description:     */ "HackRF source module for SDR++",
@@ -96,7 +100,11 @@ public:
         handler.startHandler = start;
         handler.stopHandler = stop;
         handler.tuneHandler = tune;
-        handler.stream = &stream;
+        handler.stream = &ring.out;
+        handler.captureRing = &ring;
+        handler.stream16 = &ring16.out;
+        handler.captureRing16 = &ring16;
+        handler.retuneLatency = 5.0;
 
         refresh();
 
@@ -267,6 +275,16 @@ private:
         hackrf_set_lna_gain(_this->openDev, _this->lna);
         hackrf_set_vga_gain(_this->openDev, _this->vga);
 
+        // Only the ring in use gets its slots
+        if (_this->handler.useStream16) {
+            _this->ring16.setSlotSize(HACKRF_TRANSFER_SAMPLES);
+        }
+        else {
+            _this->ring.setSlotSize(HACKRF_TRANSFER_SAMPLES);
+        }
+
+        _this->ring.start();
+        _this->ring16.start();
         hackrf_start_rx(_this->openDev, callback, _this);
 
         _this->running = true;
@@ -277,13 +295,13 @@ private:
         HackRFSourceModule* _this = (HackRFSourceModule*)ctx;
         if (!_this->running) { return; }
         _this->running = false;
-        _this->stream.stopWriter();
         // TODO: Stream stop
         hackrf_error err = (hackrf_error)hackrf_close(_this->openDev);
         if (err != HACKRF_SUCCESS) {
             flog::error("Could not close HackRF {0}: {1}", _this->selectedSerial, hackrf_error_name(err));
         }
-        _this->stream.clearWriteStop();
+        _this->ring.stop();
+        _this->ring16.stop();
         flog::info("HackRFSourceModule '{0}': Stop!", _this->name);
     }
 
@@ -382,15 +400,27 @@ private:
 
     static int callback(hackrf_transfer* transfer) {
         HackRFSourceModule* _this = (HackRFSourceModule*)transfer->rx_ctx;
-        volk_8i_s32f_convert_32f((float*)_this->stream.writeBuf, (int8_t*)transfer->buffer, 128.0f, transfer->valid_length);
-        if (!_this->stream.swap(transfer->valid_length / 2)) { return -1; }
+        int count = transfer->valid_length / 2;
+        if (_this->handler.useStream16) {
+            dsp::complex16_t* out = _this->ring16.acquire(count);
+            if (!out) { return 0; }
+            _this->conv.processInt16(count, transfer->buffer, out);
+            _this->ring16.commit(count);
+            return 0;
+        }
+        dsp::complex_t* out = _this->ring.acquire(count);
+        if (!out) { return 0; }
+        _this->conv.process(count, transfer->buffer, out);
+        _this->ring.commit(count);
         return 0;
     }
 
     std::string name;
     hackrf_device* openDev;
     bool enabled = true;
-    dsp::stream<dsp::complex_t> stream;
+    dsp::buffer::CaptureRing<dsp::complex_t> ring { 32 };
+    dsp::buffer::CaptureRing<dsp::complex16_t> ring16 { 32 };
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S8, 1.0f / 128.0f };
     int sampleRate;
     SourceManager::SourceHandler handler;
     bool running = false;
@@ -3,6 +3,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <config.h>
 #include <gui/widgets/stepped_slider.h>
@@ -527,8 +528,7 @@ private:
     static void callback(unsigned char *buf, uint32_t len, void *ctx) {
         MirisdrSourceModule* _this = (MirisdrSourceModule*)ctx;
         int count = (len/sizeof(int16_t)) / 2;
-        int16_t* buffer = (int16_t*)buf;
-        volk_16i_s32f_convert_32f((float*)_this->stream.writeBuf, buffer, 32768.0f, count * 2);
+        _this->conv.process(count, buf, _this->stream.writeBuf);
         if (!_this->stream.swap(count)) { return; }
     }
 
@@ -537,6 +537,7 @@ private:
     bool enabled = true;
     std::thread workerThread;
     dsp::stream<dsp::complex_t> stream;
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f };
     int sampleRate;
     SourceManager::SourceHandler handler;
     bool running = false;
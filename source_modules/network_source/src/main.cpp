@@ -4,6 +4,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <config.h>
 #include <gui/smgui.h>
@@ -57,6 +58,7 @@ public:
         handler.stopHandler = stop;
         handler.tuneHandler = tune;
         handler.stream = &stream;
+        handler.bufferLatency = 500.0; // Network jitter
 
         // Define samplerates
         for (int i = 3000; i <= 192000; i <<= 1) {
@@ -285,6 +287,23 @@ private:
         // Allocate receive buffer
         uint8_t* buffer = dsp::buffer::alloc<uint8_t>(frameSize);
 
+        // Select the conversion to CF32
+        dsp::convert::SampleConverter conv;
+        switch (sampType) {
+        case SAMPLE_TYPE_INT8:
+            conv.init(dsp::convert::SAMPLE_FORMAT_S8, 1.0f / 128.0f);
+            break;
+        case SAMPLE_TYPE_INT16:
+            conv.init(dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f);
+            break;
+        case SAMPLE_TYPE_INT32:
+            conv.init(dsp::convert::SAMPLE_FORMAT_S32, 1.0f / 2147483647.0f);
+            break;
+        default:
+            conv.init(dsp::convert::SAMPLE_FORMAT_F32, 1.0f);
+            break;
+        }
+
         while (true) {
             // Read samples from socket
             int bytes = sock->recv(buffer, frameSize, true);
@@ -292,22 +311,7 @@ private:
 
             // Convert to CF32 (note: problem if partial sample)
             int count = bytes / sampleSize;
-            switch (sampType) {
-            case SAMPLE_TYPE_INT8:
-                volk_8i_s32f_convert_32f((float*)stream.writeBuf, (int8_t*)buffer, 128.0f, count*2);
-                break;
-            case SAMPLE_TYPE_INT16:
-                volk_16i_s32f_convert_32f((float*)stream.writeBuf, (int16_t*)buffer, 32768.0f, count*2);
-                break;
-            case SAMPLE_TYPE_INT32:
-                volk_32i_s32f_convert_32f((float*)stream.writeBuf, (int32_t*)buffer, 2147483647.0f, count*2);
-                break;
-            case SAMPLE_TYPE_FLOAT32:
-                memcpy(stream.writeBuf, buffer, bytes);
-                break;
-            default:
-                break;
-            }
+            conv.process(count, buffer, stream.writeBuf);
 
             // Send out converted samples
             if (!stream.swap(count)) { break; }
@@ -3,6 +3,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <config.h>
 #include <gui/smgui.h>
@@ -404,21 +405,8 @@ private:
 
     static int callback(void* buf, int bufferSize, void* ctx) {
         PerseusSourceModule* _this = (PerseusSourceModule*)ctx;
-        uint8_t* samples = (uint8_t*)buf;
         int sampleCount = bufferSize / 6;
-        for (int i = 0; i < sampleCount; i++) {
-            int32_t re, im;
-            re = *(samples++);
-            re |= *(samples++) << 8;
-            re |= *(samples++) << 16;
-            re |= (re >> 23) * (0xFF << 24); // Sign extend
-            im = *(samples++);
-            im |= *(samples++) << 8;
-            im |= *(samples++) << 16;
-            im |= (im >> 23) * (0xFF << 24); // Sign extend
-            _this->stream.writeBuf[i].re = ((float)re / (float)0x7FFFFF);
-            _this->stream.writeBuf[i].im = ((float)im / (float)0x7FFFFF);
-        }
+        _this->conv.process(sampleCount, buf, _this->stream.writeBuf);
         _this->stream.swap(sampleCount);
         return 0;
     }
@@ -426,6 +414,7 @@ private:
     std::string name;
     bool enabled = true;
     dsp::stream<dsp::complex_t> stream;
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S24_LE, 1.0f / (float)0x7FFFFF };
     int sampleRate;
     SourceManager::SourceHandler handler;
     bool running = false;
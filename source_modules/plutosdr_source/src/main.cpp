@@ -3,6 +3,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <gui/smgui.h>
 #include <iio.h>
@@ -463,7 +464,7 @@ private:
             if (!buf) { break; }
 
             // Convert samples to CF32
-            volk_16i_s32f_convert_32f((float*)_this->stream.writeBuf, buf, 32768.0f, blockSize * 2);
+            _this->conv.process(blockSize, buf, _this->stream.writeBuf);
 
             // Send out the samples
             if (!_this->stream.swap(blockSize)) { break; };
@@ -480,6 +481,7 @@ private:
     std::string name;
     bool enabled = true;
     dsp::stream<dsp::complex_t> stream;
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f };
     SourceManager::SourceHandler handler;
     std::thread workerThread;
     iio_context* ctx = NULL;
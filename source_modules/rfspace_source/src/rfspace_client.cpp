@@ -236,9 +236,8 @@ namespace rfspace {
                 std::lock_guard<std::mutex> lck(bufferMtx);
 
                 // Convert samples to complex float
-                int16_t* samples = (int16_t*)&buffer[4];
                 int sampCount = (size - 4) / (2 * sizeof(int16_t));
-                volk_16i_s32f_convert_32f((float*)&output->writeBuf[inBuffer], samples, 32768.0f, sampCount * 2);
+                conv.process(sampCount, &buffer[4], &output->writeBuf[inBuffer]);
                 inBuffer += sampCount;
 
                 // Send out samples if enough are buffered
@@ -2,6 +2,7 @@
 #include <utils/net.h>
 #include <dsp/stream.h>
 #include <dsp/types.h>
+#include <dsp/convert/sample_format.h>
 #include <thread>
 #include <vector>
 #include <mutex>
@@ -132,6 +133,7 @@ namespace rfspace {
         std::shared_ptr<net::Socket> udp;
 
         dsp::stream<dsp::complex_t>* output;
+        dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f };
 
         uint16_t tcpHeader;
         uint16_t udpHeader;
@@ -3,6 +3,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <config.h>
 #include <gui/smgui.h>
@@ -70,7 +71,11 @@ public:
         handler.startHandler = start;
         handler.stopHandler = stop;
         handler.tuneHandler = tune;
-        handler.stream = &stream;
+        handler.stream = &ring.out;
+        handler.captureRing = &ring;
+        handler.stream16 = &ring16.out;
+        handler.captureRing16 = &ring16;
+        handler.retuneLatency = 20.0;
 
         strcpy(dbTxt, "--");
 
@@ -314,6 +319,16 @@ private:
 
         _this->asyncCount = (int)roundf(_this->sampleRate / (200 * 512)) * 512;
 
+        // The transfers are asyncCount bytes of 8bit IQ, only the ring in use gets its slots
+        if (_this->handler.useStream16) {
+            _this->ring16.setSlotSize(_this->asyncCount / 2);
+        }
+        else {
+            _this->ring.setSlotSize(_this->asyncCount / 2);
+        }
+
+        _this->ring.start();
+        _this->ring16.start();
         _this->workerThread = std::thread(&RTLSDRSourceModule::worker, _this);
 
         _this->running = true;
@@ -324,10 +339,10 @@ private:
         RTLSDRSourceModule* _this = (RTLSDRSourceModule*)ctx;
         if (!_this->running) { return; }
         _this->running = false;
-        _this->stream.stopWriter();
         rtlsdr_cancel_async(_this->openDev);
         if (_this->workerThread.joinable()) { _this->workerThread.join(); }
-        _this->stream.clearWriteStop();
+        _this->ring.stop();
+        _this->ring16.stop();
         rtlsdr_close(_this->openDev);
         flog::info("RTLSDRSourceModule '{0}': Stop!", _this->name);
     }
@@ -522,11 +537,17 @@ private:
     static void asyncHandler(unsigned char* buf, uint32_t len, void* ctx) {
         RTLSDRSourceModule* _this = (RTLSDRSourceModule*)ctx;
         int sampCount = len / 2;
-        for (int i = 0; i < sampCount; i++) {
-            _this->stream.writeBuf[i].re = ((float)buf[i * 2] - 127.4) / 128.0f;
-            _this->stream.writeBuf[i].im = ((float)buf[(i * 2) + 1] - 127.4) / 128.0f;
+        if (_this->handler.useStream16) {
+            dsp::complex16_t* out = _this->ring16.acquire(sampCount);
+            if (!out) { return; }
+            _this->conv.processInt16(sampCount, buf, out);
+            _this->ring16.commit(sampCount);
+            return;
         }
-        if (!_this->stream.swap(sampCount)) { return; }
+        dsp::complex_t* out = _this->ring.acquire(sampCount);
+        if (!out) { return; }
+        _this->conv.process(sampCount, buf, out);
+        _this->ring.commit(sampCount);
     }
 
     void updateGainTxt() {
@@ -536,7 +557,9 @@ private:
     std::string name;
     rtlsdr_dev_t* openDev;
     bool enabled = true;
-    dsp::stream<dsp::complex_t> stream;
+    dsp::buffer::CaptureRing<dsp::complex_t> ring { 32 };
+    dsp::buffer::CaptureRing<dsp::complex16_t> ring16 { 32 };
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_U8, 1.0f / 128.0f, 127.4f };
     double sampleRate;
     SourceManager::SourceHandler handler;
     bool running = false;
@@ -2,6 +2,7 @@
 #include <utils/net.h>
 #include <dsp/stream.h>
 #include <dsp/types.h>
+#include <dsp/convert/sample_format.h>
 #include <thread>
 
 namespace rtltcp {
@@ -38,6 +39,7 @@ namespace rtltcp {
         std::shared_ptr<net::Socket> sock;
         std::thread workerThread;
         dsp::stream<dsp::complex_t>* stream;
+        dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_U8, 1.0f / 128.0f, 128.0f };
         int bufferSize = 2400000 / 200;
     };
 
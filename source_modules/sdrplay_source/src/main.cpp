@@ -4,6 +4,7 @@
 #include <gui/gui.h>
 #include <signal_path/signal_path.h>
 #include <core.h>
+#include <dsp/convert/sample_format.h>
 #include <gui/style.h>
 #include <config.h>
 #include <sdrplay_api.h>
@@ -1111,12 +1112,12 @@ private:
     static void streamCB(short* xi, short* xq, sdrplay_api_StreamCbParamsT* params,
                          unsigned int numSamples, unsigned int reset, void* cbContext) {
         SDRPlaySourceModule* _this = (SDRPlaySourceModule*)cbContext;
-        // TODO: Optimise using volk and math
         if (!_this->running) { return; }
-        for (int i = 0; i < numSamples; i++) {
-            int id = _this->bufferIndex++;
-            _this->stream.writeBuf[id].re = (float)xi[i] / 32768.0f;
-            _this->stream.writeBuf[id].im = (float)xq[i] / 32768.0f;
+        for (int i = 0; i < numSamples;) {
+            int count = std::min<int>(numSamples - i, _this->bufferSize - _this->bufferIndex);
+            _this->conv.processPlanar(count, &xi[i], &xq[i], &_this->stream.writeBuf[_this->bufferIndex]);
+            _this->bufferIndex += count;
+            i += count;
 
             if (_this->bufferIndex >= _this->bufferSize) {
                 _this->stream.swap(_this->bufferSize);
@@ -1133,6 +1134,7 @@ private:
     std::string name;
     bool enabled = true;
     dsp::stream<dsp::complex_t> stream;
+    dsp::convert::SampleConverter conv { dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f };
     double sampleRate;
     SourceManager::SourceHandler handler;
     bool running = false;
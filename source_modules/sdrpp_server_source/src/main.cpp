@@ -45,6 +45,7 @@ public:
         handler.stopHandler = stop;
         handler.tuneHandler = tune;
         handler.stream = &stream;
+        handler.bufferLatency = 500.0; // Network jitter
 
         // Load config
         config.acquire();
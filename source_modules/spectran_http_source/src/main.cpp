@@ -38,6 +38,7 @@ public:
         handler.stopHandler = stop;
         handler.tuneHandler = tune;
         handler.stream = &stream;
+        handler.bufferLatency = 500.0; // Network jitter
 
         sigpath::sourceManager.registerSource("Spectran HTTP", &handler);
     }
@@ -132,32 +132,30 @@ namespace spyserver {
             }
             _this->deviceInfoCnd.notify_all();
         }
-        else if (mtype == SPYSERVER_MSG_TYPE_UINT8_IQ) {
-            int sampCount = _this->receivedHeader.BodySize / (sizeof(uint8_t) * 2);
-            float gain = pow(10, (double)mflags / 20.0);
-            float scale = 1.0f / (gain * 128.0f);
-            for (int i = 0; i < sampCount; i++) {
-                _this->output->writeBuf[i].re = ((float)_this->readBuf[(2 * i)] - 128.0f) * scale;
-                _this->output->writeBuf[i].im = ((float)_this->readBuf[(2 * i) + 1] - 128.0f) * scale;
+        else if (mtype == SPYSERVER_MSG_TYPE_UINT8_IQ || mtype == SPYSERVER_MSG_TYPE_INT16_IQ || mtype == SPYSERVER_MSG_TYPE_FLOAT_IQ) {
+            // The gain comes with every message, only rebuild the converter when it changes
+            if (mtype != _this->convType || mflags != _this->convFlags) {
+                float gain = pow(10, (double)mflags / 20.0);
+                if (mtype == SPYSERVER_MSG_TYPE_UINT8_IQ) {
+                    _this->conv.init(dsp::convert::SAMPLE_FORMAT_U8, 1.0f / (gain * 128.0f), 128.0f);
+                }
+                else if (mtype == SPYSERVER_MSG_TYPE_INT16_IQ) {
+                    _this->conv.init(dsp::convert::SAMPLE_FORMAT_S16, 1.0f / (gain * 32768.0f));
+                }
+                else {
+                    _this->conv.init(dsp::convert::SAMPLE_FORMAT_F32, gain);
+                }
+                _this->convType = mtype;
+                _this->convFlags = mflags;
             }
-            _this->output->swap(sampCount);
-        }
-        else if (mtype == SPYSERVER_MSG_TYPE_INT16_IQ) {
-            int sampCount = _this->receivedHeader.BodySize / (sizeof(int16_t) * 2);
-            float gain = pow(10, (double)mflags / 20.0);
-            volk_16i_s32f_convert_32f((float*)_this->output->writeBuf, (int16_t*)_this->readBuf, 32768.0 * gain, sampCount * 2);
+            int sampCount = _this->receivedHeader.BodySize / dsp::convert::sampleFormatSize(_this->conv.getFormat());
+            _this->conv.process(sampCount, _this->readBuf, _this->output->writeBuf);
             _this->output->swap(sampCount);
         }
         else if (mtype == SPYSERVER_MSG_TYPE_INT24_IQ) {
             printf("ERROR: IQ format not supported\n");
             return;
         }
-        else if (mtype == SPYSERVER_MSG_TYPE_FLOAT_IQ) {
-            int sampCount = _this->receivedHeader.BodySize / sizeof(dsp::complex_t);
-            float gain = pow(10, (double)mflags / 20.0);
-            volk_32f_s32f_multiply_32f((float*)_this->output->writeBuf, (float*)_this->readBuf, gain, sampCount * 2);
-            _this->output->swap(sampCount);
-        }
 
         _this->client->readAsync(sizeof(SpyServerMessageHeader), (uint8_t*)&_this->receivedHeader, dataHandler, _this);
     }
@@ -3,6 +3,7 @@
 #include <spyserver_protocol.h>
 #include <dsp/stream.h>
 #include <dsp/types.h>
+#include <dsp/convert/sample_format.h>
 
 namespace spyserver {
     class SpyServerClientClass {
@@ -44,6 +45,9 @@ namespace spyserver {
         SpyServerMessageHeader receivedHeader;
 
         dsp::stream<dsp::complex_t>* output;
+        dsp::convert::SampleConverter conv;
+        int convType = -1;
+        int convFlags = -1;
     };
 
     typedef std::unique_ptr<SpyServerClientClass> SpyServerClient;
@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <map>
+#include <dsp/channel/rx_vfo.h>
+#include "output.h"
+
+#define DECODE_BLOCK_SIZE   65536
+
+// A decoder tuned to one frequency of a recording. Its VFO is the same as in SDR++, only every block
+// is run by calling process() directly instead of from a thread per block.
+class Channel {
+public:
+    Channel(Output* output, const std::string& decoder, double frequency) {
+        this->output = output;
+        this->decoder = decoder;
+        this->frequency = frequency;
+    }
+
+    virtual ~Channel() {
+        if (vfoBuf) { dsp::buffer::free(vfoBuf); }
+    }
+
+    // The samplerate and bandwidth the decoder needs
+    virtual double getSamplerate() = 0;
+    virtual double getBandwidth() = 0;
+
+    void init(double inSamplerate, double offset) {
+        vfo.init(NULL, inSamplerate, getSamplerate(), getBandwidth(), offset);
+        vfo.out.free();
+        int maxCount = vfo.maxOutputSize(DECODE_BLOCK_SIZE);
+        vfoBuf = dsp::buffer::alloc<dsp::complex_t>(maxCount);
+        prepare(maxCount);
+    }
+
+    // Blocks of the recording and the time of their first sample, in seconds from the start
+    void process(const dsp::complex_t* in, int count, double time) {
+        this->time = time;
+        count = vfo.process(count, in, vfoBuf);
+        if (count) { decode(vfoBuf, count); }
+    }
+
+    // Called at the end of the recording
+    virtual void finish() {}
+
+protected:
+    // Allocates the buffers of the decoder for blocks of up to maxCount samples at its samplerate
+    virtual void prepare(int maxCount) {}
+
+    virtual void decode(dsp::complex_t* in, int count) = 0;
+
+    void emit(json record) {
+        emit(record, time);
+    }
+
+    // For records given out by another thread than the one calling process()
+    void emit(json record, double time) {
+        record["decoder"] = decoder;
+        record["frequency"] = frequency;
+        output->write(time, record);
+    }
+
+    Output* output;
+    std::string decoder;
+    double frequency;
+    double time = 0.0;
+
+private:
+    dsp::channel::RxVFO vfo;
+    dsp::complex_t* vfoBuf = NULL;
+};
+
+// Options given after the frequency of a decoder, as name=value or just a name for flags
+using ChannelOptions = std::map<std::string, std::string>;
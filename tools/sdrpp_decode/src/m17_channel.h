@@ -0,0 +1,69 @@
+#pragma once
+#include "channel.h"
+#include <m17_receiver.h>
+
+#define M17_CHANNEL_SAMPLERATE  14400.0
+#define M17_CHANNEL_BANDWIDTH   9600.0
+
+// A gap longer than this between two link setup frames starts a new transmission
+#define M17_TRANSMISSION_GAP    2.0
+
+// M17 transmissions, one record for each with the content of its link setup frame.
+// Only the receiver is needed, the codec2 frames aren't decoded into audio.
+class M17Channel : public Channel {
+public:
+    M17Channel(Output* output, double frequency, const ChannelOptions& opts) : Channel(output, "m17", frequency) {
+        receiver.init(NULL, M17_CHANNEL_SAMPLERATE, lsfHandler, this);
+        receiver.out.free();
+        receiver.diagOut.free();
+    }
+
+    ~M17Channel() {
+        if (symbols) { dsp::buffer::free(symbols); }
+    }
+
+    double getSamplerate() { return M17_CHANNEL_SAMPLERATE; }
+    double getBandwidth() { return M17_CHANNEL_BANDWIDTH; }
+
+protected:
+    void prepare(int maxCount) {
+        symbols = dsp::buffer::alloc<float>(maxCount);
+    }
+
+    void decode(dsp::complex_t* in, int count) {
+        int payloadCount;
+        receiver.process(count, in, symbols, NULL, payloadCount);
+    }
+
+private:
+    static void lsfHandler(M17LSF& lsf, void* ctx) {
+        M17Channel* _this = (M17Channel*)ctx;
+
+        // The link setup is repeated all through a transmission, only its first appearance is a record
+        double now = _this->time;
+        bool same = lsf.src == _this->lastSrc && lsf.dst == _this->lastDst && lsf.rawType == _this->lastType;
+        bool gap = (now - _this->lastLSF) > M17_TRANSMISSION_GAP;
+        _this->lastLSF = now;
+        if (same && !gap) { return; }
+        _this->lastSrc = lsf.src;
+        _this->lastDst = lsf.dst;
+        _this->lastType = lsf.rawType;
+
+        json rec;
+        rec["src"] = lsf.src;
+        rec["dst"] = lsf.dst;
+        rec["mode"] = lsf.isStream ? "stream" : "packet";
+        rec["dataType"] = M17DataTypesTxt[lsf.dataType];
+        rec["encryption"] = M17EncryptionTypesTxt[lsf.encryptionType];
+        rec["can"] = lsf.channelAccessNum;
+        _this->emit(rec);
+    }
+
+    dsp::M17Receiver receiver;
+    float* symbols = NULL;
+
+    std::string lastSrc;
+    std::string lastDst;
+    uint16_t lastType = 0;
+    double lastLSF = -M17_TRANSMISSION_GAP;
+};
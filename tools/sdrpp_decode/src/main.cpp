@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <regex>
+#include <algorithm>
+#include <filesystem>
+#include <utils/flog.h>
+#include "wav_reader.h"
+#include "output.h"
+#include "pocsag_channel.h"
+#include "rds_channel.h"
+#include "meteor_channel.h"
+#include "m17_channel.h"
+
+// Decodes IQ recordings offline, as fast as the CPU allows, with the DSP of the decoder modules.
+// Each recording is handled by a single thread and several are decoded at once.
+
+const std::vector<std::string> DECODERS = {
+    "pocsag",
+    "rds",
+    "meteor",
+    "m17",
+};
+
+struct DecoderSpec {
+    std::string type;
+    double frequency;
+    ChannelOptions opts;
+};
+
+struct Recording {
+    std::string path;
+    double center;
+};
+
+void printUsage() {
+    printf("Usage: sdrpp_decode [options] <recording.wav[@center]>...\n\n");
+    printf("Options:\n");
+    printf("  -d, --decoder <type>:<frequency>[:<option>...]  Decoder to run on every recording\n");
+    printf("  -o, --output <dir>                              Where to write the records and images (default: .)\n");
+    printf("  -j, --jobs <count>                              Recordings decoded at once (default: one per core)\n");
+    printf("  -h, --help                                      Show this message\n\n");
+    printf("Decoders and their options:\n");
+    printf("  pocsag  baud=<512|1200|2400>\n");
+    printf("  rds     region=<eu|na>\n");
+    printf("  meteor  rate=<symbolrate>, oqpsk, diff, broken, rgb=<channels, ex: 125>\n");
+    printf("  m17\n");
+    printf("\nFrequencies are in Hz and may end with k, M or G. The center frequency of a recording\n");
+    printf("is taken from its name (ex: baseband_100000000Hz_...) unless given after an @.\n");
+}
+
+// Frequency in Hz with an optional k, M or G suffix
+bool parseFrequency(const std::string& str, double& freq) {
+    try {
+        size_t end;
+        freq = std::stod(str, &end);
+        std::string suffix = str.substr(end);
+        if (suffix == "k" || suffix == "K") { freq *= 1e3; }
+        else if (suffix == "M") { freq *= 1e6; }
+        else if (suffix == "G") { freq *= 1e9; }
+        else if (!suffix.empty()) { return false; }
+        return true;
+    }
+    catch (const std::exception& e) {
+        return false;
+    }
+}
+
+bool parseSpec(const std::string& str, DecoderSpec& spec) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = str.find(':', start);
+        parts.push_back(str.substr(start, end - start));
+        if (end == std::string::npos) { break; }
+        start = end + 1;
+    }
+    if (parts.size() < 2 || !parseFrequency(parts[1], spec.frequency)) { return false; }
+    spec.type = parts[0];
+    for (int i = 2; i < parts.size(); i++) {
+        size_t eq = parts[i].find('=');
+        if (eq == std::string::npos) {
+            spec.opts[parts[i]] = "";
+        }
+        else {
+            spec.opts[parts[i].substr(0, eq)] = parts[i].substr(eq + 1);
+        }
+    }
+    return true;
+}
+
+bool parseRecording(const std::string& str, Recording& rec) {
+    // An explicit center frequency comes after the last @
+    size_t at = str.rfind('@');
+    if (at != std::string::npos && parseFrequency(str.substr(at + 1), rec.center)) {
+        rec.path = str.substr(0, at);
+        return true;
+    }
+
+    // Otherwise use the frequency in the name like the file source does
+    rec.path = str;
+    std::string filename = std::filesystem::path(str).filename().string();
+    std::smatch matches;
+    if (!std::regex_search(filename, matches, std::regex("([0-9]+)Hz"))) { return false; }
+    rec.center = std::stod(matches[1].str());
+    return true;
+}
+
+// Wall clock time of the start of a recording from the time in its name, as written by the recorder (HH-MM-SS_DD-MM-YYYY)
+time_t parseStartTime(const std::string& path) {
+    std::string filename = std::filesystem::path(path).filename().string();
+    std::smatch m;
+    if (!std::regex_search(filename, m, std::regex("([0-9]{2})-([0-9]{2})-([0-9]{2})_([0-9]{2})-([0-9]{2})-([0-9]{4})"))) { return 0; }
+    tm t = {};
+    t.tm_hour = std::stoi(m[1].str());
+    t.tm_min = std::stoi(m[2].str());
+    t.tm_sec = std::stoi(m[3].str());
+    t.tm_mday = std::stoi(m[4].str());
+    t.tm_mon = std::stoi(m[5].str()) - 1;
+    t.tm_year = std::stoi(m[6].str()) - 1900;
+    t.tm_isdst = -1;
+    time_t start = mktime(&t);
+    return (start < 0) ? 0 : start;
+}
+
+std::unique_ptr<Channel> createChannel(const DecoderSpec& spec, Output* output) {
+    if (spec.type == "pocsag") { return std::make_unique<POCSAGChannel>(output, spec.frequency, spec.opts); }
+    if (spec.type == "rds") { return std::make_unique<RDSChannel>(output, spec.frequency, spec.opts); }
+    if (spec.type == "meteor") { return std::make_unique<MeteorChannel>(output, spec.frequency, spec.opts); }
+    if (spec.type == "m17") { return std::make_unique<M17Channel>(output, spec.frequency, spec.opts); }
+    return NULL;
+}
+
+bool decodeRecording(const Recording& rec, const std::vector<DecoderSpec>& specs, const std::string& outDir) {
+    WavReader reader;
+    if (!reader.open(rec.path)) {
+        flog::error("{0}: {1}", rec.path, reader.getError());
+        return false;
+    }
+    double samplerate = reader.getSamplerate();
+
+    Output output;
+    std::string name = std::filesystem::path(rec.path).stem().string();
+    if (!output.open(outDir, name, parseStartTime(rec.path))) {
+        flog::error("{0}: Could not create the output file", rec.path);
+        return false;
+    }
+
+    // Only the channels entirely within the recording are decoded
+    std::vector<std::unique_ptr<Channel>> channels;
+    for (const auto& spec : specs) {
+        std::unique_ptr<Channel> chan;
+        try {
+            chan = createChannel(spec, &output);
+        }
+        catch (const std::exception& e) {
+            flog::error("{0}: Invalid options for {1}: {2}", rec.path, spec.type, e.what());
+            continue;
+        }
+        double offset = spec.frequency - rec.center;
+        if (fabs(offset) + (chan->getBandwidth() / 2.0) > samplerate / 2.0) {
+            flog::warn("{0}: {1} at {2}Hz is outside of the recording", rec.path, spec.type, (int64_t)spec.frequency);
+            continue;
+        }
+        chan->init(samplerate, offset);
+        channels.push_back(std::move(chan));
+    }
+    if (channels.empty()) { return false; }
+
+    auto start = std::chrono::steady_clock::now();
+    dsp::complex_t* buf = dsp::buffer::alloc<dsp::complex_t>(DECODE_BLOCK_SIZE);
+    uint64_t pos = 0;
+    while (true) {
+        int count = reader.read(buf, DECODE_BLOCK_SIZE);
+        if (!count) { break; }
+        double time = (double)pos / samplerate;
+        for (auto& chan : channels) { chan->process(buf, count, time); }
+        pos += count;
+    }
+    for (auto& chan : channels) { chan->finish(); }
+    channels.clear();
+    dsp::buffer::free(buf);
+    output.close();
+
+    double duration = (double)pos / samplerate;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    flog::info("{0}: {1} records from {2}s of recording, {3}x real time", rec.path, output.getRecordCount(), (int)duration, (int)(duration / std::max<double>(elapsed, 1e-3)));
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<DecoderSpec> specs;
+    std::vector<Recording> recordings;
+    std::string outDir = ".";
+    int jobs = std::max<int>(std::thread::hardware_concurrency(), 1);
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        }
+        else if ((arg == "-d" || arg == "--decoder") && hasValue) {
+            DecoderSpec spec;
+            if (!parseSpec(argv[++i], spec)) {
+                fprintf(stderr, "Invalid decoder '%s'\n", argv[i]);
+                return -1;
+            }
+            if (std::find(DECODERS.begin(), DECODERS.end(), spec.type) == DECODERS.end()) {
+                fprintf(stderr, "Unknown decoder '%s'\n", spec.type.c_str());
+                return -1;
+            }
+            specs.push_back(spec);
+        }
+        else if ((arg == "-o" || arg == "--output") && hasValue) {
+            outDir = argv[++i];
+        }
+        else if ((arg == "-j" || arg == "--jobs") && hasValue) {
+            jobs = std::max<int>(std::atoi(argv[++i]), 1);
+        }
+        else if (!arg.empty() && arg[0] == '-') {
+            fprintf(stderr, "Invalid argument '%s'\n", arg.c_str());
+            printUsage();
+            return -1;
+        }
+        else {
+            Recording rec;
+            if (!parseRecording(arg, rec)) {
+                fprintf(stderr, "No center frequency for '%s', add it after an @\n", arg.c_str());
+                return -1;
+            }
+            recordings.push_back(rec);
+        }
+    }
+    if (specs.empty() || recordings.empty()) {
+        printUsage();
+        return -1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(outDir, ec);
+    if (!std::filesystem::is_directory(outDir)) {
+        fprintf(stderr, "Could not create the output directory '%s'\n", outDir.c_str());
+        return -1;
+    }
+
+    // Each worker takes the next recording until none are left
+    std::atomic<int> next = 0;
+    std::atomic<int> failed = 0;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::min<int>(jobs, recordings.size()); i++) {
+        workers.push_back(std::thread([&]() {
+            for (int n = next++; n < recordings.size(); n = next++) {
+                if (!decodeRecording(recordings[n], specs, outDir)) { failed++; }
+            }
+        }));
+    }
+    for (auto& w : workers) { w.join(); }
+
+    return failed ? -1 : 0;
+}
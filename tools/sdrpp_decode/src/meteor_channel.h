@@ -0,0 +1,112 @@
+#pragma once
+#include "channel.h"
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <meteor_demod.h>
+#include <lrpt/decoder.h>
+
+#define METEOR_CHANNEL_SAMPLERATE   150000.0
+#define METEOR_DEFAULT_SYMBOLRATE   72000.0
+
+// Meteor LRPT images. The strips are gathered for the whole pass and written out as one image
+// per channel present, plus a colour composite, once the recording ends.
+class MeteorChannel : public Channel {
+public:
+    MeteorChannel(Output* output, double frequency, const ChannelOptions& opts) : Channel(output, "meteor", frequency), decoder(1) {
+        double symbolrate = opts.count("rate") ? std::stod(opts.at("rate")) : METEOR_DEFAULT_SYMBOLRATE;
+        demod.init(NULL, symbolrate, METEOR_CHANNEL_SAMPLERATE, 33, 0.6f, 0.1f, 0.005f, opts.count("broken"), opts.count("oqpsk"), 1e-6, 0.01);
+        demod.out.free();
+
+        // Channels of the composite, 1 to 6 as red, green and blue
+        std::string rgb = opts.count("rgb") ? opts.at("rgb") : "123";
+        for (int i = 0; i < 3; i++) {
+            composite[i] = (i < (int)rgb.size()) ? std::clamp<int>(rgb[i] - '1', 0, MSUMR_CHANNEL_COUNT - 1) : i;
+        }
+
+        // Strips are given out by the decoder's worker, a single one so that each file keeps to one core
+        decoder.setDifferential(opts.count("diff"));
+        decoder.setBlocking(true);
+        decoder.onStrip.bind([=](const lrpt::MSUMR::Strip& strip) {
+            std::lock_guard<std::mutex> lck(stripMtx);
+            for (int ch = 0; ch < MSUMR_CHANNEL_COUNT; ch++) {
+                present[ch] |= strip.present[ch];
+                pixels[ch].insert(pixels[ch].end(), strip.pixels[ch], &strip.pixels[ch][MSUMR_WIDTH * MSUMR_STRIP_HEIGHT]);
+            }
+            stripCount++;
+        });
+        decoder.start();
+    }
+
+    ~MeteorChannel() {
+        decoder.stop();
+        if (soft) { delete[] soft; }
+    }
+
+    double getSamplerate() { return METEOR_CHANNEL_SAMPLERATE; }
+    double getBandwidth() { return METEOR_CHANNEL_SAMPLERATE; }
+
+    void finish() {
+        decoder.flush();
+        decoder.stop();
+        lrpt::Decoder::Stats stats = decoder.getStats();
+
+        json rec;
+        rec["frames"] = stats.frames;
+        rec["framesOK"] = stats.framesOK;
+        rec["strips"] = stripCount;
+        rec["images"] = json::array();
+        if (!stripCount) {
+            emit(rec);
+            return;
+        }
+
+        int height = stripCount * MSUMR_STRIP_HEIGHT;
+        for (int ch = 0; ch < MSUMR_CHANNEL_COUNT; ch++) {
+            if (!present[ch]) { continue; }
+            std::string name = output->writeImage("meteor_" + std::to_string((int64_t)frequency) + "_ch" + std::to_string(ch + 1), pixels[ch].data(), MSUMR_WIDTH, height, 1);
+            if (!name.empty()) { rec["images"].push_back(name); }
+        }
+
+        // Missing channels of the composite are left black
+        if (present[composite[0]] || present[composite[1]] || present[composite[2]]) {
+            std::vector<uint8_t> rgb((size_t)MSUMR_WIDTH * height * 3, 0);
+            for (int c = 0; c < 3; c++) {
+                if (!present[composite[c]]) { continue; }
+                const uint8_t* src = pixels[composite[c]].data();
+                for (size_t i = 0; i < (size_t)MSUMR_WIDTH * height; i++) { rgb[(3 * i) + c] = src[i]; }
+            }
+            std::string suffix = "meteor_" + std::to_string((int64_t)frequency) + "_rgb" + std::to_string(composite[0] + 1) + std::to_string(composite[1] + 1) + std::to_string(composite[2] + 1);
+            std::string name = output->writeImage(suffix, rgb.data(), MSUMR_WIDTH, height, 3);
+            if (!name.empty()) { rec["images"].push_back(name); }
+        }
+        emit(rec);
+    }
+
+protected:
+    void prepare(int maxCount) {
+        soft = new int8_t[maxCount * 2];
+    }
+
+    void decode(dsp::complex_t* in, int count) {
+        count = demod.process(count, in, in);
+
+        // Soft symbols in the format of the recordings, as in the module
+        for (int i = 0; i < count; i++) {
+            soft[(2 * i)] = std::clamp<int>(in[i].re * 84.0f, -127, 127);
+            soft[(2 * i) + 1] = std::clamp<int>(in[i].im * 84.0f, -127, 127);
+        }
+        decoder.process(soft, count);
+    }
+
+private:
+    dsp::demod::Meteor demod;
+    lrpt::Decoder decoder;
+    int8_t* soft = NULL;
+    int composite[3];
+
+    std::mutex stripMtx;
+    bool present[MSUMR_CHANNEL_COUNT] = { false };
+    std::vector<uint8_t> pixels[MSUMR_CHANNEL_COUNT];
+    int stripCount = 0;
+};
@@ -0,0 +1,135 @@
+#include "output.h"
+#include <vector>
+#include <math.h>
+#include <algorithm>
+
+#define PNG_MAX_STORED_BLOCK    65535
+
+namespace {
+    struct CRCTable {
+        CRCTable() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int j = 0; j < 8; j++) { c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1); }
+                table[i] = c;
+            }
+        }
+
+        uint32_t table[256];
+    };
+
+    const CRCTable crcTable;
+
+    void putBE32(std::vector<uint8_t>& buf, uint32_t val) {
+        buf.push_back(val >> 24);
+        buf.push_back(val >> 16);
+        buf.push_back(val >> 8);
+        buf.push_back(val);
+    }
+
+    void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> chunk;
+        putBE32(chunk, data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+
+        // The CRC covers the type and the data
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 4; i < chunk.size(); i++) { crc = crcTable.table[(crc ^ chunk[i]) & 0xFF] ^ (crc >> 8); }
+        putBE32(chunk, crc ^ 0xFFFFFFFF);
+
+        file.write((char*)chunk.data(), chunk.size());
+    }
+
+    std::string formatTime(time_t startTime, double offset) {
+        double secs = floor(offset);
+        time_t t = startTime + (time_t)secs;
+        tm utc;
+#ifdef _WIN32
+        gmtime_s(&utc, &t);
+#else
+        gmtime_r(&t, &utc);
+#endif
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                 utc.tm_hour, utc.tm_min, utc.tm_sec, std::min<int>(round((offset - secs) * 1000.0), 999));
+        return buf;
+    }
+}
+
+bool Output::open(const std::string& dir, const std::string& name, time_t startTime) {
+    std::lock_guard<std::mutex> lck(mtx);
+    this->dir = dir;
+    this->name = name;
+    this->startTime = startTime;
+    recordCount = 0;
+    file = std::ofstream(dir + "/" + name + ".jsonl");
+    return file.is_open();
+}
+
+void Output::close() {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (file.is_open()) { file.close(); }
+}
+
+void Output::write(double time, json record) {
+    std::lock_guard<std::mutex> lck(mtx);
+    time = round(time * 1000.0) / 1000.0;
+    record["time"] = time;
+    if (startTime) { record["utc"] = formatTime(startTime, time); }
+    file << record.dump() << std::endl;
+    recordCount++;
+}
+
+std::string Output::writeImage(const std::string& suffix, const uint8_t* pixels, int width, int height, int channels) {
+    std::string filename = name + "_" + suffix + ".png";
+    std::ofstream img(dir + "/" + filename, std::ios::binary);
+    if (!img.is_open()) { return ""; }
+
+    const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    img.write((char*)signature, sizeof(signature));
+
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, width);
+    putBE32(ihdr, height);
+    ihdr.push_back(8);                          // Bit depth
+    ihdr.push_back((channels == 3) ? 2 : 0);    // RGB or grey
+    ihdr.push_back(0);                          // Deflate
+    ihdr.push_back(0);                          // Adaptive filtering
+    ihdr.push_back(0);                          // No interlacing
+    writeChunk(img, "IHDR", ihdr);
+
+    // Each line starts with its filter type, none here
+    int stride = width * channels;
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)(stride + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), &pixels[(size_t)y * stride], &pixels[(size_t)(y + 1) * stride]);
+    }
+
+    // zlib stream of uncompressed deflate blocks, the core has no zlib
+    std::vector<uint8_t> idat = { 0x78, 0x01 };
+    for (size_t pos = 0;;) {
+        size_t len = std::min<size_t>(raw.size() - pos, PNG_MAX_STORED_BLOCK);
+        bool last = (pos + len == raw.size());
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(len & 0xFF);
+        idat.push_back(len >> 8);
+        idat.push_back(~len & 0xFF);
+        idat.push_back((~len >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+        if (last) { break; }
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBE32(idat, (b << 16) | a);
+    writeChunk(img, "IDAT", idat);
+    writeChunk(img, "IEND", {});
+
+    return filename;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <time.h>
+#include <stdint.h>
+#include <json.hpp>
+
+using nlohmann::json;
+
+// Everything decoded from one recording: a JSON Lines file of records and the images next to it,
+// all named after the recording
+class Output {
+public:
+    // The start time is the wall clock time of the first sample, 0 if unknown
+    bool open(const std::string& dir, const std::string& name, time_t startTime);
+    void close();
+
+    // Adds the time of the record, given in seconds from the start of the recording
+    void write(double time, json record);
+
+    // Writes an 8bit grey or RGB image as PNG, returns the name of the file or an empty string
+    std::string writeImage(const std::string& suffix, const uint8_t* pixels, int width, int height, int channels);
+
+    int getRecordCount() { return recordCount; }
+
+private:
+    std::mutex mtx;
+    std::ofstream file;
+    std::string dir;
+    std::string name;
+    time_t startTime = 0;
+    int recordCount = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "channel.h"
+#include <pocsag/dsp.h>
+#include <pocsag/pocsag.h>
+
+#define POCSAG_CHANNEL_SAMPLERATE   24000.0
+#define POCSAG_CHANNEL_BANDWIDTH    12500.0
+
+class POCSAGChannel : public Channel {
+public:
+    POCSAGChannel(Output* output, double frequency, const ChannelOptions& opts) : Channel(output, "pocsag", frequency) {
+        baudrate = opts.count("baud") ? std::stoi(opts.at("baud")) : 1200;
+        dsp.init(NULL, POCSAG_CHANNEL_SAMPLERATE, baudrate);
+        dsp.out.free();
+
+        decoder.onMessage.bind([=](pocsag::Address addr, pocsag::MessageType type, const std::string& msg) {
+            json rec;
+            rec["baudrate"] = baudrate;
+            rec["address"] = addr;
+            rec["type"] = (type == pocsag::MESSAGE_TYPE_ALPHANUMERIC) ? "alphanumeric" : "numeric";
+            rec["message"] = msg;
+            emit(rec);
+        });
+    }
+
+    ~POCSAGChannel() {
+        if (soft) { dsp::buffer::free(soft); }
+    }
+
+    double getSamplerate() { return POCSAG_CHANNEL_SAMPLERATE; }
+    double getBandwidth() { return POCSAG_CHANNEL_BANDWIDTH; }
+
+protected:
+    void prepare(int maxCount) {
+        soft = dsp::buffer::alloc<float>(maxCount);
+    }
+
+    void decode(dsp::complex_t* in, int count) {
+        count = dsp.process(count, in, soft);
+        decoder.process(soft, count);
+    }
+
+private:
+    int baudrate;
+    POCSAGDSP dsp;
+    pocsag::Decoder decoder;
+    float* soft = NULL;
+};
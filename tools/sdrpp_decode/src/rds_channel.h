@@ -0,0 +1,88 @@
+#pragma once
+#include "channel.h"
+#include <dsp/demod/broadcast_fm.h>
+#include <rds_demod.h>
+#include <rds.h>
+
+#define RDS_CHANNEL_SAMPLERATE  250000.0
+#define RDS_CHANNEL_BANDWIDTH   150000.0
+
+// Broadcast FM station information. A record is written every time the decoded information changes.
+class RDSChannel : public Channel {
+public:
+    RDSChannel(Output* output, double frequency, const ChannelOptions& opts) : Channel(output, "rds", frequency) {
+        northAmerica = opts.count("region") && opts.at("region") == "na";
+        demod.init(NULL, RDS_CHANNEL_BANDWIDTH / 2.0, RDS_CHANNEL_SAMPLERATE, true, false, true);
+        rdsDemod.init(NULL, false);
+        rdsDemod.out.free();
+        rdsDemod.soft.free();
+    }
+
+    ~RDSChannel() {
+        if (!audio) { return; }
+        dsp::buffer::free(audio);
+        dsp::buffer::free(rdsBuf);
+        dsp::buffer::free(soft);
+        dsp::buffer::free(symbols);
+    }
+
+    double getSamplerate() { return RDS_CHANNEL_SAMPLERATE; }
+    double getBandwidth() { return RDS_CHANNEL_BANDWIDTH; }
+
+protected:
+    void prepare(int maxCount) {
+        audio = dsp::buffer::alloc<dsp::stereo_t>(maxCount);
+        rdsBuf = dsp::buffer::alloc<dsp::complex_t>(maxCount);
+        soft = dsp::buffer::alloc<float>(maxCount);
+        symbols = dsp::buffer::alloc<float>(maxCount);
+    }
+
+    void decode(dsp::complex_t* in, int count) {
+        int rdsCount = 0;
+        demod.process(count, in, audio, rdsCount, rdsBuf);
+        rdsCount = rdsDemod.process(rdsCount, rdsBuf, soft, symbols);
+        decoder.process(symbols, rdsCount);
+        update();
+    }
+
+private:
+    void update() {
+        json rec;
+        if (decoder.piCodeValid()) {
+            char pi[8];
+            snprintf(pi, sizeof(pi), "%04X", decoder.getPICode());
+            rec["pi"] = pi;
+            if (northAmerica) { rec["callsign"] = decoder.getCallsign(); }
+        }
+        if (decoder.programTypeValid()) {
+            int pty = decoder.getProgramType();
+            rec["pty"] = northAmerica ? rds::PROGRAM_TYPE_US_TO_STR[pty] : rds::PROGRAM_TYPE_EU_TO_STR[pty];
+        }
+        if (decoder.PSNameValid()) { rec["ps"] = decoder.getPSName(); }
+        if (decoder.radioTextValid()) {
+            std::string rt = decoder.getRadioText();
+            rt.erase(rt.find_last_not_of(' ') + 1);
+            rec["rt"] = rt;
+        }
+
+        // Information going stale isn't a change worth a record
+        bool changed = false;
+        for (auto& it : rec.items()) {
+            if (!last.contains(it.key()) || last[it.key()] != it.value()) { changed = true; }
+        }
+        if (!changed) { return; }
+        last.update(rec);
+        emit(last);
+    }
+
+    bool northAmerica;
+    dsp::demod::BroadcastFM demod;
+    RDSDemod rdsDemod;
+    rds::Decoder decoder;
+    json last = json::object();
+
+    dsp::stereo_t* audio = NULL;
+    dsp::complex_t* rdsBuf = NULL;
+    float* soft = NULL;
+    float* symbols = NULL;
+};
@@ -0,0 +1,125 @@
+#include "wav_reader.h"
+#include <string.h>
+#include <algorithm>
+#include <utils/wav.h>
+
+#define WAV_CODEC_EXTENSIBLE    0xFFFE
+#define WAV_RF64_SIZE_MARKER    0xFFFFFFFF
+
+namespace {
+#pragma pack(push, 1)
+    struct ChunkHeader {
+        char id[4];
+        uint32_t size;
+    };
+
+    struct DS64Header {
+        uint64_t riffSize;
+        uint64_t dataSize;
+        uint64_t sampleCount;
+    };
+#pragma pack(pop)
+}
+
+bool WavReader::open(const std::string& path) {
+    close();
+    file = std::ifstream(path, std::ios::binary);
+    if (!file.is_open()) { return fail("Could not open file"); }
+
+    // Size of the file, to bound the data of recordings that were never finalized
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    char form[12];
+    if (!file.read(form, sizeof(form))) { return fail("File too short"); }
+    bool rf64 = !memcmp(form, "RF64", 4);
+    if ((memcmp(form, "RIFF", 4) && !rf64) || memcmp(&form[8], "WAVE", 4)) { return fail("Not a wave file"); }
+
+    // Walk the chunks up to the data, the sizes of RF64 files are in the ds64 chunk
+    wav::FormatHeader fmt;
+    uint16_t codec = 0;
+    bool haveFormat = false;
+    uint64_t ds64DataSize = 0;
+    while (true) {
+        ChunkHeader hdr;
+        if (!file.read((char*)&hdr, sizeof(hdr))) { return fail("No data chunk"); }
+        uint64_t pos = file.tellg();
+
+        if (!memcmp(hdr.id, "ds64", 4)) {
+            DS64Header ds64;
+            if (hdr.size < sizeof(ds64) || !file.read((char*)&ds64, sizeof(ds64))) { return fail("Invalid ds64 chunk"); }
+            ds64DataSize = ds64.dataSize;
+        }
+        else if (!memcmp(hdr.id, "fmt ", 4)) {
+            if (hdr.size < sizeof(fmt) || !file.read((char*)&fmt, sizeof(fmt))) { return fail("Invalid format chunk"); }
+            codec = fmt.codec;
+
+            // The extensible format gives the codec in the first two bytes of its subformat GUID
+            if (codec == WAV_CODEC_EXTENSIBLE) {
+                uint8_t ext[10];
+                if (hdr.size < sizeof(fmt) + sizeof(ext) || !file.read((char*)ext, sizeof(ext))) { return fail("Invalid extensible format"); }
+                codec = ext[8] | (ext[9] << 8);
+            }
+            haveFormat = true;
+        }
+        else if (!memcmp(hdr.id, "data", 4)) {
+            if (!haveFormat) { return fail("Data before the format chunk"); }
+            uint64_t dataSize = (rf64 && hdr.size == WAV_RF64_SIZE_MARKER) ? ds64DataSize : hdr.size;
+            if (!dataSize || dataSize > fileSize - pos) { dataSize = fileSize - pos; }
+
+            if (fmt.channelCount != 2) { return fail("Not an IQ file, it has " + std::to_string(fmt.channelCount) + " channels"); }
+            if (codec == wav::CODEC_FLOAT && fmt.bitDepth == 32) {
+                conv.init(dsp::convert::SAMPLE_FORMAT_F32, 1.0f);
+            }
+            else if (codec == wav::CODEC_PCM && fmt.bitDepth == 8) {
+                conv.init(dsp::convert::SAMPLE_FORMAT_U8, 1.0f / 128.0f, 128.0f);
+            }
+            else if (codec == wav::CODEC_PCM && fmt.bitDepth == 16) {
+                conv.init(dsp::convert::SAMPLE_FORMAT_S16, 1.0f / 32768.0f);
+            }
+            else if (codec == wav::CODEC_PCM && fmt.bitDepth == 32) {
+                conv.init(dsp::convert::SAMPLE_FORMAT_S32, 1.0f / 2147483648.0f);
+            }
+            else {
+                return fail("Unsupported sample format (codec " + std::to_string(codec) + ", " + std::to_string(fmt.bitDepth) + "bit)");
+            }
+
+            samplerate = fmt.sampleRate;
+            sampleSize = dsp::convert::sampleFormatSize(conv.getFormat());
+            sampleCount = dataSize / sampleSize;
+            samplesLeft = sampleCount;
+            if (!samplerate) { return fail("Invalid samplerate"); }
+            return true;
+        }
+
+        // Chunks are padded to an even size
+        file.seekg(pos + hdr.size + (hdr.size & 1));
+    }
+}
+
+void WavReader::close() {
+    if (file.is_open()) { file.close(); }
+    samplerate = 0;
+    sampleCount = 0;
+    samplesLeft = 0;
+}
+
+int WavReader::read(dsp::complex_t* out, int count) {
+    count = std::min<uint64_t>(count, samplesLeft);
+    if (count <= 0) { return 0; }
+
+    raw.resize(count * sampleSize);
+    file.read((char*)raw.data(), raw.size());
+    count = file.gcount() / sampleSize;
+    samplesLeft = count ? (samplesLeft - count) : 0;
+
+    conv.process(count, raw.data(), out);
+    return count;
+}
+
+bool WavReader::fail(const std::string& msg) {
+    error = msg;
+    close();
+    return false;
+}
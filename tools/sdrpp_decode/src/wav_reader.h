@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include <dsp/types.h>
+#include <dsp/convert/sample_format.h>
+
+// Reads the IQ recordings of SDR++ and most other programs: stereo RIFF or RF64 wave files
+// of 8, 16 or 32bit integers or 32bit floats, converted to complex samples as they are read.
+class WavReader {
+public:
+    bool open(const std::string& path);
+    void close();
+
+    // Returns the number of samples read, 0 at the end of the file
+    int read(dsp::complex_t* out, int count);
+
+    uint32_t getSamplerate() { return samplerate; }
+    uint64_t getSampleCount() { return sampleCount; }
+    const std::string& getError() { return error; }
+
+private:
+    bool fail(const std::string& msg);
+
+    std::ifstream file;
+    std::string error;
+    uint32_t samplerate = 0;
+    uint64_t sampleCount = 0;
+    uint64_t samplesLeft = 0;
+    int sampleSize = 0;
+    dsp::convert::SampleConverter conv;
+    std::vector<uint8_t> raw;
+};